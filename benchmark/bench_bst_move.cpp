@@ -59,6 +59,41 @@ BENCHMARK_DEFINE_F(MoveYggRBBSTFixture, BM_BST_Move)
 }
 REGISTER(MoveYggRBBSTFixture, BM_BST_Move)
 
+/*
+ * Ygg's Red-Black Tree, using update_key()
+ */
+using MoveYggRBBSTFixtureUK = BSTFixture<YggRBTreeInterface<BasicTreeOptions>,
+                                         MoveExperiment, BSTMoveOptions>;
+BENCHMARK_DEFINE_F(MoveYggRBBSTFixtureUK, BM_BST_Move)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (size_t i = 0; i < this->experiment_node_pointers.size(); i++) {
+			auto * n = this->experiment_node_pointers[i];
+			auto new_val = this->experiment_values[i];
+
+			this->t.update_key(
+			    *n, [&](auto & node) { NodeInterface::set_value(node, new_val); });
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+
+		for (size_t i = 0; i < this->experiment_node_pointers.size(); i++) {
+			auto * n = this->experiment_node_pointers[i];
+			auto old_val = this->fixed_values[i];
+
+			this->t.update_key(
+			    *n, [&](auto & node) { NodeInterface::set_value(node, old_val); });
+		}
+	}
+
+	this->papi.report_and_reset(state);
+}
+REGISTER(MoveYggRBBSTFixtureUK, BM_BST_Move)
+
 /*
  * Ygg's Red-Black Tree, using color compression
  */
@@ -90,6 +90,54 @@ BENCHMARK_DEFINE_F(SearchYggRBBSTFixture, BM_BST_Search)
 }
 REGISTER(SearchYggRBBSTFixture, BM_BST_Search)
 
+/*
+ * Ygg's Red-Black Tree, with a hash index for find()
+ */
+using SearchYggHashRBBSTFixture =
+    BSTFixture<YggHashAcceleratedRBTreeInterface<BasicTreeOptions>,
+               SearchExperiment, BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggHashRBBSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggHashRBBSTFixture, BM_BST_Search)
+
+/*
+ * Ygg's Red-Black Tree, with a Bloom filter in front of find()
+ */
+using SearchYggBloomRBBSTFixture =
+    BSTFixture<YggBloomFilteredRBTreeInterface<BasicTreeOptions>,
+               SearchExperiment, BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggBloomRBBSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggBloomRBBSTFixture, BM_BST_Search)
+
 /*
  * Ygg's Red-Black Tree, using color compression
  */
@@ -272,6 +320,126 @@ BENCHMARK_DEFINE_F(SearchYggWB32SPBSTFixture, BM_BST_Search)
 }
 REGISTER(SearchYggWB32SPBSTFixture, BM_BST_Search)
 
+/*
+ * Ygg's Splay Tree. Use -DUSEZIPF or -DUSESKEWED for skewed lookups.
+ */
+using SearchYggSplayBSTFixture =
+    BSTFixture<YggSplayTreeInterface<BasicTreeOptions>, SearchExperiment,
+               BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggSplayBSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggSplayBSTFixture, BM_BST_Search)
+
+/*
+ * Ygg's Splay Tree, semi-splaying
+ */
+using SearchYggSplaySemiBSTFixture =
+    BSTFixture<YggSplayTreeInterface<SplaySemiTreeOptions>,
+               SearchExperiment, BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggSplaySemiBSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggSplaySemiBSTFixture, BM_BST_Search)
+
+/*
+ * Ygg's Splay Tree, splaying on every fourth lookup
+ */
+using SearchYggSplayEvery4BSTFixture =
+    BSTFixture<YggSplayTreeInterface<SplayEvery4TreeOptions>,
+               SearchExperiment, BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggSplayEvery4BSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggSplayEvery4BSTFixture, BM_BST_Search)
+
+/*
+ * Ygg's B+-Tree Index
+ */
+using SearchYggBTreeIndexBSTFixture =
+    BSTFixture<YggBTreeIndexInterface<BasicTreeOptions>, SearchExperiment,
+               BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggBTreeIndexBSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggBTreeIndexBSTFixture, BM_BST_Search)
+
+/*
+ * Ygg's Crit-Bit Tree
+ */
+using SearchYggCritBitBSTFixture =
+    BSTFixture<YggCritBitTreeInterface<BasicTreeOptions>, SearchExperiment,
+               BSTSearchOptions>;
+BENCHMARK_DEFINE_F(SearchYggCritBitBSTFixture, BM_BST_Search)
+(benchmark::State & state)
+{
+	Clock c;
+	for (auto _ : state) {
+		c.start();
+		this->papi.start();
+		for (auto val : this->experiment_values) {
+			auto node = this->t.find(val);
+			benchmark::DoNotOptimize(node);
+		}
+		this->papi.stop();
+		state.SetIterationTime(c.get());
+	}
+	this->papi.report_and_reset(state);
+}
+REGISTER(SearchYggCritBitBSTFixture, BM_BST_Search)
+
 /*
  * Ygg's Zip Tree, using randomness
  */
@@ -469,6 +469,109 @@ public:
 	}
 };
 
+/*
+ * Hash-Accelerated Red-Black Tree Interface
+ */
+class RBNodeKeyGetter {
+public:
+	template <class MyTreeOptions>
+	static int
+	get_key(const RBNode<MyTreeOptions> & n)
+	{
+		return n.get_value();
+	}
+};
+
+template <class MyTreeOptions>
+class YggHashAcceleratedRBTreeInterface {
+public:
+	using Node = RBNode<MyTreeOptions>;
+	using Tree = ygg::HashAccelerated<
+	    ygg::RBTree<Node, ygg::RBDefaultNodeTraits, MyTreeOptions>,
+	    RBNodeKeyGetter>;
+
+	static void
+	insert(Tree & t, Node & n)
+	{
+		t.insert(n);
+	}
+
+	static std::string
+	get_name()
+	{
+		return "HashAccelerated[RBTree]";
+	}
+
+	static int
+	get_value(const Node & n)
+	{
+		return n.get_value();
+	}
+
+	static void
+	set_value(Node & n, int val)
+	{
+		n.set_value(val);
+	}
+
+	static Node
+	create_node(int val)
+	{
+		return Node(val);
+	}
+
+	static void
+	clear(Tree & t)
+	{
+		t.clear();
+	}
+};
+
+template <class MyTreeOptions>
+class YggBloomFilteredRBTreeInterface {
+public:
+	using Node = RBNode<MyTreeOptions>;
+	using Tree = ygg::BloomFiltered<
+	    ygg::RBTree<Node, ygg::RBDefaultNodeTraits, MyTreeOptions>,
+	    RBNodeKeyGetter>;
+
+	static void
+	insert(Tree & t, Node & n)
+	{
+		t.insert(n);
+	}
+
+	static std::string
+	get_name()
+	{
+		return "BloomFiltered[RBTree]";
+	}
+
+	static int
+	get_value(const Node & n)
+	{
+		return n.get_value();
+	}
+
+	static void
+	set_value(Node & n, int val)
+	{
+		n.set_value(val);
+	}
+
+	static Node
+	create_node(int val)
+	{
+		return Node(val);
+	}
+
+	static void
+	clear(Tree & t)
+	{
+		t.clear();
+	}
+};
+
 /*
  * Weight-Balanced Tree Interface
  */
@@ -652,6 +755,248 @@ public:
 	}
 };
 
+/*
+ * Splay Tree Interface
+ */
+template <class MyTreeOptions>
+class SplayNode
+    : public ygg::SplayTreeNodeBase<SplayNode<MyTreeOptions>, MyTreeOptions> {
+private:
+	int value;
+
+public:
+	SplayNode(int value_in) : value(value_in){};
+
+	void
+	set_value(int new_value)
+	{
+		this->value = new_value;
+	}
+
+	int
+	get_value() const
+	{
+		return this->value;
+	}
+
+	bool
+	operator<(const SplayNode<MyTreeOptions> & rhs) const
+	{
+		return this->value < rhs.value;
+	}
+};
+
+template <class T>
+bool
+operator<(const SplayNode<T> & lhs, int rhs)
+{
+	return lhs.get_value() < rhs;
+}
+template <class T>
+bool
+operator<(int lhs, const SplayNode<T> & rhs)
+{
+	return lhs < rhs.get_value();
+}
+
+template <class MyTreeOptions>
+class YggSplayTreeInterface {
+public:
+	using Node = SplayNode<MyTreeOptions>;
+	using Tree = ygg::SplayTree<Node, MyTreeOptions>;
+
+	static void
+	insert(Tree & t, Node & n)
+	{
+		t.insert(n);
+	}
+
+	static std::string
+	get_name()
+	{
+		return "SplayTree";
+	}
+
+	static int
+	get_value(const Node & n)
+	{
+		return n.get_value();
+	}
+
+	static void
+	set_value(Node & n, int val)
+	{
+		n.set_value(val);
+	}
+
+	static Node
+	create_node(int val)
+	{
+		return Node(val);
+	}
+
+	static void
+	clear(Tree & t)
+	{
+		t.clear();
+	}
+};
+
+/*
+ * B+-Tree Index Interface
+ */
+class BTreeIndexNode {
+private:
+	int value;
+
+public:
+	BTreeIndexNode(int value_in) : value(value_in){};
+
+	void
+	set_value(int new_value)
+	{
+		this->value = new_value;
+	}
+
+	int
+	get_value() const
+	{
+		return this->value;
+	}
+};
+
+class BTreeIndexKeyGetter {
+public:
+	static int
+	get_key(const BTreeIndexNode & n)
+	{
+		return n.get_value();
+	}
+};
+
+template <class MyTreeOptions>
+class YggBTreeIndexInterface {
+public:
+	using Node = BTreeIndexNode;
+	using Tree =
+	    ygg::IntrusiveBTreeIndex<Node, BTreeIndexKeyGetter, MyTreeOptions>;
+
+	static void
+	insert(Tree & t, Node & n)
+	{
+		t.insert(n);
+	}
+
+	static std::string
+	get_name()
+	{
+		return "BTreeIndex";
+	}
+
+	static int
+	get_value(const Node & n)
+	{
+		return n.get_value();
+	}
+
+	static void
+	set_value(Node & n, int val)
+	{
+		n.set_value(val);
+	}
+
+	static Node
+	create_node(int val)
+	{
+		return Node(val);
+	}
+
+	static void
+	clear(Tree & t)
+	{
+		t.clear();
+	}
+};
+
+/*
+ * Crit-Bit Tree Interface
+ */
+template <class MyTreeOptions>
+class CritBitNode
+    : public ygg::CritBitNodeBase<CritBitNode<MyTreeOptions>, MyTreeOptions> {
+private:
+	int value;
+
+public:
+	CritBitNode(int value_in) : value(value_in){};
+
+	void
+	set_value(int new_value)
+	{
+		this->value = new_value;
+	}
+
+	int
+	get_value() const
+	{
+		return this->value;
+	}
+};
+
+template <class MyTreeOptions>
+class CritBitKeyGetter {
+public:
+	static int
+	get_key(const CritBitNode<MyTreeOptions> & n)
+	{
+		return n.get_value();
+	}
+};
+
+template <class MyTreeOptions>
+class YggCritBitTreeInterface {
+public:
+	using Node = CritBitNode<MyTreeOptions>;
+	using Tree =
+	    ygg::CritBitTree<Node, CritBitKeyGetter<MyTreeOptions>, MyTreeOptions>;
+
+	static void
+	insert(Tree & t, Node & n)
+	{
+		t.insert(n);
+	}
+
+	static std::string
+	get_name()
+	{
+		return "CritBitTree";
+	}
+
+	static int
+	get_value(const Node & n)
+	{
+		return n.get_value();
+	}
+
+	static void
+	set_value(Node & n, int val)
+	{
+		n.set_value(val);
+	}
+
+	static Node
+	create_node(int val)
+	{
+		return Node(val);
+	}
+
+	static void
+	clear(Tree & t)
+	{
+		t.clear();
+	}
+};
+
 /*
  * Zip Tree Interface
  */
@@ -880,6 +1225,12 @@ using RBColorCompressTreeOptions =
 using RBPrefetchTreeOptions =
     ygg::TreeOptions<ygg::TreeFlags::MULTIPLE, ygg::TreeFlags::MICRO_PREFETCH>;
 
+/* Variants of the splay tree */
+using SplaySemiTreeOptions =
+    ygg::TreeOptions<ygg::TreeFlags::MULTIPLE, ygg::TreeFlags::SPLAY_SEMI>;
+using SplayEvery4TreeOptions =
+    ygg::TreeOptions<ygg::TreeFlags::MULTIPLE, ygg::TreeFlags::SPLAY_EVERY<4>>;
+
 /* Variants of the zip tree */
 using ZRandomTreeOptions =
     ygg::TreeOptions<ygg::TreeFlags::MULTIPLE,
@@ -0,0 +1,620 @@
+#ifndef YGG_AUGMENTED_CPP
+#define YGG_AUGMENTED_CPP
+
+#include "augmented.hpp"
+
+#include <cassert>
+#include <vector>
+
+namespace ygg {
+
+namespace augmented_internal {
+// @cond INTERNAL
+
+template <class Monoid, class NB, class Node>
+typename Monoid::value_type
+get_aggregate(const Node * node)
+{
+	if (node == nullptr) {
+		return Monoid::identity();
+	}
+	return node->AugmentedNodeBase<Node, Monoid>::_aug_aggregate;
+}
+
+template <class Monoid, class NB, class Node>
+typename Monoid::value_type
+compute_aggregate(const Node * node, const typename Monoid::value_type & left,
+                  const typename Monoid::value_type & right)
+{
+	if constexpr (is_lazy<Monoid>::value) {
+		using ANB = AugmentedNodeBase<Node, Monoid>;
+		if (node->ANB::_aug_has_tag) {
+			// The children do not know about the tag yet
+			return Monoid::combine(Monoid::apply(left, node->ANB::_aug_tag),
+			                       Monoid::get_value(*node),
+			                       Monoid::apply(right, node->ANB::_aug_tag));
+		}
+	}
+
+	return Monoid::combine(left, Monoid::get_value(*node), right);
+}
+
+template <class Monoid, class NB, class Node>
+void
+fix_node(Node * node)
+{
+	node->AugmentedNodeBase<Node, Monoid>::_aug_aggregate =
+	    compute_aggregate<Monoid, NB>(
+	        node, get_aggregate<Monoid, NB>(node->NB::get_left()),
+	        get_aggregate<Monoid, NB>(node->NB::get_right()));
+}
+
+/*
+ * Recomputes the aggregates of <node> and all its ancestors, stopping before
+ * <stop>. Passing nullptr as <stop> fixes everything up to the root.
+ */
+template <class Monoid, class NB, class Node>
+void
+fix_path(Node * node, const Node * stop)
+{
+	while (node != stop) {
+		fix_node<Monoid, NB>(node);
+		node = node->NB::get_parent();
+	}
+}
+
+template <class Monoid, class NB, class Node>
+void
+fix_to_root(Node * node)
+{
+	fix_path<Monoid, NB>(node, static_cast<const Node *>(nullptr));
+}
+
+template <class Monoid, class NB, class Node>
+void
+add_tag(Node * node, const typename Monoid::tag_type & tag)
+{
+	using ANB = AugmentedNodeBase<Node, Monoid>;
+
+	if (node == nullptr) {
+		return;
+	}
+
+	Monoid::apply_to_node(*node, tag);
+	node->ANB::_aug_aggregate = Monoid::apply(node->ANB::_aug_aggregate, tag);
+	if (node->ANB::_aug_has_tag) {
+		node->ANB::_aug_tag = Monoid::compose(node->ANB::_aug_tag, tag);
+	} else {
+		node->ANB::_aug_tag = tag;
+		node->ANB::_aug_has_tag = true;
+	}
+}
+
+template <class Monoid, class NB, class Node>
+void
+push_tag(Node * node)
+{
+	using ANB = AugmentedNodeBase<Node, Monoid>;
+
+	if constexpr (is_lazy<Monoid>::value) {
+		if ((node == nullptr) || !node->ANB::_aug_has_tag) {
+			return;
+		}
+
+		add_tag<Monoid, NB>(node->NB::get_left(), node->ANB::_aug_tag);
+		add_tag<Monoid, NB>(node->NB::get_right(), node->ANB::_aug_tag);
+		node->ANB::_aug_has_tag = false;
+	} else {
+		(void)node;
+	}
+}
+
+template <class Monoid>
+template <class Node>
+PendingTags<Monoid, true>
+PendingTags<Monoid, true>::below(const Node & node) const
+{
+	using ANB = AugmentedNodeBase<Node, Monoid>;
+
+	// Tags further down are always older than the ones above them
+	if (!node.ANB::_aug_has_tag) {
+		return *this;
+	}
+
+	PendingTags result;
+	result.active = true;
+	if (this->active) {
+		result.tag = Monoid::compose(node.ANB::_aug_tag, this->tag);
+	} else {
+		result.tag = node.ANB::_aug_tag;
+	}
+	return result;
+}
+
+template <class Monoid>
+typename PendingTags<Monoid, true>::value_type
+PendingTags<Monoid, true>::apply(const value_type & value) const
+{
+	if (!this->active) {
+		return value;
+	}
+	return Monoid::apply(value, this->tag);
+}
+
+template <class Monoid, class BaseTraits>
+template <class Node, class Tree>
+void
+AugmentedNodeTraits<Monoid, BaseTraits>::leaf_inserted(Node & node, Tree & t)
+{
+	fix_to_root<Monoid, typename Tree::NB>(&node);
+	BaseTraits::leaf_inserted(node, t);
+}
+
+template <class Monoid, class BaseTraits>
+template <class Node, class Tree>
+void
+AugmentedNodeTraits<Monoid, BaseTraits>::rotated_left(Node & node, Tree & t)
+{
+	// 'node' is the node that was the old parent. The rotated subtree as a whole
+	// still contains the same nodes, so we don't need to propagate further.
+	using NB = typename Tree::NB;
+	fix_node<Monoid, NB>(&node);
+	fix_node<Monoid, NB>(node.NB::get_parent());
+	BaseTraits::rotated_left(node, t);
+}
+
+template <class Monoid, class BaseTraits>
+template <class Node, class Tree>
+void
+AugmentedNodeTraits<Monoid, BaseTraits>::rotated_right(Node & node, Tree & t)
+{
+	// 'node' is the node that was the old parent.
+	using NB = typename Tree::NB;
+	fix_node<Monoid, NB>(&node);
+	fix_node<Monoid, NB>(node.NB::get_parent());
+	BaseTraits::rotated_right(node, t);
+}
+
+template <class Monoid, class BaseTraits>
+template <class Node, class Tree>
+void
+AugmentedNodeTraits<Monoid, BaseTraits>::deleted_below(Node & node, Tree & t)
+{
+	// If nodes were swapped before the deletion, the other swapped node is an
+	// ancestor of 'node'. Thus, fixing everything up to the root covers it.
+	fix_to_root<Monoid, typename Tree::NB>(&node);
+	BaseTraits::deleted_below(node, t);
+}
+
+// @endcond
+} // namespace augmented_internal
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::insert(Node & node)
+{
+	if constexpr (lazy) {
+		node.ANB::_aug_has_tag = false;
+		this->push_for_insert(node);
+	}
+
+	this->BaseTree::insert(node);
+
+	if constexpr (!augmented_internal::AugmentTree<Tree, Monoid>::uses_hooks) {
+		// Unzipping only changed the right spine of the new node's left subtree and
+		// the left spine of its right subtree. Fix those bottom-up, then the path
+		// from the new node to the root.
+		Node * left_end = &node;
+		if (left_end->NB::get_left() != nullptr) {
+			left_end = left_end->NB::get_left();
+			while (left_end->NB::get_right() != nullptr) {
+				left_end = left_end->NB::get_right();
+			}
+		}
+		Node * right_end = &node;
+		if (right_end->NB::get_right() != nullptr) {
+			right_end = right_end->NB::get_right();
+			while (right_end->NB::get_left() != nullptr) {
+				right_end = right_end->NB::get_left();
+			}
+		}
+
+		augmented_internal::fix_path<Monoid, NB>(left_end, &node);
+		augmented_internal::fix_path<Monoid, NB>(right_end, &node);
+		augmented_internal::fix_to_root<Monoid, NB>(&node);
+	}
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::remove(Node & node)
+{
+	if constexpr (lazy) {
+		this->push_for_remove(node);
+	}
+
+	if constexpr (augmented_internal::AugmentTree<Tree, Monoid>::uses_hooks) {
+		this->BaseTree::remove(node);
+	} else {
+		Node * parent = node.NB::get_parent();
+		bool was_left = (parent != nullptr) && (parent->NB::get_left() == &node);
+
+		this->BaseTree::remove(node);
+
+		Node * replacement;
+		if (parent == nullptr) {
+			replacement = this->get_root();
+		} else if (was_left) {
+			replacement = parent->NB::get_left();
+		} else {
+			replacement = parent->NB::get_right();
+		}
+
+		/*
+		 * Zipping has merged the right spine of the left subtree and the left spine
+		 * of the right subtree into a single path starting at the replacement.
+		 * Nodes from the left subtree continue that path to the right, nodes from
+		 * the right subtree continue it to the left. Find its end, then fix
+		 * everything bottom-up.
+		 */
+		Node * bottom = replacement;
+		Node * next = replacement;
+		while (next != nullptr) {
+			bottom = next;
+			if (this->cmp(node, *next)) {
+				next = next->NB::get_left();
+			} else {
+				next = next->NB::get_right();
+			}
+		}
+
+		if (bottom != nullptr) {
+			augmented_internal::fix_to_root<Monoid, NB>(bottom);
+		} else if (parent != nullptr) {
+			augmented_internal::fix_to_root<Monoid, NB>(parent);
+		}
+	}
+}
+
+template <class Tree, class Monoid>
+template <class Comparable1, class Comparable2>
+typename Augmented<Tree, Monoid>::value_type
+Augmented<Tree, Monoid>::aggregate(const Comparable1 & lower,
+                                   const Comparable2 & upper) const
+{
+	using augmented_internal::get_aggregate;
+
+	auto concat = [](const value_type & lhs, const value_type & rhs) {
+		return Monoid::combine(lhs, rhs, Monoid::identity());
+	};
+
+	// Find the topmost node inside the range
+	Pending pending;
+	const Node * split = this->get_root();
+	while (split != nullptr) {
+		if (this->cmp(*split, lower)) {
+			pending = pending.below(*split);
+			split = split->NB::get_right();
+		} else if (!this->cmp(*split, upper)) {
+			pending = pending.below(*split);
+			split = split->NB::get_left();
+		} else {
+			break;
+		}
+	}
+
+	if (split == nullptr) {
+		return Monoid::identity();
+	}
+
+	const value_type split_value = pending.apply(Monoid::get_value(*split));
+	const Pending split_pending = pending.below(*split);
+
+	// Everything in the left subtree that is not smaller than lower
+	value_type left_part = Monoid::identity();
+	pending = split_pending;
+	const Node * cur = split->NB::get_left();
+	while (cur != nullptr) {
+		Pending child_pending = pending.below(*cur);
+		if (!this->cmp(*cur, lower)) {
+			left_part = concat(
+			    Monoid::combine(Monoid::identity(),
+			                    pending.apply(Monoid::get_value(*cur)),
+			                    child_pending.apply(get_aggregate<Monoid, NB>(
+			                        cur->NB::get_right()))),
+			    left_part);
+			cur = cur->NB::get_left();
+		} else {
+			cur = cur->NB::get_right();
+		}
+		pending = child_pending;
+	}
+
+	// Everything in the right subtree that is smaller than upper
+	value_type right_part = Monoid::identity();
+	pending = split_pending;
+	cur = split->NB::get_right();
+	while (cur != nullptr) {
+		Pending child_pending = pending.below(*cur);
+		if (this->cmp(*cur, upper)) {
+			right_part = concat(
+			    right_part,
+			    Monoid::combine(child_pending.apply(get_aggregate<Monoid, NB>(
+			                        cur->NB::get_left())),
+			                    pending.apply(Monoid::get_value(*cur)),
+			                    Monoid::identity()));
+			cur = cur->NB::get_right();
+		} else {
+			cur = cur->NB::get_left();
+		}
+		pending = child_pending;
+	}
+
+	return Monoid::combine(left_part, split_value, right_part);
+}
+
+template <class Tree, class Monoid>
+typename Augmented<Tree, Monoid>::value_type
+Augmented<Tree, Monoid>::aggregate() const
+{
+	return augmented_internal::get_aggregate<Monoid, NB>(
+	    static_cast<const Node *>(this->get_root()));
+}
+
+template <class Tree, class Monoid>
+template <class Comparable1, class Comparable2, class T>
+void
+Augmented<Tree, Monoid>::range_apply(const Comparable1 & lower,
+                                     const Comparable2 & upper,
+                                     const typename T::tag_type & tag)
+{
+	using augmented_internal::add_tag;
+	using augmented_internal::push_tag;
+
+	// Find the topmost node inside the range
+	Node * split = this->get_root();
+	while (split != nullptr) {
+		push_tag<Monoid, NB>(split);
+		if (this->cmp(*split, lower)) {
+			split = split->NB::get_right();
+		} else if (!this->cmp(*split, upper)) {
+			split = split->NB::get_left();
+		} else {
+			break;
+		}
+	}
+
+	if (split == nullptr) {
+		return;
+	}
+
+	Monoid::apply_to_node(*split, tag);
+
+	// Everything in the left subtree that is not smaller than lower
+	Node * left_end = split;
+	Node * cur = split->NB::get_left();
+	while (cur != nullptr) {
+		push_tag<Monoid, NB>(cur);
+		left_end = cur;
+		if (!this->cmp(*cur, lower)) {
+			Monoid::apply_to_node(*cur, tag);
+			add_tag<Monoid, NB>(cur->NB::get_right(), tag);
+			cur = cur->NB::get_left();
+		} else {
+			cur = cur->NB::get_right();
+		}
+	}
+
+	// Everything in the right subtree that is smaller than upper
+	Node * right_end = split;
+	cur = split->NB::get_right();
+	while (cur != nullptr) {
+		push_tag<Monoid, NB>(cur);
+		right_end = cur;
+		if (this->cmp(*cur, upper)) {
+			Monoid::apply_to_node(*cur, tag);
+			add_tag<Monoid, NB>(cur->NB::get_left(), tag);
+			cur = cur->NB::get_right();
+		} else {
+			cur = cur->NB::get_left();
+		}
+	}
+
+	augmented_internal::fix_path<Monoid, NB>(left_end, split);
+	augmented_internal::fix_path<Monoid, NB>(right_end, split);
+	augmented_internal::fix_to_root<Monoid, NB>(split);
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::push_tags_to(Node & node)
+{
+	if constexpr (lazy) {
+		std::vector<Node *> path;
+		for (Node * cur = node.NB::get_parent(); cur != nullptr;
+		     cur = cur->NB::get_parent()) {
+			path.push_back(cur);
+		}
+		for (auto it = path.rbegin(); it != path.rend(); ++it) {
+			augmented_internal::push_tag<Monoid, NB>(*it);
+		}
+	} else {
+		(void)node;
+	}
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::push_all_tags()
+{
+	if constexpr (lazy) {
+		std::vector<Node *> stack;
+		if (this->get_root() != nullptr) {
+			stack.push_back(this->get_root());
+		}
+		while (!stack.empty()) {
+			Node * cur = stack.back();
+			stack.pop_back();
+			augmented_internal::push_tag<Monoid, NB>(cur);
+			if (cur->NB::get_left() != nullptr) {
+				stack.push_back(cur->NB::get_left());
+			}
+			if (cur->NB::get_right() != nullptr) {
+				stack.push_back(cur->NB::get_right());
+			}
+		}
+	}
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::push_for_insert(const Node & node)
+{
+	using augmented_internal::push_tag;
+	using Augment = augmented_internal::AugmentTree<Tree, Monoid>;
+
+	// Every node whose subtree gains the new node must be free of tags.
+	Node * cur = this->get_root();
+	if constexpr (Augment::uses_hooks) {
+		// Rebalancing after insertion only rotates nodes on the search path.
+		while (cur != nullptr) {
+			push_tag<Monoid, NB>(cur);
+			if (this->cmp(*cur, node)) {
+				cur = cur->NB::get_right();
+			} else if (Augment::multiple || this->cmp(node, *cur)) {
+				cur = cur->NB::get_left();
+			} else {
+				break; // will not be inserted
+			}
+		}
+	} else {
+		// Follow the zip tree's search down to the insertion point, then the path
+		// that will be unzipped.
+		using Ranks = typename Augment::Ranks;
+		auto rank = Ranks::get_rank(node);
+		if ((cur != nullptr) && (rank < Ranks::get_rank(*cur))) {
+			while (true) {
+				push_tag<Monoid, NB>(cur);
+				Node * next = this->cmp(*cur, node) ? cur->NB::get_right()
+				                                    : cur->NB::get_left();
+				cur = next;
+				if ((next == nullptr) || (Ranks::get_rank(*next) < rank)) {
+					break;
+				}
+			}
+		}
+
+		while (cur != nullptr) {
+			push_tag<Monoid, NB>(cur);
+			if (this->cmp(node, *cur)) {
+				cur = cur->NB::get_left();
+			} else {
+				cur = cur->NB::get_right();
+			}
+		}
+	}
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::push_subtree(Node * node, size_t levels)
+{
+	// Pushes the tags of all nodes less than <levels> levels below <node>
+	if ((node == nullptr) || (levels == 0)) {
+		return;
+	}
+	augmented_internal::push_tag<Monoid, NB>(node);
+	this->push_subtree(node->NB::get_left(), levels - 1);
+	this->push_subtree(node->NB::get_right(), levels - 1);
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::push_for_remove(Node & node)
+{
+	using augmented_internal::push_tag;
+
+	this->push_tags_to(node);
+	push_tag<Monoid, NB>(&node);
+
+	if constexpr (augmented_internal::AugmentTree<Tree, Monoid>::uses_hooks) {
+		/*
+		 * The node is first swapped with its successor (or its only child), which
+		 * is then removed as a leaf. The rebalancing afterwards rotates nodes on
+		 * the path to that leaf, and in the worst case a sibling, its child and
+		 * its grandchild.
+		 */
+		Node * leaf = &node;
+		if ((node.NB::get_left() != nullptr) && (node.NB::get_right() != nullptr)) {
+			leaf = node.NB::get_right();
+			while (leaf->NB::get_left() != nullptr) {
+				leaf = leaf->NB::get_left();
+			}
+		} else if (node.NB::get_left() != nullptr) {
+			leaf = node.NB::get_left();
+		} else if (node.NB::get_right() != nullptr) {
+			leaf = node.NB::get_right();
+		}
+
+		std::vector<Node *> path;
+		for (Node * cur = leaf; cur != nullptr; cur = cur->NB::get_parent()) {
+			path.push_back(cur);
+		}
+		for (auto it = path.rbegin(); it != path.rend(); ++it) {
+			this->push_subtree(*it, 4);
+		}
+	} else {
+		// Zipping relinks the right spine of the left subtree and the left spine
+		// of the right subtree.
+		for (Node * cur = node.NB::get_left(); cur != nullptr;
+		     cur = cur->NB::get_right()) {
+			push_tag<Monoid, NB>(cur);
+		}
+		for (Node * cur = node.NB::get_right(); cur != nullptr;
+		     cur = cur->NB::get_left()) {
+			push_tag<Monoid, NB>(cur);
+		}
+	}
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::fixup_aggregates(Node & node)
+{
+	augmented_internal::fix_to_root<Monoid, NB>(&node);
+}
+
+template <class Tree, class Monoid>
+const typename Augmented<Tree, Monoid>::BaseTree &
+Augmented<Tree, Monoid>::get_tree() const noexcept
+{
+	return *this;
+}
+
+template <class Tree, class Monoid>
+typename Augmented<Tree, Monoid>::value_type
+Augmented<Tree, Monoid>::dbg_verify_aggregates(const Node * node) const
+{
+	if (node == nullptr) {
+		return Monoid::identity();
+	}
+
+	value_type expected = augmented_internal::compute_aggregate<Monoid, NB>(
+	    node, this->dbg_verify_aggregates(node->NB::get_left()),
+	    this->dbg_verify_aggregates(node->NB::get_right()));
+	assert(expected == node->ANB::_aug_aggregate);
+
+	return expected;
+}
+
+template <class Tree, class Monoid>
+void
+Augmented<Tree, Monoid>::dbg_verify() const
+{
+	this->BaseTree::dbg_verify();
+	this->dbg_verify_aggregates(this->get_root());
+}
+
+} // namespace ygg
+
+#endif // YGG_AUGMENTED_CPP
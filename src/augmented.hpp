@@ -0,0 +1,397 @@
+#ifndef YGG_AUGMENTED_HPP
+#define YGG_AUGMENTED_HPP
+
+#include "options.hpp"
+#include "rbtree.hpp"
+#include "wbtree.hpp"
+#include "ziptree.hpp"
+
+#include <type_traits>
+
+namespace ygg {
+
+namespace augmented_internal {
+/// @cond INTERNAL
+
+/*
+ * Detects whether a monoid supports lazy range updates, i.e., defines a
+ * tag_type.
+ */
+template <class Monoid, class = void>
+struct is_lazy : std::false_type
+{
+};
+
+template <class Monoid>
+struct is_lazy<Monoid, std::void_t<typename Monoid::tag_type>> : std::true_type
+{
+};
+
+template <class Monoid, bool lazy>
+class LazyTagStorage {
+};
+
+template <class Monoid>
+class LazyTagStorage<Monoid, true> {
+public:
+	typename Monoid::tag_type _aug_tag;
+	bool _aug_has_tag = false;
+};
+
+/// @endcond
+} // namespace augmented_internal
+
+/**
+ * @brief Base class (template) to supply your node class with an aggregate
+ *
+ * If you want to use your nodes in an Augmented tree, the node class *must*
+ * derive from this class (in addition to the base class of the underlying
+ * tree). It stores the aggregate of the node's subtree and, if the monoid
+ * supports lazy range updates, the update pending for the node's children.
+ *
+ * @tparam Node    The node class itself (CRTP).
+ * @tparam Monoid  The monoid that is aggregated. See Augmented for details.
+ */
+template <class Node, class Monoid>
+class AugmentedNodeBase
+    : public augmented_internal::LazyTagStorage<
+          Monoid, augmented_internal::is_lazy<Monoid>::value> {
+public:
+	typename Monoid::value_type _aug_aggregate;
+};
+
+namespace augmented_internal {
+/// @cond INTERNAL
+
+/*
+ * Helpers that (re-)compute aggregates. NB is the node base of the tree,
+ * which is used to navigate the tree.
+ */
+template <class Monoid, class NB, class Node>
+typename Monoid::value_type get_aggregate(const Node * node);
+
+template <class Monoid, class NB, class Node>
+typename Monoid::value_type
+compute_aggregate(const Node * node, const typename Monoid::value_type & left,
+                  const typename Monoid::value_type & right);
+
+template <class Monoid, class NB, class Node>
+void fix_node(Node * node);
+
+template <class Monoid, class NB, class Node>
+void fix_path(Node * node, const Node * stop);
+
+template <class Monoid, class NB, class Node>
+void fix_to_root(Node * node);
+
+/*
+ * Lazy updates. A node carrying a tag has already applied it to its own value
+ * and aggregate, but not yet to its children.
+ */
+template <class Monoid, class NB, class Node>
+void add_tag(Node * node, const typename Monoid::tag_type & tag);
+
+template <class Monoid, class NB, class Node>
+void push_tag(Node * node);
+
+/*
+ * The updates that are pending from the ancestors of a node, used to read
+ * values without pushing tags down.
+ */
+template <class Monoid, bool lazy>
+class PendingTags {
+public:
+	using value_type = typename Monoid::value_type;
+
+	template <class Node>
+	PendingTags
+	below(const Node & node) const
+	{
+		(void)node;
+		return *this;
+	}
+
+	value_type
+	apply(const value_type & value) const
+	{
+		return value;
+	}
+};
+
+template <class Monoid>
+class PendingTags<Monoid, true> {
+public:
+	using value_type = typename Monoid::value_type;
+
+	template <class Node>
+	PendingTags below(const Node & node) const;
+	value_type apply(const value_type & value) const;
+
+private:
+	bool active = false;
+	typename Monoid::tag_type tag;
+};
+
+/*
+ * Node traits that keep the aggregates up to date in trees that rebalance by
+ * rotations. All other hooks are passed on to BaseTraits.
+ */
+template <class Monoid, class BaseTraits>
+class AugmentedNodeTraits : public BaseTraits {
+public:
+	template <class Node, class Tree>
+	static void leaf_inserted(Node & node, Tree & t);
+	template <class Node, class Tree>
+	static void rotated_left(Node & node, Tree & t);
+	template <class Node, class Tree>
+	static void rotated_right(Node & node, Tree & t);
+	template <class Node, class Tree>
+	static void deleted_below(Node & node, Tree & t);
+};
+
+/*
+ * Maps a tree type to the tree type that is actually used by Augmented, i.e.,
+ * injects the AugmentedNodeTraits into trees that rotate. Zip trees do not
+ * need hooks, since Augmented can find all nodes changed by zipping or
+ * unzipping itself.
+ */
+template <class Tree, class Monoid>
+struct AugmentTree;
+
+template <class N, class NodeTraits, class Options, class Tag, class Compare,
+          class Monoid>
+struct AugmentTree<RBTree<N, NodeTraits, Options, Tag, Compare>, Monoid>
+{
+	using Node = N;
+	using type = RBTree<N, AugmentedNodeTraits<Monoid, NodeTraits>, Options, Tag,
+	                    Compare>;
+	static constexpr bool uses_hooks = true;
+	static constexpr bool supports_lazy = true;
+	static constexpr bool multiple = Options::multiple;
+};
+
+template <class N, class NodeTraits, class Options, class Tag, class Compare,
+          class Monoid>
+struct AugmentTree<WBTree<N, NodeTraits, Options, Tag, Compare>, Monoid>
+{
+	using Node = N;
+	using type = WBTree<N, AugmentedNodeTraits<Monoid, NodeTraits>, Options, Tag,
+	                    Compare>;
+	static constexpr bool uses_hooks = true;
+	// Top-down rebalancing touches nodes off the search path
+	static constexpr bool supports_lazy = false;
+	static constexpr bool multiple = Options::multiple;
+};
+
+template <class N, class NodeTraits, class Options, class Tag, class Compare,
+          class RankGetter, class Monoid>
+struct AugmentTree<ZTree<N, NodeTraits, Options, Tag, Compare, RankGetter>,
+                   Monoid>
+{
+	using Node = N;
+	using type = ZTree<N, NodeTraits, Options, Tag, Compare, RankGetter>;
+	using Ranks = RankGetter;
+	static constexpr bool uses_hooks = false;
+	static constexpr bool supports_lazy = true;
+	static constexpr bool multiple = Options::multiple;
+};
+
+/// @endcond
+} // namespace augmented_internal
+
+/**
+ * @brief A tree that maintains an aggregate over every subtree
+ *
+ * This class wraps an RBTree, a WBTree or a ZTree such that every node stores
+ * the aggregate of all values in its subtree, for some user-defined monoid.
+ * The aggregates are kept up to date through all rotations, swaps, zips and
+ * unzips. This allows to compute the aggregate over any range of keys in
+ * O(log n), via aggregate().
+ *
+ * This is a generalization of what the IntervalTree does with the maximum
+ * upper interval border.
+ *
+ * The Monoid class must provide:
+ *
+ * - a type value_type,
+ * - static value_type identity(), returning the neutral element,
+ * - static value_type get_value(const Node & node), returning the value of a
+ *   single node,
+ * - static value_type combine(const value_type & left, const value_type &
+ *   self, const value_type & right), which must be associative.
+ *
+ * The combine operation does not need to be commutative. Everything is
+ * combined in key order.
+ *
+ * If the Monoid additionally provides the following, the values of all nodes
+ * in a range of keys can be updated in O(log n) via range_apply(). Updates are
+ * stored as tags at the roots of O(log n) subtrees and pushed down lazily.
+ * This is supported for RBTree and ZTree.
+ *
+ * - a type tag_type, describing an update,
+ * - static void apply_to_node(Node & node, const tag_type & tag), which
+ *   updates the value of a single node,
+ * - static value_type apply(const value_type & aggregate, const tag_type &
+ *   tag), which returns the aggregate of a range after updating all of its
+ *   values,
+ * - static tag_type compose(const tag_type & first, const tag_type & second),
+ *   returning the update that applies <first>, then <second>.
+ *
+ * Note that with pending updates, the value stored in a node may be outdated.
+ * Call push_tags_to() before reading a single node's value, or push_all_tags()
+ * before iterating the tree.
+ *
+ * Your node class must derive from AugmentedNodeBase<Node, Monoid> in addition
+ * to the node base of the wrapped tree.
+ *
+ * @tparam Tree    The tree to be wrapped, e.g., RBTree<Node, RBDefaultNodeTraits,
+ * Options>. Any node traits given are still called.
+ * @tparam Monoid  The monoid to be aggregated, see above.
+ */
+template <class Tree, class Monoid>
+class Augmented
+    : private augmented_internal::AugmentTree<Tree, Monoid>::type {
+public:
+	using BaseTree = typename augmented_internal::AugmentTree<Tree, Monoid>::type;
+	using Node = typename augmented_internal::AugmentTree<Tree, Monoid>::Node;
+	using NB = typename BaseTree::NB;
+	using ANB = AugmentedNodeBase<Node, Monoid>;
+	using value_type = typename Monoid::value_type;
+	using MyClass = Augmented<Tree, Monoid>;
+
+	static constexpr bool lazy = augmented_internal::is_lazy<Monoid>::value;
+
+	static_assert(std::is_base_of<ANB, Node>::value,
+	              "Node class not properly derived from AugmentedNodeBase");
+	static_assert(
+	    !lazy || augmented_internal::AugmentTree<Tree, Monoid>::supports_lazy,
+	    "Lazy range updates are not supported for this tree");
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * See the wrapped tree's insert() for details.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * See the wrapped tree's remove() for details.
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Returns the aggregate over all nodes in [lower, upper)
+	 *
+	 * Combines the values of all nodes that are not smaller than <lower> and
+	 * smaller than <upper>, in key order. This method runs in O(log n).
+	 *
+	 * @param lower Anything comparable to a node. The lower end of the range.
+	 * @param upper Anything comparable to a node. The upper end of the range
+	 * (exclusive).
+	 * @return The aggregate, or Monoid::identity() if the range is empty.
+	 */
+	template <class Comparable1, class Comparable2>
+	value_type aggregate(const Comparable1 & lower,
+	                     const Comparable2 & upper) const;
+
+	/**
+	 * @brief Returns the aggregate over all nodes in the tree
+	 *
+	 * This method runs in O(1).
+	 */
+	value_type aggregate() const;
+
+	/**
+	 * @brief Applies an update to all nodes in [lower, upper)
+	 *
+	 * Only available if the Monoid supports lazy range updates (see above). The
+	 * update is applied to O(log n) nodes directly and stored as a tag at O(log
+	 * n) subtrees, from which it is pushed down by later operations. This method
+	 * runs in O(log n).
+	 *
+	 * @param lower Anything comparable to a node. The lower end of the range.
+	 * @param upper Anything comparable to a node. The upper end of the range
+	 * (exclusive).
+	 * @param tag The update to be applied
+	 */
+	template <class Comparable1, class Comparable2, class T = Monoid>
+	void range_apply(const Comparable1 & lower, const Comparable2 & upper,
+	                 const typename T::tag_type & tag);
+
+	/**
+	 * @brief Pushes all pending updates down to <node>
+	 *
+	 * Afterwards, the value of <node> is up to date. This method runs in
+	 * O(log n).
+	 *
+	 * @param node The node whose value should be brought up to date
+	 */
+	void push_tags_to(Node & node);
+
+	/**
+	 * @brief Pushes all pending updates down to the nodes
+	 *
+	 * Afterwards, the values of all nodes are up to date, e.g. for iterating the
+	 * tree. This method runs in O(n).
+	 */
+	void push_all_tags();
+
+	/**
+	 * @brief Updates the aggregates after the value of <node> has changed
+	 *
+	 * Call this if you changed whatever Monoid::get_value() returns for a node
+	 * in the tree. Note that you may not change the node's key. If you use lazy
+	 * range updates, call push_tags_to() before changing the value. This method
+	 * runs in O(log n).
+	 *
+	 * @param node The node whose value has changed
+	 */
+	void fixup_aggregates(Node & node);
+
+	/**
+	 * @brief Returns the wrapped tree
+	 *
+	 * Do not modify the tree via this reference.
+	 */
+	const BaseTree & get_tree() const noexcept;
+
+	/* Import some of the tree's methods into the public namespace */
+	using BaseTree::begin;
+	using BaseTree::clear;
+	using BaseTree::empty;
+	using BaseTree::end;
+	using BaseTree::find;
+	using BaseTree::iterator_to;
+	using BaseTree::lower_bound;
+	using BaseTree::rbegin;
+	using BaseTree::rend;
+	using BaseTree::size;
+	using BaseTree::upper_bound;
+
+	// Debugging methods
+	void dbg_verify() const;
+
+private:
+	using Pending = augmented_internal::PendingTags<Monoid, lazy>;
+
+	// Push down all tags on the nodes that insert() or remove() will modify
+	void push_for_insert(const Node & node);
+	void push_for_remove(Node & node);
+	void push_subtree(Node * node, size_t levels);
+
+	value_type dbg_verify_aggregates(const Node * node) const;
+};
+
+} // namespace ygg
+
+#ifndef YGG_AUGMENTED_CPP
+#include "augmented.cpp"
+#endif
+
+#endif // YGG_AUGMENTED_HPP
@@ -0,0 +1,771 @@
+#ifndef YGG_AVLTREE_CPP
+#define YGG_AVLTREE_CPP
+
+#include "avltree.hpp"
+
+#include "util.hpp"
+
+#include <algorithm>
+
+namespace ygg {
+
+namespace avltree_internal {
+
+template <class Node>
+void
+BalanceParentStorage<Node, true>::set_balance(int new_balance) noexcept
+{
+	this->parent = reinterpret_cast<Node *>(
+	    (reinterpret_cast<size_t>(this->parent) & ~balance_mask) |
+	    static_cast<size_t>(new_balance + 1));
+}
+
+template <class Node>
+int
+BalanceParentStorage<Node, true>::get_balance() const noexcept
+{
+	return static_cast<int>(reinterpret_cast<size_t>(this->parent) &
+	                        balance_mask) -
+	       1;
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, true>::set_parent(Node * new_parent) noexcept
+{
+	this->parent = reinterpret_cast<Node *>(
+	    reinterpret_cast<size_t>(new_parent) |
+	    (reinterpret_cast<size_t>(this->parent) & balance_mask));
+}
+
+template <class Node>
+Node *
+BalanceParentStorage<Node, true>::get_parent() const noexcept
+{
+	return reinterpret_cast<Node *>(reinterpret_cast<size_t>(this->parent) &
+	                                ~balance_mask);
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, true>::swap_parent_with(
+    BalanceParentStorage<Node, true> & other) noexcept
+{
+	Node * tmp = other.get_parent();
+	other.set_parent(this->get_parent());
+	this->set_parent(tmp);
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, true>::swap_balance_with(
+    BalanceParentStorage<Node, true> & other) noexcept
+{
+	int tmp = other.get_balance();
+	other.set_balance(this->get_balance());
+	this->set_balance(tmp);
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, false>::set_balance(int new_balance) noexcept
+{
+	this->balance = static_cast<signed char>(new_balance);
+}
+
+template <class Node>
+int
+BalanceParentStorage<Node, false>::get_balance() const noexcept
+{
+	return this->balance;
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, false>::set_parent(Node * new_parent) noexcept
+{
+	this->parent = new_parent;
+}
+
+template <class Node>
+Node *&
+BalanceParentStorage<Node, false>::get_parent() noexcept
+{
+	return this->parent;
+}
+
+template <class Node>
+Node *
+BalanceParentStorage<Node, false>::get_parent() const noexcept
+{
+	return this->parent;
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, false>::swap_parent_with(
+    BalanceParentStorage<Node, false> & other) noexcept
+{
+	std::swap(this->parent, other.parent);
+}
+
+template <class Node>
+void
+BalanceParentStorage<Node, false>::swap_balance_with(
+    BalanceParentStorage<Node, false> & other) noexcept
+{
+	std::swap(this->balance, other.balance);
+}
+} // namespace avltree_internal
+
+template <class Node, class Options, class Tag>
+void
+AVLTreeNodeBase<Node, Options, Tag>::set_balance(int new_balance) noexcept
+{
+	this->_bst_parent.set_balance(new_balance);
+}
+
+template <class Node, class Options, class Tag>
+int
+AVLTreeNodeBase<Node, Options, Tag>::get_balance() const noexcept
+{
+	return this->_bst_parent.get_balance();
+}
+
+template <class Node, class Options, class Tag>
+void
+AVLTreeNodeBase<Node, Options, Tag>::swap_parent_with(Node * other) noexcept
+{
+	this->_bst_parent.swap_parent_with(other->_bst_parent);
+}
+
+template <class Node, class Options, class Tag>
+void
+AVLTreeNodeBase<Node, Options, Tag>::swap_balance_with(Node * other) noexcept
+{
+	this->_bst_parent.swap_balance_with(other->_bst_parent);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::AVLTree() noexcept
+{}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::AVLTree(
+    MyClass && other) noexcept
+{
+	this->root = other.root;
+	other.root = nullptr;
+	this->s = other.s;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node)
+    CMP_NOEXCEPT(node)
+{
+	this->s.add(1);
+	this->insert_leaf_base(node, this->root);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node,
+                                                         Node & hint)
+    CMP_NOEXCEPT(node)
+{
+	this->s.add(1);
+
+	Node * parent = this->get_hint_subtree(node, hint);
+	this->insert_leaf_base(node, parent);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node,
+                                                         iterator<false> hint)
+    CMP_NOEXCEPT(node)
+{
+	if (hint == this->end()) {
+		this->s.add(1);
+
+		// special case: insert at the end
+		Node * parent = this->root;
+		if (parent != nullptr) {
+			while (parent->NB::get_right() != nullptr) {
+				parent = parent->NB::get_right();
+			}
+		}
+		this->insert_leaf_base(node, parent);
+	} else {
+		this->insert(node, *hint);
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::insert_leaf_base(
+    Node & node, Node * start) CMP_NOEXCEPT(node)
+{
+	node.NB::set_left(nullptr);
+	node.NB::set_right(nullptr);
+	node.NB::set_balance(0);
+
+	Node * parent = nullptr;
+	Node * cur = start;
+	bool go_right = false;
+
+	while (cur != nullptr) {
+		parent = cur;
+
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(cur->NB::get_left());
+			__builtin_prefetch(cur->NB::get_right());
+		}
+
+		go_right = this->cmp(*cur, node);
+		if constexpr (!Options::multiple) {
+			// Multiple are not allowed - we need three-way comparisons!
+			if (__builtin_expect(!go_right && !this->cmp(node, *cur), false)) {
+				// Same as existing. Reduce size (because we increased it earlier)
+				// and exit.
+				this->s.reduce(1);
+				return;
+			}
+		}
+
+		if constexpr (Options::micro_avoid_conditionals) {
+			cur = utilities::go_right_if(go_right, cur);
+		} else {
+			if (go_right) {
+				cur = cur->NB::get_right();
+			} else {
+				cur = cur->NB::get_left();
+			}
+		}
+	}
+
+	node.NB::set_parent(parent);
+	if (parent == nullptr) {
+		// new root!
+		this->root = &node;
+		NodeTraits::leaf_inserted(node, *this);
+		return;
+	}
+
+	if (go_right) {
+		parent->NB::set_right(&node);
+	} else {
+		parent->NB::set_left(&node);
+	}
+
+	NodeTraits::leaf_inserted(node, *this);
+	this->fixup_after_insert(&node);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::fixup_after_insert(
+    Node * node) noexcept
+{
+	// The subtree rooted at <node> has grown by one level.
+	Node * child = node;
+	Node * parent = node->NB::get_parent();
+
+	while (parent != nullptr) {
+		int balance;
+		if (parent->NB::get_left() == child) {
+			balance = parent->NB::get_balance() - 1;
+			if (balance == -2) {
+				// After the rotation, the subtree has its old height again.
+				bool height_unchanged;
+				this->rebalance_left_heavy(parent, height_unchanged);
+				return;
+			}
+		} else {
+			balance = parent->NB::get_balance() + 1;
+			if (balance == 2) {
+				bool height_unchanged;
+				this->rebalance_right_heavy(parent, height_unchanged);
+				return;
+			}
+		}
+
+		parent->NB::set_balance(balance);
+		if (balance == 0) {
+			// The lower subtree caught up, the height did not change.
+			return;
+		}
+
+		child = parent;
+		parent = parent->NB::get_parent();
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::fixup_after_delete(
+    Node * parent, bool deleted_left) noexcept
+{
+	// The subtree on the <deleted_left> side of <parent> has shrunk by one
+	// level.
+	while (parent != nullptr) {
+		Node * sub_root = parent;
+
+		if (deleted_left) {
+			int balance = parent->NB::get_balance() + 1;
+			if (balance == 2) {
+				bool height_unchanged;
+				sub_root = this->rebalance_right_heavy(parent, height_unchanged);
+				if (height_unchanged) {
+					return;
+				}
+			} else {
+				parent->NB::set_balance(balance);
+				if (balance == 1) {
+					// The other subtree still has the old height.
+					return;
+				}
+			}
+		} else {
+			int balance = parent->NB::get_balance() - 1;
+			if (balance == -2) {
+				bool height_unchanged;
+				sub_root = this->rebalance_left_heavy(parent, height_unchanged);
+				if (height_unchanged) {
+					return;
+				}
+			} else {
+				parent->NB::set_balance(balance);
+				if (balance == -1) {
+					return;
+				}
+			}
+		}
+
+		parent = sub_root->NB::get_parent();
+		if (parent != nullptr) {
+			deleted_left = (parent->NB::get_left() == sub_root);
+		}
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+Node *
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::rebalance_right_heavy(
+    Node * node, bool & height_unchanged) noexcept
+{
+	Node * right = node->NB::get_right();
+	int right_balance = right->NB::get_balance();
+
+	if (right_balance >= 0) {
+		this->rotate_left(node);
+		if (right_balance == 0) {
+			// Only possible after a deletion
+			node->NB::set_balance(1);
+			right->NB::set_balance(-1);
+			height_unchanged = true;
+		} else {
+			node->NB::set_balance(0);
+			right->NB::set_balance(0);
+			height_unchanged = false;
+		}
+		return right;
+	}
+
+	// Double rotation: the inner grandchild becomes the subtree's root
+	Node * inner = right->NB::get_left();
+	int inner_balance = inner->NB::get_balance();
+	this->rotate_right(right);
+	this->rotate_left(node);
+
+	node->NB::set_balance((inner_balance == 1) ? -1 : 0);
+	right->NB::set_balance((inner_balance == -1) ? 1 : 0);
+	inner->NB::set_balance(0);
+	height_unchanged = false;
+
+	return inner;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+Node *
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::rebalance_left_heavy(
+    Node * node, bool & height_unchanged) noexcept
+{
+	Node * left = node->NB::get_left();
+	int left_balance = left->NB::get_balance();
+
+	if (left_balance <= 0) {
+		this->rotate_right(node);
+		if (left_balance == 0) {
+			// Only possible after a deletion
+			node->NB::set_balance(-1);
+			left->NB::set_balance(1);
+			height_unchanged = true;
+		} else {
+			node->NB::set_balance(0);
+			left->NB::set_balance(0);
+			height_unchanged = false;
+		}
+		return left;
+	}
+
+	// Double rotation: the inner grandchild becomes the subtree's root
+	Node * inner = left->NB::get_right();
+	int inner_balance = inner->NB::get_balance();
+	this->rotate_left(left);
+	this->rotate_right(node);
+
+	node->NB::set_balance((inner_balance == -1) ? 1 : 0);
+	left->NB::set_balance((inner_balance == 1) ? -1 : 0);
+	inner->NB::set_balance(0);
+	height_unchanged = false;
+
+	return inner;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::rotate_left(
+    Node * parent) noexcept
+{
+	Node * right_child = parent->NB::get_right();
+	parent->NB::set_right(right_child->NB::get_left());
+	if (right_child->NB::get_left() != nullptr) {
+		right_child->NB::get_left()->NB::set_parent(parent);
+	}
+
+	Node * parents_parent = parent->NB::get_parent();
+
+	right_child->NB::set_left(parent);
+	right_child->NB::set_parent(parents_parent);
+
+	if (parents_parent != nullptr) {
+		if (parents_parent->NB::get_left() == parent) {
+			parents_parent->NB::set_left(right_child);
+		} else {
+			parents_parent->NB::set_right(right_child);
+		}
+	} else {
+		this->root = right_child;
+	}
+
+	parent->NB::set_parent(right_child);
+
+	NodeTraits::rotated_left(*parent, *this);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::rotate_right(
+    Node * parent) noexcept
+{
+	Node * left_child = parent->NB::get_left();
+	parent->NB::set_left(left_child->NB::get_right());
+	if (left_child->NB::get_right() != nullptr) {
+		left_child->NB::get_right()->NB::set_parent(parent);
+	}
+
+	Node * parents_parent = parent->NB::get_parent();
+
+	left_child->NB::set_right(parent);
+	left_child->NB::set_parent(parents_parent);
+
+	if (parents_parent != nullptr) {
+		if (parents_parent->NB::get_left() == parent) {
+			parents_parent->NB::set_left(left_child);
+		} else {
+			parents_parent->NB::set_right(left_child);
+		}
+	} else {
+		this->root = left_child;
+	}
+
+	parent->NB::set_parent(left_child);
+
+	NodeTraits::rotated_right(*parent, *this);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::remove(Node & node)
+    CMP_NOEXCEPT(node)
+{
+	this->s.reduce(1);
+	this->remove_to_leaf(node);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::remove_to_leaf(Node & node)
+    CMP_NOEXCEPT(node)
+{
+	Node * child = &node;
+
+	if ((node.NB::get_right() != nullptr) && (node.NB::get_left() != nullptr)) {
+		// Find the minimum of the larger-or-equal children
+		child = node.NB::get_right();
+		while (child->NB::get_left() != nullptr) {
+			child = child->NB::get_left();
+		}
+	} else if (node.NB::get_left() != nullptr) {
+		// A single child must be a leaf, otherwise the heights would differ by
+		// more than one.
+		child = node.NB::get_left();
+	} else if (node.NB::get_right() != nullptr) {
+		child = node.NB::get_right();
+	}
+
+	if (child != &node) {
+		this->swap_nodes(&node, child);
+	}
+
+	// If node took the place of its successor, it may still have a right child,
+	// which is a leaf.
+	if (node.NB::get_right() != nullptr) {
+		this->swap_nodes(&node, node.NB::get_right());
+	}
+
+	// Now, node is a leaf.
+	NodeTraits::delete_leaf(node, *this);
+
+	Node * parent = node.NB::get_parent();
+	if (parent == nullptr) {
+		this->root = nullptr; // Tree is now empty!
+		return;
+	}
+
+	bool deleted_left = (parent->NB::get_left() == &node);
+	if (deleted_left) {
+		parent->NB::set_left(nullptr);
+	} else {
+		parent->NB::set_right(nullptr);
+	}
+	NodeTraits::deleted_below(*parent, *this);
+
+	this->fixup_after_delete(parent, deleted_left);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class Comparable>
+ygg::utilities::select_type_t<size_t, Node *, Options::stl_erase>
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::erase(const Comparable & c)
+    CMP_NOEXCEPT(c)
+{
+	// If we allow multisets and want to be STL-conform, we must find the *first*
+	// node carrying c, so that we can iteratively delete all of them
+	auto el = this->template find<Comparable,
+	                              (Options::stl_erase && Options::multiple)>(c);
+
+	if (el != this->end()) {
+		if constexpr (Options::stl_erase) {
+			size_t count = 1;
+
+			auto next = el + 1;
+			this->remove_to_leaf(*el);
+			if (Options::multiple) {
+				el = next;
+
+				// el points to the first element comparing equal to c.
+				// For all elements after it, we must only check if they are larger
+				while (__builtin_expect((el != this->end()) && (!this->cmp(c, *el)),
+				                        false)) {
+					count++;
+					next = el + 1;
+					this->remove_to_leaf(*el);
+					el = next;
+				}
+			} else {
+				(void)next;
+			}
+			this->s.reduce(count);
+			return count;
+		} else {
+			Node * n = &(*el);
+			this->remove_to_leaf(*el);
+			this->s.reduce(1);
+			return n;
+		}
+	}
+
+	if constexpr (Options::stl_erase) {
+		return 0;
+	} else {
+		return static_cast<Node *>(nullptr);
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <bool reverse>
+ygg::utilities::select_type_t<
+    const typename AVLTree<Node, NodeTraits, Options, Tag,
+                           Compare>::template iterator<reverse>,
+    Node *, Options::stl_erase>
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::erase(
+    const iterator<reverse> & it) CMP_NOEXCEPT(*it)
+{
+	if constexpr (!Options::stl_erase) {
+		Node * n = &(*it);
+		this->remove(*it);
+
+		return n;
+	} else {
+		auto ret = it + 1;
+		this->remove(*it);
+		return ret;
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::swap_nodes(Node * n1,
+                                                             Node * n2) noexcept
+{
+	if (n1->NB::get_parent() == n2) {
+		this->swap_neighbors(n2, n1);
+	} else if (n2->NB::get_parent() == n1) {
+		this->swap_neighbors(n1, n2);
+	} else {
+		this->swap_unrelated_nodes(n1, n2);
+	}
+
+	// Balance factors belong to the position in the tree, not to the node.
+	n1->NB::swap_balance_with(n2);
+
+	NodeTraits::swapped(*n1, *n2, *this);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::swap_neighbors(
+    Node * parent, Node * child) noexcept
+{
+	child->NB::set_parent(parent->NB::get_parent());
+	parent->NB::set_parent(child);
+	if (child->NB::get_parent() != nullptr) {
+		if (child->NB::get_parent()->NB::get_left() == parent) {
+			child->NB::get_parent()->NB::set_left(child);
+		} else {
+			child->NB::get_parent()->NB::set_right(child);
+		}
+	} else {
+		this->root = child;
+	}
+
+	if (parent->NB::get_left() == child) {
+		parent->NB::set_left(child->NB::get_left());
+		if (parent->NB::get_left() != nullptr) {
+			parent->NB::get_left()->NB::set_parent(parent);
+		}
+		child->NB::set_left(parent);
+
+		std::swap(parent->NB::get_right(), child->NB::get_right());
+		if (child->NB::get_right() != nullptr) {
+			child->NB::get_right()->NB::set_parent(child);
+		}
+		if (parent->NB::get_right() != nullptr) {
+			parent->NB::get_right()->NB::set_parent(parent);
+		}
+	} else {
+		parent->NB::set_right(child->NB::get_right());
+		if (parent->NB::get_right() != nullptr) {
+			parent->NB::get_right()->NB::set_parent(parent);
+		}
+		child->NB::set_right(parent);
+
+		std::swap(parent->NB::get_left(), child->NB::get_left());
+		if (child->NB::get_left() != nullptr) {
+			child->NB::get_left()->NB::set_parent(child);
+		}
+		if (parent->NB::get_left() != nullptr) {
+			parent->NB::get_left()->NB::set_parent(parent);
+		}
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::swap_unrelated_nodes(
+    Node * n1, Node * n2) noexcept
+{
+	std::swap(n1->NB::get_left(), n2->NB::get_left());
+	if (n1->NB::get_left() != nullptr) {
+		n1->NB::get_left()->NB::set_parent(n1);
+	}
+	if (n2->NB::get_left() != nullptr) {
+		n2->NB::get_left()->NB::set_parent(n2);
+	}
+
+	std::swap(n1->NB::get_right(), n2->NB::get_right());
+	if (n1->NB::get_right() != nullptr) {
+		n1->NB::get_right()->NB::set_parent(n1);
+	}
+	if (n2->NB::get_right() != nullptr) {
+		n2->NB::get_right()->NB::set_parent(n2);
+	}
+
+	n1->NB::swap_parent_with(n2);
+
+	if (n1->NB::get_parent() != nullptr) {
+		if (n1->NB::get_parent()->NB::get_right() == n2) {
+			n1->NB::get_parent()->NB::set_right(n1);
+		} else {
+			n1->NB::get_parent()->NB::set_left(n1);
+		}
+	} else {
+		this->root = n1;
+	}
+	if (n2->NB::get_parent() != nullptr) {
+		if (n2->NB::get_parent()->NB::get_right() == n1) {
+			n2->NB::get_parent()->NB::set_right(n2);
+		} else {
+			n2->NB::get_parent()->NB::set_left(n2);
+		}
+	} else {
+		this->root = n2;
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+int
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::verify_balance(
+    const Node * node) const
+{
+	if (node == nullptr) {
+		return 0;
+	}
+
+	int left_height = this->verify_balance(node->NB::get_left());
+	int right_height = this->verify_balance(node->NB::get_right());
+
+	debug::yggassert(node->NB::get_balance() == right_height - left_height);
+	debug::yggassert((node->NB::get_balance() >= -1) &&
+	                 (node->NB::get_balance() <= 1));
+
+	return std::max(left_height, right_height) + 1;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+bool
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::verify_integrity() const
+{
+	try {
+		this->dbg_verify();
+	} catch (debug::VerifyException & e) {
+		return false;
+	}
+
+	return true;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+AVLTree<Node, NodeTraits, Options, Tag, Compare>::dbg_verify() const
+{
+	this->TB::dbg_verify();
+	this->verify_balance(this->root);
+}
+
+} // namespace ygg
+
+#endif // YGG_AVLTREE_CPP
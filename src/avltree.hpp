@@ -0,0 +1,340 @@
+#ifndef YGG_AVLTREE_HPP
+#define YGG_AVLTREE_HPP
+
+#include "bst.hpp"
+#include "debug.hpp"
+#include "options.hpp"
+#include "size_holder.hpp"
+#include "tree_iterator.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace ygg {
+namespace avltree_internal {
+/// @cond INTERNAL
+
+template <class Node, bool compress_balance>
+class BalanceParentStorage;
+
+/*
+ * Stores the balance factor (plus one) in the two lowest bits of the parent
+ * pointer. See TreeFlags::AVL_COMPRESS_BALANCE.
+ */
+template <class Node>
+class BalanceParentStorage<Node, true> {
+public:
+	void set_balance(int new_balance) noexcept;
+	int get_balance() const noexcept;
+
+	void set_parent(Node * new_parent) noexcept;
+	Node * get_parent() const noexcept;
+
+	void swap_parent_with(BalanceParentStorage<Node, true> & other) noexcept;
+	void swap_balance_with(BalanceParentStorage<Node, true> & other) noexcept;
+
+	static constexpr bool parent_reference = false;
+	static constexpr size_t balance_mask = 3;
+
+private:
+	Node * parent;
+};
+
+template <class Node>
+class BalanceParentStorage<Node, false> {
+public:
+	void set_balance(int new_balance) noexcept;
+	int get_balance() const noexcept;
+
+	void set_parent(Node * new_parent) noexcept;
+	Node *& get_parent() noexcept;
+	Node * get_parent() const noexcept;
+
+	void swap_parent_with(BalanceParentStorage<Node, false> & other) noexcept;
+	void swap_balance_with(BalanceParentStorage<Node, false> & other) noexcept;
+
+	static constexpr bool parent_reference = true;
+
+private:
+	Node * parent = nullptr;
+	signed char balance;
+};
+
+/// @endcond
+} // namespace avltree_internal
+
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the AVL Tree *must* derive from this class
+ * (template). It supplies your class with the necessary members to contain the
+ * linking between the tree nodes and the balance factor.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam options  The options class (a version of TreeOptions) that you
+ * parameterize the tree with. (See the options parameter of RBTree.)
+ * @tparam Tag 		The tag used to identify the tree that this node should
+ * be inserted into. See RBTree for details.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class AVLTreeNodeBase
+    : public bst::BSTNodeBase<Node, Options, Tag,
+                              avltree_internal::BalanceParentStorage<
+                                  Node, Options::avl_compress_balance>> {
+public:
+	/// @cond INTERNAL
+	void set_balance(int new_balance) noexcept;
+	int get_balance() const noexcept;
+
+	void swap_parent_with(Node * other) noexcept;
+	void swap_balance_with(Node * other) noexcept;
+	/// @endcond
+};
+
+/**
+ * @brief   Helper base class for the NodeTraits you need to implement for the
+ * AVL tree
+ *
+ * This class serves as an (optional) base class for the NodeTraits you need to
+ * implement. The hooks are the same as the ones of RBDefaultNodeTraits, thus
+ * NodeTraits written for the RBTree (e.g. to maintain augmented data) can be
+ * used with the AVLTree. This class just implements the various hooks as empty
+ * functions.
+ */
+class AVLDefaultNodeTraits {
+public:
+	template <class Node, class Tree>
+	static void
+	leaf_inserted(Node & node, Tree & t) noexcept
+	{
+		(void)node;
+		(void)t;
+	}
+
+	template <class Node, class Tree>
+	static void
+	rotated_left(Node & node, Tree & t) noexcept
+	{
+		(void)node;
+		(void)t;
+	}
+
+	template <class Node, class Tree>
+	static void
+	rotated_right(Node & node, Tree & t) noexcept
+	{
+		(void)node;
+		(void)t;
+	}
+
+	template <class Node, class Tree>
+	static void
+	delete_leaf(Node & node, Tree & t) noexcept
+	{
+		(void)node;
+		(void)t;
+	}
+
+	template <class Node, class Tree>
+	static void
+	deleted_below(Node & node, Tree & t) noexcept
+	{
+		(void)node;
+		(void)t;
+	}
+
+	template <class Node, class Tree>
+	static void
+	swapped(Node & old_ancestor, Node & old_descendant, Tree & t) noexcept
+	{
+		(void)old_ancestor;
+		(void)old_descendant;
+		(void)t;
+	}
+};
+
+/**
+ * @brief The AVL Tree
+ *
+ * In an AVL tree, the heights of the two subtrees of every node differ by at
+ * most one. This makes it at most about 1.44 * log(n) deep, compared to
+ * 2 * log(n) for the Red-Black Tree, at the cost of more rotations during
+ * insertion and deletion. Use it for workloads that are dominated by lookups.
+ *
+ * The interface is the same as the one of the RBTree, including the NodeTraits
+ * hooks. Set TreeFlags::AVL_COMPRESS_BALANCE to store the balance factors in
+ * the parent pointers.
+ *
+ * @tparam Node         The node class for this tree. It must be derived from
+ * AVLTreeNodeBase.
+ * @tparam NodeTraits   A class implementing various hooks and functions on your
+ * node class, e.g. AVLDefaultNodeTraits.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this tree. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies this tree. Can be used
+ * to insert the same nodes into multiple trees. Can be any class, the class can
+ * be empty.
+ * @tparam Compare      A compare class. The tree follows STL semantics for
+ * 'Compare'. Defaults to ygg::utilities::flexible_less. Implement
+ * operator<(const Node & lhs, const Node & rhs) if you want to use it.
+ */
+template <class Node, class NodeTraits, class Options = DefaultOptions,
+          class Tag = int, class Compare = ygg::utilities::flexible_less>
+class AVLTree
+    : public bst::BinarySearchTree<Node, Options, Tag, Compare,
+                                   avltree_internal::BalanceParentStorage<
+                                       Node, Options::avl_compress_balance>> {
+public:
+	using MyClass = AVLTree<Node, NodeTraits, Options, Tag, Compare>;
+	// Node Base
+	using NB = AVLTreeNodeBase<Node, Options, Tag>;
+	using TB = bst::BinarySearchTree<
+	    Node, Options, Tag, Compare,
+	    avltree_internal::BalanceParentStorage<Node,
+	                                           Options::avl_compress_balance>>;
+	static_assert(std::is_base_of<NB, Node>::value,
+	              "Node class not properly derived from AVLTreeNodeBase");
+	static_assert(!Options::avl_compress_balance || (alignof(Node) >= 4),
+	              "Compressing balance factors requires 4-byte aligned nodes.");
+
+	/**
+	 * @brief Create a new empty AVL tree.
+	 */
+	AVLTree() noexcept;
+
+	/**
+	 * @brief Create a new AVL tree from a different AVL tree.
+	 *
+	 * The other AVL tree is moved into this one, i.e., using it afterwards is
+	 * undefined behavior.
+	 *
+	 * @param other  The AVL tree that this one is constructed from
+	 */
+	AVLTree(MyClass && other) noexcept;
+
+	/*
+	 * Pull in classes from base tree
+	 */
+	template <bool reverse>
+	using iterator = typename TB::template iterator<reverse>;
+	template <bool reverse>
+	using const_iterator = typename TB::template const_iterator<reverse>;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * Inserts <node> into the tree.
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*. A common
+	 * pitfall is to store nodes in a std::vector (or other STL container), which
+	 * reallocates (and thereby moves objecs around).
+	 *
+	 * @param   Node  The node to be inserted.
+	 */
+	void insert(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Inserts <node> into the tree, starting the search at <hint>
+	 *
+	 * See RBTree::insert(Node &, Node &).
+	 *
+	 * @param node  The node to be inserted.
+	 * @param hint  A node in the tree close to the position of <node>.
+	 */
+	void insert(Node & node, Node & hint) CMP_NOEXCEPT(node);
+	void insert(Node & node, iterator<false> hint) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * Removes <node> from the tree.
+	 *
+	 * @param   Node  The node to be removed.
+	 */
+	void remove(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Deletes a node that compares equally to <c> from the tree
+	 *
+	 * @warning The behavior of this method strongly depends on whether the
+	 * STL_ERASE option is set or not!
+	 *
+	 * If STL_ERASE is set, this method removes *all* nodes that compare equally
+	 * to c from the tree and returns the number of nodes removed.
+	 *
+	 * If STL_ERASE is not set, it removes only one node and returns a pointer to
+	 * the removed node.
+	 *
+	 * @param  c Anything comparable to a node. A node (resp. all nodes, see
+	 * above) that compares equally will be removed
+	 *
+	 * @return If STL_ERASE is unset: A pointer to the node that has been removed,
+	 * or nullptr if no node was removed. If STL_ERASE is set: The number of
+	 * erased nodes.
+	 */
+	template <class Comparable>
+	utilities::select_type_t<size_t, Node *, Options::stl_erase>
+	erase(const Comparable & c) CMP_NOEXCEPT(c);
+
+	/**
+	 * @brief Deletes a node by iterator
+	 *
+	 * @warning The return type of this method depends on whether the
+	 * STL_ERASE option is set or not!
+	 *
+	 * @return If STL_ERASE is unset: A pointer to the node that has been removed.
+	 * If STL_ERASE is set: An iterator to the node after the removed node (or
+	 * end()).
+	 */
+	template <bool reverse>
+	utilities::select_type_t<const iterator<reverse>, Node *, Options::stl_erase>
+	erase(const iterator<reverse> & it) CMP_NOEXCEPT(*it);
+
+	// Mainly debugging methods
+	/// @cond INTERNAL
+	void dbg_verify() const;
+	bool verify_integrity() const;
+	/// @endcond
+
+protected:
+	void insert_leaf_base(Node & node, Node * start) CMP_NOEXCEPT(node);
+	void remove_to_leaf(Node & node) CMP_NOEXCEPT(node);
+
+	/*
+	 * Walk up from a node whose subtree grew (resp. from the parent of a removed
+	 * leaf), updating balance factors and rotating where necessary.
+	 */
+	void fixup_after_insert(Node * node) noexcept;
+	void fixup_after_delete(Node * parent, bool deleted_left) noexcept;
+
+	/*
+	 * Rebalance <node>, which has a balance factor of +2 (resp. -2), by a single
+	 * or double rotation. Returns the new root of the subtree and whether the
+	 * height of the subtree is unchanged compared to before the operation that
+	 * caused the imbalance.
+	 */
+	Node * rebalance_right_heavy(Node * node, bool & height_unchanged) noexcept;
+	Node * rebalance_left_heavy(Node * node, bool & height_unchanged) noexcept;
+
+	void rotate_left(Node * parent) noexcept;
+	void rotate_right(Node * parent) noexcept;
+
+	void swap_nodes(Node * n1, Node * n2) noexcept;
+	void swap_unrelated_nodes(Node * n1, Node * n2) noexcept;
+	void swap_neighbors(Node * parent, Node * child) noexcept;
+
+	int verify_balance(const Node * node) const;
+};
+
+} // namespace ygg
+
+#ifndef YGG_AVLTREE_CPP
+#include "avltree.cpp"
+#endif
+
+#endif // YGG_AVLTREE_HPP
@@ -0,0 +1,335 @@
+#ifndef YGG_BIASED_WBTREE_CPP
+#define YGG_BIASED_WBTREE_CPP
+
+#include "biased_wbtree.hpp"
+
+namespace ygg {
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::BiasedWBTree() noexcept
+{}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::BiasedWBTree(
+    MyClass && other) noexcept
+{
+	this->root = other.root;
+	other.root = nullptr;
+	this->s = other.s;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+size_t
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::get_weight(
+    const Node & node) noexcept
+{
+	return node.NB::_bwbt_weight;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+size_t
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::get_total_weight(
+    const Node * n) noexcept
+{
+	if (n == nullptr) {
+		return 0;
+	}
+	return n->NB::_bwbt_total;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node,
+                                                              size_t weight)
+    CMP_NOEXCEPT(node)
+{
+	assert(weight > 0);
+
+	node.NB::set_left(nullptr);
+	node.NB::set_right(nullptr);
+	node.NB::_bwbt_weight = weight;
+	node.NB::_bwbt_total = weight;
+
+	Node * parent = nullptr;
+	Node * cur = this->root;
+	while (cur != nullptr) {
+		parent = cur;
+		if (this->cmp(*cur, node)) {
+			cur = cur->NB::get_right();
+		} else if (!Options::multiple && !this->cmp(node, *cur)) {
+			// Same as existing.
+			return;
+		} else {
+			cur = cur->NB::get_left();
+		}
+	}
+
+	this->s.add(1);
+	node.NB::set_parent(parent);
+	if (parent == nullptr) {
+		this->root = &node;
+	} else {
+		if (this->cmp(*parent, node)) {
+			parent->NB::set_right(&node);
+		} else {
+			parent->NB::set_left(&node);
+		}
+
+		for (Node * ancestor = parent; ancestor != nullptr;
+		     ancestor = ancestor->NB::get_parent()) {
+			ancestor->NB::_bwbt_total += weight;
+		}
+	}
+
+	NodeTraits::leaf_inserted(node, *this);
+	this->rebalance_upwards(parent);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::remove(Node & node)
+    CMP_NOEXCEPT(node)
+{
+	// Rotate the node down until it is a leaf, always lifting the heavier child.
+	while ((node.NB::get_left() != nullptr) ||
+	       (node.NB::get_right() != nullptr)) {
+		if ((node.NB::get_right() == nullptr) ||
+		    (get_total_weight(node.NB::get_left()) >
+		     get_total_weight(node.NB::get_right()))) {
+			this->rotate_right(&node);
+		} else {
+			this->rotate_left(&node);
+		}
+	}
+
+	NodeTraits::delete_leaf(node, *this);
+
+	Node * parent = node.NB::get_parent();
+	this->s.reduce(1);
+	if (parent == nullptr) {
+		this->root = nullptr;
+		return;
+	}
+
+	if (parent->NB::get_left() == &node) {
+		parent->NB::set_left(nullptr);
+	} else {
+		parent->NB::set_right(nullptr);
+	}
+
+	for (Node * ancestor = parent; ancestor != nullptr;
+	     ancestor = ancestor->NB::get_parent()) {
+		ancestor->NB::_bwbt_total -= node.NB::_bwbt_weight;
+	}
+
+	NodeTraits::deleted_below(*parent, *this);
+	this->rebalance_upwards(parent);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::update_weight(
+    Node & node, size_t weight) noexcept
+{
+	assert(weight > 0);
+
+	size_t old_weight = node.NB::_bwbt_weight;
+	node.NB::_bwbt_weight = weight;
+	for (Node * cur = &node; cur != nullptr; cur = cur->NB::get_parent()) {
+		cur->NB::_bwbt_total = cur->NB::_bwbt_total - old_weight + weight;
+	}
+
+	this->rebalance_upwards(&node);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::rotate_left(
+    Node * parent) noexcept
+{
+	Node * right_child = parent->NB::get_right();
+	Node * inner = right_child->NB::get_left();
+
+	right_child->NB::_bwbt_total = parent->NB::_bwbt_total;
+	parent->NB::_bwbt_total = parent->NB::_bwbt_weight +
+	                          get_total_weight(parent->NB::get_left()) +
+	                          get_total_weight(inner);
+
+	parent->NB::set_right(inner);
+	if (inner != nullptr) {
+		inner->NB::set_parent(parent);
+	}
+
+	Node * parents_parent = parent->NB::get_parent();
+	right_child->NB::set_left(parent);
+	right_child->NB::set_parent(parents_parent);
+
+	if (parents_parent != nullptr) {
+		if (parents_parent->NB::get_left() == parent) {
+			parents_parent->NB::set_left(right_child);
+		} else {
+			parents_parent->NB::set_right(right_child);
+		}
+	} else {
+		this->root = right_child;
+	}
+
+	parent->NB::set_parent(right_child);
+
+	NodeTraits::rotated_left(*parent, *this);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::rotate_right(
+    Node * parent) noexcept
+{
+	Node * left_child = parent->NB::get_left();
+	Node * inner = left_child->NB::get_right();
+
+	left_child->NB::_bwbt_total = parent->NB::_bwbt_total;
+	parent->NB::_bwbt_total = parent->NB::_bwbt_weight +
+	                          get_total_weight(parent->NB::get_right()) +
+	                          get_total_weight(inner);
+
+	parent->NB::set_left(inner);
+	if (inner != nullptr) {
+		inner->NB::set_parent(parent);
+	}
+
+	Node * parents_parent = parent->NB::get_parent();
+	left_child->NB::set_right(parent);
+	left_child->NB::set_parent(parents_parent);
+
+	if (parents_parent != nullptr) {
+		if (parents_parent->NB::get_left() == parent) {
+			parents_parent->NB::set_left(left_child);
+		} else {
+			parents_parent->NB::set_right(left_child);
+		}
+	} else {
+		this->root = left_child;
+	}
+
+	parent->NB::set_parent(left_child);
+
+	NodeTraits::rotated_right(*parent, *this);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+Node *
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::rebalance_at(
+    Node * node) noexcept
+{
+	while (true) {
+		Node * left = node->NB::get_left();
+		Node * right = node->NB::get_right();
+
+		// What moves down when lifting something from the right resp. left
+		size_t stays_left = node->NB::_bwbt_weight + get_total_weight(left);
+		size_t stays_right = node->NB::_bwbt_weight + get_total_weight(right);
+
+		if (right != nullptr) {
+			Node * inner = right->NB::get_left();
+			if (right->NB::_bwbt_weight +
+			        get_total_weight(right->NB::get_right()) >
+			    stays_left) {
+				this->rotate_left(node);
+				this->rebalance_at(node);
+				node = right;
+				continue;
+			}
+			if ((inner != nullptr) &&
+			    (inner->NB::_bwbt_weight + inner->NB::_bwbt_total > stays_left)) {
+				this->rotate_right(right);
+				this->rotate_left(node);
+				this->rebalance_at(node);
+				this->rebalance_at(right);
+				node = inner;
+				continue;
+			}
+		}
+
+		if (left != nullptr) {
+			Node * inner = left->NB::get_right();
+			if (left->NB::_bwbt_weight + get_total_weight(left->NB::get_left()) >
+			    stays_right) {
+				this->rotate_right(node);
+				this->rebalance_at(node);
+				node = left;
+				continue;
+			}
+			if ((inner != nullptr) &&
+			    (inner->NB::_bwbt_weight + inner->NB::_bwbt_total > stays_right)) {
+				this->rotate_left(left);
+				this->rotate_right(node);
+				this->rebalance_at(node);
+				this->rebalance_at(left);
+				node = inner;
+				continue;
+			}
+		}
+
+		return node;
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::rebalance_upwards(
+    Node * node) noexcept
+{
+	while (node != nullptr) {
+		node = this->rebalance_at(node);
+		node = node->NB::get_parent();
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::verify_weights() const
+{
+	for (const Node & node : *this) {
+		const Node * left = node.NB::get_left();
+		const Node * right = node.NB::get_right();
+
+		debug::yggassert(node.NB::_bwbt_weight > 0);
+		debug::yggassert(node.NB::_bwbt_total == node.NB::_bwbt_weight +
+		                                             get_total_weight(left) +
+		                                             get_total_weight(right));
+
+		size_t stays_left = node.NB::_bwbt_weight + get_total_weight(left);
+		size_t stays_right = node.NB::_bwbt_weight + get_total_weight(right);
+		if (right != nullptr) {
+			debug::yggassert(right->NB::_bwbt_weight +
+			                     get_total_weight(right->NB::get_right()) <=
+			                 stays_left);
+			const Node * inner = right->NB::get_left();
+			debug::yggassert((inner == nullptr) ||
+			                 (inner->NB::_bwbt_weight + inner->NB::_bwbt_total <=
+			                  stays_left));
+		}
+		if (left != nullptr) {
+			debug::yggassert(left->NB::_bwbt_weight +
+			                     get_total_weight(left->NB::get_left()) <=
+			                 stays_right);
+			const Node * inner = left->NB::get_right();
+			debug::yggassert((inner == nullptr) ||
+			                 (inner->NB::_bwbt_weight + inner->NB::_bwbt_total <=
+			                  stays_right));
+		}
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>::dbg_verify() const
+{
+	this->verify_tree();
+	this->verify_order();
+	this->verify_weights();
+}
+
+} // namespace ygg
+
+#endif // YGG_BIASED_WBTREE_CPP
@@ -0,0 +1,179 @@
+#ifndef YGG_BIASED_WBTREE_HPP
+#define YGG_BIASED_WBTREE_HPP
+
+#include "bst.hpp"
+#include "debug.hpp"
+#include "options.hpp"
+#include "size_holder.hpp"
+#include "tree_iterator.hpp"
+#include "wbtree.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace ygg {
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the Biased Weight Balanced Tree *must* derive
+ * from this class (template). It supplies your class with the necessary members
+ * to contain the linking between the tree nodes, the node's weight and the
+ * total weight of its subtree.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam options  The options class (a version of TreeOptions) that you
+ * parameterize the tree with. (See the options parameter of RBTree.)
+ * @tparam Tag 		The tag used to identify the tree that this node should
+ * be inserted into. See RBTree for details.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class BiasedWBTreeNodeBase : public bst::BSTNodeBase<Node, Options, Tag> {
+public:
+	size_t _bwbt_weight;
+	size_t _bwbt_total;
+};
+
+/**
+ * @brief The Biased Weight Balanced Tree
+ *
+ * A variant of the WBTree that is balanced by user-supplied node weights (e.g.,
+ * access frequencies) instead of subtree sizes. Heavy nodes are kept close to
+ * the root: a node of weight w in a tree of total weight W has depth at most
+ * log_{3/2}(W / w). With all weights equal, this is an ordinary balanced tree.
+ *
+ * Let T(x) be the total weight of the subtree rooted at x, and w(x) the weight
+ * of x (both zero for empty subtrees). For every node v with children c and o
+ * and every child b of c, the tree maintains
+ *
+ *    w(c) + T(c's child on the side away from o) <= w(v) + T(o)
+ *    w(b) + T(b) <= w(v) + T(o)     for c's child b on the side of o
+ *
+ * Every single or double rotation that restores one of these reduces the
+ * weighted path length of the tree, thus rebalancing always terminates. The
+ * invariants imply that every step down from a node loses at least a third of
+ * the total weight.
+ *
+ * The weight of a node can be changed at any time via update_weight(), which
+ * rebalances the path from the node to the root. The NodeTraits hooks
+ * leaf_inserted, rotated_left, rotated_right, delete_leaf and deleted_below of
+ * WBDefaultNodeTraits are called.
+ *
+ * @tparam Node         The node class for this tree. It must be derived from
+ * BiasedWBTreeNodeBase.
+ * @tparam NodeTraits   A class implementing various hooks and functions on your
+ * node class, e.g. WBDefaultNodeTraits.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this tree. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies this tree. Can be used
+ * to insert the same nodes into multiple trees. Can be any class, the class can
+ * be empty.
+ * @tparam Compare      A compare class. The tree follows STL semantics for
+ * 'Compare'. Defaults to ygg::utilities::flexible_less. Implement
+ * operator<(const Node & lhs, const Node & rhs) if you want to use it.
+ */
+template <class Node, class NodeTraits, class Options = DefaultOptions,
+          class Tag = int, class Compare = ygg::utilities::flexible_less>
+class BiasedWBTree
+    : public bst::BinarySearchTree<Node, Options, Tag, Compare> {
+public:
+	using MyClass = BiasedWBTree<Node, NodeTraits, Options, Tag, Compare>;
+	// Node Base
+	using NB = BiasedWBTreeNodeBase<Node, Options, Tag>;
+	using TB = bst::BinarySearchTree<Node, Options, Tag, Compare>;
+	static_assert(std::is_base_of<NB, Node>::value,
+	              "Node class not properly derived from BiasedWBTreeNodeBase");
+
+	/**
+	 * @brief Create a new empty biased weight balanced tree.
+	 */
+	BiasedWBTree() noexcept;
+
+	/**
+	 * @brief Create a new biased weight balanced tree from a different one.
+	 *
+	 * The other tree is moved into this one, i.e., using it afterwards is
+	 * undefined behavior.
+	 *
+	 * @param other  The tree that this one is constructed from
+	 */
+	BiasedWBTree(MyClass && other) noexcept;
+
+	/*
+	 * Pull in classes from base tree
+	 */
+	template <bool reverse>
+	using iterator = typename TB::template iterator<reverse>;
+	template <bool reverse>
+	using const_iterator = typename TB::template const_iterator<reverse>;
+
+	/**
+	 * @brief Inserts <node> into the tree with the given weight
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param node    The node to be inserted.
+	 * @param weight  The weight of the node. Must be at least 1.
+	 */
+	void insert(Node & node, size_t weight = 1) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * @param node  The node to be removed.
+	 */
+	void remove(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Changes the weight of <node>
+	 *
+	 * The node moves up or down according to its new weight. Only the path from
+	 * the node to the root is rebalanced.
+	 *
+	 * @param node    A node in this tree
+	 * @param weight  The new weight of the node. Must be at least 1.
+	 */
+	void update_weight(Node & node, size_t weight) noexcept;
+
+	/**
+	 * @brief Returns the weight of <node>
+	 */
+	static size_t get_weight(const Node & node) noexcept;
+
+	/**
+	 * @brief Returns the total weight of all nodes in the subtree rooted at <n>
+	 *
+	 * Returns 0 if <n> is nullptr. This method runs in O(1).
+	 */
+	static size_t get_total_weight(const Node * n) noexcept;
+
+	// Mainly debugging methods
+	/// @cond INTERNAL
+	void dbg_verify() const;
+	/// @endcond
+
+protected:
+	void rotate_left(Node * parent) noexcept;
+	void rotate_right(Node * parent) noexcept;
+
+	/*
+	 * Applies improving rotations at <node> (and, recursively, at the nodes that
+	 * were moved down) until none is left. Returns the new root of the subtree.
+	 */
+	Node * rebalance_at(Node * node) noexcept;
+	void rebalance_upwards(Node * node) noexcept;
+
+	void verify_weights() const;
+};
+
+} // namespace ygg
+
+#ifndef YGG_BIASED_WBTREE_CPP
+#include "biased_wbtree.cpp"
+#endif
+
+#endif // YGG_BIASED_WBTREE_HPP
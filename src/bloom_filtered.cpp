@@ -0,0 +1,242 @@
+#ifndef YGG_BLOOM_FILTERED_CPP
+#define YGG_BLOOM_FILTERED_CPP
+
+#include "bloom_filtered.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ygg {
+
+template <class Tree, class KeyGetter, class Hasher>
+BloomFiltered<Tree, KeyGetter, Hasher>::BloomFiltered() : keys(0)
+{}
+
+template <class Tree, class KeyGetter, class Hasher>
+uint64_t
+BloomFiltered<Tree, KeyGetter, Hasher>::hash_key(const Key & key) const
+{
+	return utilities::mix_hash(static_cast<uint64_t>(this->hasher(key)));
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+size_t
+BloomFiltered<Tree, KeyGetter, Hasher>::get_counter(uint64_t hash,
+                                                    size_t i) const noexcept
+{
+	// Double hashing. Since the step is odd and the number of counters is a
+	// power of two, the first NUM_PROBES counters are all different.
+	const uint64_t step = (hash >> 32) | 1;
+	return static_cast<size_t>(hash + i * step) & (this->counters.size() - 1);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+bool
+BloomFiltered<Tree, KeyGetter, Hasher>::may_contain_hash(
+    uint64_t hash) const noexcept
+{
+	if (this->counters.empty()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < NUM_PROBES; ++i) {
+		if (this->counters[this->get_counter(hash, i)] == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::add_hash(uint64_t hash) noexcept
+{
+	for (size_t i = 0; i < NUM_PROBES; ++i) {
+		uint8_t & counter = this->counters[this->get_counter(hash, i)];
+		if (counter != SATURATED) {
+			counter++;
+		}
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::remove_hash(uint64_t hash) noexcept
+{
+	for (size_t i = 0; i < NUM_PROBES; ++i) {
+		uint8_t & counter = this->counters[this->get_counter(hash, i)];
+		// We don't know the true count of a saturated counter anymore
+		assert(counter != 0);
+		if (counter != SATURATED) {
+			counter--;
+		}
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::rebuild(size_t capacity)
+{
+	this->counters.assign(capacity, 0);
+	this->keys = 0;
+
+	const Node * last = nullptr;
+	for (const auto & n : this->t) {
+		if ((last == nullptr) ||
+		    !(KeyGetter::get_key(*last) == KeyGetter::get_key(n))) {
+			this->add_hash(this->hash_key(KeyGetter::get_key(n)));
+			this->keys++;
+		}
+		last = &n;
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::insert(Node & node)
+{
+	const uint64_t hash = this->hash_key(KeyGetter::get_key(node));
+	// The filter counts keys, not nodes. Only if the filter can't rule out the
+	// key, we must look whether it is already there.
+	const bool new_key =
+	    !this->may_contain_hash(hash) ||
+	    (this->t.find(KeyGetter::get_key(node)) == this->t.end());
+
+	this->t.insert(node);
+
+	if (new_key) {
+		this->keys++;
+		// Keep at least eight counters per key
+		if (this->keys * 8 > this->counters.size()) {
+			this->rebuild(std::max(MIN_CAPACITY, this->counters.size() * 2));
+		} else {
+			this->add_hash(hash);
+		}
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::remove(Node & node)
+{
+	// The key only leaves the filter with the last node that has it
+	const bool last_of_key = (this->get_equal_key_neighbor(node) == nullptr);
+
+	this->t.remove(node);
+
+	if (last_of_key) {
+		this->key_removed(this->hash_key(KeyGetter::get_key(node)));
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::key_removed(uint64_t hash)
+{
+	this->keys--;
+	// Shrink if there are more than 32 counters per key
+	if ((this->counters.size() > MIN_CAPACITY) &&
+	    (this->keys * 32 < this->counters.size())) {
+		this->rebuild(this->counters.size() / 2);
+	} else {
+		this->remove_hash(hash);
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+typename BloomFiltered<Tree, KeyGetter, Hasher>::erase_result
+BloomFiltered<Tree, KeyGetter, Hasher>::erase(const Key & key)
+{
+	const uint64_t hash = this->hash_key(key);
+	if (!this->may_contain_hash(hash)) {
+		return erase_result{};
+	}
+
+	if constexpr (std::is_same<erase_result, Node *>::value) {
+		iterator it = this->t.find(key);
+		if (it == this->t.end()) {
+			return nullptr;
+		}
+
+		Node & node = *it;
+		this->remove(node);
+		return &node;
+	} else {
+		// With STL_ERASE, all nodes with <key> are gone afterwards
+		const erase_result count = this->t.erase(key);
+		if (count > 0) {
+			this->key_removed(hash);
+		}
+		return count;
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+typename BloomFiltered<Tree, KeyGetter, Hasher>::iterator
+BloomFiltered<Tree, KeyGetter, Hasher>::find(const Key & key)
+{
+	if (!this->may_contain_hash(this->hash_key(key))) {
+		return this->t.end();
+	}
+	return this->t.find(key);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+typename BloomFiltered<Tree, KeyGetter, Hasher>::const_iterator
+BloomFiltered<Tree, KeyGetter, Hasher>::find(const Key & key) const
+{
+	if (!this->may_contain_hash(this->hash_key(key))) {
+		return this->t.end();
+	}
+	return this->t.find(key);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+bool
+BloomFiltered<Tree, KeyGetter, Hasher>::may_contain(const Key & key) const
+{
+	return this->may_contain_hash(this->hash_key(key));
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::clear()
+{
+	this->t.clear();
+	this->counters.clear();
+	this->keys = 0;
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+BloomFiltered<Tree, KeyGetter, Hasher>::dbg_verify() const
+{
+	this->t.dbg_verify();
+
+	// Recount from scratch. Saturated counters may be too large.
+	std::vector<size_t> expected(this->counters.size(), 0);
+	size_t distinct_keys = 0;
+	const Node * last = nullptr;
+	for (const auto & n : this->t) {
+		if ((last == nullptr) ||
+		    !(KeyGetter::get_key(*last) == KeyGetter::get_key(n))) {
+			distinct_keys++;
+			const uint64_t hash = this->hash_key(KeyGetter::get_key(n));
+			debug::yggassert(this->may_contain_hash(hash));
+			for (size_t i = 0; i < NUM_PROBES; ++i) {
+				expected[this->get_counter(hash, i)]++;
+			}
+		}
+		last = &n;
+	}
+	debug::yggassert(distinct_keys == this->keys);
+
+	for (size_t i = 0; i < this->counters.size(); ++i) {
+		debug::yggassert((this->counters[i] == expected[i]) ||
+		                 (this->counters[i] == SATURATED));
+	}
+}
+
+} // namespace ygg
+
+#endif // YGG_BLOOM_FILTERED_CPP
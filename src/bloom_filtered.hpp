@@ -0,0 +1,171 @@
+#ifndef YGG_BLOOM_FILTERED_HPP
+#define YGG_BLOOM_FILTERED_HPP
+
+#include "concurrent_read_tree.hpp"
+#include "debug.hpp"
+#include "keyed_wrapper.hpp"
+#include "options.hpp"
+#include "util.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ygg {
+
+/**
+ * @brief Answers lookups for absent keys without descending into a tree
+ *
+ * This class wraps any of the binary search trees (RBTree, WBTree, ZTree,
+ * AVLTree, EnergyTree, …) and keeps a counting Bloom filter over the keys in
+ * the tree. find() and erase() first ask the filter, and if the filter says
+ * that the key is definitely not in the tree, they return immediately. This
+ * pays off if many of your lookups are for keys that are not in the tree,
+ * since an unsuccessful search always walks all the way down to a leaf. Keys
+ * that are in the tree (and the few false positives of the filter) are
+ * searched in the tree as usual.
+ *
+ * The filter uses 8-bit counters, about eight counters per distinct key and
+ * three counters per key, which gives a false positive rate of about 3%. It is
+ * resized (and rebuilt from the tree) as the number of distinct keys changes. A
+ * counter that reaches 255 stays there until the next rebuild.
+ *
+ * The keys are retrieved via a KeyGetter. The keys must be
+ * equality-comparable, two nodes must have equal keys if and only if they
+ * compare equally in the tree, and the tree must be searchable with a key
+ * (i.e., the tree's find() must accept a Key). The key of a node must not
+ * change while the node is in the tree.
+ *
+ * Only modify the tree via insert(), remove(), erase() and clear() of this
+ * class, the filter would get out of sync otherwise.
+ *
+ * @tparam Tree       The tree to be wrapped, e.g., an RBTree.
+ * @tparam KeyGetter  A class that must implement a static Key get_key(const
+ * Node &) function that returns the key of a node.
+ * @tparam Hasher     A hasher for keys, with the same interface as std::hash.
+ * Defaults to std::hash<Key>. The hash values are mixed before use, so an
+ * identity hash (like std::hash<int>) works fine.
+ */
+template <class Tree, class KeyGetter,
+          class Hasher = std::hash<std::decay_t<decltype(KeyGetter::get_key(
+              std::declval<
+                  const concurrent_read_internal::tree_node_t<Tree> &>()))>>>
+class BloomFiltered
+    : public keyed_wrapper_internal::KeyedTreeWrapper<Tree, KeyGetter> {
+public:
+	using Base = keyed_wrapper_internal::KeyedTreeWrapper<Tree, KeyGetter>;
+	using Node = typename Base::Node;
+	using Key = typename Base::Key;
+	using MyClass = BloomFiltered<Tree, KeyGetter, Hasher>;
+
+	using iterator = typename Base::iterator;
+	using const_iterator = typename Base::const_iterator;
+	using erase_result = typename Base::erase_result;
+
+	/**
+	 * @brief Creates a new, empty tree
+	 */
+	BloomFiltered();
+
+	/**
+	 * @brief Inserts <node> into the tree and the filter
+	 *
+	 * If the filter says that the key of <node> might already be in the tree,
+	 * this costs one additional search in the tree.
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree and the filter
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Removes the nodes with key <key>
+	 *
+	 * This behaves like the erase() method of the wrapped tree. If the wrapped
+	 * tree uses STL_ERASE, all nodes with key <key> are removed. Otherwise, if
+	 * there are multiple nodes with key <key>, only one of them is removed.
+	 *
+	 * If the filter rules out <key>, this runs in O(1) and never looks at the
+	 * tree.
+	 *
+	 * @param key The key of the node(s) to be removed
+	 * @return If the wrapped tree uses STL_ERASE, the number of removed nodes.
+	 * Otherwise, a pointer to the removed node, or nullptr if there is no node
+	 * with key <key>.
+	 */
+	erase_result erase(const Key & key);
+
+	/**
+	 * @brief Finds a node with key <key>
+	 *
+	 * If the filter rules out <key>, this runs in O(1) and never looks at the
+	 * tree.
+	 *
+	 * @param key The key to search for
+	 * @return An iterator to a node with key <key>, or end() if there is no
+	 * such node.
+	 */
+	iterator find(const Key & key);
+	const_iterator find(const Key & key) const;
+
+	/**
+	 * @brief Asks the filter whether the tree might contain <key>
+	 *
+	 * @param key The key to ask for
+	 * @return false if the tree definitely does not contain a node with key
+	 * <key>, true if it might.
+	 */
+	bool may_contain(const Key & key) const;
+
+	/**
+	 * @brief Removes all elements from the tree and the filter
+	 *
+	 * Note that the nodes are not touched.
+	 */
+	void clear();
+
+	// Debugging methods
+	void dbg_verify() const;
+
+private:
+	static constexpr size_t MIN_CAPACITY = 64;
+	static constexpr size_t NUM_PROBES = 3;
+	static constexpr uint8_t SATURATED = 255;
+
+	uint64_t hash_key(const Key & key) const;
+	// The i-th counter for a hash. The counters of a hash are all different.
+	size_t get_counter(uint64_t hash, size_t i) const noexcept;
+	bool may_contain_hash(uint64_t hash) const noexcept;
+	void add_hash(uint64_t hash) noexcept;
+	void remove_hash(uint64_t hash) noexcept;
+	// Called after the last node with the key hashed to <hash> has been removed
+	void key_removed(uint64_t hash);
+	// Resizes the filter to <capacity> counters and refills it from the tree.
+	void rebuild(size_t capacity);
+
+	Hasher hasher;
+
+	std::vector<uint8_t> counters;
+	// The number of distinct keys in the tree
+	size_t keys;
+};
+
+} // namespace ygg
+
+#ifndef YGG_BLOOM_FILTERED_CPP
+#include "bloom_filtered.cpp"
+#endif
+
+#endif // YGG_BLOOM_FILTERED_HPP
@@ -5,6 +5,9 @@
 
 #include "debug.hpp"
 
+#include <algorithm>
+#include <thread>
+
 namespace ygg {
 namespace bst {
 
@@ -191,6 +194,228 @@ BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::get_uncle(
 	}
 }
 
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+template <bool strict>
+Node *
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::get_moved_past(
+    Node & node) CMP_NOEXCEPT(node)
+{
+	auto it = this->iterator_to(node);
+
+	auto prev = it;
+	--prev;
+	if (prev != this->end()) {
+		if constexpr (!strict) {
+			if (this->cmp(node, *prev)) {
+				return &*prev;
+			}
+		} else {
+			if (!this->cmp(*prev, node)) {
+				return &*prev;
+			}
+		}
+	}
+
+	auto next = it;
+	++next;
+	if (next != this->end()) {
+		if constexpr (!strict) {
+			if (this->cmp(*next, node)) {
+				return &*next;
+			}
+		} else {
+			if (!this->cmp(node, *next)) {
+				return &*next;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+Node *
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::
+    get_hint_subtree(const Node & node, Node & hint) CMP_NOEXCEPT(node)
+{
+	Node * parent = &hint;
+	Node * cur = parent;
+
+	/* We can be sure that *parent is the root of a subtree in which node is
+	 * supposed to be inserted if the path from *parent to the root contains only
+	 * "correct decisions" wrt. node.
+	 *
+	 * If we walk up the path and see one correctly taken right, and one correctly
+	 * taken left, we can be sure that the path above that is okay.
+	 */
+
+	bool left_seen;
+	bool right_seen;
+
+	// Below the hint itself, we can choose left/right
+	left_seen = this->cmp(node, hint);
+	right_seen = !left_seen;
+
+	while (!(left_seen && right_seen)) {
+		const Node * const prev = cur;
+		cur = cur->NB::get_parent();
+
+		if (__builtin_expect(cur == nullptr, 0)) {
+			parent = this->root;
+			break;
+		}
+
+		const bool ascended_left = (cur->NB::get_left() == prev);
+		const bool should_go_left = this->cmp(node, *cur);
+		left_seen |= ascended_left;
+		right_seen |= !ascended_left;
+
+		// If we took a wrong turn, reset left_seen and right_seen and set new
+		// parent
+		if (ascended_left && !should_go_left) {
+			// goes right below cur
+			right_seen = true;
+			left_seen = false;
+			parent = cur;
+		} else if (!ascended_left && should_go_left) {
+			right_seen = false;
+			left_seen = true;
+			parent = cur;
+		}
+	}
+
+	return parent;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+template <class RotateLeft, class RotateRight, class OnVine>
+void
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::
+    rebuild_subtree_dsw(Node & node, size_t size, RotateLeft && rotate_left,
+                        RotateRight && rotate_right, OnVine && on_vine)
+{
+	// Day-Stout-Warren: First turn the subtree into a vine of right children,
+	// then repeatedly left-rotate every other node of the vine. Everything is
+	// done via rotations, thus no extra memory is needed.
+	Node * parent = node.NB::get_parent();
+	bool is_left = (parent != nullptr) && (parent->NB::get_left() == &node);
+	auto get_sub_root = [&]() {
+		if (parent == nullptr) {
+			return this->root;
+		}
+		return is_left ? parent->NB::get_left() : parent->NB::get_right();
+	};
+
+	Node * cur = &node;
+	while (cur != nullptr) {
+		if (cur->NB::get_left() != nullptr) {
+			Node * left = cur->NB::get_left();
+			rotate_right(cur);
+			cur = left;
+		} else {
+			on_vine(cur);
+			cur = cur->NB::get_right();
+		}
+	}
+
+	auto compress = [&](size_t count) {
+		Node * scanner = nullptr;
+		for (size_t i = 0; i < count; ++i) {
+			Node * vine_node =
+			    (scanner == nullptr) ? get_sub_root() : scanner->NB::get_right();
+			rotate_left(vine_node);
+			scanner = vine_node->NB::get_parent();
+		}
+	};
+
+	// The largest perfect tree not larger than the subtree. The remaining nodes
+	// form the (partial) bottom level.
+	size_t perfect_size = 1;
+	while (2 * perfect_size + 1 <= size) {
+		perfect_size = 2 * perfect_size + 1;
+	}
+
+	compress(size - perfect_size);
+	while (perfect_size > 1) {
+		perfect_size /= 2;
+		compress(perfect_size);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+template <class InputIt>
+std::vector<Node *>
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::
+    collect_sorted_nodes(InputIt nodes_begin, InputIt nodes_end,
+                         size_t threads)
+{
+	std::vector<Node *> nodes;
+	for (auto it = nodes_begin; it != nodes_end; ++it) {
+		nodes.push_back(&*it);
+	}
+
+	parallel_internal::parallel_stable_sort(
+	    nodes.begin(), nodes.end(),
+	    [&](const Node * lhs, const Node * rhs) { return this->cmp(*lhs, *rhs); },
+	    threads);
+
+	if constexpr (!Options::multiple) {
+		// Like insert(), keep the first of multiple equal nodes
+		nodes.erase(std::unique(nodes.begin(), nodes.end(),
+		                        [&](const Node * lhs, const Node * rhs) {
+			                        return !this->cmp(*lhs, *rhs);
+		                        }),
+		            nodes.end());
+	}
+
+	return nodes;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+template <class Init>
+Node *
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::build_balanced(
+    Node * const * nodes, size_t count, Node * parent, size_t dir,
+    size_t depth, size_t threads, Init & init)
+{
+	if (count == 0) {
+		return nullptr;
+	}
+
+	size_t mid = count / 2;
+	Node * sub_root = nodes[mid];
+
+	sub_root->NB::set_parent(parent);
+	sub_root->NB::set_left(nullptr);
+	sub_root->NB::set_right(nullptr);
+	if (parent != nullptr) {
+		parent->NB::_bst_children[dir] = sub_root;
+	}
+	init(*sub_root, depth, count);
+
+	if (threads > 1 && count >= parallel_internal::PARALLEL_CUTOFF) {
+		// The two halves touch disjoint nodes.
+		size_t left_threads = threads / 2;
+		std::thread left_builder([&]() {
+			build_balanced(nodes, mid, sub_root, 0, depth + 1, left_threads, init);
+		});
+		build_balanced(nodes + mid + 1, count - mid - 1, sub_root, 1, depth + 1,
+		               threads - left_threads, init);
+		left_builder.join();
+	} else {
+		build_balanced(nodes, mid, sub_root, 0, depth + 1, 1, init);
+		build_balanced(nodes + mid + 1, count - mid - 1, sub_root, 1, depth + 1, 1,
+		               init);
+	}
+
+	return sub_root;
+}
+
 template <class Node, class Options, class Tag, class Compare,
           class ParentContainer>
 void
@@ -743,7 +968,7 @@ BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::find(
 	// TODO this should be the other way round! The non-const variant should
 	// utilize the const variant.
 	return const_iterator<false>(
-	    const_cast<std::remove_const_t<decltype(this)>>(this)
+	    const_cast<MyClass *>(this)
 	        ->template find<Comparable, ensure_first>(query));
 }
 
@@ -844,6 +1069,24 @@ BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::get_root()
 	return this->root;
 }
 
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+Node *
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::get_left_child(
+    Node * n) noexcept
+{
+	return n->NB::get_left();
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class ParentContainer>
+Node *
+BinarySearchTree<Node, Options, Tag, Compare, ParentContainer>::get_right_child(
+    Node * n) noexcept
+{
+	return n->NB::get_right();
+}
+
 } // namespace bst
 } // namespace ygg
 
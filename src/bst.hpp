@@ -2,6 +2,7 @@
 #define YGG_BST_HPP
 
 #include "options.hpp"
+#include "parallel.hpp"
 #include "size_holder.hpp"
 #include "tree_iterator.hpp"
 #include "util.hpp"
@@ -460,6 +461,52 @@ protected:
 	Node * get_largest() const noexcept;
 	Node * get_uncle(Node * node) const noexcept;
 
+	// @cond INTERNAL
+	/*
+	 * Helpers for changing the key of a node that is in the tree.
+	 * get_moved_past() returns nullptr if <node> still is in order with its
+	 * in-order neighbors, and the neighbor that it has moved past otherwise.
+	 * If <strict> is set, a neighbor comparing equally counts as moved past.
+	 * get_hint_subtree() walks up from <hint> and returns the root of the
+	 * smallest subtree that <node> belongs into.
+	 */
+	template <bool strict = !Options::multiple>
+	Node * get_moved_past(Node & node) CMP_NOEXCEPT(node);
+	Node * get_hint_subtree(const Node & node, Node & hint) CMP_NOEXCEPT(node);
+	// @endcond
+
+	// @cond INTERNAL
+	/*
+	 * Rebuilds the subtree of <size> nodes rooted at <node> into a complete
+	 * tree in place, using the Day-Stout-Warren algorithm. All restructuring is
+	 * done by calling rotate_left(parent) resp. rotate_right(parent), so that
+	 * derived trees can maintain their node data. on_vine(node) is called for
+	 * every node of the subtree after the first phase has moved it onto the
+	 * vine.
+	 */
+	template <class RotateLeft, class RotateRight, class OnVine>
+	void rebuild_subtree_dsw(Node & node, size_t size, RotateLeft && rotate_left,
+	                         RotateRight && rotate_right, OnVine && on_vine);
+	// @endcond
+
+	// @cond INTERNAL
+	/*
+	 * Helpers for building a tree from an unsorted range of nodes in parallel.
+	 * collect_sorted_nodes() returns pointers to all nodes in the range, sorted
+	 * stably, and without duplicates unless MULTIPLE is set. build_balanced()
+	 * links nodes[0..count) as a perfectly balanced subtree below <parent>
+	 * (in direction <dir>), top-down. It calls init(node, depth, subtree_size)
+	 * on every node right after linking it, before its children are linked.
+	 */
+	template <class InputIt>
+	std::vector<Node *> collect_sorted_nodes(InputIt nodes_begin,
+	                                         InputIt nodes_end, size_t threads);
+	template <class Init>
+	static Node * build_balanced(Node * const * nodes, size_t count,
+	                             Node * parent, size_t dir, size_t depth,
+	                             size_t threads, Init & init);
+	// @endcond
+
 	Compare cmp;
 
 	SizeHolder<Options::constant_time_size> s;
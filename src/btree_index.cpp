@@ -0,0 +1,909 @@
+#ifndef YGG_BTREE_INDEX_CPP
+#define YGG_BTREE_INDEX_CPP
+
+#include "btree_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ygg {
+namespace btree_index_internal {
+
+/*
+ * KeySearch
+ */
+template <class Key, size_t capacity>
+Key
+KeySearch<Key, capacity>::sentinel() noexcept
+{
+	if constexpr (padded) {
+		return std::numeric_limits<Key>::max();
+	} else {
+		return Key();
+	}
+}
+
+template <class Key, size_t capacity>
+template <bool or_equal>
+size_t
+KeySearch<Key, capacity>::rank(const Key * keys, size_t count,
+                               const Key & query) noexcept
+{
+	if constexpr (padded) {
+		// The padding never compares smaller than the query, but it may compare
+		// equal to it.
+		return std::min(count, rank_simd<or_equal>(keys, query));
+	} else {
+		if constexpr (or_equal) {
+			return static_cast<size_t>(std::upper_bound(keys, keys + count, query) -
+			                           keys);
+		} else {
+			return static_cast<size_t>(std::lower_bound(keys, keys + count, query) -
+			                           keys);
+		}
+	}
+}
+
+template <class Key, size_t capacity>
+template <bool or_equal>
+size_t
+KeySearch<Key, capacity>::rank_simd(const Key * keys,
+                                    const Key & query) noexcept
+{
+	// Counts the keys greater than (if or_equal is set) resp. smaller than the
+	// query. The SIMD compare instructions are signed, so unsigned keys get
+	// their sign bit flipped.
+	constexpr size_t simd_end = capacity - (capacity % simd_width);
+	size_t hits = 0;
+
+#if defined(__SSE2__)
+	constexpr bool flip = std::is_unsigned<Key>::value;
+	if constexpr (sizeof(Key) == 8) {
+		constexpr long long flip_mask =
+		    flip ? std::numeric_limits<long long>::min() : 0;
+#if defined(__AVX2__)
+		const __m256i flip_vec = _mm256_set1_epi64x(flip_mask);
+		const __m256i q =
+		    _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(query)),
+		                     flip_vec);
+		for (size_t i = 0; i < simd_end; i += 4) {
+			const __m256i v = _mm256_xor_si256(
+			    _mm256_load_si256(reinterpret_cast<const __m256i *>(keys + i)),
+			    flip_vec);
+			const __m256i cmp =
+			    or_equal ? _mm256_cmpgt_epi64(v, q) : _mm256_cmpgt_epi64(q, v);
+			hits += static_cast<size_t>(__builtin_popcount(static_cast<unsigned int>(
+			    _mm256_movemask_pd(_mm256_castsi256_pd(cmp)))));
+		}
+#elif defined(__SSE4_2__)
+		const __m128i flip_vec = _mm_set1_epi64x(flip_mask);
+		const __m128i q = _mm_xor_si128(
+		    _mm_set1_epi64x(static_cast<long long>(query)), flip_vec);
+		for (size_t i = 0; i < simd_end; i += 2) {
+			const __m128i v = _mm_xor_si128(
+			    _mm_load_si128(reinterpret_cast<const __m128i *>(keys + i)),
+			    flip_vec);
+			const __m128i cmp =
+			    or_equal ? _mm_cmpgt_epi64(v, q) : _mm_cmpgt_epi64(q, v);
+			hits += static_cast<size_t>(__builtin_popcount(static_cast<unsigned int>(
+			    _mm_movemask_pd(_mm_castsi128_pd(cmp)))));
+		}
+#endif
+	} else if constexpr (sizeof(Key) == 4) {
+		constexpr int flip_mask = flip ? std::numeric_limits<int>::min() : 0;
+#if defined(__AVX2__)
+		const __m256i flip_vec = _mm256_set1_epi32(flip_mask);
+		const __m256i q = _mm256_xor_si256(
+		    _mm256_set1_epi32(static_cast<int>(query)), flip_vec);
+		for (size_t i = 0; i < simd_end; i += 8) {
+			const __m256i v = _mm256_xor_si256(
+			    _mm256_load_si256(reinterpret_cast<const __m256i *>(keys + i)),
+			    flip_vec);
+			const __m256i cmp =
+			    or_equal ? _mm256_cmpgt_epi32(v, q) : _mm256_cmpgt_epi32(q, v);
+			hits += static_cast<size_t>(__builtin_popcount(static_cast<unsigned int>(
+			    _mm256_movemask_ps(_mm256_castsi256_ps(cmp)))));
+		}
+#else
+		const __m128i flip_vec = _mm_set1_epi32(flip_mask);
+		const __m128i q =
+		    _mm_xor_si128(_mm_set1_epi32(static_cast<int>(query)), flip_vec);
+		for (size_t i = 0; i < simd_end; i += 4) {
+			const __m128i v = _mm_xor_si128(
+			    _mm_load_si128(reinterpret_cast<const __m128i *>(keys + i)),
+			    flip_vec);
+			const __m128i cmp =
+			    or_equal ? _mm_cmpgt_epi32(v, q) : _mm_cmpgt_epi32(q, v);
+			hits += static_cast<size_t>(__builtin_popcount(static_cast<unsigned int>(
+			    _mm_movemask_ps(_mm_castsi128_ps(cmp)))));
+		}
+#endif
+	}
+#endif
+
+	// Scalar remainder, if the page size is not a multiple of the SIMD width
+	for (size_t i = simd_end; i < capacity; ++i) {
+		if constexpr (or_equal) {
+			hits += (query < keys[i]) ? 1 : 0;
+		} else {
+			hits += (keys[i] < query) ? 1 : 0;
+		}
+	}
+
+	if constexpr (or_equal) {
+		return capacity - hits;
+	} else {
+		return hits;
+	}
+}
+
+/*
+ * Pages
+ */
+template <class Key, size_t capacity>
+PageBase<Key, capacity>::PageBase(bool leaf_in) noexcept
+    : count(0), leaf(leaf_in)
+{
+	if constexpr (KeySearch<Key, capacity>::padded) {
+		std::fill(this->keys, this->keys + capacity,
+		          KeySearch<Key, capacity>::sentinel());
+	}
+}
+
+template <class Node, class Key, size_t capacity>
+LeafPage<Node, Key, capacity>::LeafPage() noexcept
+    : PageBase<Key, capacity>(true), next(nullptr)
+{}
+
+template <class Key, size_t capacity>
+InnerPage<Key, capacity>::InnerPage() noexcept
+    : PageBase<Key, capacity>(false)
+{}
+
+} // namespace btree_index_internal
+
+/*
+ * Iterators
+ */
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+    is_const>::IteratorBase(const Leaf * leaf_in, size_t index_in)
+    : leaf(leaf_in), index(index_in)
+{}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+    is_const>::IteratorBase(const IteratorBase<false> & other)
+    : leaf(other.leaf), index(other.index)
+{}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+typename IntrusiveBTreeIndex<Node, KeyGetter,
+                             Options>::template IteratorBase<is_const>::reference
+    IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+        is_const>::operator*() const
+{
+	return *this->leaf->nodes[this->index];
+}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+typename IntrusiveBTreeIndex<Node, KeyGetter,
+                             Options>::template IteratorBase<is_const>::pointer
+    IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+        is_const>::operator->() const
+{
+	return this->leaf->nodes[this->index];
+}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+typename IntrusiveBTreeIndex<Node, KeyGetter,
+                             Options>::template IteratorBase<is_const> &
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+    is_const>::operator++()
+{
+	this->index++;
+	if (this->index == this->leaf->count) {
+		this->leaf = this->leaf->next;
+		this->index = 0;
+	}
+	return *this;
+}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+typename IntrusiveBTreeIndex<Node, KeyGetter,
+                             Options>::template IteratorBase<is_const>
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+    is_const>::operator++(int)
+{
+	IteratorBase cpy = *this;
+	++(*this);
+	return cpy;
+}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+bool
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+    is_const>::operator==(const IteratorBase & other) const
+{
+	return (this->leaf == other.leaf) && (this->index == other.index);
+}
+
+template <class Node, class KeyGetter, class Options>
+template <bool is_const>
+bool
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IteratorBase<
+    is_const>::operator!=(const IteratorBase & other) const
+{
+	return !(*this == other);
+}
+
+/*
+ * IntrusiveBTreeIndex
+ */
+template <class Node, class KeyGetter, class Options>
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IntrusiveBTreeIndex() noexcept
+    : root(nullptr), element_count(0)
+{}
+
+template <class Node, class KeyGetter, class Options>
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::IntrusiveBTreeIndex(
+    MyClass && other) noexcept
+    : root(other.root), element_count(other.element_count)
+{
+	other.root = nullptr;
+	other.element_count = 0;
+}
+
+template <class Node, class KeyGetter, class Options>
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::~IntrusiveBTreeIndex()
+{
+	this->clear();
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::insert(Node & node)
+{
+	const Key key = KeyGetter::get_key(node);
+
+	if (__builtin_expect(this->root == nullptr, false)) {
+		this->root = new Leaf();
+	}
+
+	Key separator = Key();
+	Page * new_sibling = this->insert_into(this->root, node, key, separator);
+	if (new_sibling != nullptr) {
+		// The root was split. Grow by one level.
+		Inner * new_root = new Inner();
+		new_root->keys[0] = separator;
+		new_root->children[0] = this->root;
+		new_root->children[1] = new_sibling;
+		new_root->count = 1;
+		this->root = new_root;
+	}
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::Page *
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::insert_into(Page * page,
+                                                           Node & node,
+                                                           const Key & key,
+                                                           Key & separator)
+{
+	// Insert behind all equal keys
+	const size_t pos =
+	    Search::template rank<true>(page->keys, page->count, key);
+
+	if (page->leaf) {
+		Leaf * leaf = static_cast<Leaf *>(page);
+		if constexpr (!Options::multiple) {
+			if ((pos > 0) && !(leaf->keys[pos - 1] < key)) {
+				// Duplicate
+				return nullptr;
+			}
+		}
+		this->element_count++;
+
+		if (leaf->count < page_keys) {
+			std::move_backward(leaf->keys + pos, leaf->keys + leaf->count,
+			                   leaf->keys + leaf->count + 1);
+			std::move_backward(leaf->nodes + pos, leaf->nodes + leaf->count,
+			                   leaf->nodes + leaf->count + 1);
+			leaf->keys[pos] = key;
+			leaf->nodes[pos] = &node;
+			leaf->count++;
+			return nullptr;
+		}
+
+		// Split the leaf. The left half keeps (page_keys + 1) / 2 entries.
+		Key all_keys[page_keys + 1];
+		Node * all_nodes[page_keys + 1];
+		std::copy(leaf->keys, leaf->keys + pos, all_keys);
+		std::copy(leaf->nodes, leaf->nodes + pos, all_nodes);
+		all_keys[pos] = key;
+		all_nodes[pos] = &node;
+		std::copy(leaf->keys + pos, leaf->keys + page_keys, all_keys + pos + 1);
+		std::copy(leaf->nodes + pos, leaf->nodes + page_keys, all_nodes + pos + 1);
+
+		constexpr size_t left_count = (page_keys + 1) / 2;
+		Leaf * right = new Leaf();
+		std::copy(all_keys, all_keys + left_count, leaf->keys);
+		std::copy(all_nodes, all_nodes + left_count, leaf->nodes);
+		leaf->count = left_count;
+		std::copy(all_keys + left_count, all_keys + page_keys + 1, right->keys);
+		std::copy(all_nodes + left_count, all_nodes + page_keys + 1,
+		          right->nodes);
+		right->count = page_keys + 1 - left_count;
+		pad_keys(leaf);
+
+		right->next = leaf->next;
+		leaf->next = right;
+
+		separator = right->keys[0];
+		return right;
+	}
+
+	Inner * inner = static_cast<Inner *>(page);
+	Key child_separator = Key();
+	Page * new_child =
+	    this->insert_into(inner->children[pos], node, key, child_separator);
+	if (new_child == nullptr) {
+		return nullptr;
+	}
+
+	if (inner->count < page_keys) {
+		std::move_backward(inner->keys + pos, inner->keys + inner->count,
+		                   inner->keys + inner->count + 1);
+		std::move_backward(inner->children + pos + 1,
+		                   inner->children + inner->count + 1,
+		                   inner->children + inner->count + 2);
+		inner->keys[pos] = child_separator;
+		inner->children[pos + 1] = new_child;
+		inner->count++;
+		return nullptr;
+	}
+
+	// Split the inner page. The middle key moves up into the parent.
+	Key all_keys[page_keys + 1];
+	Page * all_children[page_keys + 2];
+	std::copy(inner->keys, inner->keys + pos, all_keys);
+	all_keys[pos] = child_separator;
+	std::copy(inner->keys + pos, inner->keys + page_keys, all_keys + pos + 1);
+	std::copy(inner->children, inner->children + pos + 1, all_children);
+	all_children[pos + 1] = new_child;
+	std::copy(inner->children + pos + 1, inner->children + page_keys + 1,
+	          all_children + pos + 2);
+
+	constexpr size_t left_count = (page_keys + 1) / 2;
+	Inner * right = new Inner();
+	std::copy(all_keys, all_keys + left_count, inner->keys);
+	std::copy(all_children, all_children + left_count + 1, inner->children);
+	inner->count = left_count;
+	separator = all_keys[left_count];
+	std::copy(all_keys + left_count + 1, all_keys + page_keys + 1, right->keys);
+	std::copy(all_children + left_count + 1, all_children + page_keys + 2,
+	          right->children);
+	right->count = page_keys - left_count;
+	pad_keys(inner);
+
+	return right;
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::remove(Node & node)
+{
+	assert(this->root != nullptr);
+
+	const Key key = KeyGetter::get_key(node);
+	[[maybe_unused]] bool found = this->remove_from(this->root, node, key);
+	assert(found);
+
+	if (this->root->count == 0) {
+		// Shrink by one level
+		if (this->root->leaf) {
+			delete static_cast<Leaf *>(this->root);
+			this->root = nullptr;
+		} else {
+			Inner * old_root = static_cast<Inner *>(this->root);
+			this->root = old_root->children[0];
+			delete old_root;
+		}
+	}
+}
+
+template <class Node, class KeyGetter, class Options>
+bool
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::remove_from(
+    Page * page, Node & node, const Key & key) noexcept
+{
+	const size_t first =
+	    Search::template rank<false>(page->keys, page->count, key);
+
+	if (page->leaf) {
+		Leaf * leaf = static_cast<Leaf *>(page);
+		for (size_t i = first; (i < leaf->count) && !(key < leaf->keys[i]); ++i) {
+			if (leaf->nodes[i] == &node) {
+				std::move(leaf->keys + i + 1, leaf->keys + leaf->count,
+				          leaf->keys + i);
+				std::move(leaf->nodes + i + 1, leaf->nodes + leaf->count,
+				          leaf->nodes + i);
+				leaf->count--;
+				pad_keys(leaf);
+				this->element_count--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// With MULTIPLE, nodes with the same key may be spread over several
+	// children. Try all of them.
+	Inner * inner = static_cast<Inner *>(page);
+	const size_t last =
+	    Search::template rank<true>(page->keys, page->count, key);
+
+	for (size_t child = first; child <= last; ++child) {
+		if (this->remove_from(inner->children[child], node, key)) {
+			if (inner->children[child]->count < min_keys) {
+				this->fix_underflow(inner, child);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::fix_underflow(
+    Inner * parent, size_t child) noexcept
+{
+	if ((child > 0) && (parent->children[child - 1]->count > min_keys)) {
+		this->borrow_from_left(parent, child);
+	} else if ((child < parent->count) &&
+	           (parent->children[child + 1]->count > min_keys)) {
+		this->borrow_from_right(parent, child);
+	} else if (child > 0) {
+		this->merge(parent, child - 1);
+	} else {
+		this->merge(parent, child);
+	}
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::borrow_from_left(
+    Inner * parent, size_t child) noexcept
+{
+	Page * page = parent->children[child];
+	Page * left = parent->children[child - 1];
+
+	std::move_backward(page->keys, page->keys + page->count,
+	                   page->keys + page->count + 1);
+
+	if (page->leaf) {
+		Leaf * leaf = static_cast<Leaf *>(page);
+		Leaf * left_leaf = static_cast<Leaf *>(left);
+		std::move_backward(leaf->nodes, leaf->nodes + leaf->count,
+		                   leaf->nodes + leaf->count + 1);
+		leaf->keys[0] = left_leaf->keys[left_leaf->count - 1];
+		leaf->nodes[0] = left_leaf->nodes[left_leaf->count - 1];
+		parent->keys[child - 1] = leaf->keys[0];
+	} else {
+		Inner * inner = static_cast<Inner *>(page);
+		Inner * left_inner = static_cast<Inner *>(left);
+		std::move_backward(inner->children, inner->children + inner->count + 1,
+		                   inner->children + inner->count + 2);
+		inner->keys[0] = parent->keys[child - 1];
+		inner->children[0] = left_inner->children[left_inner->count];
+		parent->keys[child - 1] = left_inner->keys[left_inner->count - 1];
+	}
+
+	page->count++;
+	left->count--;
+	pad_keys(left);
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::borrow_from_right(
+    Inner * parent, size_t child) noexcept
+{
+	Page * page = parent->children[child];
+	Page * right = parent->children[child + 1];
+
+	if (page->leaf) {
+		Leaf * leaf = static_cast<Leaf *>(page);
+		Leaf * right_leaf = static_cast<Leaf *>(right);
+		leaf->keys[leaf->count] = right_leaf->keys[0];
+		leaf->nodes[leaf->count] = right_leaf->nodes[0];
+		std::move(right_leaf->nodes + 1, right_leaf->nodes + right_leaf->count,
+		          right_leaf->nodes);
+		std::move(right_leaf->keys + 1, right_leaf->keys + right_leaf->count,
+		          right_leaf->keys);
+		parent->keys[child] = right_leaf->keys[0];
+	} else {
+		Inner * inner = static_cast<Inner *>(page);
+		Inner * right_inner = static_cast<Inner *>(right);
+		inner->keys[inner->count] = parent->keys[child];
+		inner->children[inner->count + 1] = right_inner->children[0];
+		parent->keys[child] = right_inner->keys[0];
+		std::move(right_inner->keys + 1, right_inner->keys + right_inner->count,
+		          right_inner->keys);
+		std::move(right_inner->children + 1,
+		          right_inner->children + right_inner->count + 1,
+		          right_inner->children);
+	}
+
+	page->count++;
+	right->count--;
+	pad_keys(right);
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::merge(Inner * parent,
+                                                     size_t left) noexcept
+{
+	Page * page = parent->children[left];
+	Page * right = parent->children[left + 1];
+
+	if (page->leaf) {
+		Leaf * leaf = static_cast<Leaf *>(page);
+		Leaf * right_leaf = static_cast<Leaf *>(right);
+		std::copy(right_leaf->keys, right_leaf->keys + right_leaf->count,
+		          leaf->keys + leaf->count);
+		std::copy(right_leaf->nodes, right_leaf->nodes + right_leaf->count,
+		          leaf->nodes + leaf->count);
+		leaf->count += right_leaf->count;
+		leaf->next = right_leaf->next;
+	} else {
+		Inner * inner = static_cast<Inner *>(page);
+		Inner * right_inner = static_cast<Inner *>(right);
+		inner->keys[inner->count] = parent->keys[left];
+		std::copy(right_inner->keys, right_inner->keys + right_inner->count,
+		          inner->keys + inner->count + 1);
+		std::copy(right_inner->children,
+		          right_inner->children + right_inner->count + 1,
+		          inner->children + inner->count + 1);
+		inner->count += right_inner->count + 1;
+	}
+
+	// The children (if any) of <right> now belong to <page>
+	if (right->leaf) {
+		delete static_cast<Leaf *>(right);
+	} else {
+		delete static_cast<Inner *>(right);
+	}
+
+	std::move(parent->keys + left + 1, parent->keys + parent->count,
+	          parent->keys + left);
+	std::move(parent->children + left + 2, parent->children + parent->count + 1,
+	          parent->children + left + 1);
+	parent->count--;
+	pad_keys(parent);
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::pad_keys(Page * page) noexcept
+{
+	if constexpr (Search::padded) {
+		std::fill(page->keys + page->count, page->keys + page_keys,
+		          Search::sentinel());
+	} else {
+		(void)page;
+	}
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::free_page(Page * page) noexcept
+{
+	if (page->leaf) {
+		delete static_cast<Leaf *>(page);
+	} else {
+		Inner * inner = static_cast<Inner *>(page);
+		for (size_t i = 0; i <= inner->count; ++i) {
+			free_page(inner->children[i]);
+		}
+		delete inner;
+	}
+}
+
+template <class Node, class KeyGetter, class Options>
+template <bool or_equal>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::search(
+    const Key & key) const noexcept
+{
+	if (this->root == nullptr) {
+		return this->end();
+	}
+
+	const Page * page = this->root;
+	while (!page->leaf) {
+		const size_t child =
+		    Search::template rank<or_equal>(page->keys, page->count, key);
+		page = static_cast<const Inner *>(page)->children[child];
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(page);
+			__builtin_prefetch(reinterpret_cast<const char *>(page) + 64);
+		}
+	}
+
+	const Leaf * leaf = static_cast<const Leaf *>(page);
+	const size_t index =
+	    Search::template rank<or_equal>(leaf->keys, leaf->count, key);
+	if (index == leaf->count) {
+		// All keys in this leaf are smaller. Non-root leaves are never empty.
+		return const_iterator(leaf->next, 0);
+	}
+	return const_iterator(leaf, index);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::find(const Key & key) noexcept
+{
+	const_iterator it = this->template search<false>(key);
+	if ((it.leaf == nullptr) || (key < it.leaf->keys[it.index])) {
+		return this->end();
+	}
+	return iterator(it.leaf, it.index);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::find(
+    const Key & key) const noexcept
+{
+	const_iterator it = this->template search<false>(key);
+	if ((it.leaf == nullptr) || (key < it.leaf->keys[it.index])) {
+		return this->end();
+	}
+	return it;
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::lower_bound(
+    const Key & key) noexcept
+{
+	const_iterator it = this->template search<false>(key);
+	return iterator(it.leaf, it.index);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::lower_bound(
+    const Key & key) const noexcept
+{
+	return this->template search<false>(key);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::upper_bound(
+    const Key & key) noexcept
+{
+	const_iterator it = this->template search<true>(key);
+	return iterator(it.leaf, it.index);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::upper_bound(
+    const Key & key) const noexcept
+{
+	return this->template search<true>(key);
+}
+
+template <class Node, class KeyGetter, class Options>
+const typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::Leaf *
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::get_first_leaf() const noexcept
+{
+	if (this->root == nullptr) {
+		return nullptr;
+	}
+
+	const Page * page = this->root;
+	while (!page->leaf) {
+		page = static_cast<const Inner *>(page)->children[0];
+	}
+	return static_cast<const Leaf *>(page);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::begin() noexcept
+{
+	return iterator(this->get_first_leaf(), 0);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::begin() const noexcept
+{
+	return const_iterator(this->get_first_leaf(), 0);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::cbegin() const noexcept
+{
+	return this->begin();
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::end() noexcept
+{
+	return iterator(nullptr, 0);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::end() const noexcept
+{
+	return const_iterator(nullptr, 0);
+}
+
+template <class Node, class KeyGetter, class Options>
+typename IntrusiveBTreeIndex<Node, KeyGetter, Options>::const_iterator
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::cend() const noexcept
+{
+	return this->end();
+}
+
+template <class Node, class KeyGetter, class Options>
+size_t
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::size() const noexcept
+{
+	return this->element_count;
+}
+
+template <class Node, class KeyGetter, class Options>
+bool
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::empty() const noexcept
+{
+	return this->element_count == 0;
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::clear() noexcept
+{
+	if (this->root != nullptr) {
+		free_page(this->root);
+	}
+	this->root = nullptr;
+	this->element_count = 0;
+}
+
+template <class Node, class KeyGetter, class Options>
+size_t
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::get_height() const noexcept
+{
+	size_t height = 0;
+	for (const Page * page = this->root; page != nullptr;
+	     page = page->leaf ? nullptr
+	                       : static_cast<const Inner *>(page)->children[0]) {
+		height++;
+	}
+	return height;
+}
+
+template <class Node, class KeyGetter, class Options>
+bool
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::verify_integrity() const
+{
+	try {
+		this->dbg_verify();
+	} catch (debug::VerifyException & e) {
+		return false;
+	}
+
+	return true;
+}
+
+template <class Node, class KeyGetter, class Options>
+void
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::dbg_verify() const
+{
+	using debug::yggassert;
+
+	if (this->root == nullptr) {
+		yggassert(this->element_count == 0);
+		return;
+	}
+
+	this->dbg_verify_page(this->root, nullptr, nullptr, true);
+
+	// The leaves must be chained in order and contain all nodes
+	size_t count = 0;
+	const Leaf * last_leaf = nullptr;
+	for (const Leaf * leaf = this->get_first_leaf(); leaf != nullptr;
+	     leaf = leaf->next) {
+		if (last_leaf != nullptr) {
+			yggassert(!(leaf->keys[0] < last_leaf->keys[last_leaf->count - 1]));
+		}
+		count += leaf->count;
+		last_leaf = leaf;
+	}
+	yggassert(count == this->element_count);
+}
+
+template <class Node, class KeyGetter, class Options>
+size_t
+IntrusiveBTreeIndex<Node, KeyGetter, Options>::dbg_verify_page(
+    const Page * page, const Key * lower, const Key * upper, bool is_root) const
+{
+	using debug::yggassert;
+
+	yggassert(page->count <= page_keys);
+	if (!is_root) {
+		yggassert(page->count >= min_keys);
+	}
+
+	for (size_t i = 0; i < page->count; ++i) {
+		if (i > 0) {
+			yggassert(!(page->keys[i] < page->keys[i - 1]));
+			if constexpr (!Options::multiple) {
+				if (page->leaf) {
+					yggassert(page->keys[i - 1] < page->keys[i]);
+				}
+			}
+		}
+		if (lower != nullptr) {
+			yggassert(!(page->keys[i] < *lower));
+		}
+		if (upper != nullptr) {
+			yggassert(!(*upper < page->keys[i]));
+		}
+	}
+	if constexpr (Search::padded) {
+		for (size_t i = page->count; i < page_keys; ++i) {
+			yggassert(page->keys[i] == Search::sentinel());
+		}
+	}
+
+	if (page->leaf) {
+		const Leaf * leaf = static_cast<const Leaf *>(page);
+		for (size_t i = 0; i < leaf->count; ++i) {
+			yggassert(!(leaf->keys[i] < KeyGetter::get_key(*leaf->nodes[i])));
+			yggassert(!(KeyGetter::get_key(*leaf->nodes[i]) < leaf->keys[i]));
+		}
+		return 1;
+	}
+
+	const Inner * inner = static_cast<const Inner *>(page);
+	yggassert(page->count >= 1);
+	size_t height = 0;
+	for (size_t i = 0; i <= inner->count; ++i) {
+		const Key * child_lower = (i == 0) ? lower : &inner->keys[i - 1];
+		const Key * child_upper = (i == inner->count) ? upper : &inner->keys[i];
+		size_t child_height =
+		    this->dbg_verify_page(inner->children[i], child_lower, child_upper,
+		                          false);
+		if (i == 0) {
+			height = child_height;
+		}
+		// All leaves must be on the same level
+		yggassert(child_height == height);
+	}
+	return height + 1;
+}
+
+} // namespace ygg
+
+#endif // YGG_BTREE_INDEX_CPP
@@ -0,0 +1,329 @@
+#ifndef YGG_BTREE_INDEX_HPP
+#define YGG_BTREE_INDEX_HPP
+
+#include "debug.hpp"
+#include "options.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace ygg {
+namespace btree_index_internal {
+/// @cond INTERNAL
+
+/*
+ * Searching within a page. For 32- and 64-bit integer keys, all keys of a page
+ * are compared to the query using SIMD instructions (AVX2, or SSE2 / SSE4.2),
+ * which is branch-free and touches every cache line of the page exactly once.
+ * To make this work, unused key slots are padded with the largest possible
+ * key. All other key types are binary-searched.
+ */
+template <class Key, size_t capacity>
+class KeySearch {
+public:
+	static constexpr size_t simd_width =
+	    (std::is_integral<Key>::value && !std::is_same<Key, bool>::value)
+	        ?
+#if defined(__AVX2__)
+	        ((sizeof(Key) == 8) ? 4 : ((sizeof(Key) == 4) ? 8 : 0))
+#elif defined(__SSE4_2__)
+	        ((sizeof(Key) == 8) ? 2 : ((sizeof(Key) == 4) ? 4 : 0))
+#elif defined(__SSE2__)
+	        ((sizeof(Key) == 4) ? 4 : 0)
+#else
+	        0
+#endif
+	        : 0;
+	static constexpr bool padded = (simd_width > 0);
+
+	static Key sentinel() noexcept;
+
+	/*
+	 * Returns the number of keys among the first <count> keys that are smaller
+	 * than (or, if <or_equal> is set, smaller than or equal to) <query>.
+	 */
+	template <bool or_equal>
+	static size_t rank(const Key * keys, size_t count,
+	                   const Key & query) noexcept;
+
+private:
+	template <bool or_equal>
+	static size_t rank_simd(const Key * keys, const Key & query) noexcept;
+};
+
+template <class Key, size_t capacity>
+struct alignas(64) PageBase
+{
+	explicit PageBase(bool leaf_in) noexcept;
+
+	Key keys[capacity];
+	size_t count;
+	bool leaf;
+};
+
+template <class Node, class Key, size_t capacity>
+struct LeafPage : public PageBase<Key, capacity>
+{
+	LeafPage() noexcept;
+
+	Node * nodes[capacity];
+	LeafPage * next;
+};
+
+template <class Key, size_t capacity>
+struct InnerPage : public PageBase<Key, capacity>
+{
+	InnerPage() noexcept;
+
+	PageBase<Key, capacity> * children[capacity + 1];
+};
+
+/// @endcond
+} // namespace btree_index_internal
+
+/**
+ * @brief A B+-tree index over your (intrusive) nodes
+ *
+ * The IntrusiveBTreeIndex keeps the "bring your own node" model of the other
+ * data structures in this library: It never copies, moves or allocates your
+ * nodes. However, it does not link the nodes themselves. Instead, it allocates
+ * pages which store arrays of keys together with pointers to your nodes. A
+ * lookup therefore costs one or two cache misses per page (and there are only
+ * log_B(n) levels of pages for B keys per page), compared to one cache miss
+ * per binary level for e.g. the RBTree. For 32- and 64-bit integer keys, the
+ * keys of a page are searched using SIMD instructions if the target supports
+ * them (AVX2 or SSE), with a scalar fallback otherwise.
+ *
+ * The key of a node is copied into the index on insertion, thus the key of a
+ * node must not change while the node is in the index. Also, a node may not
+ * move in memory while it is in the index.
+ *
+ * Insertions and removals are not noexcept, since they may allocate pages.
+ *
+ * @tparam Node       The node class. It does not need to derive from anything.
+ * @tparam KeyGetter  A class that must implement a static Key get_key(const
+ * Node &) function that returns the key of a node. Keys are compared with
+ * operator<.
+ * @tparam Options    The TreeOptions class specifying the parameters of this
+ * index. MULTIPLE and TreeFlags::BTREE_PAGE_KEYS are honored.
+ */
+template <class Node, class KeyGetter, class Options = DefaultOptions>
+class IntrusiveBTreeIndex {
+public:
+	using MyClass = IntrusiveBTreeIndex<Node, KeyGetter, Options>;
+	using Key = std::decay_t<decltype(
+	    KeyGetter::get_key(std::declval<const Node &>()))>;
+
+	/**
+	 * @brief The number of keys per page
+	 *
+	 * By default, as many keys as fit into two cache lines. See
+	 * TreeFlags::BTREE_PAGE_KEYS.
+	 */
+	static constexpr size_t page_keys =
+	    (Options::btree_page_keys != 0)
+	        ? Options::btree_page_keys
+	        : ((128 / sizeof(Key) >= 4) ? (128 / sizeof(Key)) : 4);
+	static_assert(page_keys >= 4, "Pages must be able to hold at least 4 keys.");
+
+	/// @cond INTERNAL
+	template <bool is_const>
+	class IteratorBase {
+	public:
+		using difference_type = ptrdiff_t;
+		using value_type = Node;
+		using reference = std::conditional_t<is_const, const Node &, Node &>;
+		using pointer = std::conditional_t<is_const, const Node *, Node *>;
+		using iterator_category = std::forward_iterator_tag;
+
+		IteratorBase() = default;
+		// Allows conversion from iterator to const_iterator
+		IteratorBase(const IteratorBase<false> & other);
+
+		reference operator*() const;
+		pointer operator->() const;
+
+		IteratorBase & operator++();
+		IteratorBase operator++(int);
+
+		bool operator==(const IteratorBase & other) const;
+		bool operator!=(const IteratorBase & other) const;
+
+	private:
+		friend class IntrusiveBTreeIndex;
+		template <bool>
+		friend class IteratorBase;
+
+		using Leaf = btree_index_internal::LeafPage<Node, Key, page_keys>;
+
+		IteratorBase(const Leaf * leaf, size_t index);
+
+		const Leaf * leaf = nullptr;
+		size_t index = 0;
+	};
+	/// @endcond
+
+	using iterator = IteratorBase<false>;
+	using const_iterator = IteratorBase<true>;
+
+	/**
+	 * @brief Creates a new, empty index
+	 */
+	IntrusiveBTreeIndex() noexcept;
+
+	/**
+	 * @brief Creates a new index from a different index
+	 *
+	 * The other index is moved into this one and left empty.
+	 */
+	IntrusiveBTreeIndex(MyClass && other) noexcept;
+	~IntrusiveBTreeIndex();
+
+	IntrusiveBTreeIndex(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into the index
+	 *
+	 * If MULTIPLE is not set and a node with the same key is already in the
+	 * index, nothing happens.
+	 *
+	 * @param node The node to be inserted.
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the index
+	 *
+	 * The node must be in the index.
+	 *
+	 * @param node The node to be removed.
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Finds a node with the key <key>
+	 *
+	 * If MULTIPLE is set and several nodes have the key <key>, an iterator to
+	 * the first of them is returned.
+	 *
+	 * @param key  The key to search for
+	 * @return An iterator to the found node, or end() if no node has key <key>.
+	 */
+	iterator find(const Key & key) noexcept;
+	const_iterator find(const Key & key) const noexcept;
+
+	/**
+	 * @brief Returns an iterator to the first node with a key not smaller than
+	 * <key>, or end() if no such node exists.
+	 */
+	iterator lower_bound(const Key & key) noexcept;
+	const_iterator lower_bound(const Key & key) const noexcept;
+
+	/**
+	 * @brief Returns an iterator to the first node with a key greater than
+	 * <key>, or end() if no such node exists.
+	 */
+	iterator upper_bound(const Key & key) noexcept;
+	const_iterator upper_bound(const Key & key) const noexcept;
+
+	/**
+	 * @brief Returns an iterator to the node with the smallest key
+	 */
+	iterator begin() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+
+	/**
+	 * @brief Returns an iterator pointing after the last node
+	 */
+	iterator end() noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+
+	/**
+	 * @brief Returns the number of nodes in the index
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Returns whether the index is empty
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * @brief Removes all nodes from the index and frees all pages
+	 */
+	void clear() noexcept;
+
+	/**
+	 * @brief Returns the number of page levels, i.e., the number of pages a
+	 * lookup visits. Zero if the index is empty.
+	 */
+	size_t get_height() const noexcept;
+
+	// Mainly debugging methods
+	/// @cond INTERNAL
+	void dbg_verify() const;
+	bool verify_integrity() const;
+	/// @endcond
+
+private:
+	using Page = btree_index_internal::PageBase<Key, page_keys>;
+	using Leaf = btree_index_internal::LeafPage<Node, Key, page_keys>;
+	using Inner = btree_index_internal::InnerPage<Key, page_keys>;
+	using Search = btree_index_internal::KeySearch<Key, page_keys>;
+
+	// Every page except for the root must hold at least this many keys
+	static constexpr size_t min_keys = page_keys / 2;
+
+	template <bool or_equal>
+	const_iterator search(const Key & key) const noexcept;
+
+	/*
+	 * Inserts <node> into the subtree below <page>. If <page> had to be split,
+	 * the new right sibling is returned, and <separator> is set to the smallest
+	 * key in it. Otherwise, nullptr is returned.
+	 */
+	Page * insert_into(Page * page, Node & node, const Key & key,
+	                   Key & separator);
+
+	// Returns whether <node> was found (and removed) below <page>
+	bool remove_from(Page * page, Node & node, const Key & key) noexcept;
+
+	/*
+	 * Repairs the underfull child <child> of <parent> by borrowing a key from a
+	 * sibling or by merging it with a sibling.
+	 */
+	void fix_underflow(Inner * parent, size_t child) noexcept;
+	void borrow_from_left(Inner * parent, size_t child) noexcept;
+	void borrow_from_right(Inner * parent, size_t child) noexcept;
+	// Merges parent's child <left> + 1 into child <left>
+	void merge(Inner * parent, size_t left) noexcept;
+
+	// Restores the padding after the used keys of <page>
+	static void pad_keys(Page * page) noexcept;
+	static void free_page(Page * page) noexcept;
+	const Leaf * get_first_leaf() const noexcept;
+
+	size_t dbg_verify_page(const Page * page, const Key * lower,
+	                       const Key * upper, bool is_root) const;
+
+	Page * root;
+	size_t element_count;
+};
+
+} // namespace ygg
+
+#ifndef YGG_BTREE_INDEX_CPP
+#include "btree_index.cpp"
+#endif
+
+#endif // YGG_BTREE_INDEX_HPP
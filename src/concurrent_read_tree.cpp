@@ -0,0 +1,282 @@
+#ifndef YGG_CONCURRENT_READ_TREE_CPP
+#define YGG_CONCURRENT_READ_TREE_CPP
+
+#include "concurrent_read_tree.hpp"
+
+#include <algorithm>
+
+namespace ygg {
+
+namespace concurrent_read_internal {
+// @cond INTERNAL
+
+inline EpochManager::EpochManager() noexcept : epoch(0)
+{
+	for (auto & parity : this->slots) {
+		for (auto & slot : parity) {
+			slot.count.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+inline size_t
+EpochManager::enter() const noexcept
+{
+	size_t slot = utilities::get_thread_index() % SLOTS;
+	while (true) {
+		uint64_t e = this->epoch.load();
+		size_t parity = static_cast<size_t>(e & 1);
+		this->slots[parity][slot].count.fetch_add(1);
+		// If the epoch was advanced in the meantime, the advancing thread might
+		// not have seen us. Register with the new epoch instead.
+		if (this->epoch.load() == e) {
+			return parity * SLOTS + slot;
+		}
+		this->slots[parity][slot].count.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+inline void
+EpochManager::leave(size_t token) const noexcept
+{
+	this->slots[token / SLOTS][token % SLOTS].count.fetch_sub(
+	    1, std::memory_order_release);
+}
+
+inline uint64_t
+EpochManager::get_epoch() const noexcept
+{
+	return this->epoch.load();
+}
+
+inline bool
+EpochManager::parity_empty(size_t parity) const noexcept
+{
+	for (const auto & slot : this->slots[parity]) {
+		if (slot.count.load() != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+inline bool
+EpochManager::try_advance() noexcept
+{
+	uint64_t e = this->epoch.load();
+	// Readers of epoch e - 1 use the same counters as readers of epoch e + 1
+	// will. All of them must be gone before we can advance.
+	if (!this->parity_empty(static_cast<size_t>((e + 1) & 1))) {
+		return false;
+	}
+	this->epoch.store(e + 1);
+	return true;
+}
+
+inline void
+EpochManager::synchronize() noexcept
+{
+	uint64_t target = this->epoch.load() + 2;
+	size_t spins = 0;
+	while (this->epoch.load() < target) {
+		if (!this->try_advance()) {
+			if (++spins < 64) {
+				utilities::cpu_relax();
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+
+inline EpochGuard::EpochGuard(const EpochManager & em_in) noexcept
+    : em(em_in), token(em_in.enter())
+{}
+
+inline EpochGuard::~EpochGuard() noexcept { this->em.leave(this->token); }
+
+inline SequenceWriteGuard::SequenceWriteGuard(
+    std::atomic<uint64_t> & seq_in) noexcept
+    : seq(seq_in)
+{
+	// Only ever called by the writer holding the lock, so no RMW is necessary
+	this->seq.store(this->seq.load(std::memory_order_relaxed) + 1,
+	                std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline SequenceWriteGuard::~SequenceWriteGuard() noexcept
+{
+	this->seq.store(this->seq.load(std::memory_order_relaxed) + 1,
+	                std::memory_order_release);
+}
+
+// @endcond
+} // namespace concurrent_read_internal
+
+template <class Tree>
+ConcurrentReadTree<Tree>::ConcurrentReadTree() : t(), seq(0)
+{}
+
+template <class Tree>
+template <class Func>
+decltype(auto)
+ConcurrentReadTree<Tree>::write(Func && func)
+{
+	std::lock_guard<std::mutex> lock(this->write_mutex);
+	concurrent_read_internal::SequenceWriteGuard guard(this->seq);
+	return func(this->t);
+}
+
+template <class Tree>
+void
+ConcurrentReadTree<Tree>::insert(Node & node)
+{
+	this->write([&](Tree & tree) { tree.insert(node); });
+}
+
+template <class Tree>
+void
+ConcurrentReadTree<Tree>::remove(Node & node)
+{
+	this->write([&](Tree & tree) { tree.remove(node); });
+}
+
+template <class Tree>
+void
+ConcurrentReadTree<Tree>::retire(Node & node)
+{
+	this->remove(node);
+
+	// Readers that started before the node was unlinked are registered with the
+	// current (or the previous) epoch.
+	std::lock_guard<std::mutex> lock(this->reclaim_mutex);
+	this->retired.emplace_back(&node, this->em.get_epoch());
+}
+
+template <class Tree>
+template <class Callback>
+size_t
+ConcurrentReadTree<Tree>::reclaim(Callback && callback)
+{
+	std::lock_guard<std::mutex> lock(this->reclaim_mutex);
+	this->em.try_advance();
+	uint64_t e = this->em.get_epoch();
+
+	auto safe_end = std::partition(
+	    this->retired.begin(), this->retired.end(),
+	    [&](const std::pair<Node *, uint64_t> & entry) {
+		    return entry.second + 2 <= e;
+	    });
+	size_t count = static_cast<size_t>(safe_end - this->retired.begin());
+	for (auto it = this->retired.begin(); it != safe_end; ++it) {
+		callback(*it->first);
+	}
+	this->retired.erase(this->retired.begin(), safe_end);
+
+	return count;
+}
+
+template <class Tree>
+void
+ConcurrentReadTree<Tree>::synchronize()
+{
+	std::lock_guard<std::mutex> lock(this->reclaim_mutex);
+	this->em.synchronize();
+}
+
+template <class Tree>
+template <class Func>
+auto
+ConcurrentReadTree<Tree>::read(Func && func) const
+{
+	concurrent_read_internal::EpochGuard guard(this->em);
+
+	while (true) {
+		uint64_t before = this->seq.load(std::memory_order_acquire);
+		if ((before & 1) != 0) {
+			// A writer is active
+			utilities::cpu_relax();
+			continue;
+		}
+
+		auto result = func(static_cast<const Tree &>(this->t));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (this->seq.load(std::memory_order_relaxed) == before) {
+			return result;
+		}
+	}
+}
+
+template <class Tree>
+template <class Iterator>
+const typename ConcurrentReadTree<Tree>::Node *
+ConcurrentReadTree<Tree>::to_pointer(const Tree & tree, Iterator it)
+{
+	if (it == tree.end()) {
+		return nullptr;
+	}
+	return &*it;
+}
+
+template <class Tree>
+template <class Comparable>
+const typename ConcurrentReadTree<Tree>::Node *
+ConcurrentReadTree<Tree>::find(const Comparable & query) const
+{
+	return this->read(
+	    [&](const Tree & tree) { return to_pointer(tree, tree.find(query)); });
+}
+
+template <class Tree>
+template <class Comparable>
+const typename ConcurrentReadTree<Tree>::Node *
+ConcurrentReadTree<Tree>::lower_bound(const Comparable & query) const
+{
+	return this->read([&](const Tree & tree) {
+		return to_pointer(tree, tree.lower_bound(query));
+	});
+}
+
+template <class Tree>
+template <class Comparable>
+const typename ConcurrentReadTree<Tree>::Node *
+ConcurrentReadTree<Tree>::upper_bound(const Comparable & query) const
+{
+	return this->read([&](const Tree & tree) {
+		return to_pointer(tree, tree.upper_bound(query));
+	});
+}
+
+template <class Tree>
+size_t
+ConcurrentReadTree<Tree>::size() const
+{
+	return this->read([](const Tree & tree) { return tree.size(); });
+}
+
+template <class Tree>
+bool
+ConcurrentReadTree<Tree>::empty() const
+{
+	return this->read([](const Tree & tree) { return tree.empty(); });
+}
+
+template <class Tree>
+Tree &
+ConcurrentReadTree<Tree>::get_tree() noexcept
+{
+	return this->t;
+}
+
+template <class Tree>
+void
+ConcurrentReadTree<Tree>::dbg_verify() const
+{
+	this->t.dbg_verify();
+}
+
+} // namespace ygg
+
+#endif // YGG_CONCURRENT_READ_TREE_CPP
@@ -0,0 +1,300 @@
+#ifndef YGG_CONCURRENT_READ_TREE_HPP
+#define YGG_CONCURRENT_READ_TREE_HPP
+
+#include "options.hpp"
+#include "util.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ygg {
+
+namespace concurrent_read_internal {
+/// @cond INTERNAL
+
+/*
+ * Epoch-based reclamation for optimistic readers.
+ *
+ * Readers register themselves with the epoch that is current when they start.
+ * The epoch is only advanced once all readers of the previous epoch have left.
+ * Thus, readers can only ever belong to the current or the previous epoch, and
+ * something that was unlinked in epoch e cannot be seen by any reader anymore
+ * as soon as the epoch has reached e + 2.
+ *
+ * Readers are counted per epoch parity in a couple of per-cache-line slots,
+ * into which threads are hashed. Entering and leaving are thus uncontended
+ * atomic increments unless there are a lot of threads.
+ */
+class EpochManager {
+public:
+	static constexpr size_t SLOTS = 32;
+
+	EpochManager() noexcept;
+
+	// Returns the slot-and-parity token that must be passed to leave()
+	size_t enter() const noexcept;
+	void leave(size_t token) const noexcept;
+
+	uint64_t get_epoch() const noexcept;
+
+	// Must be called by one thread at a time
+	bool try_advance() noexcept;
+	void synchronize() noexcept;
+
+private:
+	struct alignas(64) Slot
+	{
+		std::atomic<size_t> count;
+	};
+
+	bool parity_empty(size_t parity) const noexcept;
+
+	std::atomic<uint64_t> epoch;
+	mutable Slot slots[2][SLOTS];
+};
+
+/*
+ * RAII helper to be registered with an EpochManager while reading
+ */
+class EpochGuard {
+public:
+	EpochGuard(const EpochManager & em) noexcept;
+	~EpochGuard() noexcept;
+
+	EpochGuard(const EpochGuard & other) = delete;
+	EpochGuard & operator=(const EpochGuard & other) = delete;
+
+private:
+	const EpochManager & em;
+	size_t token;
+};
+
+/*
+ * RAII helper to keep a sequence counter odd while writing
+ */
+class SequenceWriteGuard {
+public:
+	SequenceWriteGuard(std::atomic<uint64_t> & seq) noexcept;
+	~SequenceWriteGuard() noexcept;
+
+	SequenceWriteGuard(const SequenceWriteGuard & other) = delete;
+	SequenceWriteGuard & operator=(const SequenceWriteGuard & other) = delete;
+
+private:
+	std::atomic<uint64_t> & seq;
+};
+
+template <class Tree>
+using tree_node_t = std::remove_const_t<
+    std::remove_reference_t<decltype(*std::declval<Tree &>().begin())>>;
+
+/// @endcond
+} // namespace concurrent_read_internal
+
+/**
+ * @brief Makes a tree usable from one writer and many optimistic readers
+ *
+ * This class wraps any of the trees (RBTree, WBTree, ZTree, EnergyTree, …) and
+ * makes it accessible concurrently from many threads, with a focus on
+ * read-mostly workloads.
+ *
+ * Writers (insert(), remove(), write(), …) are serialized by a mutex. While
+ * modifying the tree, the writer holds a sequence counter at an odd value.
+ * Readers (find(), lower_bound(), upper_bound(), read(), …) never write to any
+ * shared cache line except for a per-thread-slot epoch counter. They run the
+ * search on the tree optimistically and afterwards check whether the sequence
+ * counter changed. If it did, the result is discarded and the search is
+ * repeated. With few writes, a lookup thus costs barely more than the lookup
+ * on the bare tree.
+ *
+ * Since readers might walk over a node while it is being removed, removed
+ * nodes must not be destroyed or reused right away. Either call synchronize()
+ * after removing nodes (which waits until no reader can see them anymore), or
+ * use retire() instead of remove() and periodically call reclaim(), which
+ * hands you back all retired nodes that have become safe to reuse without
+ * waiting.
+ *
+ * @warning Optimistic readers read the tree's links while the writer might be
+ * changing them. Just like TreeFlags::COMPRESS_COLOR, this is technically not
+ * standard compliant, but works on all common platforms. All your comparison
+ * functions must be able to deal with being called on nodes that have just
+ * been removed from the tree (but not yet reclaimed). In other words, do not
+ * modify a node's key until it has been reclaimed.
+ *
+ * @tparam Tree   The tree to be wrapped, e.g., an RBTree.
+ */
+template <class Tree>
+class ConcurrentReadTree {
+public:
+	using Node = concurrent_read_internal::tree_node_t<Tree>;
+	using MyClass = ConcurrentReadTree<Tree>;
+
+	/**
+	 * @brief Constructs a new concurrent wrapper around an empty tree
+	 */
+	ConcurrentReadTree();
+
+	// Trees that are shared between threads may not move.
+	ConcurrentReadTree(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * Waits for other writers, but not for readers.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * Waits for other writers, but not for readers. Concurrent readers may
+	 * still look at the node after this returns. Call synchronize() before
+	 * destroying or reusing the node.
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree and defers its reclamation
+	 *
+	 * Like remove(), but additionally remembers the node as retired. Once no
+	 * reader can see the node anymore, reclaim() hands it back to you.
+	 *
+	 * @param node The node to be retired
+	 */
+	void retire(Node & node);
+
+	/**
+	 * @brief Hands back retired nodes that have become safe to reuse
+	 *
+	 * Calls <callback> (with a Node & as argument) for every retired node that
+	 * no reader can see anymore. Never waits for readers.
+	 *
+	 * @param callback  The callback to be called for every reclaimed node
+	 * @return The number of reclaimed nodes
+	 */
+	template <class Callback>
+	size_t reclaim(Callback && callback);
+
+	/**
+	 * @brief Waits until all readers that might have seen removed nodes are done
+	 *
+	 * After this returns, all nodes that have been removed before calling it
+	 * can be destroyed or reused.
+	 */
+	void synchronize();
+
+	/**
+	 * @brief Performs an arbitrary modification on the tree
+	 *
+	 * Calls <func> with a reference to the wrapped tree while holding the
+	 * write lock. Use this for everything that is not covered by insert() and
+	 * remove(), e.g. hinted insertion.
+	 *
+	 * @param func  The function to be called with the tree
+	 * @return Whatever <func> returns
+	 */
+	template <class Func>
+	decltype(auto) write(Func && func);
+
+	/**
+	 * @brief Finds an element in the tree
+	 *
+	 * Never blocks (but might retry). See Tree::find() for the semantics.
+	 *
+	 * @param query An object comparing equally to the element that should be
+	 * found.
+	 * @return A pointer to the found node or nullptr if no such node exists.
+	 */
+	template <class Comparable>
+	const Node * find(const Comparable & query) const;
+
+	/**
+	 * @brief Lower-bounds an element
+	 *
+	 * Never blocks (but might retry). See Tree::lower_bound() for the semantics.
+	 *
+	 * @param query An object comparable to Node that should be lower-bounded
+	 * @return A pointer to the found node or nullptr if no such node exists.
+	 */
+	template <class Comparable>
+	const Node * lower_bound(const Comparable & query) const;
+
+	/**
+	 * @brief Upper-bounds an element
+	 *
+	 * Never blocks (but might retry). See Tree::upper_bound() for the semantics.
+	 *
+	 * @param query An object comparable to Node that should be upper-bounded
+	 * @return A pointer to the found node or nullptr if no such node exists.
+	 */
+	template <class Comparable>
+	const Node * upper_bound(const Comparable & query) const;
+
+	/**
+	 * @brief Returns the number of elements in the tree
+	 *
+	 * Only available if the wrapped tree offers size().
+	 */
+	size_t size() const;
+
+	/**
+	 * @brief Returns whether the tree is empty
+	 */
+	bool empty() const;
+
+	/**
+	 * @brief Performs an arbitrary read-only operation on the tree
+	 *
+	 * Calls <func> with a const reference to the wrapped tree, optimistically.
+	 * If the tree was modified concurrently, the result is thrown away and
+	 * <func> is called again. Thus, <func> must not have any side effects and
+	 * must not assume that the tree is consistent while it runs (it must not,
+	 * e.g., iterate until it finds a certain node).
+	 *
+	 * @param func  The function to be called with the tree
+	 * @return Whatever <func> returned in its last (validated) call
+	 */
+	template <class Func>
+	auto read(Func && func) const;
+
+	/**
+	 * @brief Returns the wrapped tree
+	 *
+	 * @warning Accessing the tree via this reference is not synchronized at
+	 * all. Use only when no other thread is using the tree.
+	 */
+	Tree & get_tree() noexcept;
+
+	// Debugging methods. These must not be called concurrently with anything.
+	void dbg_verify() const;
+
+private:
+	template <class Iterator>
+	static const Node * to_pointer(const Tree & tree, Iterator it);
+
+	Tree t;
+
+	std::atomic<uint64_t> seq;
+	std::mutex write_mutex;
+
+	concurrent_read_internal::EpochManager em;
+	std::mutex reclaim_mutex;
+	std::vector<std::pair<Node *, uint64_t>> retired;
+};
+
+} // namespace ygg
+
+#ifndef YGG_CONCURRENT_READ_TREE_CPP
+#include "concurrent_read_tree.cpp"
+#endif
+
+#endif // YGG_CONCURRENT_READ_TREE_HPP
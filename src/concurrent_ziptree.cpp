@@ -0,0 +1,532 @@
+#ifndef YGG_CONCURRENT_ZIPTREE_CPP
+#define YGG_CONCURRENT_ZIPTREE_CPP
+
+#include "concurrent_ziptree.hpp"
+
+#include <cassert>
+#include <thread>
+
+namespace ygg {
+
+namespace concurrent_ztree_internal {
+// @cond INTERNAL
+
+template <class Node>
+Link<Node>::Link() noexcept : version(0), locked(false)
+{
+	this->children[0].store(nullptr, std::memory_order_relaxed);
+	this->children[1].store(nullptr, std::memory_order_relaxed);
+}
+
+template <class Node>
+Link<Node>::Link(const Link<Node> & other) noexcept : Link()
+{
+	(void)other;
+}
+
+template <class Node>
+Link<Node> &
+Link<Node>::operator=(const Link<Node> & other) noexcept
+{
+	(void)other;
+	return *this;
+}
+
+template <class Node>
+void
+Link<Node>::lock() noexcept
+{
+	size_t spins = 0;
+	while (this->locked.exchange(true, std::memory_order_acquire)) {
+		// Spin on a load to not bounce the cache line around
+		while (this->locked.load(std::memory_order_relaxed)) {
+			if (++spins < 64) {
+				utilities::cpu_relax();
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+
+template <class Node>
+void
+Link<Node>::unlock() noexcept
+{
+	this->locked.store(false, std::memory_order_release);
+}
+
+template <class Node>
+bool
+Link<Node>::dbg_is_locked() const noexcept
+{
+	return this->locked.load(std::memory_order_relaxed);
+}
+
+template <class Node>
+void
+Link<Node>::begin_modification() noexcept
+{
+	// Only ever called by the writer holding the lock, so no RMW is necessary
+	uint64_t v = this->version.load(std::memory_order_relaxed);
+	if (Link<Node>::is_stable(v)) {
+		this->version.store(v + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+}
+
+template <class Node>
+void
+Link<Node>::end_modification() noexcept
+{
+	uint64_t v = this->version.load(std::memory_order_relaxed);
+	assert(!Link<Node>::is_stable(v));
+	this->version.store(v + 1, std::memory_order_release);
+}
+
+template <class Node>
+uint64_t
+Link<Node>::read_version() const noexcept
+{
+	return this->version.load(std::memory_order_acquire);
+}
+
+template <class Node>
+bool
+Link<Node>::validate(uint64_t v) const noexcept
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return this->version.load(std::memory_order_relaxed) == v;
+}
+
+template <class Node>
+Node *
+Link<Node>::get_child(size_t dir) const noexcept
+{
+	return this->children[dir].load(std::memory_order_relaxed);
+}
+
+template <class Node>
+void
+Link<Node>::set_child(size_t dir, Node * child) noexcept
+{
+	this->children[dir].store(child, std::memory_order_relaxed);
+}
+
+// @endcond
+} // namespace concurrent_ztree_internal
+
+template <class Node, class Options, class Tag>
+auto
+ConcurrentZTreeNodeBase<Node, Options, Tag>::dbg_get_rank() const noexcept
+{
+	return RankGenerator::get_rank(*(static_cast<const Node *>(this)));
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::ConcurrentZTree() noexcept
+    : s(0)
+{}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+typename ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::Link &
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::link(
+    Node * n) noexcept
+{
+	return n->NB::_czt_link;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+const typename ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::Link &
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::link(
+    const Node * n) noexcept
+{
+	return n->NB::_czt_link;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+void
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::release(
+    Node * n) noexcept
+{
+	link(n).end_modification();
+	link(n).unlock();
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+void
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::insert(
+    Node & node) noexcept
+{
+	const auto node_rank = RankGetter::get_rank(node);
+
+	// The new node must look "under construction" to readers until it has
+	// received its final children.
+	link(&node).set_child(0, nullptr);
+	link(&node).set_child(1, nullptr);
+	link(&node).begin_modification();
+
+	// Find the link below which the node is placed, locking hand-over-hand.
+	Link * parent = &this->head;
+	size_t dir = 0;
+	parent->lock();
+	Node * cur = parent->get_child(dir);
+
+	// The rank order allows ties on both sides, so on a tie the new node goes
+	// below the existing one, just like in ZTree::insert().
+	while ((cur != nullptr) && (RankGetter::get_rank(*cur) >= node_rank)) {
+		link(cur).lock();
+		parent->unlock();
+
+		parent = &link(cur);
+		dir = this->cmp(*cur, node) ? 1 : 0;
+		cur = parent->get_child(dir);
+	}
+
+	// We keep the parent locked until we're done. Thus, no other writer can
+	// enter the part of the tree we're modifying. Writers that are already in
+	// there are ahead of us, and unzip() waits for them.
+	parent->begin_modification();
+	parent->set_child(dir, &node);
+
+	if (cur != nullptr) {
+		this->unzip(cur, node);
+	}
+
+	link(&node).end_modification();
+	parent->end_modification();
+	parent->unlock();
+
+	if constexpr (Options::constant_time_size) {
+		this->s.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+void
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::unzip(
+    Node * cur, Node & newn) noexcept
+{
+	// The heads of the spines stay locked until their last pointer has been
+	// written. Writers that are ahead of us therefore can never observe a
+	// half-unzipped spine.
+	Node * left_head = &newn;
+	Node * right_head = &newn;
+
+	while (cur != nullptr) {
+		link(cur).lock();
+		link(cur).begin_modification();
+
+		if (this->cmp(newn, *cur)) {
+			// Add to the right spine
+			if (__builtin_expect((right_head != &newn), 1)) {
+				link(right_head).set_child(0, cur);
+				release(right_head);
+			} else {
+				link(right_head).set_child(1, cur);
+			}
+
+			right_head = cur;
+			cur = link(cur).get_child(0);
+		} else {
+			// Add to the left spine
+			if (__builtin_expect((left_head != &newn), 1)) {
+				link(left_head).set_child(1, cur);
+				release(left_head);
+			} else {
+				link(left_head).set_child(0, cur);
+			}
+
+			left_head = cur;
+			cur = link(cur).get_child(1);
+		}
+	}
+
+	// End of the spines
+	if (left_head != &newn) {
+		link(left_head).set_child(1, nullptr);
+		release(left_head);
+	}
+
+	if (right_head != &newn) {
+		link(right_head).set_child(0, nullptr);
+		release(right_head);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+bool
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::remove(Node & node)
+    CMP_NOEXCEPT(node)
+{
+	// Find the parent of the node, locking hand-over-hand.
+	Link * parent = &this->head;
+	size_t dir = 0;
+	parent->lock();
+	Node * cur = parent->get_child(dir);
+
+	while (cur != &node) {
+		if (cur == nullptr) {
+			// Node is not in the tree, e.g. because another thread removed it.
+			parent->unlock();
+			return false;
+		}
+
+		link(cur).lock();
+		parent->unlock();
+
+		parent = &link(cur);
+		dir = this->cmp(*cur, node) ? 1 : 0;
+		cur = parent->get_child(dir);
+	}
+
+	link(&node).lock();
+	parent->begin_modification();
+	link(&node).begin_modification();
+
+	this->zip(*parent, dir, node);
+
+	// Readers that still look at the node will fail to validate it.
+	link(&node).set_child(0, nullptr);
+	link(&node).set_child(1, nullptr);
+	release(&node);
+
+	parent->end_modification();
+	parent->unlock();
+
+	if constexpr (Options::constant_time_size) {
+		this->s.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	return true;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+void
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::zip(
+    Link & parent, size_t dir, Node & old_root) noexcept
+{
+	Node * left_head = link(&old_root).get_child(0);
+	Node * right_head = link(&old_root).get_child(1);
+
+	// The link (and direction) where the next node of the zipped path goes, and
+	// the node owning that link (nullptr for the parent, which is released by
+	// the caller)
+	Link * attach = &parent;
+	size_t attach_dir = dir;
+	Node * attach_owner = nullptr;
+
+	// On rank ties, the right head goes up, just like in ZTree::zip(). Since
+	// ties are allowed on both sides, the rank order is kept either way.
+	while ((left_head != nullptr) && (right_head != nullptr)) {
+		Node * next;
+		bool from_left;
+		if (RankGetter::get_rank(*left_head) > RankGetter::get_rank(*right_head)) {
+			// Use left
+			next = left_head;
+			link(next).lock();
+			link(next).begin_modification();
+			left_head = link(next).get_child(1);
+			from_left = true;
+		} else {
+			// Use right
+			next = right_head;
+			link(next).lock();
+			link(next).begin_modification();
+			right_head = link(next).get_child(0);
+			from_left = false;
+		}
+
+		attach->set_child(attach_dir, next);
+		if (attach_owner != nullptr) {
+			release(attach_owner);
+		}
+
+		// A node from the left continues to the right and vice versa
+		attach_owner = next;
+		attach = &link(next);
+		attach_dir = from_left ? 1 : 0;
+	}
+
+	// One of both heads has become nullptr, the other tree might still be
+	// non-empty. We must re-hang this one completely.
+	if (left_head != nullptr) {
+		attach->set_child(attach_dir, left_head);
+	} else {
+		attach->set_child(attach_dir, right_head);
+	}
+
+	if (attach_owner != nullptr) {
+		release(attach_owner);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+template <class Comparable>
+Node *
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::find(
+    const Comparable & query) const CMP_NOEXCEPT(query)
+{
+	// Every step validates the version of the current node after having read
+	// the version of its child. Thus, as long as the version of a node is
+	// unchanged, the node is in the tree and the query lies within the key range
+	// of the node's subtree. Nodes change their version whenever this could
+	// stop being the case.
+	//
+	// A writer keeps the versions of the nodes it changes unstable only while
+	// it zips or unzips, which is short. We therefore retry instead of
+	// waiting, but yield after a while in case the writer has been preempted.
+	for (size_t retries = 0;; ++retries) {
+		if (retries >= 64) {
+			std::this_thread::yield();
+		} else if (retries > 0) {
+			utilities::cpu_relax();
+		}
+
+		const Link * parent = &this->head;
+		uint64_t parent_version = parent->read_version();
+		Node * cur = parent->get_child(0);
+		bool restart = !Link::is_stable(parent_version);
+
+		while (!restart && (cur != nullptr)) {
+			const Link & cur_link = link(cur);
+			uint64_t cur_version = cur_link.read_version();
+			if (!Link::is_stable(cur_version) ||
+			    !parent->validate(parent_version)) {
+				restart = true;
+				break;
+			}
+
+			size_t dir;
+			if (this->cmp(query, *cur)) {
+				dir = 0;
+			} else if (this->cmp(*cur, query)) {
+				dir = 1;
+			} else {
+				if (cur_link.validate(cur_version)) {
+					return cur;
+				}
+				restart = true;
+				break;
+			}
+
+			Node * next = cur_link.get_child(dir);
+			parent = &cur_link;
+			parent_version = cur_version;
+			cur = next;
+		}
+
+		// Reaching nullptr is only valid if the last node did not change.
+		if (!restart && parent->validate(parent_version)) {
+			return nullptr;
+		}
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+size_t
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::size() const noexcept
+{
+	static_assert(Options::constant_time_size,
+	              "size() requires CONSTANT_TIME_SIZE to be set.");
+	return this->s.load(std::memory_order_relaxed);
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+bool
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::empty() const noexcept
+{
+	return this->head.get_child(0) == nullptr;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+size_t
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::dbg_count() const
+    noexcept
+{
+	size_t count = 0;
+	std::vector<const Node *> stack;
+	if (this->head.get_child(0) != nullptr) {
+		stack.push_back(this->head.get_child(0));
+	}
+
+	while (!stack.empty()) {
+		const Node * n = stack.back();
+		stack.pop_back();
+		count++;
+
+		for (size_t dir = 0; dir < 2; ++dir) {
+			if (link(n).get_child(dir) != nullptr) {
+				stack.push_back(link(n).get_child(dir));
+			}
+		}
+	}
+
+	return count;
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+void
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::dbg_verify() const
+{
+	assert(!this->head.dbg_is_locked());
+	assert(Link::is_stable(this->head.read_version()));
+
+	this->dbg_verify_consistency(this->head.get_child(0), nullptr, nullptr);
+
+	if constexpr (Options::constant_time_size) {
+		assert(this->size() == this->dbg_count());
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare,
+          class RankGetter>
+void
+ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>::
+    dbg_verify_consistency(const Node * sub_root, const Node * lower_bound_node,
+                           const Node * upper_bound_node) const
+{
+	if (sub_root == nullptr) {
+		return;
+	}
+
+	assert(!link(sub_root).dbg_is_locked());
+	assert(Link::is_stable(link(sub_root).read_version()));
+
+	if (lower_bound_node != nullptr) {
+		assert(this->cmp(*lower_bound_node, *sub_root));
+	}
+	if (upper_bound_node != nullptr) {
+		assert(this->cmp(*sub_root, *upper_bound_node));
+	}
+
+	const Node * left = link(sub_root).get_child(0);
+	const Node * right = link(sub_root).get_child(1);
+
+	if (left != nullptr) {
+		assert(RankGetter::get_rank(*left) <= RankGetter::get_rank(*sub_root));
+		this->dbg_verify_consistency(left, lower_bound_node, sub_root);
+	}
+
+	if (right != nullptr) {
+		assert(RankGetter::get_rank(*right) <= RankGetter::get_rank(*sub_root));
+		this->dbg_verify_consistency(right, sub_root, upper_bound_node);
+	}
+}
+
+} // namespace ygg
+
+#endif // YGG_CONCURRENT_ZIPTREE_CPP
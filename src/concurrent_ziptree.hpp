@@ -0,0 +1,294 @@
+#ifndef YGG_CONCURRENT_ZIPTREE_H
+#define YGG_CONCURRENT_ZIPTREE_H
+
+#include "options.hpp"
+#include "util.hpp"
+#include "ziptree.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace ygg {
+
+// Forwards
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class ConcurrentZTreeNodeBase;
+
+namespace concurrent_ztree_internal {
+/// @cond INTERNAL
+
+/*
+ * The synchronization state of a single link in a ConcurrentZTree, i.e., of a
+ * node or of the tree's root pointer.
+ *
+ * Writers lock links hand-over-hand. The version of a link is odd while a
+ * writer is modifying the link, i.e., changing its children or moving it
+ * around in the tree. Readers never lock, but validate the versions of the
+ * links they traverse.
+ */
+template <class Node>
+class Link {
+public:
+	Link() noexcept;
+	// Copying a node does not copy its position in a tree.
+	Link(const Link<Node> & other) noexcept;
+	Link<Node> & operator=(const Link<Node> & other) noexcept;
+
+	void lock() noexcept;
+	void unlock() noexcept;
+	bool dbg_is_locked() const noexcept;
+
+	void begin_modification() noexcept;
+	void end_modification() noexcept;
+
+	uint64_t read_version() const noexcept;
+	bool validate(uint64_t version) const noexcept;
+	static bool
+	is_stable(uint64_t version) noexcept
+	{
+		return (version & 1) == 0;
+	}
+
+	Node * get_child(size_t dir) const noexcept;
+	void set_child(size_t dir, Node * child) noexcept;
+
+private:
+	std::atomic<Node *> children[2];
+	std::atomic<uint64_t> version;
+	std::atomic<bool> locked;
+};
+
+/// @endcond
+} // namespace concurrent_ztree_internal
+
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the Concurrent Zip Tree *must* derive from
+ * this class (template). It supplies your class with the necessary members to
+ * contain the linking between the tree nodes.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam Options  The options class (a version of TreeOptions) that you
+ * parameterize the tree with. (See the options parameter of ConcurrentZTree.)
+ * @tparam Tag 		The tag used to identify the tree that this node should
+ * be inserted into. See ConcurrentZTree for details.
+ */
+template <class Node, class Options, class Tag>
+class ConcurrentZTreeNodeBase {
+public:
+	// Debugging methods
+	auto dbg_get_rank() const noexcept;
+
+protected:
+	/**
+	 * @brief Update the stored rank in this node
+	 *
+	 * See ZTreeNodeBase::update_rank(). The same rules apply.
+	 */
+	void
+	update_rank() noexcept
+	{
+		RankGenerator::update_rank(*static_cast<Node *>(this));
+	}
+
+private:
+	template <class, class, class, class, class>
+	friend class ConcurrentZTree;
+	template <class, class, bool, bool>
+	friend class ztree_internal::ZTreeRankGenerator;
+
+	using RankGenerator =
+	    ztree_internal::ZTreeRankGenerator<Node, Options, Options::ztree_use_hash,
+	                                       Options::ztree_store_rank>;
+
+	concurrent_ztree_internal::Link<Node> _czt_link;
+	RankGenerator _zt_rank;
+};
+
+/**
+ * @brief A Zip Tree that can be used by many threads at the same time
+ *
+ * This is a variant of the Zip Tree (see ZTree) that allows to call insert(),
+ * remove() and find() from many threads concurrently, without any external
+ * synchronization.
+ *
+ * Insertions and removals (the "writers") only lock the nodes they work on.
+ * They descend from the root, locking nodes hand-over-hand, and then keep
+ * locked the (single) node below which they unzip resp. zip, plus the nodes
+ * along the unzipping resp. zipping path. Thus, writers working on different
+ * parts of the tree do not interfere. Since the ranks of the nodes are
+ * geometrically distributed, almost all unzipping / zipping happens close to
+ * the leaves.
+ *
+ * Searches (the "readers") never lock anything and never write to shared
+ * memory. Every node carries a version counter, which writers increment when
+ * they start and when they finish changing the node's children or position.
+ * Readers descend optimistically and validate the versions of the nodes they
+ * pass. If a reader detects a concurrent modification, it restarts its search.
+ * Thus, readers never wait for a lock, but a reader may have to retry until a
+ * writer working on its search path has finished zipping resp. unzipping.
+ *
+ * @warning A removed node may still be looked at by searches that were running
+ * concurrently to its removal. You must not destroy, modify or re-insert a
+ * removed node until all calls to find() that have been running while
+ * remove() was called have returned.
+ *
+ * @warning The tree does not support multiple nodes comparing equally. Setting
+ * TreeFlags::MULTIPLE is an error.
+ *
+ * Apart from that, the Concurrent Zip Tree behaves like the Zip Tree. It
+ * supports the same rank options (except for TreeFlags::ZTREE_COMPRESS_RANK)
+ * and the same RankGetter mechanism. Since concurrently maintaining
+ * augmented data is not possible, there are no NodeTraits. Iteration is
+ * not supported.
+ *
+ * @tparam Node         The node class for this tree. It must be derived from
+ * ConcurrentZTreeNodeBase.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this tree. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies
+ * this tree. Can be used to insert the same nodes into multiple trees. Can be
+ * any class, the class can be empty.
+ * @tparam Compare      A compare class. The Zip Tree follows STL
+ * semantics for 'Compare'. Defaults to ygg::utilities::flexible_less. Implement
+ * operator<(const Node & lhs, const Node & rhs) if you want to use it.
+ * @tparam RankGetter   A class that must implement a static size_t
+ * get_rank(const Node &) function that returns the rank of a node. See ZTree.
+ */
+template <
+    class Node, class Options = DefaultOptions, class Tag = int,
+    class Compare = ygg::utilities::flexible_less,
+    class RankGetter = ztree_internal::ZTreeRankGenerator<
+        Node, Options, Options::ztree_use_hash, Options::ztree_store_rank>>
+class ConcurrentZTree {
+public:
+	using NB = ConcurrentZTreeNodeBase<Node, Options, Tag>;
+	using MyClass = ConcurrentZTree<Node, Options, Tag, Compare, RankGetter>;
+
+	/**********************************************
+	 * Sanity Checks                              *
+	 **********************************************/
+	static_assert(std::is_base_of<NB, Node>::value,
+	              "Node class not properly derived from node base!");
+	static_assert(
+	    Options::ztree_store_rank || Options::ztree_use_hash,
+	    "ZipTrees need to have either ZTREE_RANK_TYPE or ZTREE_USE_HASH set");
+	static_assert(!Options::ztree_compress_rank,
+	              "The concurrent Zip Tree does not support compressed ranks.");
+	static_assert(!Options::multiple,
+	              "The concurrent Zip Tree does not support MULTIPLE.");
+
+	/**
+	 * @brief Construct a new empty Concurrent Zip Tree.
+	 */
+	ConcurrentZTree() noexcept;
+
+	// Trees that are shared between threads may not move.
+	ConcurrentZTree(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * Inserts <node> into the tree. May be called concurrently to all other
+	 * methods except for the debugging methods.
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param   node  The node to be inserted.
+	 */
+	void insert(Node & node) noexcept;
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * Removes <node> from the tree. May be called concurrently to all other
+	 * methods except for the debugging methods. See the class documentation for
+	 * when <node> may be reused.
+	 *
+	 * If <node> is not in the tree (e.g. because another thread has removed it
+	 * already), nothing happens.
+	 *
+	 * @param   node  The node to be removed.
+	 * @return true if <node> was removed, false if it was not in the tree
+	 */
+	bool remove(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Finds an element in the tree
+	 *
+	 * Returns a pointer to the element that compares equally to <query>. Note
+	 * that <query> does not have to be a Node, but can be anything that can be
+	 * compared to a Node (see BinarySearchTree::find()).
+	 *
+	 * This never locks anything and may be called concurrently to all other
+	 * methods except for the debugging methods. The result reflects the state
+	 * of the tree at some point in time during the call.
+	 *
+	 * Note that this is not wait-free: if a writer is currently changing a node
+	 * on the search path, the search is retried until the writer is done with
+	 * that node.
+	 *
+	 * @param query An object comparing equally to the element that should be
+	 * found.
+	 * @returns A pointer to the element comparing equally to <query>, or nullptr
+	 * if no such element exists
+	 */
+	template <class Comparable>
+	Node * find(const Comparable & query) const CMP_NOEXCEPT(query);
+
+	/**
+	 * @brief Returns the number of elements in the tree
+	 *
+	 * Only available if TreeFlags::CONSTANT_TIME_SIZE is set. If called
+	 * concurrently with insertions or removals, any value between the sizes
+	 * before and after these operations may be returned.
+	 *
+	 * @return The number of elements in the tree
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Returns whether the tree is empty
+	 *
+	 * @return true if the tree is empty, false otherwise
+	 */
+	bool empty() const noexcept;
+
+	// Debugging methods. These must not be called concurrently with anything.
+	void dbg_verify() const;
+	size_t dbg_count() const noexcept;
+
+private:
+	using Link = concurrent_ztree_internal::Link<Node>;
+
+	static Link & link(Node * n) noexcept;
+	static const Link & link(const Node * n) noexcept;
+	static void release(Node * n) noexcept;
+
+	void unzip(Node * cur, Node & newn) noexcept;
+	void zip(Link & parent, size_t dir, Node & old_root) noexcept;
+
+	// Debugging methods
+	void dbg_verify_consistency(const Node * sub_root,
+	                            const Node * lower_bound_node,
+	                            const Node * upper_bound_node) const;
+
+	Link head;
+	Compare cmp;
+	std::atomic<size_t> s;
+};
+
+} // namespace ygg
+
+#ifndef YGG_CONCURRENT_ZIPTREE_CPP
+#include "concurrent_ziptree.cpp"
+#endif
+
+#endif // YGG_CONCURRENT_ZIPTREE_H
@@ -0,0 +1,806 @@
+#ifndef YGG_CRITBIT_TREE_CPP
+#define YGG_CRITBIT_TREE_CPP
+
+#include "critbit_tree.hpp"
+
+#include <cassert>
+
+namespace ygg {
+namespace critbit_internal {
+
+/*
+ * KeyBits
+ */
+template <class Key>
+uint64_t
+KeyBits<Key, std::enable_if_t<std::is_integral<Key>::value>>::to_unsigned(
+    const Key & key) noexcept
+{
+	using Unsigned = std::make_unsigned_t<Key>;
+	uint64_t u = static_cast<Unsigned>(key);
+	if constexpr (std::is_signed<Key>::value) {
+		u ^= uint64_t(1) << (bits - 1);
+	}
+	return u;
+}
+
+template <class Key>
+bool
+KeyBits<Key, std::enable_if_t<std::is_integral<Key>::value>>::get_bit(
+    const Key & key, size_t bit) noexcept
+{
+	return ((to_unsigned(key) >> (bits - 1 - bit)) & 1) != 0;
+}
+
+template <class Key>
+size_t
+KeyBits<Key, std::enable_if_t<std::is_integral<Key>::value>>::critical_bit(
+    const Key & lhs, const Key & rhs) noexcept
+{
+	const uint64_t diff = to_unsigned(lhs) ^ to_unsigned(rhs);
+	if (diff == 0) {
+		return bits;
+	}
+	return static_cast<size_t>(__builtin_clzll(diff)) - (64 - bits);
+}
+
+template <size_t N>
+bool
+KeyBits<std::array<unsigned char, N>>::get_bit(
+    const std::array<unsigned char, N> & key, size_t bit) noexcept
+{
+	return ((key[bit / 8] >> (7 - (bit % 8))) & 1) != 0;
+}
+
+template <size_t N>
+size_t
+KeyBits<std::array<unsigned char, N>>::critical_bit(
+    const std::array<unsigned char, N> & lhs,
+    const std::array<unsigned char, N> & rhs) noexcept
+{
+	for (size_t i = 0; i < N; ++i) {
+		const unsigned int diff = static_cast<unsigned int>(lhs[i] ^ rhs[i]);
+		if (diff != 0) {
+			return i * 8 + static_cast<size_t>(__builtin_clz(diff)) -
+			       (sizeof(unsigned int) - 1) * 8;
+		}
+	}
+	return bits;
+}
+
+} // namespace critbit_internal
+
+/*
+ * Iterators
+ */
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+    is_const, reverse>::IteratorBase(const Node * n_in)
+    : n(n_in)
+{}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+    is_const, reverse>::IteratorBase(const IteratorBase<false, reverse> & other)
+    : n(other.n)
+{}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template IteratorBase<is_const, reverse>::reference
+    CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+        is_const, reverse>::operator*() const
+{
+	// Only const iterators can be created from const trees
+	return *const_cast<Node *>(this->n);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template IteratorBase<is_const, reverse>::pointer
+    CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+        is_const, reverse>::operator->() const
+{
+	return const_cast<Node *>(this->n);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template IteratorBase<is_const, reverse> &
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<is_const,
+                                                         reverse>::operator++()
+{
+	if constexpr (reverse) {
+		this->n = MyClass::get_previous(this->n);
+	} else {
+		this->n = MyClass::get_next(this->n);
+	}
+	return *this;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template IteratorBase<is_const, reverse>
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+    is_const, reverse>::operator++(int)
+{
+	IteratorBase cpy = *this;
+	++(*this);
+	return cpy;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template IteratorBase<is_const, reverse> &
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<is_const,
+                                                         reverse>::operator--()
+{
+	if constexpr (reverse) {
+		this->n = MyClass::get_next(this->n);
+	} else {
+		this->n = MyClass::get_previous(this->n);
+	}
+	return *this;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template IteratorBase<is_const, reverse>
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+    is_const, reverse>::operator--(int)
+{
+	IteratorBase cpy = *this;
+	--(*this);
+	return cpy;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+bool
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+    is_const, reverse>::operator==(const IteratorBase & other) const
+{
+	return this->n == other.n;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+template <bool is_const, bool reverse>
+bool
+CritBitTree<Node, KeyGetter, Options, Tag>::IteratorBase<
+    is_const, reverse>::operator!=(const IteratorBase & other) const
+{
+	return this->n != other.n;
+}
+
+/*
+ * CritBitTree
+ */
+template <class Node, class KeyGetter, class Options, class Tag>
+CritBitTree<Node, KeyGetter, Options, Tag>::CritBitTree() noexcept : root(0)
+{}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+CritBitTree<Node, KeyGetter, Options, Tag>::CritBitTree(
+    MyClass && other) noexcept
+    : root(other.root), s(other.s)
+{
+	other.root = 0;
+	other.s.set(0);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+uintptr_t
+CritBitTree<Node, KeyGetter, Options, Tag>::get_tiebreaker(
+    const Node & node) noexcept
+{
+	if constexpr (Options::multiple) {
+		return reinterpret_cast<uintptr_t>(&node);
+	} else {
+		(void)node;
+		return 0;
+	}
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+bool
+CritBitTree<Node, KeyGetter, Options, Tag>::get_bit(const Key & key,
+                                                    uintptr_t tiebreaker,
+                                                    size_t bit) noexcept
+{
+	if constexpr (Options::multiple) {
+		if (bit >= Bits::bits) {
+			return ((tiebreaker >> (total_bits - 1 - bit)) & 1) != 0;
+		}
+	} else {
+		(void)tiebreaker;
+	}
+	return Bits::get_bit(key, bit);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+size_t
+CritBitTree<Node, KeyGetter, Options, Tag>::critical_bit(
+    const Key & lhs, uintptr_t lhs_tiebreaker, const Key & rhs,
+    uintptr_t rhs_tiebreaker) noexcept
+{
+	const size_t bit = Bits::critical_bit(lhs, rhs);
+	if constexpr (Options::multiple) {
+		if (bit == Bits::bits) {
+			const uintptr_t diff = lhs_tiebreaker ^ rhs_tiebreaker;
+			if (diff == 0) {
+				return total_bits;
+			}
+			return Bits::bits + static_cast<size_t>(__builtin_clzll(diff));
+		}
+	} else {
+		(void)lhs_tiebreaker;
+		(void)rhs_tiebreaker;
+	}
+	return bit;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+bool
+CritBitTree<Node, KeyGetter, Options, Tag>::is_leaf(uintptr_t ref) noexcept
+{
+	return (ref & 1) != 0;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_leaf(uintptr_t ref) noexcept
+{
+	return static_cast<Node *>(
+	    reinterpret_cast<NB *>(ref & ~static_cast<uintptr_t>(1)));
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::Inner *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_inner(uintptr_t ref) noexcept
+{
+	return reinterpret_cast<Inner *>(ref);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+uintptr_t
+CritBitTree<Node, KeyGetter, Options, Tag>::leaf_ref(const Node * node) noexcept
+{
+	return reinterpret_cast<uintptr_t>(static_cast<const NB *>(node)) | 1;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+uintptr_t
+CritBitTree<Node, KeyGetter, Options, Tag>::inner_ref(
+    const Inner * inner) noexcept
+{
+	return reinterpret_cast<uintptr_t>(inner);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::Inner *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_parent(uintptr_t ref) noexcept
+{
+	if (is_leaf(ref)) {
+		return get_leaf(ref)->NB::leaf_parent;
+	} else {
+		return get_inner(ref)->parent;
+	}
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+void
+CritBitTree<Node, KeyGetter, Options, Tag>::set_parent(uintptr_t ref,
+                                                       Inner * parent) noexcept
+{
+	if (is_leaf(ref)) {
+		get_leaf(ref)->NB::leaf_parent = parent;
+	} else {
+		get_inner(ref)->parent = parent;
+	}
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+void
+CritBitTree<Node, KeyGetter, Options, Tag>::replace_child(
+    Inner * parent, uintptr_t old_child, uintptr_t new_child) noexcept
+{
+	if (parent == nullptr) {
+		this->root = new_child;
+	} else {
+		parent->children[parent->children[1] == old_child] = new_child;
+	}
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_leftmost(uintptr_t ref) noexcept
+{
+	while (!is_leaf(ref)) {
+		ref = get_inner(ref)->children[0];
+	}
+	return get_leaf(ref);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_rightmost(
+    uintptr_t ref) noexcept
+{
+	while (!is_leaf(ref)) {
+		ref = get_inner(ref)->children[1];
+	}
+	return get_leaf(ref);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+const Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_next(const Node * node) noexcept
+{
+	uintptr_t ref = leaf_ref(node);
+	Inner * parent = node->NB::leaf_parent;
+	// Go up until we come from a left child
+	while ((parent != nullptr) && (parent->children[1] == ref)) {
+		ref = inner_ref(parent);
+		parent = parent->parent;
+	}
+	if (parent == nullptr) {
+		return nullptr;
+	}
+	return get_leftmost(parent->children[1]);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+const Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::get_previous(
+    const Node * node) noexcept
+{
+	uintptr_t ref = leaf_ref(node);
+	Inner * parent = node->NB::leaf_parent;
+	// Go up until we come from a right child
+	while ((parent != nullptr) && (parent->children[0] == ref)) {
+		ref = inner_ref(parent);
+		parent = parent->parent;
+	}
+	if (parent == nullptr) {
+		return nullptr;
+	}
+	return get_rightmost(parent->children[0]);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::descend(
+    const Key & key, uintptr_t tiebreaker) const noexcept
+{
+	uintptr_t cur = this->root;
+	while (!is_leaf(cur)) {
+		const Inner * inner = get_inner(cur);
+		cur = inner->children[get_bit(key, tiebreaker, inner->bit)];
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(reinterpret_cast<const void *>(
+			    cur & ~static_cast<uintptr_t>(1)));
+		}
+	}
+	return get_leaf(cur);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+void
+CritBitTree<Node, KeyGetter, Options, Tag>::insert(Node & node) noexcept
+{
+	node.NB::leaf_parent = nullptr;
+	node.NB::inner.bit = Inner::UNUSED;
+
+	if (__builtin_expect(this->root == 0, false)) {
+		this->root = leaf_ref(&node);
+		this->s.add(1);
+		return;
+	}
+
+	const Key key = KeyGetter::get_key(node);
+	const uintptr_t tiebreaker = get_tiebreaker(node);
+
+	// The node reached by following the bits of <key> shares the longest
+	// common prefix with <key>.
+	const Node * closest = this->descend(key, tiebreaker);
+	const size_t bit = critical_bit(key, tiebreaker, KeyGetter::get_key(*closest),
+	                                get_tiebreaker(*closest));
+	if (bit == total_bits) {
+		// Same key already present
+		return;
+	}
+	const bool direction = get_bit(key, tiebreaker, bit);
+
+	// Find the place where the new inner node branching on <bit> belongs
+	Inner * parent = nullptr;
+	uintptr_t cur = this->root;
+	while (!is_leaf(cur) && (get_inner(cur)->bit < bit)) {
+		parent = get_inner(cur);
+		cur = parent->children[get_bit(key, tiebreaker, parent->bit)];
+	}
+
+	// Every node brings the storage for the inner node created when inserting
+	// it.
+	Inner * inner = &node.NB::inner;
+	inner->bit = bit;
+	inner->children[direction] = leaf_ref(&node);
+	inner->children[!direction] = cur;
+	inner->parent = parent;
+	node.NB::leaf_parent = inner;
+
+	set_parent(cur, inner);
+	this->replace_child(parent, cur, inner_ref(inner));
+
+	this->s.add(1);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+void
+CritBitTree<Node, KeyGetter, Options, Tag>::remove(Node & node) noexcept
+{
+	this->s.reduce(1);
+
+	Inner * own = &node.NB::inner;
+	Inner * parent = node.NB::leaf_parent;
+	if (parent == nullptr) {
+		// Node was the only node
+		this->root = 0;
+		return;
+	}
+
+	// Replace the parent by the sibling of node
+	const uintptr_t sibling =
+	    parent->children[parent->children[0] == leaf_ref(&node)];
+	Inner * grandparent = parent->parent;
+	this->replace_child(grandparent, inner_ref(parent), sibling);
+	set_parent(sibling, grandparent);
+
+	// The storage of the parent is now free. If the inner node stored in node
+	// is still in use, move it there.
+	if (own != parent) {
+		if (own->bit != Inner::UNUSED) {
+			*parent = *own;
+			this->replace_child(parent->parent, inner_ref(own), inner_ref(parent));
+			set_parent(parent->children[0], parent);
+			set_parent(parent->children[1], parent);
+		} else {
+			parent->bit = Inner::UNUSED;
+		}
+	}
+	own->bit = Inner::UNUSED;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::bound(
+    const Key & key, uintptr_t tiebreaker) const noexcept
+{
+	if (this->root == 0) {
+		return nullptr;
+	}
+
+	Node * closest = this->descend(key, tiebreaker);
+	const size_t bit = critical_bit(key, tiebreaker, KeyGetter::get_key(*closest),
+	                                get_tiebreaker(*closest));
+	if (bit == total_bits) {
+		return closest;
+	}
+
+	// All nodes below <cur> share the first <bit> bits with the query, and
+	// differ from it in bit <bit>.
+	uintptr_t cur = this->root;
+	while (!is_leaf(cur) && (get_inner(cur)->bit < bit)) {
+		const Inner * inner = get_inner(cur);
+		cur = inner->children[get_bit(key, tiebreaker, inner->bit)];
+	}
+
+	if (!get_bit(key, tiebreaker, bit)) {
+		// The query is smaller than everything below cur
+		return get_leftmost(cur);
+	}
+
+	// The query is larger than everything below cur.
+	Inner * parent = get_parent(cur);
+	while ((parent != nullptr) && (parent->children[1] == cur)) {
+		cur = inner_ref(parent);
+		parent = parent->parent;
+	}
+	if (parent == nullptr) {
+		return nullptr;
+	}
+	return get_leftmost(parent->children[1]);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::find(const Key & key) noexcept
+{
+	return iterator<false>(static_cast<const MyClass *>(this)->find(key).n);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::find(const Key & key) const noexcept
+{
+	if (this->root == 0) {
+		return this->end();
+	}
+
+	const Node * candidate;
+	if constexpr (Options::multiple) {
+		candidate = this->bound(key, 0);
+		if (candidate == nullptr) {
+			return this->end();
+		}
+	} else {
+		// Without duplicates, only the node on the path of key can match.
+		candidate = this->descend(key, 0);
+	}
+
+	if (Bits::critical_bit(key, KeyGetter::get_key(*candidate)) != Bits::bits) {
+		return this->end();
+	}
+	return const_iterator<false>(candidate);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::lower_bound(
+    const Key & key) noexcept
+{
+	return iterator<false>(this->bound(key, 0));
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::lower_bound(
+    const Key & key) const noexcept
+{
+	return const_iterator<false>(this->bound(key, 0));
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::upper_bound(
+    const Key & key) noexcept
+{
+	return iterator<false>(
+	    static_cast<const MyClass *>(this)->upper_bound(key).n);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::upper_bound(
+    const Key & key) const noexcept
+{
+	if constexpr (Options::multiple) {
+		// No node has the largest possible address
+		return const_iterator<false>(
+		    this->bound(key, std::numeric_limits<uintptr_t>::max()));
+	} else {
+		const Node * candidate = this->bound(key, 0);
+		if ((candidate != nullptr) &&
+		    (Bits::critical_bit(key, KeyGetter::get_key(*candidate)) ==
+		     Bits::bits)) {
+			candidate = get_next(candidate);
+		}
+		return const_iterator<false>(candidate);
+	}
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::begin() noexcept
+{
+	return iterator<false>(static_cast<const MyClass *>(this)->begin().n);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::begin() const noexcept
+{
+	if (this->root == 0) {
+		return this->end();
+	}
+	return const_iterator<false>(get_leftmost(this->root));
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::cbegin() const noexcept
+{
+	return this->begin();
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::end() noexcept
+{
+	return iterator<false>(nullptr);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::end() const noexcept
+{
+	return const_iterator<false>(nullptr);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<false>
+CritBitTree<Node, KeyGetter, Options, Tag>::cend() const noexcept
+{
+	return this->end();
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<true>
+CritBitTree<Node, KeyGetter, Options, Tag>::rbegin() noexcept
+{
+	return iterator<true>(static_cast<const MyClass *>(this)->rbegin().n);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<true>
+CritBitTree<Node, KeyGetter, Options, Tag>::rbegin() const noexcept
+{
+	if (this->root == 0) {
+		return this->rend();
+	}
+	return const_iterator<true>(get_rightmost(this->root));
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<true>
+CritBitTree<Node, KeyGetter, Options, Tag>::crbegin() const noexcept
+{
+	return this->rbegin();
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options, Tag>::template iterator<true>
+CritBitTree<Node, KeyGetter, Options, Tag>::rend() noexcept
+{
+	return iterator<true>(nullptr);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<true>
+CritBitTree<Node, KeyGetter, Options, Tag>::rend() const noexcept
+{
+	return const_iterator<true>(nullptr);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+typename CritBitTree<Node, KeyGetter, Options,
+                     Tag>::template const_iterator<true>
+CritBitTree<Node, KeyGetter, Options, Tag>::crend() const noexcept
+{
+	return this->rend();
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+size_t
+CritBitTree<Node, KeyGetter, Options, Tag>::size() const noexcept
+{
+	return this->s.get();
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+bool
+CritBitTree<Node, KeyGetter, Options, Tag>::empty() const noexcept
+{
+	return this->root == 0;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+void
+CritBitTree<Node, KeyGetter, Options, Tag>::clear() noexcept
+{
+	this->root = 0;
+	this->s.set(0);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+bool
+CritBitTree<Node, KeyGetter, Options, Tag>::verify_integrity() const
+{
+	try {
+		this->dbg_verify();
+	} catch (debug::VerifyException & e) {
+		return false;
+	}
+
+	return true;
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+void
+CritBitTree<Node, KeyGetter, Options, Tag>::dbg_verify() const
+{
+	using debug::yggassert;
+
+	size_t leaves = 0;
+	if (this->root != 0) {
+		this->dbg_verify_subtree(this->root, nullptr, 0, leaves);
+	}
+
+	if constexpr (Options::constant_time_size) {
+		yggassert(leaves == this->size());
+	}
+
+	// Iteration must be in order, in both directions
+	size_t count = 0;
+	const Node * last = nullptr;
+	for (const auto & n : *this) {
+		if (last != nullptr) {
+			yggassert(!(KeyGetter::get_key(n) < KeyGetter::get_key(*last)));
+		}
+		last = &n;
+		count++;
+	}
+	yggassert(count == leaves);
+
+	count = 0;
+	for (auto it = this->crbegin(); it != this->crend(); ++it) {
+		count++;
+	}
+	yggassert(count == leaves);
+}
+
+template <class Node, class KeyGetter, class Options, class Tag>
+const Node *
+CritBitTree<Node, KeyGetter, Options, Tag>::dbg_verify_subtree(
+    uintptr_t ref, Inner * parent, size_t min_bit, size_t & leaves) const
+{
+	using debug::yggassert;
+
+	yggassert(get_parent(ref) == parent);
+
+	if (is_leaf(ref)) {
+		leaves++;
+		return get_leaf(ref);
+	}
+
+	// Returns one node of each subtree. The two must differ first in the bit
+	// this inner node branches on.
+	const Inner * inner = get_inner(ref);
+	yggassert(inner->bit != Inner::UNUSED);
+	yggassert(inner->bit >= min_bit);
+	yggassert(inner->bit < total_bits);
+
+	const Node * left = this->dbg_verify_subtree(
+	    inner->children[0], get_inner(ref), inner->bit + 1, leaves);
+	const Node * right = this->dbg_verify_subtree(
+	    inner->children[1], get_inner(ref), inner->bit + 1, leaves);
+
+	yggassert(critical_bit(KeyGetter::get_key(*left), get_tiebreaker(*left),
+	                       KeyGetter::get_key(*right),
+	                       get_tiebreaker(*right)) == inner->bit);
+	yggassert(!get_bit(KeyGetter::get_key(*left), get_tiebreaker(*left),
+	                   inner->bit));
+
+	return left;
+}
+
+} // namespace ygg
+
+#endif // YGG_CRITBIT_TREE_CPP
@@ -0,0 +1,361 @@
+#ifndef YGG_CRITBIT_TREE_HPP
+#define YGG_CRITBIT_TREE_HPP
+
+#include "debug.hpp"
+#include "options.hpp"
+#include "size_holder.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace ygg {
+namespace critbit_internal {
+/// @cond INTERNAL
+
+/*
+ * Access to the bits of a key, most significant bit first. The order of the
+ * resulting bit strings must be the order of the keys.
+ */
+template <class Key, class Enable = void>
+class KeyBits {
+	static_assert(!std::is_same<Key, Key>::value,
+	              "The CritBitTree supports integer keys and std::array<unsigned "
+	              "char, N> keys.");
+};
+
+template <class Key>
+class KeyBits<Key, std::enable_if_t<std::is_integral<Key>::value>> {
+public:
+	static_assert(sizeof(Key) <= sizeof(uint64_t),
+	              "Integer keys must be at most 64 bits wide.");
+	static constexpr size_t bits = sizeof(Key) * 8;
+
+	static bool get_bit(const Key & key, size_t bit) noexcept;
+	// Returns the index of the first bit in which lhs and rhs differ, or <bits>
+	static size_t critical_bit(const Key & lhs, const Key & rhs) noexcept;
+
+private:
+	// Flips the sign bit of signed keys, such that negative keys come first
+	static uint64_t to_unsigned(const Key & key) noexcept;
+};
+
+template <size_t N>
+class KeyBits<std::array<unsigned char, N>> {
+public:
+	static constexpr size_t bits = N * 8;
+
+	static bool get_bit(const std::array<unsigned char, N> & key,
+	                    size_t bit) noexcept;
+	static size_t critical_bit(const std::array<unsigned char, N> & lhs,
+	                           const std::array<unsigned char, N> & rhs) noexcept;
+};
+
+/*
+ * An inner node of the crit-bit tree. It branches on bit <bit> of the keys.
+ * The lowest bit of a child reference is set if the child is a leaf, i.e.,
+ * one of your nodes.
+ */
+class InnerNode {
+public:
+	static constexpr size_t UNUSED = std::numeric_limits<size_t>::max();
+
+	uintptr_t children[2];
+	InnerNode * parent;
+	size_t bit = UNUSED;
+};
+
+/// @endcond
+} // namespace critbit_internal
+
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the CritBitTree *must* derive from this class
+ * (template). Every node carries the link to its parent, plus the storage for
+ * one inner node of the crit-bit tree. This way, the crit-bit tree never
+ * allocates memory.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam options  The options class (a version of TreeOptions) that you
+ * parameterize the tree with. (See the options parameter of RBTree.)
+ * @tparam Tag 		The tag used to identify the tree that this node should
+ * be inserted into. See RBTree for details.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class CritBitNodeBase {
+public:
+	/// @cond INTERNAL
+	critbit_internal::InnerNode * leaf_parent = nullptr;
+	critbit_internal::InnerNode inner;
+	/// @endcond
+};
+
+/**
+ * @brief The Crit-Bit Tree
+ *
+ * A crit-bit tree is a binary radix tree that only stores the bits in which
+ * keys differ ("critical bits"). Searching never compares keys: At every inner
+ * node, the search takes the branch given by one bit of the query. Only at the
+ * end of the search, the key of the found node is compared to the query once.
+ * The depth of the tree is bounded by the key length in bits, not by log(n),
+ * and the search path does not depend on comparisons that the CPU has to
+ * predict.
+ *
+ * Keys are accessed via a KeyGetter class. Supported keys are integers (signed
+ * or unsigned, at most 64 bits) and fixed-width byte strings
+ * (std::array<unsigned char, N>, compared lexicographically). The key of a
+ * node must not change while the node is in the tree.
+ *
+ * If MULTIPLE is set, nodes with equal keys are ordered by their address. The
+ * tree never allocates memory, see CritBitNodeBase.
+ *
+ * @tparam Node         The node class for this tree. It must be derived from
+ * CritBitNodeBase.
+ * @tparam KeyGetter    A class that must implement a static Key get_key(const
+ * Node &) function that returns the key of a node.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this tree. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies this tree. Can be used
+ * to insert the same nodes into multiple trees. Can be any class, the class can
+ * be empty.
+ */
+template <class Node, class KeyGetter, class Options = DefaultOptions,
+          class Tag = int>
+class CritBitTree {
+public:
+	using MyClass = CritBitTree<Node, KeyGetter, Options, Tag>;
+	// Node Base
+	using NB = CritBitNodeBase<Node, Options, Tag>;
+	using Key = std::decay_t<decltype(
+	    KeyGetter::get_key(std::declval<const Node &>()))>;
+	static_assert(std::is_base_of<NB, Node>::value,
+	              "Node class not properly derived from CritBitNodeBase");
+
+	/// @cond INTERNAL
+	template <bool is_const, bool reverse>
+	class IteratorBase {
+	public:
+		using difference_type = ptrdiff_t;
+		using value_type = Node;
+		using reference = std::conditional_t<is_const, const Node &, Node &>;
+		using pointer = std::conditional_t<is_const, const Node *, Node *>;
+		using iterator_category = std::bidirectional_iterator_tag;
+
+		IteratorBase() = default;
+		// Allows conversion from iterator to const_iterator
+		IteratorBase(const IteratorBase<false, reverse> & other);
+
+		reference operator*() const;
+		pointer operator->() const;
+
+		IteratorBase & operator++();
+		IteratorBase operator++(int);
+		IteratorBase & operator--();
+		IteratorBase operator--(int);
+
+		bool operator==(const IteratorBase & other) const;
+		bool operator!=(const IteratorBase & other) const;
+
+	private:
+		friend class CritBitTree;
+		template <bool, bool>
+		friend class IteratorBase;
+
+		explicit IteratorBase(const Node * n);
+
+		const Node * n = nullptr;
+	};
+	/// @endcond
+
+	/**
+	 * @brief Iterators over the nodes of the tree, in order of their keys
+	 *
+	 * *Warning*: As for the binary search trees, it is not possible to
+	 * decrement the end() iterator.
+	 */
+	template <bool reverse>
+	using iterator = IteratorBase<false, reverse>;
+	template <bool reverse>
+	using const_iterator = IteratorBase<true, reverse>;
+
+	/**
+	 * @brief Create a new empty crit-bit tree.
+	 */
+	CritBitTree() noexcept;
+
+	/**
+	 * @brief Create a new crit-bit tree from a different crit-bit tree.
+	 *
+	 * The other tree is moved into this one, i.e., using it afterwards is
+	 * undefined behavior.
+	 *
+	 * @param other  The crit-bit tree that this one is constructed from
+	 */
+	CritBitTree(MyClass && other) noexcept;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * If MULTIPLE is not set and a node with the same key is already in the
+	 * tree, nothing happens.
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param node The node to be inserted.
+	 */
+	void insert(Node & node) noexcept;
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * @param node The node to be removed.
+	 */
+	void remove(Node & node) noexcept;
+
+	/**
+	 * @brief Finds a node with key <key>
+	 *
+	 * If MULTIPLE is set and several nodes have the key <key>, an iterator to
+	 * the first of them is returned.
+	 *
+	 * @param key  The key to search for
+	 * @return An iterator to the found node, or end() if no node has key <key>.
+	 */
+	iterator<false> find(const Key & key) noexcept;
+	const_iterator<false> find(const Key & key) const noexcept;
+
+	/**
+	 * @brief Returns an iterator to the first node with a key not smaller than
+	 * <key>, or end() if no such node exists.
+	 */
+	iterator<false> lower_bound(const Key & key) noexcept;
+	const_iterator<false> lower_bound(const Key & key) const noexcept;
+
+	/**
+	 * @brief Returns an iterator to the first node with a key greater than
+	 * <key>, or end() if no such node exists.
+	 */
+	iterator<false> upper_bound(const Key & key) noexcept;
+	const_iterator<false> upper_bound(const Key & key) const noexcept;
+
+	/**
+	 * @brief Returns an iterator to the node with the smallest key
+	 */
+	iterator<false> begin() noexcept;
+	const_iterator<false> begin() const noexcept;
+	const_iterator<false> cbegin() const noexcept;
+
+	/**
+	 * @brief Returns an iterator pointing after the last node
+	 */
+	iterator<false> end() noexcept;
+	const_iterator<false> end() const noexcept;
+	const_iterator<false> cend() const noexcept;
+
+	/**
+	 * @brief Returns a reverse iterator to the node with the largest key
+	 */
+	iterator<true> rbegin() noexcept;
+	const_iterator<true> rbegin() const noexcept;
+	const_iterator<true> crbegin() const noexcept;
+
+	/**
+	 * @brief Returns a reverse iterator pointing before the first node
+	 */
+	iterator<true> rend() noexcept;
+	const_iterator<true> rend() const noexcept;
+	const_iterator<true> crend() const noexcept;
+
+	/**
+	 * Return the number of elements in the tree.
+	 *
+	 * This method runs in O(1).
+	 *
+	 * @warning This method is only available if CONSTANT_TIME_SIZE is set as
+	 * option!
+	 *
+	 * @return The number of elements in the tree.
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Returns whether the tree is empty
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * @brief Removes all elements from the tree.
+	 *
+	 * Removes all elements from the tree. Note that the nodes are not touched.
+	 */
+	void clear() noexcept;
+
+	// Mainly debugging methods
+	/// @cond INTERNAL
+	void dbg_verify() const;
+	bool verify_integrity() const;
+	/// @endcond
+
+private:
+	using Inner = critbit_internal::InnerNode;
+	using Bits = critbit_internal::KeyBits<Key>;
+
+	/*
+	 * With MULTIPLE, the bit strings of the keys are extended by the addresses
+	 * of the nodes, which makes them unique.
+	 */
+	static constexpr size_t total_bits =
+	    Bits::bits + (Options::multiple ? (sizeof(uintptr_t) * 8) : 0);
+	static uintptr_t get_tiebreaker(const Node & node) noexcept;
+	static bool get_bit(const Key & key, uintptr_t tiebreaker,
+	                    size_t bit) noexcept;
+	static size_t critical_bit(const Key & lhs, uintptr_t lhs_tiebreaker,
+	                           const Key & rhs,
+	                           uintptr_t rhs_tiebreaker) noexcept;
+
+	/*
+	 * Handling of (tagged) child references
+	 */
+	static bool is_leaf(uintptr_t ref) noexcept;
+	static Node * get_leaf(uintptr_t ref) noexcept;
+	static Inner * get_inner(uintptr_t ref) noexcept;
+	static uintptr_t leaf_ref(const Node * node) noexcept;
+	static uintptr_t inner_ref(const Inner * inner) noexcept;
+	static Inner * get_parent(uintptr_t ref) noexcept;
+	static void set_parent(uintptr_t ref, Inner * parent) noexcept;
+	void replace_child(Inner * parent, uintptr_t old_child,
+	                   uintptr_t new_child) noexcept;
+
+	static Node * get_leftmost(uintptr_t ref) noexcept;
+	static Node * get_rightmost(uintptr_t ref) noexcept;
+	static const Node * get_next(const Node * node) noexcept;
+	static const Node * get_previous(const Node * node) noexcept;
+
+	// Follows the bits of <key> down to a leaf
+	Node * descend(const Key & key, uintptr_t tiebreaker) const noexcept;
+	// Returns the first node that is not smaller than (key, tiebreaker)
+	Node * bound(const Key & key, uintptr_t tiebreaker) const noexcept;
+
+	const Node * dbg_verify_subtree(uintptr_t ref, Inner * parent,
+	                                size_t min_bit, size_t & leaves) const;
+
+	uintptr_t root;
+	SizeHolder<Options::constant_time_size> s;
+};
+
+} // namespace ygg
+
+#ifndef YGG_CRITBIT_TREE_CPP
+#include "critbit_tree.cpp"
+#endif
+
+#endif // YGG_CRITBIT_TREE_HPP
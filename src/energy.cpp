@@ -7,886 +7,756 @@
 #include "debug.hpp"
 
 #include <cassert>
-#include <cmath>
-#include <iostream>
-
-// TODO currently, only a multi-set is implemented
+#include <utility>
 
 namespace ygg {
-
-template <class Node, class Options, class Tag>
-size_t
-EnergyTreeNodeBase<Node, Options, Tag>::get_depth() const noexcept
-{
-	size_t depth = 0;
-	const Node * n = static_cast<const Node *>(this);
-
-	while (n->_et_parent != nullptr) {
-		depth++;
-		n = n->_et_parent;
-	}
-
-	return depth;
-}
-
 template <class Node, class Options, class Tag, class Compare>
-EnergyTree<Node, Options, Tag, Compare>::EnergyTree() : root(nullptr)
+EnergyTree<Node, Options, Tag, Compare>::EnergyTree() noexcept
+    : rebuild_pending_count(0)
 {}
 
 template <class Node, class Options, class Tag, class Compare>
-EnergyTree<Node, Options, Tag, Compare>::EnergyTree(MyClass && other)
+EnergyTree<Node, Options, Tag, Compare>::EnergyTree(MyClass && other) noexcept
 {
 	this->root = other.root;
 	other.root = nullptr;
+	this->s = other.s;
+	this->rebuild_queue = std::move(other.rebuild_queue);
+	this->rebuild_pending_count = other.rebuild_pending_count;
+	other.rebuild_queue.clear();
+	other.rebuild_pending_count = 0;
 }
 
 template <class Node, class Options, class Tag, class Compare>
 EnergyTree<Node, Options, Tag, Compare> &
-EnergyTree<Node, Options, Tag, Compare>::operator=(MyClass && other)
+EnergyTree<Node, Options, Tag, Compare>::operator=(MyClass && other) noexcept
 {
 	this->root = other.root;
 	other.root = nullptr;
+	this->s = other.s;
+	this->rebuild_queue = std::move(other.rebuild_queue);
+	this->rebuild_pending_count = other.rebuild_pending_count;
+	other.rebuild_queue.clear();
+	other.rebuild_pending_count = 0;
 
 	return *this;
 }
 
+template <class Node, class Options, class Tag, class Compare>
+bool
+EnergyTree<Node, Options, Tag, Compare>::is_unbalanced(const Node * n) noexcept
+{
+	return n->NB::_et_energy * Options::etree_energy_denominator >
+	       n->NB::_et_size * Options::etree_energy_numerator;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+bool
+EnergyTree<Node, Options, Tag, Compare>::is_queued(const Node * n) noexcept
+{
+	if constexpr (Options::etree_incremental_rebuild) {
+		return n->NB::_et_queue_pos != NOT_QUEUED;
+	} else {
+		(void)n;
+		return false;
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare>
+bool
+EnergyTree<Node, Options, Tag, Compare>::needs_rebuild(const Node * n) noexcept
+{
+	// A queued subtree stays unbalanced until its rebuild reaches it. Imbalances
+	// below it must still be scheduled, otherwise they grow unchecked meanwhile.
+	return is_unbalanced(n) && !is_queued(n);
+}
+
 template <class Node, class Options, class Tag, class Compare>
 void
-EnergyTree<Node, Options, Tag, Compare>::insert(Node & node)
+EnergyTree<Node, Options, Tag, Compare>::insert(Node & node) CMP_NOEXCEPT(node)
 {
 	this->s.add(1);
+	this->insert_leaf_base(node, this->root);
+}
 
-	node._et_size = 1;
-	node._et_energy = 0;
-	node._et_left = nullptr;
-	node._et_right = nullptr;
+template <class Node, class Options, class Tag, class Compare>
+void
+EnergyTree<Node, Options, Tag, Compare>::insert(Node & node, Node & hint)
+    CMP_NOEXCEPT(node)
+{
+	this->s.add(1);
+
+	Node * parent = this->get_hint_subtree(node, hint);
+	this->insert_leaf_base(node, parent);
+}
 
-	if (__builtin_expect(this->root == nullptr, false)) {
+template <class Node, class Options, class Tag, class Compare>
+void
+EnergyTree<Node, Options, Tag, Compare>::insert(Node & node,
+                                                iterator<false> hint)
+    CMP_NOEXCEPT(node)
+{
+	if (hint == this->end()) {
+		this->s.add(1);
+
+		// special case: insert at the end
+		Node * parent = this->root;
+		if (parent != nullptr) {
+			while (parent->NB::get_right() != nullptr) {
+				parent = parent->NB::get_right();
+			}
+		}
+		this->insert_leaf_base(node, parent);
+	} else {
+		this->insert(node, *hint);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+EnergyTree<Node, Options, Tag, Compare>::insert_leaf_base(Node & node,
+                                                          Node * start)
+    CMP_NOEXCEPT(node)
+{
+	node.NB::_et_size = 1;
+	node.NB::_et_energy = 0;
+	if constexpr (Options::etree_incremental_rebuild) {
+		node.NB::_et_queue_pos = NOT_QUEUED;
+	}
+	node.NB::set_left(nullptr);
+	node.NB::set_right(nullptr);
+
+	if (__builtin_expect(start == nullptr, false)) {
 		this->root = &node;
-		node._et_parent = nullptr;
+		node.NB::set_parent(nullptr);
 		return;
 	}
 
-	Node * cur = this->root;
-	Node * rebuild_at = nullptr;
+	Node * cur = start;
+	Node * parent = start;
+	bool go_right = false;
+	Node * unbalanced = nullptr;
+	size_t energy_added = 0;
+
+	while (cur != nullptr) {
+		parent = cur;
+
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(cur->NB::get_left());
+			__builtin_prefetch(cur->NB::get_right());
+		}
 
-	// TODO this implements a left-leaning multiset.
-	// TODO sprinkle with expects?
-	while (true) {
 		cur->NB::_et_size += 1;
 		cur->NB::_et_energy += 1;
-
-		// TODO unroll two stages of the loop
-		// TODO make 0.5 configurable
-		if ((rebuild_at == nullptr) &&
-		    (2 * cur->NB::_et_energy > cur->NB::_et_size)) {
-			rebuild_at = cur;
+		energy_added++;
+		if ((unbalanced == nullptr) && this->needs_rebuild(cur)) {
+			unbalanced = cur;
 		}
 
-		if (this->cmp(*cur, node)) {
-			if (cur->NB::_et_right != nullptr) {
-				cur = cur->NB::_et_right;
-			} else {
-				cur->NB::_et_right = &node;
-				node.NB::_et_parent = cur;
-				break;
+		go_right = this->cmp(*cur, node);
+		if constexpr (!Options::multiple) {
+			// Multiple are not allowed - we need three-way comparisons!
+			if (__builtin_expect(!go_right && !this->cmp(node, *cur), false)) {
+				// Same as existing. Revert the changes made on the way down.
+				for (Node * undo = cur; undo != start->NB::get_parent();
+				     undo = undo->NB::get_parent()) {
+					undo->NB::_et_size -= 1;
+					undo->NB::_et_energy -= 1;
+				}
+				this->s.reduce(1);
+				return;
 			}
+		}
+
+		if constexpr (Options::micro_avoid_conditionals) {
+			cur = utilities::go_right_if(go_right, cur);
 		} else {
-			if (cur->NB::_et_left != nullptr) {
-				cur = cur->NB::_et_left;
+			if (go_right) {
+				cur = cur->NB::get_right();
 			} else {
-				cur->NB::_et_left = &node;
-				node.NB::_et_parent = cur;
-				break;
+				cur = cur->NB::get_left();
 			}
 		}
 	}
 
-	if (rebuild_at != nullptr) {
-		this->rebuild_below(rebuild_at);
+	if (go_right) {
+		parent->NB::set_right(&node);
+	} else {
+		parent->NB::set_left(&node);
+	}
+	node.NB::set_parent(parent);
+
+	// If we started below the root, the nodes above the start still need to
+	// account for the new node. We want the topmost unbalanced node.
+	for (Node * ancestor = start->NB::get_parent(); ancestor != nullptr;
+	     ancestor = ancestor->NB::get_parent()) {
+		ancestor->NB::_et_size += 1;
+		ancestor->NB::_et_energy += 1;
+		energy_added++;
+		if (this->needs_rebuild(ancestor)) {
+			unbalanced = ancestor;
+		}
+	}
+
+	this->handle_imbalance(unbalanced, energy_added);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+EnergyTree<Node, Options, Tag, Compare>::handle_imbalance(Node * unbalanced,
+                                                          size_t energy_added)
+{
+	if constexpr (Options::etree_incremental_rebuild) {
+		if (unbalanced != nullptr) {
+			this->schedule_rebuild(unbalanced);
+		}
+		/* Rebuilding a subtree of m nodes takes m steps and is triggered by an
+		 * energy of at least m * numerator / denominator. Doing steps in
+		 * proportion to the energy added thus finishes the scheduled rebuilds as
+		 * fast as new ones can arise, i.e., the queue does not fall behind.
+		 */
+		if (this->rebuild_pending_count > 0) {
+			this->rebuild_steps(Options::etree_rebuild_steps *
+			                    (1 + energy_added *
+			                             Options::etree_energy_denominator /
+			                             Options::etree_energy_numerator));
+		}
+	} else {
+		(void)energy_added;
+		if (unbalanced != nullptr) {
+			this->rebalance_subtree(*unbalanced);
+		}
 	}
 }
 
 template <class Node, class Options, class Tag, class Compare>
 void
-EnergyTree<Node, Options, Tag, Compare>::remove(Node & node)
+EnergyTree<Node, Options, Tag, Compare>::remove(Node & node) CMP_NOEXCEPT(node)
 {
 	this->s.reduce(1);
 
 	Node * cur = &node;
-	Node * rebuild_at = nullptr;
-	bool rebuild_set_upwards = false;
+	Node * unbalanced = nullptr;
+	bool unbalanced_above = false;
+	size_t energy_added = 0;
 
-	//	std::cout << "<<<<<<<<<<<<<<< Deleting node " << std::hex << &node << " of
-	// size "
-	//          << std::dec << node.NB::_et_size << "\n";
-	// std::cout << "Parent is: " << std::hex << node.NB::_et_parent << std::dec
-	// << "\n";
-
-	while (cur->NB::_et_parent != nullptr) {
-		cur = cur->NB::_et_parent;
+	while (cur->NB::get_parent() != nullptr) {
+		cur = cur->NB::get_parent();
 		cur->NB::_et_size -= 1;
 		cur->NB::_et_energy += 1;
+		energy_added++;
 
-		// std::cout << " <<< Up-Updating energy and size at " << std::hex << cur <<
-		// std::dec << "\n";
-
-		// TODO make 0.5 configurable
-		// TODO ceil here?
-		if (2 * cur->NB::_et_energy > cur->NB::_et_size) {
-			rebuild_at = cur;
-			rebuild_set_upwards = true;
+		if (needs_rebuild(cur)) {
+			unbalanced = cur;
+			unbalanced_above = true;
 		}
 	}
 
 	cur = &node;
 	Node * child = &node;
 
-	if ((cur->NB::_et_left == nullptr) && (cur->NB::_et_right == nullptr)) {
-		// std::cout << "<<< Deleting Leaf.\n";
-
-		// This is a leaf. We can just delete.
-		Node * parent = cur->NB::_et_parent;
+	if ((cur->NB::get_left() == nullptr) && (cur->NB::get_right() == nullptr)) {
+		Node * parent = cur->NB::get_parent();
 		if (parent == nullptr) {
 			this->root = nullptr;
-		} else if (parent->NB::_et_left == cur) {
-			parent->NB::_et_left = nullptr;
+		} else if (parent->NB::get_left() == cur) {
+			parent->NB::set_left(nullptr);
 		} else {
-			assert(parent->NB::_et_right == cur);
-			parent->NB::_et_right = nullptr;
+			assert(parent->NB::get_right() == cur);
+			parent->NB::set_right(nullptr);
 		}
 	} else {
-		if (cur->NB::_et_left != nullptr) {
-			// std::cout << "<<< Delete-Swapping from left.\n";
-			// TODO randomly select whether we do left-leaning or right-leaning
-			// deletion? For now, left-leaning is implemented
-			child = cur->NB::_et_left;
-
-			// Find the largest among the less-or-equal children
-			while (child->NB::_et_right != nullptr) {
+		if (cur->NB::get_left() != nullptr) {
+			child = cur->NB::get_left();
+
+			while (child->NB::get_right() != nullptr) {
 				child->NB::_et_size -= 1;
 				child->NB::_et_energy += 1;
+				energy_added++;
 
-				if ((rebuild_at == nullptr) &&
-				    (2 * child->NB::_et_energy > child->NB::_et_size)) {
-					rebuild_at = child;
+				if ((unbalanced == nullptr) && (needs_rebuild(child))) {
+					unbalanced = child;
 				}
 
-				child = child->NB::_et_right;
+				child = child->NB::get_right();
 			}
 
-			// std::cout << "<<<< Selected swappee: " << std::hex << child << std::dec
-			//          << "\n";
-
-			// Splice this child out of the tree
-			if (child->NB::_et_left != nullptr) {
-				// TODO this is only non-true if we did not descend above.
-				// unroll this case?
-
-				// std::cout << "<<<<< Splicing swappee out between " << std::hex
-				//          << child->NB::_et_parent << " and " << child->NB::_et_left
-				//          << std::dec << "\n";
-
-				if (__builtin_expect(child->NB::_et_parent->NB::_et_right == child,
+			if (child->NB::get_left() != nullptr) {
+				if (__builtin_expect(child->NB::get_parent()->NB::get_right() == child,
 				                     true)) {
-					child->NB::_et_parent->NB::_et_right = child->NB::_et_left;
+					child->NB::get_parent()->NB::set_right(child->NB::get_left());
 				} else {
-					assert(child->NB::_et_parent->NB::_et_left == child);
-					child->NB::_et_parent->NB::_et_left = child->NB::_et_left;
+					assert(child->NB::get_parent()->NB::get_left() == child);
+					child->NB::get_parent()->NB::set_left(child->NB::get_left());
 				}
-				child->NB::_et_left->NB::_et_parent = child->NB::_et_parent;
+				child->NB::get_left()->NB::set_parent(child->NB::get_parent());
 			} else {
-				if (__builtin_expect(child->NB::_et_parent->NB::_et_right == child,
+				if (__builtin_expect(child->NB::get_parent()->NB::get_right() == child,
 				                     true)) {
-					child->NB::_et_parent->NB::_et_right = nullptr;
+					child->NB::get_parent()->NB::set_right(nullptr);
 				} else {
-					assert(child->NB::_et_parent->NB::_et_left == child);
-					child->NB::_et_parent->NB::_et_left = nullptr;
+					assert(child->NB::get_parent()->NB::get_left() == child);
+					child->NB::get_parent()->NB::set_left(nullptr);
 				}
-
-				// std::cout << "<<<< Swapped element is empty on the left.\n";
 			}
-
 		} else {
-			// std::cout << "<<< Delete-Swapping from right.\n";
-			child = cur->NB::_et_right;
+			child = cur->NB::get_right();
 
-			// Find the smallest among the greater-or-equal children
-			while (child->NB::_et_left != nullptr) {
+			while (child->NB::get_left() != nullptr) {
 				child->NB::_et_size -= 1;
 				child->NB::_et_energy += 1;
+				energy_added++;
 
-				if ((rebuild_at == nullptr) &&
-				    (2 * child->NB::_et_energy > child->NB::_et_size)) {
-					rebuild_at = child;
+				if ((unbalanced == nullptr) && (needs_rebuild(child))) {
+					unbalanced = child;
 				}
 
-				child = child->NB::_et_left;
+				child = child->NB::get_left();
 			}
 
-			// std::cout << "<<<< Selected swappee: " << std::hex << child << std::dec
-			//			          << "\n";
-
-			// Splice this child out of the tree
-			if (child->NB::_et_right != nullptr) {
-
-				// std::cout << "<<<<< Splicing swappee out between " << std::hex
-				//          << child->NB::_et_parent << " and " << child->NB::_et_right
-				//          << std::dec << "\n";
-
-				// TODO this is only non-true if we did not descend above.
-				// unroll this case?
-				if (__builtin_expect(child->NB::_et_parent->NB::_et_left == child,
+			if (child->NB::get_right() != nullptr) {
+				if (__builtin_expect(child->NB::get_parent()->NB::get_left() == child,
 				                     true)) {
-					child->NB::_et_parent->NB::_et_left = child->NB::_et_right;
+					child->NB::get_parent()->NB::set_left(child->NB::get_right());
 				} else {
-					assert(child->NB::_et_parent->NB::_et_right == child);
-					child->NB::_et_parent->NB::_et_right = child->NB::_et_right;
+					assert(child->NB::get_parent()->NB::get_right() == child);
+					child->NB::get_parent()->NB::set_right(child->NB::get_right());
 				}
-				child->NB::_et_right->NB::_et_parent = child->NB::_et_parent;
+				child->NB::get_right()->NB::set_parent(child->NB::get_parent());
 			} else {
-				if (__builtin_expect(child->NB::_et_parent->NB::_et_left == child,
+				if (__builtin_expect(child->NB::get_parent()->NB::get_left() == child,
 				                     true)) {
-					child->NB::_et_parent->NB::_et_left = nullptr;
+					child->NB::get_parent()->NB::set_left(nullptr);
 				} else {
-					assert(child->NB::_et_parent->NB::_et_right == child);
-					child->NB::_et_parent->NB::_et_right = nullptr;
+					assert(child->NB::get_parent()->NB::get_right() == child);
+					child->NB::get_parent()->NB::set_right(nullptr);
 				}
-
-				// std::cout << "<<<< Swapped element is empty on the right.\n";
 			}
 		}
 
-		// Move the child up where the node to be deleted was
-		if (node.NB::_et_left != child) {
-			child->NB::_et_left = node.NB::_et_left;
-			if (child->NB::_et_left != nullptr) {
-				child->NB::_et_left->NB::_et_parent = child;
+		if (node.NB::get_left() != child) {
+			child->NB::set_left(node.NB::get_left());
+			if (child->NB::get_left() != nullptr) {
+				child->NB::get_left()->NB::set_parent(child);
 			}
 		}
 
-		// TODO both can't be true at the same time - skip one check?
-		if (node.NB::_et_right != child) {
-			child->NB::_et_right = node.NB::_et_right;
-			if (child->NB::_et_right != nullptr) {
-				child->NB::_et_right->NB::_et_parent = child;
+		if (node.NB::get_right() != child) {
+			child->NB::set_right(node.NB::get_right());
+			if (child->NB::get_right() != nullptr) {
+				child->NB::get_right()->NB::set_parent(child);
 			}
 		}
 
-		if (node.NB::_et_parent == nullptr) {
+		if (node.NB::get_parent() == nullptr) {
 			this->root = child;
-		} else if (node.NB::_et_parent->NB::_et_left == &node) {
-			node.NB::_et_parent->NB::_et_left = child;
+		} else if (node.NB::get_parent()->NB::get_left() == &node) {
+			node.NB::get_parent()->NB::set_left(child);
 		} else {
-			assert(node.NB::_et_parent->NB::_et_right == &node);
-			node.NB::_et_parent->NB::_et_right = child;
+			assert(node.NB::get_parent()->NB::get_right() == &node);
+			node.NB::get_parent()->NB::set_right(child);
 		}
-		child->NB::_et_parent = node.NB::_et_parent;
+		child->NB::set_parent(node.NB::get_parent());
 
 		child->NB::_et_energy = node.NB::_et_energy + 1;
 		child->NB::_et_size = node.NB::_et_size - 1;
+		energy_added++;
 
-		if (!rebuild_set_upwards &&
-		    (2 * child->NB::_et_energy > child->NB::_et_size)) {
-			rebuild_at = child;
+		if (!unbalanced_above && (is_unbalanced(child))) {
+			unbalanced = child;
 		}
 	}
 
-	if (rebuild_at != nullptr) {
-		this->rebuild_below(rebuild_at);
+	if constexpr (Options::etree_incremental_rebuild) {
+		// A queued subtree root might just have been removed. Its subtree is now
+		// rooted at the node that replaced it.
+		if (is_queued(&node)) {
+			const size_t pos = node.NB::_et_queue_pos;
+			if ((child != &node) && !is_queued(child)) {
+				this->rebuild_queue[pos] = child;
+				child->NB::_et_queue_pos = pos;
+				node.NB::_et_queue_pos = NOT_QUEUED;
+			} else {
+				this->unschedule_rebuild(&node);
+			}
+		}
 	}
-}
 
-template <class Node, class Options, class Tag, class Compare>
-void
-EnergyTree<Node, Options, Tag, Compare>::dbg_verify() const
-{
-	this->dbg_verify_tree();
-	this->dbg_verify_size();
-	this->dbg_verify_energy();
-	this->dbg_verify_sizes();
+	this->handle_imbalance(unbalanced, energy_added);
 }
 
 template <class Node, class Options, class Tag, class Compare>
-bool
-EnergyTree<Node, Options, Tag, Compare>::verify_integrity() const
-{
-	try {
-		this->dbg_verify();
-	} catch (debug::VerifyException & e) {
-		return false;
+template <class Comparable>
+ygg::utilities::select_type_t<size_t, Node *, Options::stl_erase>
+EnergyTree<Node, Options, Tag, Compare>::erase(const Comparable & c)
+    CMP_NOEXCEPT(c)
+{
+	// If we allow multisets and want to be STL-conform, we must find the *first*
+	// node carrying c, so that we can iteratively delete all of them
+	auto el = this->template find<Comparable,
+	                              (Options::stl_erase && Options::multiple)>(c);
+
+	if (el != this->end()) {
+		if constexpr (Options::stl_erase) {
+			size_t count = 1;
+
+			auto next = el + 1;
+			this->remove(*el);
+			if (Options::multiple) {
+				el = next;
+
+				// el points to the first element comparing equal to c.
+				// For all elements after it, we must only check if they are larger
+				while (__builtin_expect((el != this->end()) && (!this->cmp(c, *el)),
+				                        false)) {
+					count++;
+					next = el + 1;
+					this->remove(*el);
+					el = next;
+				}
+			} else {
+				(void)next;
+			}
+			return count;
+		} else {
+			Node * n = &(*el);
+			this->remove(*el);
+			return n;
+		}
 	}
 
-	return true;
+	if constexpr (Options::stl_erase) {
+		return 0;
+	} else {
+		return static_cast<Node *>(nullptr);
+	}
 }
 
 template <class Node, class Options, class Tag, class Compare>
-bool
-EnergyTree<Node, Options, Tag, Compare>::empty() const
+template <bool reverse>
+ygg::utilities::select_type_t<
+    const typename EnergyTree<Node, Options, Tag,
+                              Compare>::template iterator<reverse>,
+    Node *, Options::stl_erase>
+EnergyTree<Node, Options, Tag, Compare>::erase(const iterator<reverse> & it)
+    CMP_NOEXCEPT(*it)
 {
-	return this->root == nullptr;
+	if constexpr (!Options::stl_erase) {
+		Node * n = &(*it);
+		this->remove(*it);
+
+		return n;
+	} else {
+		auto ret = it + 1;
+		this->remove(*it);
+		return ret;
+	}
 }
 
 template <class Node, class Options, class Tag, class Compare>
 void
-EnergyTree<Node, Options, Tag, Compare>::dbg_verify_size() const
+EnergyTree<Node, Options, Tag, Compare>::clear() noexcept
 {
-	if (!Options::constant_time_size) {
-		return;
-	}
-
-	size_t count = 0;
-	for (const Node & n : *this) {
-		(void)n;
-		count++;
-	}
+	this->TB::clear();
+	this->rebuild_queue.clear();
+	this->rebuild_pending_count = 0;
+}
 
-	debug::yggassert(count == this->size());
+template <class Node, class Options, class Tag, class Compare>
+size_t
+EnergyTree<Node, Options, Tag, Compare>::get_subtree_size(
+    const Node * n) noexcept
+{
+	return n->NB::_et_size;
 }
 
 template <class Node, class Options, class Tag, class Compare>
-void
-EnergyTree<Node, Options, Tag, Compare>::dbg_verify_energy() const
+bool
+EnergyTree<Node, Options, Tag, Compare>::rebuild_pending() const noexcept
 {
-	for (const Node & n : *this) {
-		debug::yggassert(2 * n.NB::_et_energy <= n.NB::_et_size);
-	}
+	return this->rebuild_pending_count > 0;
 }
 
 template <class Node, class Options, class Tag, class Compare>
 void
-EnergyTree<Node, Options, Tag, Compare>::dbg_verify_sizes() const
+EnergyTree<Node, Options, Tag, Compare>::finish_rebuild()
 {
-	for (const Node & n : *this) {
-		size_t left_size = 0;
-		if (n.NB::_et_left != nullptr) {
-			left_size = n.NB::_et_left->NB::_et_size;
-		}
-		size_t right_size = 0;
-		if (n.NB::_et_right != nullptr) {
-			right_size = n.NB::_et_right->NB::_et_size;
-		}
-
-		debug::yggassert(n.NB::_et_size == left_size + right_size + 1);
+	while (!this->rebuild_queue.empty()) {
+		this->rebuild_steps(this->rebuild_queue.size());
 	}
 }
 
 template <class Node, class Options, class Tag, class Compare>
 void
-EnergyTree<Node, Options, Tag, Compare>::dbg_verify_tree(Node * node) const
+EnergyTree<Node, Options, Tag, Compare>::schedule_rebuild(Node * node)
 {
-	if (node == nullptr) {
-		node = this->root;
-		if (node == nullptr) {
-			return;
-		}
-	}
-
-	debug::yggassert(node->_et_left != node);
-	if (node->_et_left != nullptr) {
-		debug::yggassert(node->_et_left->_et_parent == node);
-		this->dbg_verify_tree(node->_et_left);
-	}
-
-	debug::yggassert(node->_et_right != node);
-	if (node->_et_right != nullptr) {
-		debug::yggassert(node->_et_right->_et_parent == node);
-		this->dbg_verify_tree(node->_et_right);
+	if (is_queued(node)) {
+		return;
 	}
+	node->NB::_et_queue_pos = this->rebuild_queue.size();
+	this->rebuild_queue.push_back(node);
+	this->rebuild_pending_count++;
 }
 
 template <class Node, class Options, class Tag, class Compare>
 void
-EnergyTree<Node, Options, Tag, Compare>::rebuild_below(Node * node)
+EnergyTree<Node, Options, Tag, Compare>::unschedule_rebuild(
+    Node * node) noexcept
 {
-	// TODO this is a wild hack. Is this portable?
-	//	size_t full_tree_size = 1 << (fls(node->NB::_et_size) + (1 -
-	//__builtin_parity(node->NB::_et_size)));
-	int tree_levels =
-	    static_cast<int>(std::ceil(std::log2(node->NB::_et_size + 1)));
-	size_t full_tree_size = (1 << tree_levels) - 1;
-
-	this->rebuild_buffer.resize(full_tree_size);
-
-	Node * smallest;
-	Node * largest;
-
-	Node * original_parent = node->NB::_et_parent;
-	size_t original_size = node->NB::_et_size;
-
-	/*
-	std::cout << "################# Rebuilding subtree of size " << original_size
-	          << "\n";
-	*/
-
-	// TODO it should be possible to prevent backtracking out of the node
-	smallest = node;
-	while (smallest->NB::_et_left != nullptr) {
-		smallest = smallest->NB::_et_left;
-	}
-	largest = node;
-	while (largest->NB::_et_right != nullptr) {
-		largest = largest->NB::_et_right;
-	}
-
-	iterator<false> it(smallest);
-
-	size_t bottom_level_size =
-	    ((full_tree_size + 1) / 2) - (full_tree_size - original_size);
-	assert((full_tree_size + 1) / 2 > (full_tree_size - original_size));
-	assert(bottom_level_size > 0);
-
-	size_t max_counter_bottom_level = 1 + (2 * (bottom_level_size - 1));
-	//	std::cout << "Bottom level size: " << bottom_level_size << "\n";
-	// std::cout << "Max bottom level counter: " << max_counter_bottom_level <<
-	// "\n";
-
-	// Handle first element manually
-	this->rebuild_buffer[0] = smallest;
-	unsigned int counter = 1;
-
-	/*
-	std::cout << "--------------------\n";
-	std::cout << "N: " << std::hex << (size_t)smallest << std::dec << "\n";
-	std::cout << "Level offset 0 / index 0 \n";
-	*/
-
-	// TODO unroll this loop?
-	while (&(*it) != largest) {
-		++it;
-		++counter;
-		// TODO this is a two-phase loop. Unroll the two phases.
-		if (counter > max_counter_bottom_level) {
-			if (counter % 2 == 1) {
-				counter++;
-			}
-		}
-
-		// Lowest level is 0, topmost is (tree_levels - 1)
-		int level = __builtin_ctz(counter);
-		size_t prev_levels_size = (1 << (tree_levels - 1 - level)) - 1;
-		size_t this_level_size = prev_levels_size + 1;
-		size_t level_offset =
-		    full_tree_size - prev_levels_size -
-		    this_level_size; // TODO can be simplified - just omit the "-1" above
-
-		unsigned int index_in_level = counter >> (level + 1);
-
-		/*
-		std::cout << "N: " << std::hex << (size_t) & (*it) << std::dec << "\n";
-		std::cout << "Level offset " << level_offset << " / index "
-		          << index_in_level << "\n";
-		*/
-
-		this->rebuild_buffer[level_offset +
-		                     static_cast<unsigned long>(index_in_level)] = &(*it);
-	}
+	this->rebuild_queue[node->NB::_et_queue_pos] = nullptr;
+	node->NB::_et_queue_pos = NOT_QUEUED;
+	this->rebuild_pending_count--;
+}
 
-	//	std::cout << "--------------------\n";
-
-	size_t lower_offset = 0;
-	size_t upper_offset = (full_tree_size + 1) / 2;
-
-	//	std::cout << "-- Up-linking bottom level. Level Size: " <<
-	// bottom_level_size
-	//          << "\n";
-
-	if (tree_levels > 1) {
-		// Linking the bottom level up is special, since it is not full
-		size_t i = 0;
-		for (; i < bottom_level_size - 1; i += 2) { // Go in steps of two
-			/*
-			std::cout << "## i: " << i << " Upper Node: " << std::hex
-			          << (size_t)this->rebuild_buffer[upper_offset + (i / 2)]
-			          << std::dec << "\n";
-			*/
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_left =
-			    this->rebuild_buffer[i];
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_right =
-			    this->rebuild_buffer[i + 1];
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_size = 3;
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_energy = 0;
-			/*
-			std::cout << "  L: " << std::hex << this->rebuild_buffer[i]
-			          << " R: " << this->rebuild_buffer[i + 1] << std::dec << "\n";
-			*/
-			this->rebuild_buffer[i]->NB::_et_left = nullptr;
-			this->rebuild_buffer[i]->NB::_et_size = 1;
-			this->rebuild_buffer[i]->NB::_et_energy = 0;
-			this->rebuild_buffer[i]->NB::_et_right = nullptr;
-			this->rebuild_buffer[i]->NB::_et_parent =
-			    this->rebuild_buffer[upper_offset + (i / 2)];
-			this->rebuild_buffer[i + 1]->NB::_et_left = nullptr;
-			this->rebuild_buffer[i + 1]->NB::_et_right = nullptr;
-			this->rebuild_buffer[i + 1]->NB::_et_parent =
-			    this->rebuild_buffer[upper_offset + (i / 2)];
-			this->rebuild_buffer[i + 1]->NB::_et_size = 1;
-			this->rebuild_buffer[i + 1]->NB::_et_energy = 0;
-		}
-		if (i < bottom_level_size) {
-			/*
-			std::cout << "## Remaining i: " << i << " Upper Node: " << std::hex
-			          << (size_t)this->rebuild_buffer[upper_offset + (i / 2)]
-			          << std::dec << "\n";
-			std::cout << "  L: " << std::hex << this->rebuild_buffer[i] << std::dec
-			          << "\n";
-			*/
-
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_left =
-			    this->rebuild_buffer[i];
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_right = nullptr;
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_size = 2;
-			this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_energy = 0;
-
-			this->rebuild_buffer[i]->NB::_et_left = nullptr;
-			this->rebuild_buffer[i]->NB::_et_right = nullptr;
-			this->rebuild_buffer[i]->NB::_et_parent =
-			    this->rebuild_buffer[upper_offset + (i / 2)];
-			this->rebuild_buffer[i]->NB::_et_size = 1;
-			this->rebuild_buffer[i]->NB::_et_energy = 0;
-
-			i += 2;
+template <class Node, class Options, class Tag, class Compare>
+void
+EnergyTree<Node, Options, Tag, Compare>::rebuild_steps(size_t steps)
+{
+	// The queue is processed depth-first, thus a single scheduled rebuild only
+	// ever holds O(log n) subtrees in the queue.
+	size_t step = 0;
+	while ((step < steps) && !this->rebuild_queue.empty()) {
+		Node * sub_root = this->rebuild_queue.back();
+		this->rebuild_queue.pop_back();
+		if (sub_root == nullptr) {
+			continue;
 		}
-
-		for (size_t j = i / 2; j < static_cast<size_t>(1 << (tree_levels - 2));
-		     j++) {
-			// Remaining nodes in the second-to-last level
-			/*
-			std::cout << "## Zero-ing out to below " << std::hex
-			          << this->rebuild_buffer[i] << std::dec << " at position " << j
-			          << " \n";
-			*/
-			this->rebuild_buffer[upper_offset + j]->NB::_et_left = nullptr;
-			this->rebuild_buffer[upper_offset + j]->NB::_et_right = nullptr;
-			this->rebuild_buffer[upper_offset + j]->NB::_et_size = 1;
-			this->rebuild_buffer[upper_offset + j]->NB::_et_energy = 0;
+		sub_root->NB::_et_queue_pos = NOT_QUEUED;
+		this->rebuild_pending_count--;
+		step++;
+
+		sub_root = this->lift_median(sub_root);
+		// The median may have been queued on its own. We just took care of its
+		// subtree, so its entry is merged into this one.
+		if (is_queued(sub_root)) {
+			this->unschedule_rebuild(sub_root);
 		}
+		sub_root->NB::_et_energy = 0;
 
-		// Now, climb up the levels
-		int level = 1;
-		while (level < tree_levels - 1) {
-
-			lower_offset = upper_offset;
-			upper_offset = full_tree_size - (1 << (tree_levels - 1 - level)) + 1;
-			assert(upper_offset > lower_offset);
-			size_t current_lower_level_size = upper_offset - lower_offset;
-
-			/*
-			std::cout << "-- Up-linking level " << level
-			          << ". Lower Offset: " << lower_offset
-			          << " | Upper Offset: " << upper_offset << "\n";
-			*/
-			// TODO it's probably faster to increment *_offset and save some
-			// additions…
-			for (i = 0; i < current_lower_level_size; i += 2) { // Go in steps of two
-				/*
-				std::cout << "## i: " << i << " Upper node: " << std::hex
-				          << this->rebuild_buffer[upper_offset + (i / 2)] << std::dec
-				          << "\n";
-				*/
-				this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_left =
-				    this->rebuild_buffer[lower_offset + i];
-				this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_right =
-				    this->rebuild_buffer[lower_offset + i + 1];
-				this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_size =
-				    (this->rebuild_buffer[lower_offset + i]->NB::_et_size +
-				     this->rebuild_buffer[lower_offset + i + 1]->NB::_et_size + 1);
-				this->rebuild_buffer[upper_offset + (i / 2)]->NB::_et_energy = 0;
-
-				this->rebuild_buffer[lower_offset + i]->NB::_et_parent =
-				    this->rebuild_buffer[upper_offset + (i / 2)];
-				this->rebuild_buffer[lower_offset + i + 1]->NB::_et_parent =
-				    this->rebuild_buffer[upper_offset + (i / 2)];
+		for (Node * child : {sub_root->NB::get_left(), sub_root->NB::get_right()}) {
+			if (child == nullptr) {
+				continue;
+			}
+			if (is_queued(child)) {
+				// Re-queue it on top to keep processing depth-first
+				this->unschedule_rebuild(child);
+			}
+			if (child->NB::_et_size > 1) {
+				this->schedule_rebuild(child);
+			} else {
+				child->NB::_et_energy = 0;
 			}
-
-			level += 1;
 		}
 	}
 
-	/*
-	std::cout << "-- Fixing Top.\n";
-	std::cout << "Top node: " << std::hex << this->rebuild_buffer.back()
-	          << " / Parent: " << original_parent << std::dec << "\n";
-	*/
-
-	// Top level connects to the original parent
-	this->rebuild_buffer.back()->NB::_et_parent = original_parent;
-	if (original_parent == nullptr) {
-		this->root = this->rebuild_buffer.back();
-	} else if (original_parent->NB::_et_left == node) {
-		original_parent->NB::_et_left = this->rebuild_buffer.back();
-	} else {
-		assert(original_parent->NB::_et_right == node);
-		original_parent->NB::_et_right = this->rebuild_buffer.back();
+	// Don't keep trailing entries of nodes that have left the queue
+	while (!this->rebuild_queue.empty() &&
+	       (this->rebuild_queue.back() == nullptr)) {
+		this->rebuild_queue.pop_back();
 	}
-	this->rebuild_buffer.back()->NB::_et_size = original_size;
-	this->rebuild_buffer.back()->NB::_et_energy = 0;
 }
 
 template <class Node, class Options, class Tag, class Compare>
 Node *
-EnergyTree<Node, Options, Tag, Compare>::get_smallest() const
+EnergyTree<Node, Options, Tag, Compare>::lift_median(Node * node) noexcept
 {
-	Node * smallest = this->root;
-	if (smallest == nullptr) {
-		return nullptr;
+	size_t rank = node->NB::_et_size / 2;
+	Node * median = node;
+	while (true) {
+		size_t left_size = (median->NB::get_left() != nullptr)
+		                       ? median->NB::get_left()->NB::_et_size
+		                       : 0;
+		if (rank < left_size) {
+			median = median->NB::get_left();
+		} else if (rank == left_size) {
+			break;
+		} else {
+			rank -= left_size + 1;
+			median = median->NB::get_right();
+		}
 	}
 
-	while (smallest->NB::_et_left != nullptr) {
-		smallest = smallest->NB::_et_left;
+	Node * stop = node->NB::get_parent();
+	while (median->NB::get_parent() != stop) {
+		Node * parent = median->NB::get_parent();
+		if (parent->NB::get_left() == median) {
+			this->rotate_right(parent);
+		} else {
+			this->rotate_left(parent);
+		}
 	}
 
-	return smallest;
+	return median;
 }
 
 template <class Node, class Options, class Tag, class Compare>
-Node *
-EnergyTree<Node, Options, Tag, Compare>::get_largest() const
+void
+EnergyTree<Node, Options, Tag, Compare>::rotate_left(Node * parent) noexcept
 {
-	Node * largest = this->root;
-	if (largest == nullptr) {
-		return nullptr;
-	}
+	Node * right_child = parent->NB::get_right();
+	Node * inner = right_child->NB::get_left();
 
-	while (largest->NB::_et_right != nullptr) {
-		largest = largest->NB::_et_right;
+	parent->NB::set_right(inner);
+	if (inner != nullptr) {
+		inner->NB::set_parent(parent);
 	}
 
-	return largest;
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::iterator_to(const Node & node) const
-{
-	return const_iterator<false>(&node);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::iterator_to(Node & node)
-{
-	return iterator<false>(&node);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::cbegin() const
-{
-	Node * smallest = this->get_smallest();
-	if (smallest == nullptr) { // TODO what the hell?
-		return const_iterator<false>(nullptr);
+	Node * parents_parent = parent->NB::get_parent();
+	right_child->NB::set_left(parent);
+	right_child->NB::set_parent(parents_parent);
+	if (parents_parent == nullptr) {
+		this->root = right_child;
+	} else if (parents_parent->NB::get_left() == parent) {
+		parents_parent->NB::set_left(right_child);
+	} else {
+		parents_parent->NB::set_right(right_child);
 	}
+	parent->NB::set_parent(right_child);
 
-	return const_iterator<false>(smallest);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::cend() const
-{
-	return const_iterator<false>(nullptr);
+	right_child->NB::_et_size = parent->NB::_et_size;
+	parent->NB::_et_size = 1 +
+	                       ((parent->NB::get_left() != nullptr)
+	                            ? parent->NB::get_left()->NB::_et_size
+	                            : 0) +
+	                       ((inner != nullptr) ? inner->NB::_et_size : 0);
 }
 
 template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::begin() const
+void
+EnergyTree<Node, Options, Tag, Compare>::rotate_right(Node * parent) noexcept
 {
-	return this->cbegin();
-}
+	Node * left_child = parent->NB::get_left();
+	Node * inner = left_child->NB::get_right();
 
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::begin()
-{
-	Node * smallest = this->get_smallest();
-	if (smallest == nullptr) {
-		return iterator<false>(nullptr);
+	parent->NB::set_left(inner);
+	if (inner != nullptr) {
+		inner->NB::set_parent(parent);
 	}
 
-	return iterator<false>(smallest);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::end() const
-{
-	return this->cend();
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::end()
-{
-	return iterator<false>(nullptr);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<true>
-EnergyTree<Node, Options, Tag, Compare>::crbegin() const
-{
-	Node * largest = this->get_largest();
-	if (largest == nullptr) {
-		return const_iterator<true>(nullptr);
+	Node * parents_parent = parent->NB::get_parent();
+	left_child->NB::set_right(parent);
+	left_child->NB::set_parent(parents_parent);
+	if (parents_parent == nullptr) {
+		this->root = left_child;
+	} else if (parents_parent->NB::get_left() == parent) {
+		parents_parent->NB::set_left(left_child);
+	} else {
+		parents_parent->NB::set_right(left_child);
 	}
+	parent->NB::set_parent(left_child);
 
-	return const_iterator<true>(largest);
+	left_child->NB::_et_size = parent->NB::_et_size;
+	parent->NB::_et_size = 1 +
+	                       ((parent->NB::get_right() != nullptr)
+	                            ? parent->NB::get_right()->NB::_et_size
+	                            : 0) +
+	                       ((inner != nullptr) ? inner->NB::_et_size : 0);
 }
 
 template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<true>
-EnergyTree<Node, Options, Tag, Compare>::crend() const
-{
-	return const_iterator<true>(nullptr);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<true>
-EnergyTree<Node, Options, Tag, Compare>::rbegin() const
+void
+EnergyTree<Node, Options, Tag, Compare>::rebalance_subtree(Node & node)
 {
-	return this->crbegin();
+	this->rebuild_subtree_dsw(node, node.NB::_et_size,
+	                          [this](Node * n) { this->rotate_left(n); },
+	                          [this](Node * n) { this->rotate_right(n); },
+	                          [](Node * n) { n->NB::_et_energy = 0; });
 }
 
 template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<true>
-EnergyTree<Node, Options, Tag, Compare>::rend() const
+void
+EnergyTree<Node, Options, Tag, Compare>::dbg_verify() const
 {
-	return this->crend();
+	this->verify_tree();
+	this->verify_order();
+	this->verify_size();
+	this->dbg_verify_sizes();
+	this->dbg_verify_energy();
+	this->dbg_verify_queue();
 }
 
 template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<true>
-EnergyTree<Node, Options, Tag, Compare>::rbegin()
+bool
+EnergyTree<Node, Options, Tag, Compare>::verify_integrity() const
 {
-	Node * largest = this->get_largest();
-	if (largest == nullptr) {
-		return iterator<true>(nullptr);
+	try {
+		this->dbg_verify();
+	} catch (debug::VerifyException & e) {
+		return false;
 	}
 
-	return iterator<true>(largest);
-}
-
-template <class Node, class Options, class Tag, class Compare>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<true>
-EnergyTree<Node, Options, Tag, Compare>::rend()
-{
-	return iterator<true>(nullptr);
+	return true;
 }
 
 template <class Node, class Options, class Tag, class Compare>
-template <class Comparable>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::find(const Comparable & query)
+void
+EnergyTree<Node, Options, Tag, Compare>::dbg_verify_energy() const
 {
-	Node * cur = this->root;
-	Node * last_left = nullptr;
-
-	while (cur != nullptr) {
-		if (this->cmp(*cur, query)) {
-			cur = cur->NB::_et_right;
-		} else {
-			last_left = cur;
-			cur = cur->NB::_et_left;
+	for (const Node & n : *this) {
+		if (!is_unbalanced(&n)) {
+			continue;
 		}
-	}
 
-	if ((last_left != nullptr) && (!this->cmp(query, *last_left))) {
-		return iterator<false>(last_left);
-	} else {
-		return this->end();
+		// Subtrees waiting for their rebuild may be out of balance, but then the
+		// rebuild of that subtree (or of a subtree containing it) must be queued.
+		const Node * cur = &n;
+		while ((cur != nullptr) && !is_queued(cur)) {
+			cur = cur->NB::get_parent();
+		}
+		debug::yggassert(cur != nullptr);
 	}
 }
 
 template <class Node, class Options, class Tag, class Compare>
-template <class Comparable>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::find(const Comparable & query) const
-{
-	return const_iterator<false>(
-	    const_cast<std::remove_const_t<decltype(this)>>(this)->find(query));
-}
-
-template <class Node, class Options, class Tag, class Compare>
-template <class Comparable>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::lower_bound(const Comparable & query)
-{
-	Node * cur = this->root;
-	Node * last_left = nullptr;
+void
+EnergyTree<Node, Options, Tag, Compare>::dbg_verify_queue() const
+{
+	if constexpr (Options::etree_incremental_rebuild) {
+		size_t queued = 0;
+		for (size_t i = 0; i < this->rebuild_queue.size(); ++i) {
+			const Node * n = this->rebuild_queue[i];
+			if (n == nullptr) {
+				continue;
+			}
+			queued++;
+			debug::yggassert(n->NB::_et_queue_pos == i);
 
-	while (cur != nullptr) {
-		if (this->cmp(*cur, query)) {
-			cur = cur->NB::_et_right;
-		} else {
-			last_left = cur;
-			cur = cur->NB::_et_left;
+			// Must be a node of this tree
+			while (n->NB::get_parent() != nullptr) {
+				n = n->NB::get_parent();
+			}
+			debug::yggassert(n == this->root);
 		}
-	}
+		debug::yggassert(queued == this->rebuild_pending_count);
 
-	if (last_left != nullptr) {
-		return iterator<false>(last_left);
+		for (const Node & n : *this) {
+			if (is_queued(&n)) {
+				debug::yggassert(n.NB::_et_queue_pos < this->rebuild_queue.size());
+				debug::yggassert(this->rebuild_queue[n.NB::_et_queue_pos] == &n);
+			}
+		}
 	} else {
-		return this->end();
+		debug::yggassert(this->rebuild_queue.empty());
 	}
 }
 
 template <class Node, class Options, class Tag, class Compare>
-template <class Comparable>
-typename EnergyTree<Node, Options, Tag, Compare>::template iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::upper_bound(const Comparable & query)
+void
+EnergyTree<Node, Options, Tag, Compare>::dbg_verify_sizes() const
 {
-	Node * cur = this->root;
-	Node * last_left = nullptr;
-
-	while (cur != nullptr) {
-		if (this->cmp(query, *cur)) {
-			last_left = cur;
-			cur = cur->_et_left;
-		} else {
-			cur = cur->_et_right;
+	for (const Node & n : *this) {
+		size_t left_size = 0;
+		if (n.NB::get_left() != nullptr) {
+			left_size = n.NB::get_left()->NB::_et_size;
+		}
+		size_t right_size = 0;
+		if (n.NB::get_right() != nullptr) {
+			right_size = n.NB::get_right()->NB::_et_size;
 		}
-	}
 
-	if (last_left != nullptr) {
-		return iterator<false>(last_left);
-	} else {
-		return this->end();
+		debug::yggassert(n.NB::_et_size == left_size + right_size + 1);
 	}
 }
-
-template <class Node, class Options, class Tag, class Compare>
-template <class Comparable>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::upper_bound(
-    const Comparable & query) const
-{
-	return const_iterator<false>(const_cast<MyClass *>(this)->upper_bound(query));
-}
-
-template <class Node, class Options, class Tag, class Compare>
-template <class Comparable>
-typename EnergyTree<Node, Options, Tag, Compare>::template const_iterator<false>
-EnergyTree<Node, Options, Tag, Compare>::lower_bound(
-    const Comparable & query) const
-{
-	return const_iterator<false>(const_cast<MyClass *>(this)->lower_bound(query));
-}
-
-template <class Node, class Options, class Tag, class Compare>
-size_t
-EnergyTree<Node, Options, Tag, Compare>::size() const
-{
-	return this->s.get();
-}
-
-template <class Node, class Options, class Tag, class Compare>
-void
-EnergyTree<Node, Options, Tag, Compare>::clear()
-{
-	this->root = nullptr;
-	this->s.set(0);
-}
-
 } // namespace ygg
 
 #endif // YGG_ENERGY_CPP
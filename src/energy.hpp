@@ -1,129 +1,131 @@
 #ifndef YGG_ENERGY_HPP
 #define YGG_ENERGY_HPP
 
-#include <vector>
-
+#include "bst.hpp"
+#include "debug.hpp"
 #include "options.hpp"
 #include "size_holder.hpp"
 #include "tree_iterator.hpp"
 
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 namespace ygg {
 
-template <class Node, class Options = DefaultOptions, class Tag = int>
-class EnergyTreeNodeBase {
+namespace energy_internal {
+/// @cond INTERNAL
+
+/*
+ * With ETREE_INCREMENTAL_REBUILD, every node knows its position in the rebuild
+ * queue of the tree. Without it, this takes no space.
+ */
+template <class Tag, bool incremental>
+class EnergyTreeQueueSlot {};
+
+template <class Tag>
+class EnergyTreeQueueSlot<Tag, true> {
 public:
-	Node * _et_left;
-	Node * _et_right;
-	Node * _et_parent;
+	size_t _et_queue_pos;
+};
 
+/// @endcond
+} // namespace energy_internal
+
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the Energy Balanced Tree *must* derive from
+ * this class (template). It supplies your class with the necessary members to
+ * contain the linking between the tree nodes, the subtree size and the energy.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam options  The options class (a version of TreeOptions) that you
+ * parameterize the tree with. (See the options parameter of RBTree.)
+ * @tparam Tag 		The tag used to identify the tree that this node should
+ * be inserted into. See RBTree for details.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class EnergyTreeNodeBase
+    : public bst::BSTNodeBase<Node, Options, Tag>,
+      public energy_internal::EnergyTreeQueueSlot<
+          Tag, Options::etree_incremental_rebuild> {
+public:
 	size_t _et_size;
 	size_t _et_energy;
-
-	// Debugging
-	size_t get_depth() const noexcept;
 };
 
+/**
+ * @brief The Energy Balanced Tree
+ *
+ * Every node stores the size of its subtree and an energy, which counts the
+ * insertions and deletions that passed through the node since its subtree was
+ * last rebuilt. As soon as the energy of a node exceeds a fraction of its
+ * subtree size (one half by default, see ETREE_ENERGY_NUMERATOR and
+ * ETREE_ENERGY_DENOMINATOR), the subtree is rebuilt into a perfectly balanced
+ * tree. See ETREE_INCREMENTAL_REBUILD to bound the cost of a single operation.
+ *
+ * Searching, iteration etc. are provided by the BinarySearchTree base class,
+ * thus options like MICRO_PREFETCH and MICRO_AVOID_CONDITIONALS apply.
+ *
+ * @tparam Node         The node class for this tree. It must be derived from
+ * EnergyTreeNodeBase.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this tree. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies this tree. Can be used
+ * to insert the same nodes into multiple trees. Can be any class, the class can
+ * be empty.
+ * @tparam Compare      A compare class. The tree follows STL semantics for
+ * 'Compare'. Defaults to ygg::utilities::flexible_less. Implement
+ * operator<(const Node & lhs, const Node & rhs) if you want to use it.
+ */
 template <class Node, class Options = DefaultOptions, class Tag = int,
           class Compare = ygg::utilities::flexible_less>
-class EnergyTree {
+class EnergyTree : public bst::BinarySearchTree<Node, Options, Tag, Compare> {
+public:
 	using MyClass = EnergyTree<Node, Options, Tag, Compare>;
+	// Node Base
 	using NB = EnergyTreeNodeBase<Node, Options, Tag>;
-
+	using TB = bst::BinarySearchTree<Node, Options, Tag, Compare>;
 	static_assert(std::is_base_of<NB, Node>::value,
 	              "Node class not properly derived from EnergyTreeNodeBase");
 
-public:
-	EnergyTree();
-	EnergyTree(MyClass && other);
-	MyClass & operator=(MyClass && other);
+	/**
+	 * @brief Create a new empty energy balanced tree.
+	 */
+	EnergyTree() noexcept;
 
-private:
-	/******************************************************
-	 ******************************************************
-	 *          Begin of iterator declaration
-	 ******************************************************
-	 ******************************************************/
-
-	// Class to tell the abstract search tree iterator how to handle our nodes
-	class NodeInterface {
-	public:
-		static Node *
-		get_parent(Node * n)
-		{
-			return n->NB::_et_parent;
-		}
-		static Node *
-		get_left(Node * n)
-		{
-			return n->NB::_et_left;
-		}
-		static Node *
-		get_right(Node * n)
-		{
-			return n->NB::_et_right;
-		}
-
-		static const Node *
-		get_parent(const Node * n)
-		{
-			return n->NB::_et_parent;
-		}
-		static const Node *
-		get_left(const Node * n)
-		{
-			return n->NB::_et_left;
-		}
-		static const Node *
-		get_right(const Node * n)
-		{
-			return n->NB::_et_right;
-		}
-	};
+	/**
+	 * @brief Create a new energy balanced tree from a different one.
+	 *
+	 * The other tree is moved into this one, i.e., using it afterwards is
+	 * undefined behavior.
+	 *
+	 * @param other  The tree that this one is constructed from
+	 */
+	EnergyTree(MyClass && other) noexcept;
 
-public:
-	// forward, for friendship
-	template <bool reverse>
-	class const_iterator;
+	/**
+	 * @brief Move-assign an other energy balanced tree to this one
+	 *
+	 * The other tree is moved into this one, i.e., using it afterwards is
+	 * undefined behavior.
+	 *
+	 * @param other  The tree that this one is constructed from
+	 */
+	MyClass & operator=(MyClass && other) noexcept;
 
+	/*
+	 * Pull in classes from base tree
+	 */
 	template <bool reverse>
-	class iterator : public internal::IteratorBase<iterator<reverse>, Node,
-	                                               NodeInterface, reverse> {
-	public:
-		using internal::IteratorBase<iterator<reverse>, Node, NodeInterface,
-		                             reverse>::IteratorBase;
-		iterator(const iterator<reverse> & orig)
-		    : internal::IteratorBase<iterator<reverse>, Node, NodeInterface,
-		                             reverse>(orig.n){};
-		iterator()
-		    : internal::IteratorBase<iterator<reverse>, Node, NodeInterface,
-		                             reverse>(){};
-
-	private:
-		friend class const_iterator<reverse>;
-	};
-
+	using iterator = typename TB::template iterator<reverse>;
 	template <bool reverse>
-	class const_iterator
-	    : public internal::IteratorBase<const_iterator<reverse>, const Node,
-	                                    NodeInterface, reverse> {
-	public:
-		using internal::IteratorBase<const_iterator<reverse>, const Node,
-		                             NodeInterface, reverse>::IteratorBase;
-		const_iterator(const const_iterator<reverse> & orig)
-		    : internal::IteratorBase<const_iterator<reverse>, const Node,
-		                             NodeInterface, reverse>(orig.n){};
-		const_iterator(const iterator<reverse> & orig)
-		    : internal::IteratorBase<const_iterator<reverse>, const Node,
-		                             NodeInterface, reverse>(orig.n){};
-		const_iterator()
-		    : internal::IteratorBase<const_iterator<reverse>, const Node,
-		                             NodeInterface, reverse>(){};
-	};
-	/******************************************************
-	 ******************************************************
-	 *          End of iterator declaration
-	 ******************************************************
-	 ******************************************************/
+	using const_iterator = typename TB::template const_iterator<reverse>;
 
 	/**
 	 * @brief Inserts <node> into the tree
@@ -135,203 +137,169 @@ public:
 	 * pitfall is to store nodes in a std::vector (or other STL container), which
 	 * reallocates (and thereby moves objecs around).
 	 *
-	 * @warning Not available for explicitly ordered trees
-	 *
 	 * @param   Node  The node to be inserted.
 	 */
-	void insert(Node & node);
-	void insert(Node & node, Node & hint);
-	void insert(Node & node, iterator<false> hint);
+	void insert(Node & node) CMP_NOEXCEPT(node);
 
 	/**
-	 * @brief Finds an element in the tree
-	 *
-	 * Returns an iterator to the first element that compares equally to <query>.
-	 * Note that <query> does not have to be a Node, but can be anything that can
-	 * be compared to a Node, i.e., for which
-	 *    Compare()(const Node &, const Comparable &)
-	 * and
-	 *    Compare()(const Comparable &, const Node &)
-	 * are defined and implemented. In the case of using the default
-	 * ygg::utilities::flexible_less as Compare, that means you have to implement
-	 * operator<() for both types.
+	 * @brief Inserts <node> into the tree, starting the search at <hint>
 	 *
-	 * @warning Not available for explicitly ordered trees
+	 * If <hint> is close to where <node> belongs, this saves comparisons. The
+	 * sizes and energies along the path to the root must still be updated.
 	 *
-	 * @param query An object comparing equally to the element that should be
-	 * found.
-	 * @returns An iterator to the first element comparing equally to <query>, or
-	 * end() if no such element exists
+	 * @param node  The node to be inserted.
+	 * @param hint  A node in the tree close to the position of <node>.
 	 */
-	template <class Comparable>
-	const_iterator<false> find(const Comparable & query) const;
-	template <class Comparable>
-	iterator<false> find(const Comparable & query);
+	void insert(Node & node, Node & hint) CMP_NOEXCEPT(node);
+	void insert(Node & node, iterator<false> hint) CMP_NOEXCEPT(node);
 
 	/**
-	 * @brief Upper-bounds an element
-	 *
-	 * Returns an iterator to the smallest element to which <query> compares as
-	 * "less", i.e. the smallest element that is considered go strictly after
-	 * <query>.
-	 *
-	 * Note that <query> does not have to be a Node, but can be anything that can
-	 * be compared to a Node, i.e., for which
-	 *    Compare()(const Node &, const Comparable &)
-	 * and
-	 *    Compare()(const Comparable &, const Node &)
-	 * are defined and implemented. In the case of using the default
-	 * ygg::utilities::flexible_less as Compare, that means you have to implement
-	 * operator<() for both types.
+	 * @brief Removes <node> from the tree
 	 *
-	 * @warning Not available for explicitly ordered trees
+	 * Removes <node> from the tree.
 	 *
-	 * @param query An object comparable to Node that should be upper-bounded
-	 * @returns An iterator to the first element comparing "greater" to <query>,
-	 * or end() if no such element exists
+	 * @param   Node  The node to be removed.
 	 */
-	template <class Comparable>
-	const_iterator<false> upper_bound(const Comparable & query) const;
-	template <class Comparable>
-	iterator<false> upper_bound(const Comparable & query);
+	void remove(Node & node) CMP_NOEXCEPT(node);
 
 	/**
-	 * @brief Lower-bounds an element
+	 * @brief Deletes a node that compares equally to <c>
+	 *
+	 * @warning The behavior of this method strongly depends on whether the
+	 * STL_ERASE option is set or not!
 	 *
-	 * Returns an iterator to the first element that is not less that <query>,
-	 * i.e., that does not have to go before <query>.
+	 * If STL_ERASE is set, this method removes *all* nodes that compare equally
+	 * to c from the tree and returns the number of nodes removed.
 	 *
-	 * Note that <query> does not have to be a Node, but can be anything that can
-	 * be compared to a Node, i.e., for which
-	 *    Compare()(const Node &, const Comparable &)
-	 * and
-	 *    Compare()(const Comparable &, const Node &)
-	 * are defined and implemented. In the case of using the default
-	 * ygg::utilities::flexible_less as Compare, that means you have to implement
-	 * operator<() for both types.
+	 * If STL_ERASE is not set, it removes only one node and returns a pointer to
+	 * the removed node.
 	 *
-	 * @warning Not available for explicitly ordered trees
+	 * @param  c Anything comparable to a node. A node (resp. all nodes, see
+	 * above) that compares equally will be removed
 	 *
-	 * @param query An object comparable to Node that should be lower-bounded
-	 * @returns An iterator to the first element comparing greater-or-equally to
-	 * <query>, or end() if no such element exists
+	 * @return If STL_ERASE is unset: A pointer to the node that has been removed,
+	 * or nullptr if no node was removed. If STL_ERASE is set: The number of
+	 * erased nodes.
 	 */
 	template <class Comparable>
-	const_iterator<false> lower_bound(const Comparable & query) const;
-	template <class Comparable>
-	iterator<false> lower_bound(const Comparable & query);
-
-	
-	// Iteration
-	/**
-	 * Returns an iterator pointing to the smallest element in the tree.
-	 */
-	const_iterator<false> cbegin() const;
-	/**
-	 * Returns an iterator pointing after the largest element in the tree.
-	 */
-	const_iterator<false> cend() const;
-	/**
-	 * Returns an iterator pointing to the smallest element in the tree.
-	 */
-	const_iterator<false> begin() const;
-	iterator<false> begin();
-
-	/**
-	 * Returns an iterator pointing after the largest element in the tree.
-	 */
-	const_iterator<false> end() const;
-	iterator<false> end();
+	utilities::select_type_t<size_t, Node *, Options::stl_erase>
+	erase(const Comparable & c) CMP_NOEXCEPT(c);
 
 	/**
-	 * Returns an reverse iterator pointing to the largest element in the tree.
-	 */
-	const_iterator<true> crbegin() const;
-	/**
-	 * Returns an reverse iterator pointing before the smallest element in the
-	 * tree.
-	 */
-	const_iterator<true> crend() const;
-	/**
-	 * Returns an reverse iterator pointing to the largest element in the tree.
+	 * @brief Deletes a node by iterator
+	 *
+	 * @warning The return type of this method depends on whether the
+	 * STL_ERASE option is set or not!
+	 *
+	 * @return If STL_ERASE is unset: A pointer to the node that has been removed.
+	 * If STL_ERASE is set: An iterator to the node after the removed node (or
+	 * end()).
 	 */
-	const_iterator<true> rbegin() const;
-	iterator<true> rbegin();
+	template <bool reverse>
+	utilities::select_type_t<const iterator<reverse>, Node *, Options::stl_erase>
+	erase(const iterator<reverse> & it) CMP_NOEXCEPT(*it);
 
 	/**
-	 * Returns an reverse iterator pointing before the smallest element in the
-	 * tree.
+	 * @brief Removes all elements from the tree.
+	 *
+	 * Removes all elements from the tree.
 	 */
-	const_iterator<true> rend() const;
-	iterator<true> rend();
+	void clear() noexcept;
 
 	/**
-	 * Returns an iterator pointing to the entry held in node.
+	 * @brief Returns the number of nodes in the subtree rooted at <n>
 	 *
-	 * @param node  The node the iterator should point to.
+	 * This method runs in O(1).
 	 */
-	const_iterator<false> iterator_to(const Node & node) const;
-	iterator<false> iterator_to(Node & node);
+	static size_t get_subtree_size(const Node * n) noexcept;
 
 	/**
-	 * @brief Removes <node> from the tree
+	 * @brief Rebuilds the subtree rooted at <node> into a balanced tree
 	 *
-	 * Removes <node> from the tree.
+	 * The subtree is rebuilt in place using the Day-Stout-Warren algorithm, i.e.,
+	 * in O(m) time for a subtree of m nodes and with O(1) additional memory. The
+	 * energy of all nodes in the subtree is reset. This is what the tree does by
+	 * itself whenever a subtree gets out of balance.
 	 *
-	 * @param   Node  The node to be removed.
+	 * @param node  The root of the subtree to be rebuilt
 	 */
-	void remove(Node & node);
+	void rebalance_subtree(Node & node);
 
 	/**
-	 * @brief Removes all elements from the tree.
+	 * @brief Returns whether scheduled subtree rebuilds are pending
 	 *
-	 * Removes all elements from the tree.
+	 * Always false unless ETREE_INCREMENTAL_REBUILD is set.
 	 */
-	void clear();
+	bool rebuild_pending() const noexcept;
 
 	/**
-	 * Return the number of elements in the tree.
-	 *
-	 * This method runs in O(1).
-	 *
-	 * @warning This method is only available if CONSTANT_TIME_SIZE is set as
-	 * option!
-	 *
-	 * @return The number of elements in the tree.
-	 */
-	size_t size() const;
-	
-	/**
-	 * @brief Returns whether the tree is empty
-	 *
-	 * This method runs in O(1).
+	 * @brief Completes all scheduled subtree rebuilds
 	 *
-	 * @return true if the tree is empty, false otherwise
+	 * Only useful if ETREE_INCREMENTAL_REBUILD is set, e.g. to do the pending
+	 * work at a point in time where latency does not matter.
 	 */
-	bool empty() const;
+	void finish_rebuild();
 
+	// Mainly debugging methods
+	/// @cond INTERNAL
 	void dbg_verify() const;
 	bool verify_integrity() const;
+	/// @endcond
 
 private:
-	void rebuild_below(Node * node);
-	Node * get_smallest() const;
-	Node * get_largest() const;
+	[[gnu::always_inline]] static inline bool
+	is_unbalanced(const Node * n) noexcept;
 
-	Node * root;
-	Compare cmp;
-	SizeHolder<Options::constant_time_size> s;
+	/*
+	 * Descends from <start> and links <node> as a leaf, updating sizes and
+	 * energies of all nodes from the root to the new leaf. <start> must be the
+	 * root of a subtree that <node> belongs into.
+	 */
+	void insert_leaf_base(Node & node, Node * start) CMP_NOEXCEPT(node);
+
+	/*
+	 * Rebuilds (or schedules the rebuild of) the subtree rooted at <unbalanced>,
+	 * which may be nullptr. Also performs the incremental rebuild steps. The
+	 * amount of work is tied to <energy_added>, the number of nodes whose energy
+	 * the operation has increased.
+	 */
+	void handle_imbalance(Node * unbalanced, size_t energy_added);
 
-	std::vector<Node *> rebuild_buffer;
+	void rotate_left(Node * parent) noexcept;
+	void rotate_right(Node * parent) noexcept;
+
+	/*
+	 * Incremental rebuilding: The queue holds roots of subtrees that still need
+	 * to be rebuilt. A rebuild step lifts the median of one such subtree to its
+	 * root and queues the two halves. Every queued node stores its position in
+	 * the queue. Entries of nodes that left the queue otherwise are set to
+	 * nullptr and skipped.
+	 */
+	static constexpr size_t NOT_QUEUED = std::numeric_limits<size_t>::max();
+
+	[[gnu::always_inline]] static inline bool
+	is_queued(const Node * n) noexcept;
+	// Whether <n> should be scheduled, i.e., is unbalanced and not yet queued
+	[[gnu::always_inline]] static inline bool
+	needs_rebuild(const Node * n) noexcept;
+	void schedule_rebuild(Node * node);
+	void unschedule_rebuild(Node * node) noexcept;
+	void rebuild_steps(size_t steps);
+	Node * lift_median(Node * node) noexcept;
+
+	std::vector<Node *> rebuild_queue;
+	// The number of non-nullptr entries in the queue
+	size_t rebuild_pending_count;
 
 	void dbg_verify_sizes() const;
 	void dbg_verify_energy() const;
-	void dbg_verify_tree(Node * node = nullptr) const;
-	void dbg_verify_size() const;
+	void dbg_verify_queue() const;
 };
 
 } // namespace ygg
 
+#ifndef YGG_ENERGY_CPP
 #include "energy.cpp"
+#endif
 
 #endif // YGG_ENERGY_HPP
@@ -0,0 +1,196 @@
+#ifndef YGG_FLAT_COMBINING_TREE_CPP
+#define YGG_FLAT_COMBINING_TREE_CPP
+
+#include "flat_combining_tree.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace ygg {
+
+template <class Tree, class Compare>
+FlatCombiningTree<Tree, Compare>::FlatCombiningTree()
+    : t(), cmp(), combined_batches(0)
+{
+	for (auto & record : this->records) {
+		record.claimed.store(false, std::memory_order_relaxed);
+		record.op.store(Operation::NONE, std::memory_order_relaxed);
+		record.node = nullptr;
+	}
+	this->batch_inserts.reserve(SLOTS);
+	this->batch_removes.reserve(SLOTS);
+}
+
+template <class Tree, class Compare>
+typename FlatCombiningTree<Tree, Compare>::Record &
+FlatCombiningTree<Tree, Compare>::claim_record() noexcept
+{
+	// Usually, every thread finds its own record free. Only with more than
+	// SLOTS threads do we have to look for another one.
+	size_t index = utilities::get_thread_index() % SLOTS;
+	while (true) {
+		Record & record = this->records[index];
+		if (!record.claimed.load(std::memory_order_relaxed) &&
+		    !record.claimed.exchange(true, std::memory_order_acquire)) {
+			return record;
+		}
+		index = (index + 1) % SLOTS;
+		utilities::cpu_relax();
+	}
+}
+
+template <class Tree, class Compare>
+void
+FlatCombiningTree<Tree, Compare>::publish_and_wait(Node & node, Operation op)
+{
+	Record & record = this->claim_record();
+	record.node = &node;
+	record.op.store(op, std::memory_order_release);
+
+	size_t spins = 0;
+	while (record.op.load(std::memory_order_acquire) != Operation::NONE) {
+		if (this->combiner_mutex.try_lock()) {
+			this->combine();
+			this->combiner_mutex.unlock();
+		} else if (++spins < 64) {
+			utilities::cpu_relax();
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	record.claimed.store(false, std::memory_order_release);
+}
+
+template <class Tree, class Compare>
+void
+FlatCombiningTree<Tree, Compare>::combine()
+{
+	// Requests that are published while we are combining are picked up by
+	// further passes, up to a limit so that the combiner can return eventually.
+	constexpr size_t MAX_PASSES = 3;
+
+	for (size_t pass = 0; pass < MAX_PASSES; ++pass) {
+		this->batch_inserts.clear();
+		this->batch_removes.clear();
+
+		for (auto & record : this->records) {
+			switch (record.op.load(std::memory_order_acquire)) {
+			case Operation::INSERT:
+				this->batch_inserts.push_back(&record);
+				break;
+			case Operation::REMOVE:
+				this->batch_removes.push_back(&record);
+				break;
+			case Operation::NONE:
+			default:
+				break;
+			}
+		}
+
+		if (this->batch_inserts.empty() && this->batch_removes.empty()) {
+			break;
+		}
+		this->combined_batches++;
+
+		// A node can not have an insertion and a removal pending at the same
+		// time, so the order between the two does not matter.
+		for (Record * record : this->batch_removes) {
+			this->t.remove(*record->node);
+		}
+
+		std::sort(this->batch_inserts.begin(), this->batch_inserts.end(),
+		          [&](const Record * lhs, const Record * rhs) {
+			          return this->cmp(*lhs->node, *rhs->node);
+		          });
+		Node * previous = nullptr;
+		for (Record * record : this->batch_inserts) {
+			if constexpr (flat_combining_internal::has_hinted_insert<Tree,
+			                                                         Node>::value) {
+				if (previous != nullptr) {
+					this->t.insert(*record->node, *previous);
+				} else {
+					this->t.insert(*record->node);
+				}
+			} else {
+				this->t.insert(*record->node);
+			}
+			previous = record->node;
+		}
+
+		for (Record * record : this->batch_removes) {
+			record->op.store(Operation::NONE, std::memory_order_release);
+		}
+		for (Record * record : this->batch_inserts) {
+			record->op.store(Operation::NONE, std::memory_order_release);
+		}
+	}
+}
+
+template <class Tree, class Compare>
+void
+FlatCombiningTree<Tree, Compare>::insert(Node & node)
+{
+	this->publish_and_wait(node, Operation::INSERT);
+}
+
+template <class Tree, class Compare>
+void
+FlatCombiningTree<Tree, Compare>::remove(Node & node)
+{
+	this->publish_and_wait(node, Operation::REMOVE);
+}
+
+template <class Tree, class Compare>
+template <class Comparable>
+typename FlatCombiningTree<Tree, Compare>::Node *
+FlatCombiningTree<Tree, Compare>::find(const Comparable & query)
+{
+	std::lock_guard<std::mutex> lock(this->combiner_mutex);
+	auto it = this->t.find(query);
+	if (it == this->t.end()) {
+		return nullptr;
+	}
+	return &*it;
+}
+
+template <class Tree, class Compare>
+size_t
+FlatCombiningTree<Tree, Compare>::size()
+{
+	std::lock_guard<std::mutex> lock(this->combiner_mutex);
+	return this->t.size();
+}
+
+template <class Tree, class Compare>
+bool
+FlatCombiningTree<Tree, Compare>::empty()
+{
+	std::lock_guard<std::mutex> lock(this->combiner_mutex);
+	return this->t.empty();
+}
+
+template <class Tree, class Compare>
+Tree &
+FlatCombiningTree<Tree, Compare>::get_tree() noexcept
+{
+	return this->t;
+}
+
+template <class Tree, class Compare>
+void
+FlatCombiningTree<Tree, Compare>::dbg_verify() const
+{
+	this->t.dbg_verify();
+}
+
+template <class Tree, class Compare>
+size_t
+FlatCombiningTree<Tree, Compare>::dbg_get_combined_batches() const noexcept
+{
+	return this->combined_batches;
+}
+
+} // namespace ygg
+
+#endif // YGG_FLAT_COMBINING_TREE_CPP
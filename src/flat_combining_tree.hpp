@@ -0,0 +1,179 @@
+#ifndef YGG_FLAT_COMBINING_TREE_HPP
+#define YGG_FLAT_COMBINING_TREE_HPP
+
+#include "concurrent_read_tree.hpp"
+#include "options.hpp"
+#include "util.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace ygg {
+
+namespace flat_combining_internal {
+/// @cond INTERNAL
+
+enum class Operation : uint8_t
+{
+	NONE,
+	INSERT,
+	REMOVE
+};
+
+/*
+ * A publication record. A thread claims one of these, writes its request into
+ * it and then waits until some combiner has set the operation back to NONE.
+ */
+template <class Node>
+struct alignas(64) Record
+{
+	std::atomic<bool> claimed;
+	std::atomic<Operation> op;
+	Node * node;
+};
+
+template <class Tree, class Node, class = void>
+struct has_hinted_insert : std::false_type
+{
+};
+
+template <class Tree, class Node>
+struct has_hinted_insert<
+    Tree, Node,
+    std::void_t<decltype(std::declval<Tree &>().insert(std::declval<Node &>(),
+                                                       std::declval<Node &>()))>>
+    : std::true_type
+{
+};
+
+/// @endcond
+} // namespace flat_combining_internal
+
+/**
+ * @brief A tree that many threads can write to, using flat combining
+ *
+ * This class wraps a tree (e.g., an RBTree or a WBTree) such that many threads
+ * can call insert() and remove() concurrently. Instead of every thread taking a
+ * lock and modifying the tree itself (which makes the tree's nodes bounce
+ * between the CPUs' caches), threads publish their requests in per-thread
+ * slots. Whichever thread gets hold of the lock (the "combiner") collects all
+ * pending requests, sorts them and applies them to the tree in one go. The
+ * other threads just wait for their request to be done.
+ *
+ * If the tree supports hinted insertion (i.e., an insert(Node &, Node &)
+ * method, like RBTree), the combiner inserts every node of the sorted batch
+ * with its predecessor in the batch as hint, which makes inserting runs of
+ * consecutive keys much cheaper.
+ *
+ * Searches simply take the combiner lock.
+ *
+ * @tparam Tree     The tree to be wrapped, e.g., an RBTree.
+ * @tparam Compare  The compare class used to sort a batch of insertions. Must
+ * be the same as the tree's compare class. Defaults to
+ * ygg::utilities::flexible_less.
+ */
+template <class Tree, class Compare = ygg::utilities::flexible_less>
+class FlatCombiningTree {
+public:
+	using Node = concurrent_read_internal::tree_node_t<Tree>;
+	using MyClass = FlatCombiningTree<Tree, Compare>;
+
+	static constexpr size_t SLOTS = 64;
+
+	/**
+	 * @brief Constructs a new flat combining wrapper around an empty tree
+	 */
+	FlatCombiningTree();
+
+	// Trees that are shared between threads may not move.
+	FlatCombiningTree(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * Returns after <node> has been inserted, either by this thread or by
+	 * another thread acting as combiner.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * Returns after <node> has been removed, either by this thread or by
+	 * another thread acting as combiner.
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Finds an element in the tree
+	 *
+	 * Takes the combiner lock. See Tree::find() for the semantics.
+	 *
+	 * @param query An object comparing equally to the element that should be
+	 * found.
+	 * @return A pointer to the found node or nullptr if no such node exists.
+	 */
+	template <class Comparable>
+	Node * find(const Comparable & query);
+
+	/**
+	 * @brief Returns the number of elements in the tree
+	 *
+	 * Takes the combiner lock. Only available if the wrapped tree offers size().
+	 */
+	size_t size();
+
+	/**
+	 * @brief Returns whether the tree is empty
+	 *
+	 * Takes the combiner lock.
+	 */
+	bool empty();
+
+	/**
+	 * @brief Returns the wrapped tree
+	 *
+	 * @warning Accessing the tree via this reference is not synchronized at
+	 * all. Use only when no other thread is using the tree.
+	 */
+	Tree & get_tree() noexcept;
+
+	// Debugging methods. These must not be called concurrently with anything.
+	void dbg_verify() const;
+	size_t dbg_get_combined_batches() const noexcept;
+
+private:
+	using Record = flat_combining_internal::Record<Node>;
+	using Operation = flat_combining_internal::Operation;
+
+	void publish_and_wait(Node & node, Operation op);
+	Record & claim_record() noexcept;
+	void combine();
+
+	Tree t;
+	Compare cmp;
+
+	std::mutex combiner_mutex;
+	Record records[SLOTS];
+
+	// Only ever used by the combiner
+	std::vector<Record *> batch_inserts;
+	std::vector<Record *> batch_removes;
+	size_t combined_batches;
+};
+
+} // namespace ygg
+
+#ifndef YGG_FLAT_COMBINING_TREE_CPP
+#include "flat_combining_tree.cpp"
+#endif
+
+#endif // YGG_FLAT_COMBINING_TREE_HPP
@@ -0,0 +1,263 @@
+#ifndef YGG_HASH_ACCELERATED_CPP
+#define YGG_HASH_ACCELERATED_CPP
+
+#include "hash_accelerated.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ygg {
+
+template <class Tree, class KeyGetter, class Hasher>
+HashAccelerated<Tree, KeyGetter, Hasher>::HashAccelerated()
+    : entries(0), shift(64)
+{}
+
+template <class Tree, class KeyGetter, class Hasher>
+uint64_t
+HashAccelerated<Tree, KeyGetter, Hasher>::hash_key(const Key & key) const
+{
+	// The highest bits select the home slot.
+	return utilities::mix_hash(static_cast<uint64_t>(this->hasher(key)));
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+size_t
+HashAccelerated<Tree, KeyGetter, Hasher>::get_home(uint64_t hash) const
+    noexcept
+{
+	return static_cast<size_t>(hash >> this->shift);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+size_t
+HashAccelerated<Tree, KeyGetter, Hasher>::find_slot(const Key & key,
+                                                    uint64_t hash) const
+{
+	const size_t mask = this->table.size() - 1;
+	size_t index = this->get_home(hash);
+	while (this->table[index].node != nullptr) {
+		if ((this->table[index].hash == hash) &&
+		    (KeyGetter::get_key(*this->table[index].node) == key)) {
+			break;
+		}
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::erase_slot(size_t index) noexcept
+{
+	// Linear probing with backward shifting: Move every following entry of the
+	// cluster into the hole, unless that would put it before its home slot.
+	const size_t mask = this->table.size() - 1;
+	size_t hole = index;
+	size_t cur = (hole + 1) & mask;
+	while (this->table[cur].node != nullptr) {
+		const size_t home = this->get_home(this->table[cur].hash);
+		// Can the entry at cur be moved to hole, i.e., is home not in (hole, cur]?
+		const bool stays = (hole <= cur) ? ((hole < home) && (home <= cur))
+		                                 : ((hole < home) || (home <= cur));
+		if (!stays) {
+			this->table[hole] = this->table[cur];
+			hole = cur;
+		}
+		cur = (cur + 1) & mask;
+	}
+	this->table[hole].node = nullptr;
+	this->entries--;
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::rehash(size_t capacity)
+{
+	std::vector<Slot> old_table(capacity, Slot{0, nullptr});
+	std::swap(old_table, this->table);
+
+	this->shift = 64;
+	while ((size_t{1} << (64 - this->shift)) < capacity) {
+		this->shift--;
+	}
+
+	const size_t mask = capacity - 1;
+	for (const Slot & slot : old_table) {
+		if (slot.node != nullptr) {
+			size_t index = this->get_home(slot.hash);
+			while (this->table[index].node != nullptr) {
+				index = (index + 1) & mask;
+			}
+			this->table[index] = slot;
+		}
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::insert(Node & node)
+{
+	// Keep the load factor below 3/4
+	if ((this->entries + 1) * 4 > this->table.size() * 3) {
+		this->rehash(std::max(MIN_CAPACITY, this->table.size() * 2));
+	}
+
+	this->t.insert(node);
+
+	const uint64_t hash = this->hash_key(KeyGetter::get_key(node));
+	const size_t index = this->find_slot(KeyGetter::get_key(node), hash);
+	// If there already is a node with this key, it stays the one in the table
+	if (this->table[index].node == nullptr) {
+		this->table[index] = Slot{hash, &node};
+		this->entries++;
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::remove(Node & node)
+{
+	const uint64_t hash = this->hash_key(KeyGetter::get_key(node));
+	const size_t index = this->find_slot(KeyGetter::get_key(node), hash);
+	assert(this->table[index].node != nullptr);
+
+	if (this->table[index].node == &node) {
+		// Another node with the same key takes the place of <node> in the table
+		Node * replacement = this->get_equal_key_neighbor(node);
+		if (replacement != nullptr) {
+			this->table[index].node = replacement;
+		} else {
+			this->key_removed(index);
+		}
+	}
+
+	this->t.remove(node);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::key_removed(size_t index)
+{
+	this->erase_slot(index);
+
+	// Shrink if the load factor falls below 1/8
+	if ((this->table.size() > MIN_CAPACITY) &&
+	    (this->entries * 8 < this->table.size())) {
+		this->rehash(this->table.size() / 2);
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+typename HashAccelerated<Tree, KeyGetter, Hasher>::erase_result
+HashAccelerated<Tree, KeyGetter, Hasher>::erase(const Key & key)
+{
+	if (this->entries == 0) {
+		return erase_result{};
+	}
+
+	const size_t index = this->find_slot(key, this->hash_key(key));
+	Node * node = this->table[index].node;
+	if (node == nullptr) {
+		return erase_result{};
+	}
+
+	if constexpr (std::is_same<erase_result, Node *>::value) {
+		// Any node with <key> will do, so take the one we already know
+		this->remove(*node);
+		return node;
+	} else {
+		// With STL_ERASE, all nodes with <key> are gone afterwards
+		const erase_result count = this->t.erase(key);
+		this->key_removed(index);
+		return count;
+	}
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+typename HashAccelerated<Tree, KeyGetter, Hasher>::iterator
+HashAccelerated<Tree, KeyGetter, Hasher>::find(const Key & key)
+{
+	if (this->entries == 0) {
+		return this->t.end();
+	}
+
+	Node * node = this->table[this->find_slot(key, this->hash_key(key))].node;
+	if (node == nullptr) {
+		return this->t.end();
+	}
+	return this->t.iterator_to(*node);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+typename HashAccelerated<Tree, KeyGetter, Hasher>::const_iterator
+HashAccelerated<Tree, KeyGetter, Hasher>::find(const Key & key) const
+{
+	if (this->entries == 0) {
+		return this->t.end();
+	}
+
+	const Node * node =
+	    this->table[this->find_slot(key, this->hash_key(key))].node;
+	if (node == nullptr) {
+		return this->t.end();
+	}
+	return this->t.iterator_to(*node);
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::clear()
+{
+	this->t.clear();
+	this->table.clear();
+	this->entries = 0;
+	this->shift = 64;
+}
+
+template <class Tree, class KeyGetter, class Hasher>
+void
+HashAccelerated<Tree, KeyGetter, Hasher>::dbg_verify() const
+{
+	this->t.dbg_verify();
+
+	// Every slot must point to a node in the tree, and must be reachable from
+	// its home slot.
+	const size_t mask = this->table.size() - 1;
+	size_t used = 0;
+	for (size_t index = 0; index < this->table.size(); ++index) {
+		const Slot & slot = this->table[index];
+		if (slot.node == nullptr) {
+			continue;
+		}
+		used++;
+		debug::yggassert(slot.hash ==
+		                 this->hash_key(KeyGetter::get_key(*slot.node)));
+		for (size_t i = this->get_home(slot.hash); i != index;
+		     i = (i + 1) & mask) {
+			debug::yggassert(this->table[i].node != nullptr);
+		}
+		debug::yggassert(
+		    this->find_slot(KeyGetter::get_key(*slot.node), slot.hash) == index);
+	}
+	debug::yggassert(used == this->entries);
+
+	// Every key in the tree must be in the table
+	size_t distinct_keys = 0;
+	const Node * last = nullptr;
+	for (const auto & n : this->t) {
+		if ((last == nullptr) ||
+		    !(KeyGetter::get_key(*last) == KeyGetter::get_key(n))) {
+			distinct_keys++;
+			const_iterator found = this->find(KeyGetter::get_key(n));
+			debug::yggassert(found != this->t.end());
+			debug::yggassert(KeyGetter::get_key(*found) == KeyGetter::get_key(n));
+		}
+		last = &n;
+	}
+	debug::yggassert(distinct_keys == this->entries);
+}
+
+} // namespace ygg
+
+#endif // YGG_HASH_ACCELERATED_CPP
@@ -0,0 +1,165 @@
+#ifndef YGG_HASH_ACCELERATED_HPP
+#define YGG_HASH_ACCELERATED_HPP
+
+#include "concurrent_read_tree.hpp"
+#include "debug.hpp"
+#include "keyed_wrapper.hpp"
+#include "options.hpp"
+#include "util.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ygg {
+
+/**
+ * @brief Adds an O(1) exact-match find() to a tree
+ *
+ * This class wraps any of the binary search trees (RBTree, WBTree, ZTree,
+ * AVLTree, EnergyTree, …) and keeps an open-addressed hash table of pointers
+ * to the nodes in sync with the tree. The hash table never copies or moves your
+ * nodes, it only stores (hash, pointer) pairs. Exact-match lookups via find()
+ * are answered by the hash table, which costs about one cache miss for the
+ * table plus one for the node, instead of one cache miss per level of the
+ * tree. lower_bound(), upper_bound() and iteration keep using the tree.
+ *
+ * The nodes are hashed by their keys, which are retrieved via a KeyGetter. The
+ * keys must be equality-comparable, and two nodes must have equal keys if and
+ * only if they compare equally in the tree. The key of a node must not change
+ * while the node is in the tree.
+ *
+ * If the tree contains multiple nodes with equal keys, the hash table only
+ * points to one of them. find() then returns an iterator to that node. If it
+ * is removed, one of the remaining nodes with that key takes its place.
+ *
+ * Only modify the tree via insert(), remove() and clear() of this class, the
+ * hash table would get out of sync otherwise.
+ *
+ * @tparam Tree       The tree to be wrapped, e.g., an RBTree.
+ * @tparam KeyGetter  A class that must implement a static Key get_key(const
+ * Node &) function that returns the key of a node.
+ * @tparam Hasher     A hasher for keys, with the same interface as std::hash.
+ * Defaults to std::hash<Key>. The hash values are mixed before use, so an
+ * identity hash (like std::hash<int>) works fine.
+ */
+template <class Tree, class KeyGetter,
+          class Hasher = std::hash<std::decay_t<decltype(KeyGetter::get_key(
+              std::declval<
+                  const concurrent_read_internal::tree_node_t<Tree> &>()))>>>
+class HashAccelerated
+    : public keyed_wrapper_internal::KeyedTreeWrapper<Tree, KeyGetter> {
+public:
+	using Base = keyed_wrapper_internal::KeyedTreeWrapper<Tree, KeyGetter>;
+	using Node = typename Base::Node;
+	using Key = typename Base::Key;
+	using MyClass = HashAccelerated<Tree, KeyGetter, Hasher>;
+
+	using iterator = typename Base::iterator;
+	using const_iterator = typename Base::const_iterator;
+	using erase_result = typename Base::erase_result;
+
+	/**
+	 * @brief Creates a new, empty tree
+	 */
+	HashAccelerated();
+
+	/**
+	 * @brief Inserts <node> into the tree and the hash table
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree and the hash table
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Removes the nodes with key <key>
+	 *
+	 * This behaves like the erase() method of the wrapped tree. If the wrapped
+	 * tree uses STL_ERASE, all nodes with key <key> are removed. Otherwise, if
+	 * there are multiple nodes with key <key>, only one of them is removed.
+	 *
+	 * If there is no node with key <key>, this runs in expected O(1) and never
+	 * looks at the tree.
+	 *
+	 * @param key The key of the node(s) to be removed
+	 * @return If the wrapped tree uses STL_ERASE, the number of removed nodes.
+	 * Otherwise, a pointer to the removed node, or nullptr if there is no node
+	 * with key <key>.
+	 */
+	erase_result erase(const Key & key);
+
+	/**
+	 * @brief Finds a node with key <key> via the hash table
+	 *
+	 * This runs in expected O(1), and never looks at the tree.
+	 *
+	 * @param key The key to search for
+	 * @return An iterator to a node with key <key>, or end() if there is no
+	 * such node.
+	 */
+	iterator find(const Key & key);
+	const_iterator find(const Key & key) const;
+
+	/**
+	 * @brief Removes all elements from the tree and the hash table
+	 *
+	 * Note that the nodes are not touched.
+	 */
+	void clear();
+
+	// Debugging methods
+	void dbg_verify() const;
+
+private:
+	/*
+	 * A slot of the hash table. Empty slots have node == nullptr. The (mixed)
+	 * hash is stored such that mismatches can usually be detected without
+	 * touching the node.
+	 */
+	struct Slot
+	{
+		uint64_t hash;
+		Node * node;
+	};
+
+	static constexpr size_t MIN_CAPACITY = 16;
+
+	uint64_t hash_key(const Key & key) const;
+	size_t get_home(uint64_t hash) const noexcept;
+	// Returns the index of the slot pointing to a node with key <key>, or the
+	// index of the empty slot where the search ended.
+	size_t find_slot(const Key & key, uint64_t hash) const;
+	void erase_slot(size_t index) noexcept;
+	// Erases the slot at <index>, whose key has left the tree, and shrinks the
+	// table if it has become too sparse.
+	void key_removed(size_t index);
+	void rehash(size_t capacity);
+
+	Hasher hasher;
+
+	std::vector<Slot> table;
+	size_t entries;
+	// The table has 2^(64 - shift) slots
+	size_t shift;
+};
+
+} // namespace ygg
+
+#ifndef YGG_HASH_ACCELERATED_CPP
+#include "hash_accelerated.cpp"
+#endif
+
+#endif // YGG_HASH_ACCELERATED_HPP
@@ -35,11 +35,11 @@ ExtendedNodeTraits<Node, INB, NodeTraits>::leaf_inserted(Node & node,
 	node.INB::_it_max_upper = NodeTraits::get_upper(node);
 
 	// Propagate up
-	Node * cur = node.get_parent();
+	Node * cur = node.INB::get_parent();
 	while ((cur != nullptr) &&
 	       (cur->INB::_it_max_upper < node.INB::_it_max_upper)) {
 		cur->INB::_it_max_upper = node.INB::_it_max_upper;
-		cur = cur->get_parent();
+		cur = cur->INB::get_parent();
 	}
 }
 
@@ -50,19 +50,19 @@ ExtendedNodeTraits<Node, INB, NodeTraits>::fix_node(Node & node)
 	auto old_val = node.INB::_it_max_upper;
 	node.INB::_it_max_upper = NodeTraits::get_upper(node);
 
-	if (node.get_left() != nullptr) {
-		node.INB::_it_max_upper =
-		    std::max(node.INB::_it_max_upper, node.get_left()->INB::_it_max_upper);
+	if (node.INB::get_left() != nullptr) {
+		node.INB::_it_max_upper = std::max(
+		    node.INB::_it_max_upper, node.INB::get_left()->INB::_it_max_upper);
 	}
 
-	if (node.get_right() != nullptr) {
-		node.INB::_it_max_upper =
-		    std::max(node.INB::_it_max_upper, node.get_right()->INB::_it_max_upper);
+	if (node.INB::get_right() != nullptr) {
+		node.INB::_it_max_upper = std::max(
+		    node.INB::_it_max_upper, node.INB::get_right()->INB::_it_max_upper);
 	}
 
 	if (old_val != node.INB::_it_max_upper) {
 		// propagate up
-		Node * cur = node.get_parent();
+		Node * cur = node.INB::get_parent();
 		if (cur != nullptr) {
 			if ((cur->INB::_it_max_upper < node.INB::_it_max_upper) ||
 			    (cur->INB::_it_max_upper == old_val)) {
@@ -82,7 +82,7 @@ ExtendedNodeTraits<Node, INB, NodeTraits>::rotated_left(Node & node,
 
 	// 'node' is the node that was the old parent.
 	fix_node(node);
-	fix_node(*(node.get_parent()));
+	fix_node(*(node.INB::get_parent()));
 }
 
 template <class Node, class INB, class NodeTraits>
@@ -95,7 +95,7 @@ ExtendedNodeTraits<Node, INB, NodeTraits>::rotated_right(Node & node,
 
 	// 'node' is the node that was the old parent.
 	fix_node(node);
-	fix_node(*(node.get_parent()));
+	fix_node(*(node.INB::get_parent()));
 }
 
 template <class Node, class INB, class NodeTraits>
@@ -118,13 +118,13 @@ ExtendedNodeTraits<Node, INB, NodeTraits>::swapped(Node & n1, Node & n2,
 	(void)t;
 
 	fix_node(n1);
-	if (n1.get_parent() != nullptr) {
-		fix_node(*(n1.get_parent()));
+	if (n1.INB::get_parent() != nullptr) {
+		fix_node(*(n1.INB::get_parent()));
 	}
 
 	fix_node(n2);
-	if (n2.get_parent() != nullptr) {
-		fix_node(*(n2.get_parent()));
+	if (n2.INB::get_parent() != nullptr) {
+		fix_node(*(n2.INB::get_parent()));
 	}
 }
 
@@ -171,13 +171,13 @@ IntervalTree<Node, NodeTraits, Options, Tag>::verify_maxima(Node * n) const
 	bool valid = true;
 	auto maximum = NodeTraits::get_upper(*n);
 
-	if (n->get_right() != nullptr) {
-		maximum = std::max(maximum, n->get_right()->INB::_it_max_upper);
-		valid &= this->verify_maxima(n->get_right());
+	if (n->INB::get_right() != nullptr) {
+		maximum = std::max(maximum, n->INB::get_right()->INB::_it_max_upper);
+		valid &= this->verify_maxima(n->INB::get_right());
 	}
-	if (n->get_left() != nullptr) {
-		maximum = std::max(maximum, n->get_left()->INB::_it_max_upper);
-		valid &= this->verify_maxima(n->get_left());
+	if (n->INB::get_left() != nullptr) {
+		maximum = std::max(maximum, n->INB::get_left()->INB::_it_max_upper);
+		valid &= this->verify_maxima(n->INB::get_left());
 	}
 
 	valid &= (maximum == n->INB::_it_max_upper);
@@ -203,9 +203,10 @@ IntervalTree<Node, NodeTraits, Options, Tag>::query(const Comparable & q) const
 		return QueryResult<Comparable>(nullptr, q);
 	}
 
-	while ((cur->get_left() != nullptr) &&
-	       (cur->get_left()->INB::_it_max_upper >= NodeTraits::get_lower(q))) {
-		cur = cur->get_left();
+	while ((cur->INB::get_left() != nullptr) &&
+	       (cur->INB::get_left()->INB::_it_max_upper >=
+	        NodeTraits::get_lower(q))) {
+		cur = cur->INB::get_left();
 	}
 
 	Node * hit;
@@ -242,7 +243,7 @@ typename IntervalTree<Node, NodeTraits, Options,
                       Tag>::BaseTree::template const_iterator<false>
 IntervalTree<Node, NodeTraits, Options, Tag>::find(const Comparable & q) const
 {
-	return const_cast<std::remove_const_t<decltype(this)>>(this)->contains(q);
+	return const_cast<MyClass *>(this)->contains(q);
 }
 
 template <class Node, class NodeTraits, class Options, class Tag>
@@ -389,35 +390,35 @@ find_next_overlapping(Node * cur, const Comparable & q)
 		// We make sure that at the start of the loop, the lower of cur is smaller
 		// than the upper of q. Thus, we need to only check the upper to check for
 		// overlap.
-		if (cur->get_right() != nullptr) {
+		if (cur->INB::get_right() != nullptr) {
 			// go to smallest larger-or-equal child
-			cur = cur->get_right();
+			cur = cur->INB::get_right();
 			if (cur->INB::_it_max_upper < NodeTraits::get_lower(q)) {
 				// Prune!
 				// Nothing starting from this node can overlap b/c of upper limit.
 				// Backtrack.
-				while ((cur->get_parent() != nullptr) &&
-				       (cur->get_parent()->get_right() ==
+				while ((cur->INB::get_parent() != nullptr) &&
+				       (cur->INB::get_parent()->INB::get_right() ==
 				        cur)) { // these are the nodes which are smaller and were
 					              // already visited
-					cur = cur->get_parent();
+					cur = cur->INB::get_parent();
 				}
 
 				// go one further up
-				if (cur->get_parent() == nullptr) {
+				if (cur->INB::get_parent() == nullptr) {
 					// Backtracked out of the root
 					return nullptr;
 				} else {
 					// go up
-					cur = cur->get_parent();
+					cur = cur->INB::get_parent();
 				}
 			} else {
-				while (cur->get_left() != nullptr) {
-					cur = cur->get_left();
+				while (cur->INB::get_left() != nullptr) {
+					cur = cur->INB::get_left();
 					if (cur->INB::_it_max_upper < NodeTraits::get_lower(q)) {
 						// Prune!
 						// Nothing starting from this node can overlap. Backtrack.
-						cur = cur->get_parent();
+						cur = cur->INB::get_parent();
 						break;
 					}
 				}
@@ -425,20 +426,20 @@ find_next_overlapping(Node * cur, const Comparable & q)
 		} else {
 			// go up
 			// skip over the nodes already visited
-			while ((cur->get_parent() != nullptr) &&
-			       (cur->get_parent()->get_right() ==
+			while ((cur->INB::get_parent() != nullptr) &&
+			       (cur->INB::get_parent()->INB::get_right() ==
 			        cur)) { // these are the nodes which are smaller and were already
 				              // visited
-				cur = cur->get_parent();
+				cur = cur->INB::get_parent();
 			}
 
 			// go one further up
-			if (cur->get_parent() == nullptr) {
+			if (cur->INB::get_parent() == nullptr) {
 				// Backtracked into the root
 				return nullptr;
 			} else {
 				// go up
-				cur = cur->get_parent();
+				cur = cur->INB::get_parent();
 			}
 		}
 
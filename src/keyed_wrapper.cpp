@@ -0,0 +1,123 @@
+#ifndef YGG_KEYED_WRAPPER_CPP
+#define YGG_KEYED_WRAPPER_CPP
+
+#include "keyed_wrapper.hpp"
+
+namespace ygg {
+namespace keyed_wrapper_internal {
+
+template <class Tree, class KeyGetter>
+typename KeyedTreeWrapper<Tree, KeyGetter>::Node *
+KeyedTreeWrapper<Tree, KeyGetter>::get_equal_key_neighbor(Node & node)
+{
+	// Nodes with equal keys are neighbors in the tree. Stepping past either end
+	// of the tree yields an iterator that does not point to a node.
+	auto it = this->t.iterator_to(node);
+
+	auto next = it;
+	++next;
+	Node * successor = next.operator->();
+	if ((successor != nullptr) &&
+	    (KeyGetter::get_key(*successor) == KeyGetter::get_key(node))) {
+		return successor;
+	}
+
+	if (it == this->t.begin()) {
+		return nullptr;
+	}
+	auto prev = it;
+	--prev;
+	Node * predecessor = prev.operator->();
+	if ((predecessor != nullptr) &&
+	    (KeyGetter::get_key(*predecessor) == KeyGetter::get_key(node))) {
+		return predecessor;
+	}
+
+	return nullptr;
+}
+
+template <class Tree, class KeyGetter>
+template <class Comparable>
+typename KeyedTreeWrapper<Tree, KeyGetter>::iterator
+KeyedTreeWrapper<Tree, KeyGetter>::lower_bound(const Comparable & query)
+{
+	return this->t.lower_bound(query);
+}
+
+template <class Tree, class KeyGetter>
+template <class Comparable>
+typename KeyedTreeWrapper<Tree, KeyGetter>::const_iterator
+KeyedTreeWrapper<Tree, KeyGetter>::lower_bound(const Comparable & query) const
+{
+	return this->t.lower_bound(query);
+}
+
+template <class Tree, class KeyGetter>
+template <class Comparable>
+typename KeyedTreeWrapper<Tree, KeyGetter>::iterator
+KeyedTreeWrapper<Tree, KeyGetter>::upper_bound(const Comparable & query)
+{
+	return this->t.upper_bound(query);
+}
+
+template <class Tree, class KeyGetter>
+template <class Comparable>
+typename KeyedTreeWrapper<Tree, KeyGetter>::const_iterator
+KeyedTreeWrapper<Tree, KeyGetter>::upper_bound(const Comparable & query) const
+{
+	return this->t.upper_bound(query);
+}
+
+template <class Tree, class KeyGetter>
+typename KeyedTreeWrapper<Tree, KeyGetter>::iterator
+KeyedTreeWrapper<Tree, KeyGetter>::begin()
+{
+	return this->t.begin();
+}
+
+template <class Tree, class KeyGetter>
+typename KeyedTreeWrapper<Tree, KeyGetter>::const_iterator
+KeyedTreeWrapper<Tree, KeyGetter>::begin() const
+{
+	return this->t.begin();
+}
+
+template <class Tree, class KeyGetter>
+typename KeyedTreeWrapper<Tree, KeyGetter>::iterator
+KeyedTreeWrapper<Tree, KeyGetter>::end()
+{
+	return this->t.end();
+}
+
+template <class Tree, class KeyGetter>
+typename KeyedTreeWrapper<Tree, KeyGetter>::const_iterator
+KeyedTreeWrapper<Tree, KeyGetter>::end() const
+{
+	return this->t.end();
+}
+
+template <class Tree, class KeyGetter>
+size_t
+KeyedTreeWrapper<Tree, KeyGetter>::size() const
+{
+	return this->t.size();
+}
+
+template <class Tree, class KeyGetter>
+bool
+KeyedTreeWrapper<Tree, KeyGetter>::empty() const
+{
+	return this->t.empty();
+}
+
+template <class Tree, class KeyGetter>
+const Tree &
+KeyedTreeWrapper<Tree, KeyGetter>::get_tree() const noexcept
+{
+	return this->t;
+}
+
+} // namespace keyed_wrapper_internal
+} // namespace ygg
+
+#endif // YGG_KEYED_WRAPPER_CPP
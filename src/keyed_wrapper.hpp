@@ -0,0 +1,105 @@
+#ifndef YGG_KEYED_WRAPPER_HPP
+#define YGG_KEYED_WRAPPER_HPP
+
+#include "concurrent_read_tree.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ygg {
+namespace keyed_wrapper_internal {
+
+/**
+ * @brief Common base of the wrappers that index the keys of a tree
+ *
+ * HashAccelerated and BloomFiltered keep an additional structure over the keys
+ * of the wrapped tree. This class owns the wrapped tree and forwards all the
+ * operations that do not modify the tree to it.
+ *
+ * @tparam Tree       The tree to be wrapped, e.g., an RBTree.
+ * @tparam KeyGetter  A class that must implement a static Key get_key(const
+ * Node &) function that returns the key of a node.
+ */
+template <class Tree, class KeyGetter>
+class KeyedTreeWrapper {
+public:
+	using Node = concurrent_read_internal::tree_node_t<Tree>;
+	using Key = std::decay_t<decltype(
+	    KeyGetter::get_key(std::declval<const Node &>()))>;
+
+	using iterator = decltype(std::declval<Tree &>().begin());
+	using const_iterator = decltype(std::declval<const Tree &>().begin());
+	// What erase() returns, which depends on whether the wrapped tree uses
+	// STL_ERASE
+	using erase_result =
+	    decltype(std::declval<Tree &>().erase(std::declval<const Key &>()));
+
+	/**
+	 * @brief Lower-bounds an element in the tree
+	 *
+	 * See the lower_bound() method of the wrapped tree.
+	 */
+	template <class Comparable>
+	iterator lower_bound(const Comparable & query);
+	template <class Comparable>
+	const_iterator lower_bound(const Comparable & query) const;
+
+	/**
+	 * @brief Upper-bounds an element in the tree
+	 *
+	 * See the upper_bound() method of the wrapped tree.
+	 */
+	template <class Comparable>
+	iterator upper_bound(const Comparable & query);
+	template <class Comparable>
+	const_iterator upper_bound(const Comparable & query) const;
+
+	/**
+	 * @brief Returns an iterator to the smallest element of the tree
+	 */
+	iterator begin();
+	const_iterator begin() const;
+
+	/**
+	 * @brief Returns an iterator pointing after the largest element of the tree
+	 */
+	iterator end();
+	const_iterator end() const;
+
+	/**
+	 * @brief Returns the number of elements in the tree
+	 *
+	 * Only available if the wrapped tree offers size().
+	 */
+	size_t size() const;
+
+	/**
+	 * @brief Returns whether the tree is empty
+	 */
+	bool empty() const;
+
+	/**
+	 * @brief Returns the wrapped tree
+	 *
+	 * Only read-only access is possible, since modifying the tree directly
+	 * would not update the wrapper.
+	 */
+	const Tree & get_tree() const noexcept;
+
+protected:
+	// Returns an in-order neighbor of <node> that has the same key, or nullptr
+	// if there is none. <node> must be in the tree.
+	Node * get_equal_key_neighbor(Node & node);
+
+	Tree t;
+};
+
+} // namespace keyed_wrapper_internal
+} // namespace ygg
+
+#ifndef YGG_KEYED_WRAPPER_CPP
+#include "keyed_wrapper.cpp"
+#endif
+
+#endif // YGG_KEYED_WRAPPER_HPP
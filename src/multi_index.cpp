@@ -0,0 +1,153 @@
+#ifndef YGG_MULTI_INDEX_CPP
+#define YGG_MULTI_INDEX_CPP
+
+#include "multi_index.hpp"
+
+#include <iterator>
+#include <utility>
+
+namespace ygg {
+
+template <class Node, class... Index>
+MultiIndex<Node, Index...>::MultiIndex()
+{}
+
+template <class Node, class... Index>
+void
+MultiIndex<Node, Index...>::insert(Node & node)
+{
+	std::apply([&](auto &... index) { (index.insert(node), ...); },
+	           this->indexes);
+	this->s.add(1);
+}
+
+template <class Node, class... Index>
+void
+MultiIndex<Node, Index...>::remove(Node & node)
+{
+	std::apply([&](auto &... index) { (index.remove(node), ...); },
+	           this->indexes);
+	this->s.reduce(1);
+}
+
+template <class Node, class... Index>
+template <size_t... Is, class Fn>
+void
+MultiIndex<Node, Index...>::modify_key(Node & node, Fn && fn)
+{
+	static_assert(((Is < sizeof...(Index)) && ...), "Index out of range.");
+
+	(std::get<Is>(this->indexes).remove(node), ...);
+	fn(node);
+	(std::get<Is>(this->indexes).insert(node), ...);
+}
+
+template <class Node, class... Index>
+template <class ForwardIt>
+void
+MultiIndex<Node, Index...>::insert_batch(ForwardIt nodes_begin,
+                                         ForwardIt nodes_end)
+{
+	// One index after the other, not one node after the other
+	auto insert_all = [&](auto & idx) {
+		for (auto it = nodes_begin; it != nodes_end; ++it) {
+			idx.insert(*it);
+		}
+	};
+	std::apply([&](auto &... index) { (insert_all(index), ...); },
+	           this->indexes);
+	this->s.add(static_cast<size_t>(std::distance(nodes_begin, nodes_end)));
+}
+
+template <class Node, class... Index>
+template <class ForwardIt>
+void
+MultiIndex<Node, Index...>::remove_batch(ForwardIt nodes_begin,
+                                         ForwardIt nodes_end)
+{
+	// One index after the other, not one node after the other
+	auto remove_all = [&](auto & idx) {
+		for (auto it = nodes_begin; it != nodes_end; ++it) {
+			idx.remove(*it);
+		}
+	};
+	std::apply([&](auto &... index) { (remove_all(index), ...); },
+	           this->indexes);
+	this->s.reduce(static_cast<size_t>(std::distance(nodes_begin, nodes_end)));
+}
+
+template <class Node, class... Index>
+template <size_t... Is, class ForwardIt, class Fn>
+void
+MultiIndex<Node, Index...>::modify_key_batch(ForwardIt nodes_begin,
+                                             ForwardIt nodes_end, Fn && fn)
+{
+	static_assert(((Is < sizeof...(Index)) && ...), "Index out of range.");
+
+	auto remove_all = [&](auto & idx) {
+		for (auto it = nodes_begin; it != nodes_end; ++it) {
+			idx.remove(*it);
+		}
+	};
+	auto insert_all = [&](auto & idx) {
+		for (auto it = nodes_begin; it != nodes_end; ++it) {
+			idx.insert(*it);
+		}
+	};
+
+	(remove_all(std::get<Is>(this->indexes)), ...);
+	for (auto it = nodes_begin; it != nodes_end; ++it) {
+		fn(*it);
+	}
+	(insert_all(std::get<Is>(this->indexes)), ...);
+}
+
+template <class Node, class... Index>
+template <size_t I>
+typename MultiIndex<Node, Index...>::template index_type<I> &
+MultiIndex<Node, Index...>::get() noexcept
+{
+	return std::get<I>(this->indexes);
+}
+
+template <class Node, class... Index>
+template <size_t I>
+const typename MultiIndex<Node, Index...>::template index_type<I> &
+MultiIndex<Node, Index...>::get() const noexcept
+{
+	return std::get<I>(this->indexes);
+}
+
+template <class Node, class... Index>
+size_t
+MultiIndex<Node, Index...>::size() const noexcept
+{
+	return this->s.get();
+}
+
+template <class Node, class... Index>
+bool
+MultiIndex<Node, Index...>::empty() const noexcept
+{
+	return this->s.get() == 0;
+}
+
+template <class Node, class... Index>
+void
+MultiIndex<Node, Index...>::clear()
+{
+	std::apply([](auto &... index) { (index.clear(), ...); }, this->indexes);
+	this->s.set(0);
+}
+
+template <class Node, class... Index>
+void
+MultiIndex<Node, Index...>::dbg_verify() const
+{
+	std::apply([](const auto &... index) { (index.dbg_verify(), ...); },
+	           this->indexes);
+}
+
+} // namespace ygg
+
+#endif // YGG_MULTI_INDEX_CPP
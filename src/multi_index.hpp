@@ -0,0 +1,199 @@
+#ifndef YGG_MULTI_INDEX_HPP
+#define YGG_MULTI_INDEX_HPP
+
+#include "size_holder.hpp"
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace ygg {
+
+/**
+ * @brief Keeps the same set of nodes in several trees at once
+ *
+ * Using tags, a node can be part of several trees at the same time, each of
+ * them ordering the nodes by a different key. This class owns such a set of
+ * trees (the "indexes") and keeps them in sync: insert() and remove() insert
+ * into / remove from all of the indexes with a single call, and modify_key()
+ * changes the keys of a node while only touching the indexes that are ordered
+ * by the changed keys.
+ *
+ * Every index can be any tree with insert(Node &) and remove(Node &), e.g., an
+ * RBTree ordered by an ID, a ZTree ordered by a timestamp and an IntervalTree
+ * over a range. Every index must use its own Tag, and your node class must
+ * derive from the respective node base of every index.
+ *
+ * All indexes must accept every node. If an index does not allow multiple
+ * equal nodes (i.e., TreeFlags::MULTIPLE is not set), you must make sure that
+ * you never insert a node that compares equally to a node already in that
+ * index; it would silently be missing from that one index.
+ *
+ * Only modify the indexes via the methods of this class. You can use get() to
+ * access the indexes for searching and iterating.
+ *
+ * Example:
+ *
+ * @code
+ * using Index = MultiIndex<Node, IdTree, TimeTree>;
+ * Index index;
+ * index.insert(node);
+ * // Only the TimeTree (index 1) is ordered by the timestamp
+ * index.modify_key<1>(node, [](Node & n) { n.timestamp++; });
+ * auto it = index.get<0>().find(42);
+ * @endcode
+ *
+ * @tparam Node   The node class.
+ * @tparam Index  The tree classes that make up the indexes.
+ */
+template <class Node, class... Index>
+class MultiIndex {
+public:
+	using MyClass = MultiIndex<Node, Index...>;
+
+	static_assert(sizeof...(Index) > 0, "A MultiIndex needs at least one index.");
+
+	/**
+	 * @brief The type of the <I>-th index
+	 */
+	template <size_t I>
+	using index_type = std::tuple_element_t<I, std::tuple<Index...>>;
+
+	/**
+	 * @brief The number of indexes
+	 */
+	static constexpr size_t index_count = sizeof...(Index);
+
+	/**
+	 * @brief Creates a new MultiIndex with all indexes being empty
+	 */
+	MultiIndex();
+
+	// The nodes are linked to the indexes, which therefore may not move.
+	MultiIndex(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into all indexes
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from all indexes
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Changes the keys of <node> for some of the indexes
+	 *
+	 * Removes <node> from the indexes <Is...>, calls fn(node) and re-inserts
+	 * <node> into the indexes <Is...>. The remaining indexes are not touched, so
+	 * <fn> must not change anything that one of the remaining indexes orders
+	 * (or augments) the nodes by. If <Is...> is empty, <fn> may only change
+	 * data that none of the indexes cares about.
+	 *
+	 * @tparam Is The indexes (as in get()) that order <node> by something that
+	 * <fn> changes.
+	 * @param node The node to be modified. Must be in the MultiIndex.
+	 * @param fn   Called as fn(node) to modify the node.
+	 */
+	template <size_t... Is, class Fn>
+	void modify_key(Node & node, Fn && fn);
+
+	/**
+	 * @brief Inserts a batch of nodes into all indexes
+	 *
+	 * Inserts all nodes in [nodes_begin, nodes_end). The batch is inserted into
+	 * one index after the other, such that only one index is worked on at any
+	 * time. This keeps more of that index in the caches than calling insert()
+	 * on every single node.
+	 *
+	 * @param nodes_begin Iterator to the first node to be inserted
+	 * @param nodes_end   Iterator past the last node to be inserted
+	 */
+	template <class ForwardIt>
+	void insert_batch(ForwardIt nodes_begin, ForwardIt nodes_end);
+
+	/**
+	 * @brief Removes a batch of nodes from all indexes
+	 *
+	 * Removes all nodes in [nodes_begin, nodes_end), one index after the other.
+	 * See insert_batch().
+	 *
+	 * @param nodes_begin Iterator to the first node to be removed
+	 * @param nodes_end   Iterator past the last node to be removed
+	 */
+	template <class ForwardIt>
+	void remove_batch(ForwardIt nodes_begin, ForwardIt nodes_end);
+
+	/**
+	 * @brief Changes the keys of a batch of nodes for some of the indexes
+	 *
+	 * This is the batched version of modify_key(). All nodes in [nodes_begin,
+	 * nodes_end) are removed from the indexes <Is...> (one index after the
+	 * other), then fn() is called on every node, then all nodes are re-inserted
+	 * into the indexes <Is...>.
+	 *
+	 * @tparam Is The indexes that order the nodes by something that <fn>
+	 * changes.
+	 * @param nodes_begin Iterator to the first node to be modified
+	 * @param nodes_end   Iterator past the last node to be modified
+	 * @param fn          Called as fn(node) for every node of the batch.
+	 */
+	template <size_t... Is, class ForwardIt, class Fn>
+	void modify_key_batch(ForwardIt nodes_begin, ForwardIt nodes_end, Fn && fn);
+
+	/**
+	 * @brief Returns the <I>-th index
+	 *
+	 * Use this to search or iterate the nodes in the order of the <I>-th index.
+	 * Do not insert or remove nodes via the returned index.
+	 */
+	template <size_t I>
+	index_type<I> & get() noexcept;
+	template <size_t I>
+	const index_type<I> & get() const noexcept;
+
+	/**
+	 * @brief Returns the number of nodes in the MultiIndex
+	 *
+	 * @return The number of nodes in the MultiIndex
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Returns whether the MultiIndex is empty
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * @brief Removes all nodes from all indexes
+	 *
+	 * Only available if all indexes offer clear(). Note that the nodes are not
+	 * touched.
+	 */
+	void clear();
+
+	// Debugging methods
+	void dbg_verify() const;
+
+private:
+	std::tuple<Index...> indexes;
+	// Every index might not count its nodes, so we do it here.
+	SizeHolder<true> s;
+};
+
+} // namespace ygg
+
+#ifndef YGG_MULTI_INDEX_CPP
+#include "multi_index.cpp"
+#endif
+
+#endif // YGG_MULTI_INDEX_HPP
@@ -8,6 +8,7 @@
 #include "util.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <sstream>
@@ -90,6 +91,18 @@ public:
 	class COMPRESS_COLOR {
 	};
 
+	/**
+	 * @brief AVLTree option: Indicates that balance factors should be compressed
+	 * into the parent pointer
+	 *
+	 * The balance factor of an AVL tree node is one of -1, 0 and +1, which fits
+	 * into the two lowest bits of the parent pointer. Like COMPRESS_COLOR, this
+	 * saves a word per node (due to padding) and uses some pointer magic which is
+	 * technically not standard compliant but should work on almost all systems.
+	 */
+	class AVL_COMPRESS_BALANCE {
+	};
+
 	/**
 	 * @brief Zip Tree Option: Indicates that nodes' ranks should be derived from
 	 * a std::hash hash of the node.
@@ -117,6 +130,29 @@ public:
 		using type = T;
 	};
 
+	/**
+	 * @brief Zip Tree Option: Indicates that nodes' ranks should be compressed
+	 * into the parent pointer
+	 *
+	 * Ranks are almost always below 64, so they fit into the uppermost bits of
+	 * the parent pointer, which are unused on all common 64 bit platforms. This
+	 * removes the separate rank field from the nodes, which usually saves a whole
+	 * word per node (due to padding). Ranks are stored, thus if you derive ranks
+	 * from hashes (see ZTREE_USE_HASH), you must call update_rank() just as if
+	 * you had set ZTREE_RANK_TYPE. Ranks larger than 127 are capped at 127,
+	 * which does not affect the correctness of the tree. Setting ZTREE_RANK_TYPE
+	 * is not necessary if this option is set.
+	 *
+	 * Like COMPRESS_COLOR, this uses some pointer magic which is technically not
+	 * standard compliant but should work on almost all 64 bit systems. The
+	 * rank is stored in the upper seven bits of the parent pointer, so this
+	 * must not be used if the addresses of your nodes carry tags in these bits,
+	 * as with AArch64 top byte tagging (MTE, HWASan) or Intel LAM. Debug builds
+	 * check this.
+	 */
+	class ZTREE_COMPRESS_RANK {
+	};
+
 	/**
 	 * @brief Zip Tree Option: Supply your own hasher class to be used with
 	 * hash-based ranks.
@@ -282,6 +318,19 @@ public:
 	class WBT_SINGLE_PASS {
 	};
 
+	/**
+	 * @brief Rebalance red-black trees using the top-down instead of the
+	 *  bottom-up algorithm
+	 *
+	 * Setting this option causes RBTree::insert() and RBTree::remove() to
+	 * rebalance the tree while descending: On insertion, nodes with two red
+	 * children are split on the way down, on deletion, a red node is pushed down
+	 * towards the node that is actually unlinked. Thus, no second walk back up
+	 * to the root is necessary. Hinted insertion is not affected.
+	 */
+	class RB_SINGLE_PASS {
+	};
+
 	/**
 	 * @brief Causes the IntervalTrees's find() queries to run in O(log n)
 	 *
@@ -293,6 +342,124 @@ public:
 	class ITREE_FAST_FIND {
 	};
 
+	/**
+	 * @brief Energy Tree Option: Spread subtree rebuilds over subsequent
+	 * operations
+	 *
+	 * By default, an insertion or deletion that unbalances a subtree of the
+	 * EnergyTree rebuilds that subtree immediately, which can take O(n) time for
+	 * a single operation. With this option, the subtree is only scheduled for
+	 * rebuilding. While rebuilds are pending, every insertion or deletion then
+	 * performs rebuild steps, each of which moves the median of one subtree to
+	 * its root with O(log n) rotations. The number of steps is <steps> times
+	 * (1 + the energy the operation has added, divided by the energy
+	 * threshold), i.e., O(log n). This keeps up with the rate at which new
+	 * rebuilds can become necessary, thus the height of the tree stays in
+	 * O(log n) even while rebuilds are pending. The tree stays a valid search
+	 * tree at all times.
+	 *
+	 * @tparam steps The factor for the number of rebuild steps done per
+	 * operation. Must be at least 1.
+	 */
+	template <size_t steps>
+	class ETREE_INCREMENTAL_REBUILD {
+	public:
+		constexpr static size_t value = steps;
+	};
+
+	/**
+	 * @brief Energy Tree Option: Numerator of the energy threshold
+	 *
+	 * A subtree of the EnergyTree is rebuilt as soon as its energy exceeds
+	 * <numerator> / <denominator> times its size. Smaller thresholds keep the
+	 * tree closer to perfect balance at the cost of more frequent rebuilds.
+	 * Defaults to 1, see ETREE_ENERGY_DENOMINATOR.
+	 *
+	 * @tparam numerator The numerator of the threshold. Must be at least 1.
+	 */
+	template <size_t numerator>
+	class ETREE_ENERGY_NUMERATOR {
+	public:
+		constexpr static size_t value = numerator;
+	};
+
+	/**
+	 * @brief Energy Tree Option: Denominator of the energy threshold
+	 *
+	 * See ETREE_ENERGY_NUMERATOR. Defaults to 2, i.e., a subtree is rebuilt once
+	 * its energy exceeds half of its size.
+	 *
+	 * @tparam denominator The denominator of the threshold. Must be at least 1.
+	 */
+	template <size_t denominator>
+	class ETREE_ENERGY_DENOMINATOR {
+	public:
+		constexpr static size_t value = denominator;
+	};
+
+	/**
+	 * @brief Splay Tree Option: Use semi-splaying
+	 *
+	 * By default, every access moves the accessed node to the root of the
+	 * SplayTree (using top-down splaying). With this option, the accessed node
+	 * is semi-splayed bottom-up instead: in the zig-zig case, only the parent is
+	 * rotated upwards, and splaying continues from there. The accessed node only
+	 * moves about halfway up, but only half as many rotations are done.
+	 * Removals always splay fully.
+	 */
+	class SPLAY_SEMI {
+	};
+
+	/**
+	 * @brief Splay Tree Option: Only splay on every k-th lookup
+	 *
+	 * Splaying writes to the tree on every lookup. With this option, only every
+	 * <k>-th call to SplayTree::find() restructures the tree, all other lookups
+	 * are plain, read-only searches. Insertions and removals are not affected.
+	 *
+	 * @tparam k The lookup interval at which splaying is done. Must be at least
+	 * 1, which is the default.
+	 */
+	template <size_t k>
+	class SPLAY_EVERY {
+	public:
+		constexpr static size_t value = k;
+	};
+
+	/**
+	 * @brief B+-Tree Index Option: Number of keys per page
+	 *
+	 * Sets the number of keys that every page of an IntrusiveBTreeIndex can
+	 * hold. By default, a page holds as many keys as fit into two cache lines
+	 * (i.e., 16 64-bit keys or 32 32-bit keys). Larger pages make the index
+	 * shallower, but every page search has to look at more keys.
+	 *
+	 * @tparam n The number of keys per page. Must be at least 4.
+	 */
+	template <size_t n>
+	class BTREE_PAGE_KEYS {
+	public:
+		constexpr static size_t value = n;
+	};
+
+	/**
+	 * @brief Skip List Option: Maximum height of the towers
+	 *
+	 * Every node of a SkipList carries a tower of forward links, of which it
+	 * uses a random number. This sets the number of links that every node
+	 * stores, and thus the maximum number of levels of the skip list. Every
+	 * level holds about a quarter of the nodes of the level below it, so the
+	 * default of 16 levels suffices for about 4^16 nodes. Lower values make the
+	 * nodes smaller.
+	 *
+	 * @tparam n The maximum tower height. Must be between 1 and 32.
+	 */
+	template <size_t n>
+	class SKIPLIST_MAX_HEIGHT {
+	public:
+		constexpr static size_t value = n;
+	};
+
 	/******************************************************
 	 * Micro-Optimization Options
 	 ******************************************************/
@@ -507,13 +674,19 @@ public:
 	    OptPack::template has<TreeFlags::CONSTANT_TIME_SIZE>();
 	static constexpr bool compress_color =
 	    OptPack::template has<TreeFlags::COMPRESS_COLOR>();
+	static constexpr bool avl_compress_balance =
+	    OptPack::template has<TreeFlags::AVL_COMPRESS_BALANCE>();
 	static constexpr bool ztree_use_hash =
 	    OptPack::template has<TreeFlags::ZTREE_USE_HASH>();
 	static constexpr bool stl_erase =
 	    OptPack::template has<TreeFlags::STL_ERASE>();
-	using ztree_rank_type =
-	    typename utilities::get_type_if_present<TreeFlags::ZTREE_RANK_TYPE, void,
-	                                            Opts...>::type;
+	static constexpr bool ztree_compress_rank =
+	    OptPack::template has<TreeFlags::ZTREE_COMPRESS_RANK>();
+	using ztree_rank_type = typename utilities::get_type_if_present<
+	    TreeFlags::ZTREE_RANK_TYPE,
+	    utilities::select_type_t<TreeFlags::ZTREE_RANK_TYPE<uint8_t>, void,
+	                             ztree_compress_rank>,
+	    Opts...>::type;
 
 	template <class Node>
 	using ztree_hasher_type = typename decltype(
@@ -647,9 +820,39 @@ public:
 	static constexpr bool wbt_single_pass =
 	    OptPack::template has<TreeFlags::WBT_SINGLE_PASS>();
 
+	static constexpr bool rb_single_pass =
+	    OptPack::template has<TreeFlags::RB_SINGLE_PASS>();
+
 	static constexpr bool itree_fast_find =
 	    OptPack::template has<TreeFlags::ITREE_FAST_FIND>();
 
+	static constexpr bool etree_incremental_rebuild =
+	    utilities::get_value_if_present<TreeFlags::ETREE_INCREMENTAL_REBUILD,
+	                                    Opts...>::found;
+	static constexpr size_t etree_rebuild_steps =
+	    utilities::get_value_if_present_else_default<
+	        TreeFlags::ETREE_INCREMENTAL_REBUILD, 0, Opts...>::value;
+	static constexpr size_t etree_energy_numerator =
+	    utilities::get_value_if_present_else_default<
+	        TreeFlags::ETREE_ENERGY_NUMERATOR, 1, Opts...>::value;
+	static constexpr size_t etree_energy_denominator =
+	    utilities::get_value_if_present_else_default<
+	        TreeFlags::ETREE_ENERGY_DENOMINATOR, 2, Opts...>::value;
+
+	static constexpr bool splay_semi =
+	    OptPack::template has<TreeFlags::SPLAY_SEMI>();
+	static constexpr size_t splay_every =
+	    utilities::get_value_if_present_else_default<TreeFlags::SPLAY_EVERY, 1,
+	                                                 Opts...>::value;
+
+	static constexpr size_t btree_page_keys =
+	    utilities::get_value_if_present_else_default<TreeFlags::BTREE_PAGE_KEYS,
+	                                                 0, Opts...>::value;
+
+	static constexpr size_t skiplist_max_height =
+	    utilities::get_value_if_present_else_default<
+	        TreeFlags::SKIPLIST_MAX_HEIGHT, 16, Opts...>::value;
+
 	/**********************************************
 	 * Micro-Optimization
 	 **********************************************/
@@ -0,0 +1,266 @@
+#ifndef YGG_PARALLEL_CPP
+#define YGG_PARALLEL_CPP
+
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace ygg {
+
+namespace parallel_internal {
+// @cond INTERNAL
+
+inline size_t
+effective_threads(size_t threads) noexcept
+{
+	if (threads == 0) {
+		threads = std::thread::hardware_concurrency();
+	}
+	return std::max(threads, size_t{1});
+}
+
+template <class Func>
+void
+run_on_threads(size_t threads, Func && func)
+{
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for (size_t i = 0; i + 1 < threads; ++i) {
+		workers.emplace_back([&func, i]() { func(i); });
+	}
+	if (threads > 0) {
+		func(threads - 1);
+	}
+	for (auto & worker : workers) {
+		worker.join();
+	}
+}
+
+template <class RandomIt, class Compare>
+void
+parallel_stable_sort(RandomIt first, RandomIt last, Compare cmp,
+                     size_t threads)
+{
+	size_t n = static_cast<size_t>(std::distance(first, last));
+	threads = std::min(effective_threads(threads),
+	                   std::max(n / PARALLEL_CUTOFF, size_t{1}));
+
+	if (threads == 1) {
+		std::stable_sort(first, last, cmp);
+		return;
+	}
+
+	// Chunk i is [bounds[i], bounds[i+1])
+	std::vector<size_t> bounds;
+	for (size_t i = 0; i <= threads; ++i) {
+		bounds.push_back(i * n / threads);
+	}
+
+	run_on_threads(threads, [&](size_t i) {
+		std::stable_sort(first + static_cast<ptrdiff_t>(bounds[i]),
+		                 first + static_cast<ptrdiff_t>(bounds[i + 1]), cmp);
+	});
+
+	// Merge neighboring chunks until only one is left
+	while (bounds.size() > 2) {
+		size_t merges = (bounds.size() - 1) / 2;
+		run_on_threads(merges, [&](size_t i) {
+			std::inplace_merge(first + static_cast<ptrdiff_t>(bounds[2 * i]),
+			                   first + static_cast<ptrdiff_t>(bounds[2 * i + 1]),
+			                   first + static_cast<ptrdiff_t>(bounds[2 * i + 2]),
+			                   cmp);
+		});
+
+		std::vector<size_t> merged_bounds;
+		for (size_t i = 0; i < bounds.size(); i += 2) {
+			merged_bounds.push_back(bounds[i]);
+		}
+		if (merged_bounds.back() != n) {
+			merged_bounds.push_back(n);
+		}
+		bounds = std::move(merged_bounds);
+	}
+}
+
+template <class Tree>
+std::vector<TreePart<tree_node_t<Tree>>>
+split_tree(Tree & tree, size_t parts)
+{
+	using Node = tree_node_t<Tree>;
+	using TreeT = std::remove_const_t<Tree>;
+
+	// Without subtree sizes, assume every level halves the subtrees.
+	constexpr size_t ESTIMATE_LEVELS = 40;
+	auto weigh = [](Node * node, size_t depth) -> size_t {
+		if (node == nullptr) {
+			return 0;
+		}
+		if constexpr (has_subtree_size<Tree>::value) {
+			(void)depth;
+			return TreeT::get_subtree_size(node);
+		} else {
+			return (depth < ESTIMATE_LEVELS) ? (size_t{1} << (ESTIMATE_LEVELS - depth))
+			                                 : 1;
+		}
+	};
+
+	std::vector<TreePart<Node>> result;
+	std::vector<size_t> depths;
+	Node * root = tree.get_root();
+	if (root == nullptr) {
+		return result;
+	}
+	result.push_back({root, true, weigh(root, 0)});
+	depths.push_back(0);
+
+	while (result.size() < parts) {
+		// Find the heaviest subtree that can still be split
+		size_t heaviest = result.size();
+		for (size_t i = 0; i < result.size(); ++i) {
+			if (result[i].whole_subtree &&
+			    ((heaviest == result.size()) ||
+			     (result[i].weight > result[heaviest].weight))) {
+				heaviest = i;
+			}
+		}
+		if (heaviest == result.size()) {
+			break; // only single nodes left
+		}
+
+		Node * node = result[heaviest].node;
+		size_t depth = depths[heaviest];
+		Node * left = TreeT::get_left_child(node);
+		Node * right = TreeT::get_right_child(node);
+
+		std::vector<TreePart<Node>> replacement;
+		std::vector<size_t> replacement_depths;
+		if (left != nullptr) {
+			replacement.push_back({left, true, weigh(left, depth + 1)});
+			replacement_depths.push_back(depth + 1);
+		}
+		replacement.push_back({node, false, 1});
+		replacement_depths.push_back(depth);
+		if (right != nullptr) {
+			replacement.push_back({right, true, weigh(right, depth + 1)});
+			replacement_depths.push_back(depth + 1);
+		}
+
+		auto offset = static_cast<ptrdiff_t>(heaviest);
+		result.erase(result.begin() + offset);
+		result.insert(result.begin() + offset, replacement.begin(),
+		              replacement.end());
+		depths.erase(depths.begin() + offset);
+		depths.insert(depths.begin() + offset, replacement_depths.begin(),
+		              replacement_depths.end());
+	}
+
+	return result;
+}
+
+template <class Tree, class Visit>
+size_t
+visit_parallel(Tree & tree, Visit && visit, size_t threads)
+{
+	using Node = tree_node_t<Tree>;
+	using TreeT = std::remove_const_t<Tree>;
+
+	threads = effective_threads(threads);
+	if constexpr (has_subtree_size<Tree>::value) {
+		Node * root = tree.get_root();
+		if ((root == nullptr) ||
+		    (TreeT::get_subtree_size(root) < PARALLEL_CUTOFF)) {
+			threads = 1;
+		}
+	}
+
+	// A few parts per worker, so that the workers' ranges can be balanced
+	auto parts = split_tree(tree, 4 * threads);
+	threads = std::max(std::min(threads, parts.size()), size_t{1});
+
+	size_t total_weight = 0;
+	for (const auto & part : parts) {
+		total_weight += part.weight;
+	}
+
+	// Worker i handles parts [bounds[i], bounds[i+1])
+	std::vector<size_t> bounds{0};
+	size_t seen_weight = 0;
+	for (size_t i = 0; i < parts.size(); ++i) {
+		seen_weight += parts[i].weight;
+		if ((bounds.size() < threads) &&
+		    (seen_weight * threads >= bounds.size() * total_weight)) {
+			bounds.push_back(i + 1);
+		}
+	}
+	while (bounds.size() <= threads) {
+		bounds.push_back(parts.size());
+	}
+
+	run_on_threads(threads, [&](size_t worker) {
+		std::vector<Node *> stack;
+		for (size_t i = bounds[worker]; i < bounds[worker + 1]; ++i) {
+			if (!parts[i].whole_subtree) {
+				visit(worker, *parts[i].node);
+				continue;
+			}
+
+			// In-order traversal of the subtree
+			Node * cur = parts[i].node;
+			while ((cur != nullptr) || !stack.empty()) {
+				while (cur != nullptr) {
+					stack.push_back(cur);
+					cur = TreeT::get_left_child(cur);
+				}
+				cur = stack.back();
+				stack.pop_back();
+				visit(worker, *cur);
+				cur = TreeT::get_right_child(cur);
+			}
+		}
+	});
+
+	return threads;
+}
+
+// @endcond
+} // namespace parallel_internal
+
+template <class Tree, class Func>
+void
+parallel_for_each(Tree & tree, Func fn, size_t threads)
+{
+	parallel_internal::visit_parallel(
+	    tree,
+	    [&fn](size_t worker, parallel_internal::tree_node_ref_t<Tree> node) {
+		    (void)worker;
+		    fn(node);
+	    },
+	    threads);
+}
+
+template <class Tree, class T, class Fold, class Combine>
+T
+parallel_reduce(Tree & tree, T init, Fold fold, Combine combine,
+                size_t threads)
+{
+	std::vector<parallel_internal::CacheLinePadded<T>> results(
+	    parallel_internal::effective_threads(threads), {init});
+	size_t workers = parallel_internal::visit_parallel(
+	    tree,
+	    [&](size_t worker, parallel_internal::tree_node_ref_t<Tree> node) {
+		    results[worker].value = fold(std::move(results[worker].value), node);
+	    },
+	    threads);
+
+	T result = std::move(results[0].value);
+	for (size_t i = 1; i < workers; ++i) {
+		result = combine(std::move(result), std::move(results[i].value));
+	}
+	return result;
+}
+
+} // namespace ygg
+
+#endif // YGG_PARALLEL_CPP
@@ -0,0 +1,158 @@
+#ifndef YGG_PARALLEL_HPP
+#define YGG_PARALLEL_HPP
+
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ygg {
+
+namespace parallel_internal {
+/// @cond INTERNAL
+
+/*
+ * Below this number of elements, it is not worth it to start another thread.
+ */
+constexpr size_t PARALLEL_CUTOFF = size_t{1} << 14;
+
+/*
+ * Calls func(i) for every i in [0, threads), each on its own thread. The
+ * calling thread does the last call itself.
+ */
+template <class Func>
+void run_on_threads(size_t threads, Func && func);
+
+/*
+ * Stable-sorts [first, last) using up to <threads> threads. The chunks are
+ * sorted in parallel and then merged pairwise in parallel.
+ */
+template <class RandomIt, class Compare>
+void parallel_stable_sort(RandomIt first, RandomIt last, Compare cmp,
+                          size_t threads);
+
+/*
+ * Returns <threads>, or the number of hardware threads if <threads> is 0.
+ */
+inline size_t effective_threads(size_t threads) noexcept;
+
+template <class Tree>
+using tree_node_ref_t = decltype(*std::declval<Tree &>().begin());
+template <class Tree>
+using tree_node_t =
+    std::remove_const_t<std::remove_reference_t<tree_node_ref_t<Tree>>>;
+
+/*
+ * Keeps per-thread results on separate cache lines.
+ */
+template <class T>
+struct alignas(64) CacheLinePadded
+{
+	T value;
+};
+
+/*
+ * Detects whether a tree can report the size of a subtree in constant time.
+ */
+template <class Tree, class = void>
+struct has_subtree_size : std::false_type
+{
+};
+
+template <class Tree>
+struct has_subtree_size<
+    Tree, std::void_t<decltype(std::remove_const_t<Tree>::get_subtree_size(
+              std::declval<const tree_node_t<Tree> *>()))>> : std::true_type
+{
+};
+
+/*
+ * A part of the tree that one worker handles: either a whole subtree, or just
+ * a single node. <weight> is the size of the part if the tree knows subtree
+ * sizes, and an estimate otherwise.
+ */
+template <class Node>
+struct TreePart
+{
+	Node * node;
+	bool whole_subtree;
+	size_t weight;
+};
+
+/*
+ * Cuts the tree into at least <parts> parts (if it has that many nodes) by
+ * repeatedly splitting the heaviest subtree into its left subtree, its root
+ * and its right subtree. The returned parts are sorted by key.
+ */
+template <class Tree>
+std::vector<TreePart<tree_node_t<Tree>>> split_tree(Tree & tree, size_t parts);
+
+/*
+ * Splits the tree into parts, hands contiguous runs of parts of about equal
+ * weight to the workers, and calls visit(worker, node) for every node, in key
+ * order within every worker. Returns the number of workers used.
+ */
+template <class Tree, class Visit>
+size_t visit_parallel(Tree & tree, Visit && visit, size_t threads);
+
+/// @endcond
+} // namespace parallel_internal
+
+/**
+ * @brief Calls a function for every node of a tree, using multiple threads
+ *
+ * The tree is cut into disjoint subtrees near the root, and every thread
+ * visits a contiguous range of keys. Within its range, every thread visits the
+ * nodes in key order. If the tree knows the sizes of its subtrees (i.e., it
+ * offers a static get_subtree_size() method, like WBTree and EnergyTree), the
+ * ranges are chosen such that every thread visits the same number of nodes.
+ * Otherwise, the split assumes the tree to be balanced.
+ *
+ * The tree must not be modified while this runs. fn must not throw and must
+ * not modify anything that determines the nodes' order.
+ *
+ * @param tree    The tree to iterate. Can be any of RBTree, WBTree, ZTree or
+ * EnergyTree.
+ * @param fn      Is called as fn(node) for every node.
+ * @param threads The number of threads to use. 0 means as many as there are
+ * hardware threads.
+ */
+template <class Tree, class Func>
+void parallel_for_each(Tree & tree, Func fn, size_t threads = 0);
+
+/**
+ * @brief Reduces all nodes of a tree into a single value, using multiple
+ * threads
+ *
+ * The tree is cut up as in parallel_for_each(). Every thread then starts with
+ * a copy of <init> and folds the nodes of its key range into it, in key order,
+ * by calling acc = fold(std::move(acc), node). Finally, the results of all
+ * threads are combined in key order, using combine(lhs, rhs).
+ *
+ * Since every thread starts from <init>, init must be a neutral element of
+ * combine. Since the threads' results are combined in key order, combine must
+ * be associative, but does not need to be commutative.
+ *
+ * The tree must not be modified while this runs. fold and combine must not
+ * throw.
+ *
+ * @param tree    The tree to reduce
+ * @param init    The neutral element to start from
+ * @param fold    Folds one node into an intermediate result
+ * @param combine Combines two intermediate results
+ * @param threads The number of threads to use. 0 means as many as there are
+ * hardware threads.
+ * @return The result of combining all threads' results
+ */
+template <class Tree, class T, class Fold, class Combine>
+T parallel_reduce(Tree & tree, T init, Fold fold, Combine combine,
+                  size_t threads = 0);
+
+} // namespace ygg
+
+#ifndef YGG_PARALLEL_CPP
+#include "parallel.cpp"
+#endif
+
+#endif // YGG_PARALLEL_HPP
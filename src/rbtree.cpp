@@ -5,6 +5,8 @@
 
 #include "util.hpp"
 
+#include <algorithm>
+
 namespace ygg {
 
 namespace rbtree_internal {
@@ -196,14 +198,17 @@ template <class Node, class Tag, class Options>
 void
 RBTreeNodeBase<Node, Tag, Options>::swap_color_with(Node * other) noexcept
 {
-	this->_bst_parent.swap_color_with(other->_bst_parent);
+	// <other> might derive from multiple node bases (with different tags)
+	this->_bst_parent.swap_color_with(
+	    static_cast<RBTreeNodeBase<Node, Tag, Options> *>(other)->_bst_parent);
 }
 
 template <class Node, class Tag, class Options>
 void
 RBTreeNodeBase<Node, Tag, Options>::swap_parent_with(Node * other) noexcept
 {
-	this->_bst_parent.swap_parent_with(other->_bst_parent);
+	this->_bst_parent.swap_parent_with(
+	    static_cast<RBTreeNodeBase<Node, Tag, Options> *>(other)->_bst_parent);
 }
 
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
@@ -415,6 +420,15 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::fixup_after_insert(
 		return;
 	}
 
+	this->resolve_red_parent(node);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::resolve_red_parent(
+    Node * node) noexcept
+{
+	// Both node and its parent are red, the uncle is black.
 	Node * parent = node->NB::get_parent();
 	Node * grandparent = parent->NB::get_parent();
 
@@ -444,6 +458,89 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::fixup_after_insert(
 	grandparent->NB::make_red();
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::insert_leaf_onepass(
+    Node & node) CMP_NOEXCEPT(node)
+{
+	node.NB::set_right(nullptr);
+	node.NB::set_left(nullptr);
+
+	if (this->root == nullptr) {
+		node.NB::set_parent(nullptr);
+		node.NB::make_black();
+		this->root = &node;
+		NodeTraits::leaf_inserted(node, *this);
+		return;
+	}
+
+	Node * cur = this->root;
+	while (true) {
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(cur->NB::get_left());
+			__builtin_prefetch(cur->NB::get_right());
+		}
+
+		Node * left = cur->NB::get_left();
+		Node * right = cur->NB::get_right();
+
+		// Split nodes with two red children on the way down. Afterwards, no node
+		// on the search path has a red sibling, thus a red parent can always be
+		// fixed by rotations.
+		if ((left != nullptr) && (right != nullptr) &&
+		    (left->NB::get_color() == rbtree_internal::Color::RED) &&
+		    (right->NB::get_color() == rbtree_internal::Color::RED)) {
+			left->NB::make_black();
+			right->NB::make_black();
+
+			// The root stays black
+			if (cur->NB::get_parent() != nullptr) {
+				cur->NB::make_red();
+				if (cur->NB::get_parent()->NB::get_color() ==
+				    rbtree_internal::Color::RED) {
+					this->resolve_red_parent(cur);
+				}
+			}
+		}
+
+		bool go_right;
+		if constexpr (Options::multiple) {
+			go_right = this->cmp(*cur, node);
+		} else {
+			if (this->cmp(*cur, node)) {
+				go_right = true;
+			} else if (this->cmp(node, *cur)) {
+				go_right = false;
+			} else {
+				// Same as existing. Reduce size (because we increased it earlier)
+				// and exit.
+				this->s.reduce(1);
+				return;
+			}
+		}
+
+		// The children of cur might have changed by the rotation above
+		Node * next = go_right ? cur->NB::get_right() : cur->NB::get_left();
+		if (next == nullptr) {
+			node.NB::set_parent(cur);
+			node.NB::make_red();
+			if (go_right) {
+				cur->NB::set_right(&node);
+			} else {
+				cur->NB::set_left(&node);
+			}
+
+			NodeTraits::leaf_inserted(node, *this);
+			if (cur->NB::get_color() == rbtree_internal::Color::RED) {
+				this->resolve_red_parent(&node);
+			}
+			return;
+		}
+
+		cur = next;
+	}
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
 void
 RBTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node)
@@ -455,7 +552,11 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node)
 #endif
 	// TODO merge this
 	this->s.add(1);
-	this->insert_leaf_base(node, this->root);
+	if constexpr (Options::rb_single_pass) {
+		this->insert_leaf_onepass(node);
+	} else {
+		this->insert_leaf_base(node, this->root);
+	}
 }
 
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
@@ -478,52 +579,7 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::insert(Node & node,
 	// this->insert(node);
 
 	// find parent
-	Node * parent = &hint;
-	Node * cur = parent;
-
-	/* We can be sure that *parent is the root of a subtree in which node is
-	 * supposed to be inserted if the path from *parent to the root contains only
-	 * "correct decisions" wrt. node.
-	 *
-	 * If we walk up the path and see one correctly taken right, and one correctly
-	 * taken left, we can be sure that the path above that is okay.
-	 */
-
-	bool left_seen;
-	bool right_seen;
-
-	// Below the hint itself, we can choose left/right
-	left_seen = this->cmp(node, hint);
-	right_seen = !left_seen;
-
-	while (!(left_seen && right_seen)) {
-		const Node * const prev = cur;
-		cur = cur->NB::get_parent();
-
-		if (__builtin_expect(cur == nullptr, 0)) {
-			parent = this->root;
-			break;
-		}
-
-		const bool ascended_left = (cur->NB::get_left() == prev);
-		const bool should_go_left = this->cmp(node, *cur);
-		left_seen |= ascended_left;
-		right_seen |= !ascended_left;
-
-		// If we took a wrong turn, reset left_seen and right_seen and set new
-		// parent
-		if (ascended_left && !should_go_left) {
-			// goes right below cur
-			right_seen = true;
-			left_seen = false;
-			parent = cur;
-		} else if (!ascended_left && should_go_left) {
-			right_seen = false;
-			left_seen = true;
-			parent = cur;
-		}
-	}
-
+	Node * parent = this->get_hint_subtree(node, hint);
 	this->insert_leaf_base(node, parent);
 
 	/* We need to walk up if:
@@ -559,29 +615,210 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::insert(
     RBTree<Node, NodeTraits, Options, Tag, Compare>::iterator<false> hint)
     CMP_NOEXCEPT(node)
 {
+	if (hint == this->end()) {
 #ifdef YGG_STORE_SEQUENCE
-	this->bss.register_insert(reinterpret_cast<const void *>(&node),
-	                          Options::SequenceInterface::get_key(node));
+		this->bss.register_insert(reinterpret_cast<const void *>(&node),
+		                          Options::SequenceInterface::get_key(node));
 #endif
-	this->s.add(1);
+		this->s.add(1);
 
-	if (hint == this->end()) {
 		// special case: insert at the end
 		Node * parent = this->root;
 
 		if (parent == nullptr) {
-			this->template insert_leaf_base<false>(node, parent);
+			this->insert_leaf_base(node, parent);
 		} else {
 			while (parent->NB::get_right() != nullptr) {
 				parent = parent->NB::get_right();
 			}
-			this->template insert_leaf_base<false>(node, parent);
+			this->insert_leaf_base(node, parent);
 		}
 	} else {
 		this->insert(node, *hint);
 	}
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class InputIt>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::build_parallel(
+    InputIt nodes_begin, InputIt nodes_end, size_t threads)
+{
+	assert(this->root == nullptr);
+
+	threads = parallel_internal::effective_threads(threads);
+	std::vector<Node *> nodes =
+	    this->collect_sorted_nodes(nodes_begin, nodes_end, threads);
+
+#ifdef YGG_STORE_SEQUENCE
+	for (Node * node : nodes) {
+		this->bss.register_insert(reinterpret_cast<const void *>(node),
+		                          Options::SequenceInterface::get_key(*node));
+	}
+#endif
+
+	// build_balanced() completely fills every level except for the last one.
+	// Coloring that last level red and everything above black gives every path
+	// the same number of black nodes.
+	size_t full_levels = 0;
+	while ((size_t{1} << (full_levels + 1)) <= nodes.size() + 1) {
+		full_levels++;
+	}
+
+	constexpr bool call_hooks =
+	    !std::is_same<NodeTraits, RBDefaultNodeTraits>::value;
+	auto init = [&](Node & node, size_t depth, size_t subtree_size) {
+		(void)subtree_size;
+		if (depth >= full_levels) {
+			node.NB::make_red();
+		} else {
+			node.NB::make_black();
+		}
+		if constexpr (call_hooks) {
+			// Hooks may walk up to the root, so they are never called
+			// concurrently.
+			NodeTraits::leaf_inserted(node, *this);
+		}
+	};
+
+	this->root = TB::build_balanced(nodes.data(), nodes.size(), nullptr, 0, 0,
+	                                call_hooks ? 1 : threads, init);
+	this->s.set(nodes.size());
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::find_batch_predecessors(
+    Node * sub_root, Node * predecessor, Node * const * batch,
+    Node ** predecessors, size_t count)
+{
+	// Walks down the tree, splitting the batch at every node. In the end, every
+	// batch node has the largest tree node that is smaller (or, without
+	// MULTIPLE, smaller or equal) as predecessor.
+	while (count > 0) {
+		if (sub_root == nullptr) {
+			for (size_t i = 0; i < count; ++i) {
+				predecessors[i] = predecessor;
+			}
+			return;
+		}
+
+		Node * const * split = std::partition_point(
+		    batch, batch + count, [&](const Node * batch_node) {
+			    if constexpr (Options::multiple) {
+				    return !this->cmp(*sub_root, *batch_node);
+			    } else {
+				    return this->cmp(*batch_node, *sub_root);
+			    }
+		    });
+		size_t left_count = static_cast<size_t>(split - batch);
+
+		this->find_batch_predecessors(sub_root->NB::get_left(), predecessor, batch,
+		                              predecessors, left_count);
+
+		// Continue iteratively to the right
+		predecessor = sub_root;
+		sub_root = sub_root->NB::get_right();
+		batch += left_count;
+		predecessors += left_count;
+		count -= left_count;
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class InputIt>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::insert_batch(
+    InputIt nodes_begin, InputIt nodes_end)
+{
+	std::vector<Node *> batch;
+	for (auto it = nodes_begin; it != nodes_end; ++it) {
+		batch.push_back(&*it);
+	}
+	std::vector<Node *> predecessors(batch.size());
+	this->find_batch_predecessors(this->root, nullptr, batch.data(),
+	                              predecessors.data(), batch.size());
+
+	Node * last_inserted = nullptr;
+	Node * last_predecessor = nullptr;
+	for (size_t i = 0; i < batch.size(); ++i) {
+		Node & node = *batch[i];
+
+		// Rotations never change the order of the nodes, so the node belongs
+		// right after its predecessor, or after the last inserted node if that
+		// one had the same predecessor.
+		Node * predecessor = predecessors[i];
+		if ((last_inserted != nullptr) && (last_predecessor == predecessor)) {
+			predecessor = last_inserted;
+		}
+
+		if constexpr (!Options::multiple) {
+			if ((predecessor != nullptr) && !this->cmp(*predecessor, node)) {
+				continue; // Equal node is already present
+			}
+		}
+
+#ifdef YGG_STORE_SEQUENCE
+		this->bss.register_insert(reinterpret_cast<const void *>(&node),
+		                          Options::SequenceInterface::get_key(node));
+#endif
+		this->s.add(1);
+		last_inserted = &node;
+		last_predecessor = predecessors[i];
+
+		node.NB::set_left(nullptr);
+		node.NB::set_right(nullptr);
+
+		// Find the free spot directly after the predecessor
+		Node * parent;
+		bool goes_left;
+		if (predecessor == nullptr) {
+			parent = this->get_smallest();
+			goes_left = true;
+		} else if (predecessor->NB::get_right() == nullptr) {
+			parent = predecessor;
+			goes_left = false;
+		} else {
+			parent = predecessor->NB::get_right();
+			while (parent->NB::get_left() != nullptr) {
+				parent = parent->NB::get_left();
+			}
+			goes_left = true;
+		}
+
+		if (parent == nullptr) {
+			// new root!
+			node.NB::set_parent(nullptr);
+			node.NB::make_black();
+			this->root = &node;
+			NodeTraits::leaf_inserted(node, *this);
+			continue;
+		}
+
+		node.NB::set_parent(parent);
+		node.NB::make_red();
+		if (goes_left) {
+			parent->NB::set_left(&node);
+		} else {
+			parent->NB::set_right(&node);
+		}
+
+		NodeTraits::leaf_inserted(node, *this);
+		this->fixup_after_insert(&node);
+	}
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class InputIt>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::remove_batch(
+    InputIt nodes_begin, InputIt nodes_end)
+{
+	for (auto it = nodes_begin; it != nodes_end; ++it) {
+		this->remove(*it);
+	}
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
 void
 RBTree<Node, NodeTraits, Options, Tag, Compare>::verify_black_root() const
@@ -684,7 +921,7 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::swap_nodes(
 	}
 
 	if (!swap_colors) {
-		n1->swap_color_with(n2);
+		n1->NB::swap_color_with(n2);
 	}
 
 	NodeTraits::swapped(*n1, *n2, *this);
@@ -803,9 +1040,16 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::swap_unrelated_nodes(
 
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
 void
-RBTree<Node, NodeTraits, Options, Tag, Compare>::remove_to_leaf(Node & node)
+RBTree<Node, NodeTraits, Options, Tag, Compare>::remove_to_leaf(Node & node,
+                                                                bool in_order)
     CMP_NOEXCEPT(node)
 {
+	if constexpr (Options::rb_single_pass) {
+		this->remove_onepass(node, in_order);
+		return;
+	}
+	(void)in_order;
+
 	Node * cur = &node;
 	Node * child = &node;
 
@@ -888,6 +1132,149 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::remove_to_leaf(Node & node)
 	}
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+RBTree<Node, NodeTraits, Options, Tag, Compare>::remove_onepass(Node & node,
+                                                                bool in_order)
+    CMP_NOEXCEPT(node)
+{
+	/*
+	 * Top-down deletion: While descending towards the node that is actually
+	 * unlinked (node itself or its successor), we make sure that the current
+	 * node is red or has a red child in the direction we go next. Thus, the
+	 * unlinked node is red (or the root) and no fixup is needed afterwards.
+	 */
+
+	// With multiple equal keys (or if the key of node has changed), comparisons
+	// cannot tell where node is. Record the directions from the root to node
+	// instead. The rotations below never change the child of a node on that
+	// path in the direction we go next.
+	const bool follow_path = Options::multiple || !in_order;
+	constexpr size_t max_depth = 2 * std::numeric_limits<size_t>::digits;
+	std::bitset<max_depth> path_right;
+	size_t depth = 0;
+	if (follow_path) {
+		for (Node * cur = &node; cur->NB::get_parent() != nullptr;
+		     cur = cur->NB::get_parent()) {
+			path_right[depth++] = (cur->NB::get_parent()->NB::get_right() == cur);
+		}
+	}
+
+	auto is_red = [](const Node * n) {
+		return (n != nullptr) &&
+		       (n->NB::get_color() == rbtree_internal::Color::RED);
+	};
+
+	bool found = false;
+	Node * cur = nullptr;
+	Node * next = this->root;
+	while (next != nullptr) {
+		cur = next;
+
+		bool dir_right;
+		if (cur == &node) {
+			found = true;
+			if ((cur->NB::get_left() != nullptr) &&
+			    (cur->NB::get_right() != nullptr)) {
+				// Descend to the successor
+				dir_right = true;
+			} else {
+				// Head for the empty side
+				dir_right = (cur->NB::get_left() != nullptr);
+			}
+		} else if (found) {
+			dir_right = false;
+		} else if (follow_path) {
+			dir_right = path_right[--depth];
+		} else {
+			dir_right = this->cmp(*cur, node);
+		}
+
+		Node * towards = dir_right ? cur->NB::get_right() : cur->NB::get_left();
+		Node * away = dir_right ? cur->NB::get_left() : cur->NB::get_right();
+		Node * parent = cur->NB::get_parent();
+
+		if (!is_red(cur) && !is_red(towards)) {
+			if (is_red(away)) {
+				// Lift the red child, cur becomes red
+				if (dir_right) {
+					this->rotate_right(cur);
+				} else {
+					this->rotate_left(cur);
+				}
+				away->NB::make_black();
+				cur->NB::make_red();
+			} else if (parent != nullptr) {
+				// parent is red (or the root), the sibling is black
+				bool cur_right = (parent->NB::get_right() == cur);
+				Node * sibling =
+				    cur_right ? parent->NB::get_left() : parent->NB::get_right();
+				Node * sibling_outer =
+				    cur_right ? sibling->NB::get_left() : sibling->NB::get_right();
+				Node * sibling_inner =
+				    cur_right ? sibling->NB::get_right() : sibling->NB::get_left();
+
+				if (!is_red(sibling_outer) && !is_red(sibling_inner)) {
+					parent->NB::make_black();
+					sibling->NB::make_red();
+					cur->NB::make_red();
+				} else {
+					Node * top;
+					if (is_red(sibling_inner)) {
+						if (cur_right) {
+							this->rotate_left(sibling);
+							this->rotate_right(parent);
+						} else {
+							this->rotate_right(sibling);
+							this->rotate_left(parent);
+						}
+						top = sibling_inner;
+					} else {
+						if (cur_right) {
+							this->rotate_right(parent);
+						} else {
+							this->rotate_left(parent);
+						}
+						top = sibling;
+					}
+
+					cur->NB::make_red();
+					top->NB::make_red();
+					top->NB::get_left()->NB::make_black();
+					top->NB::get_right()->NB::make_black();
+				}
+			}
+		}
+
+		next = dir_right ? cur->NB::get_right() : cur->NB::get_left();
+	}
+
+	// cur is red (thus a leaf) or the root without children. Move node to its
+	// position, keeping the colors at their positions.
+	if (cur != &node) {
+		this->swap_nodes(&node, cur, false);
+	}
+	assert(node.NB::get_left() == nullptr);
+	assert(node.NB::get_right() == nullptr);
+
+	NodeTraits::delete_leaf(node, *this);
+	Node * parent = node.NB::get_parent();
+	if (parent == nullptr) {
+		this->root = nullptr;
+		return;
+	}
+
+	if (parent->NB::get_left() == &node) {
+		parent->NB::set_left(nullptr);
+	} else {
+		parent->NB::set_right(nullptr);
+	}
+	NodeTraits::deleted_below(*parent, *this);
+
+	// Rotations at the root may have colored it red
+	this->root->NB::make_black();
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
 template <class Comparable>
 ygg::utilities::select_type_t<size_t, Node *, Options::stl_erase>
@@ -1096,6 +1483,42 @@ RBTree<Node, NodeTraits, Options, Tag, Compare>::remove(Node & node)
 	this->s.reduce(1);
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class Mutator>
+bool
+RBTree<Node, NodeTraits, Options, Tag, Compare>::update_key(Node & node,
+                                                            Mutator && mutator)
+    CMP_NOEXCEPT(node)
+{
+	mutator(node);
+
+	// The mutator does not change the tree's structure, so the in-order
+	// neighbors are the same as before.
+	Node * moved_past = this->get_moved_past(node);
+	if (moved_past == nullptr) {
+		// Data stored in the nodes might depend on the key
+		NodeTraits::deleted_below(node, *this);
+		return true;
+	}
+
+#ifdef YGG_STORE_SEQUENCE
+	this->bss.register_delete(reinterpret_cast<const void *>(&node),
+	                          Options::SequenceInterface::get_key(node));
+#endif
+	this->remove_to_leaf(node, false);
+	this->s.reduce(1);
+
+	if constexpr (!Options::multiple) {
+		// The hinted insertion would not see an equal node above the hint
+		if (this->find(node) != this->end()) {
+			return false;
+		}
+	}
+
+	this->insert(node, *moved_past);
+	return true;
+}
+
 } // namespace ygg
 
 #endif // YGG_RBTREE_CPP
@@ -6,8 +6,10 @@
 #include "size_holder.hpp"
 #include "tree_iterator.hpp"
 
+#include <bitset>
 #include <cassert>
 #include <cstddef>
+#include <limits>
 #include <set>
 #include <type_traits>
 
@@ -251,6 +253,54 @@ public:
 	// TODO document hinted inserts
 	// TODO should order be preserved on hints?
 
+	/**
+	 * @brief Builds the tree from a range of nodes, using multiple threads
+	 *
+	 * Inserts all nodes in [nodes_begin, nodes_end) into the tree, which must be
+	 * empty. The range does not need to be sorted. The nodes are sorted in
+	 * parallel and then linked into a perfectly balanced tree, with different
+	 * threads building disjoint subtrees. This is much faster than inserting the
+	 * nodes one by one.
+	 *
+	 * If MULTIPLE is not set, of several equal nodes only the first one in the
+	 * range is inserted.
+	 *
+	 * If NodeTraits is not RBDefaultNodeTraits, its leaf_inserted() hook is
+	 * called for every node in top-down order, and the tree is linked by a
+	 * single thread.
+	 *
+	 * @param nodes_begin Iterator to the first node to be inserted
+	 * @param nodes_end   Iterator past the last node to be inserted
+	 * @param threads     The number of threads to use. 0 means as many as
+	 * there are hardware threads.
+	 */
+	template <class InputIt>
+	void build_parallel(InputIt nodes_begin, InputIt nodes_end,
+	                    size_t threads = 0);
+
+	/**
+	 * @brief Inserts a sorted batch of nodes into the tree
+	 *
+	 * Inserts all nodes in [nodes_begin, nodes_end), which must be sorted, into
+	 * the tree. Instead of searching the position of every node from the root,
+	 * the whole batch is distributed over the tree in a single descent, which
+	 * finds the in-order predecessor of every node in the tree. Every node is
+	 * then linked right after its predecessor (which may be the previous node
+	 * of the batch). This way, the upper levels of the tree are only searched
+	 * once per batch instead of once per node.
+	 *
+	 * If MULTIPLE is set, the nodes of the batch keep their order, and are
+	 * placed before nodes in the tree that compare equally. This is the same as
+	 * calling insert() on the nodes in reverse order. If MULTIPLE is not set,
+	 * nodes that compare equally to a node in the tree or to a previous node of
+	 * the batch are not inserted.
+	 *
+	 * @param nodes_begin Iterator to the first node to be inserted
+	 * @param nodes_end   Iterator past the last node to be inserted
+	 */
+	template <class InputIt>
+	void insert_batch(InputIt nodes_begin, InputIt nodes_end);
+
 	/**
 	 * @brief Removes <node> from the tree
 	 *
@@ -260,6 +310,44 @@ public:
 	 */
 	void remove(Node & node) CMP_NOEXCEPT(node);
 
+	/**
+	 * @brief Changes the key of <node> in place
+	 *
+	 * Calls mutator(node), which may change anything that <node> is compared
+	 * by. If <node> still is in order with its in-order neighbors afterwards,
+	 * nothing else happens, which usually costs O(1). Otherwise, <node> is
+	 * removed and re-inserted, starting the search for its new position at the
+	 * neighbor it has moved past instead of at the root.
+	 *
+	 * This is much cheaper than remove() followed by insert() if most changes
+	 * are small enough to not change the order of the nodes.
+	 *
+	 * If <node> stays where it is, NodeTraits::deleted_below(node, tree) is
+	 * called, so that data stored in the nodes can be updated for the new key.
+	 *
+	 * @param node    The node whose key should be changed. Must be in the tree.
+	 * @param mutator Called as mutator(node) to change the key.
+	 * @return true if <node> is in the tree afterwards. If MULTIPLE is not set
+	 * and <node> compares equally to another node after the change, <node> is
+	 * removed from the tree and false is returned.
+	 */
+	template <class Mutator>
+	bool update_key(Node & node, Mutator && mutator) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Removes a batch of nodes from the tree
+	 *
+	 * Removes all nodes in [nodes_begin, nodes_end) from the tree. Since
+	 * removing a node never searches the tree, this is equivalent to calling
+	 * remove() on every node in the batch. The batch does not need to be
+	 * sorted.
+	 *
+	 * @param nodes_begin Iterator to the first node to be removed
+	 * @param nodes_end   Iterator past the last node to be removed
+	 */
+	template <class InputIt>
+	void remove_batch(InputIt nodes_begin, InputIt nodes_end);
+
 	/**
 	 * @brief Deletes a node that compares equally to <c> from the tree
 	 *
@@ -313,12 +401,25 @@ public:
 protected:
 	using Path = std::vector<Node *>;
 
-	void remove_to_leaf(Node & node) CMP_NOEXCEPT(node);
+	// <in_order> must be false if the key of <node> has been changed while
+	// <node> was in the tree. Removing it must then not compare anything.
+	void remove_to_leaf(Node & node, bool in_order = true) CMP_NOEXCEPT(node);
 	void fixup_after_delete(Node * parent, bool deleted_left) noexcept;
 
 	void insert_leaf_base(Node & node, Node * start) CMP_NOEXCEPT(node);
 
+	/*
+	 * Top-down variants used if RB_SINGLE_PASS is set. They rebalance during the
+	 * descent, such that no fixup walking back up is necessary.
+	 */
+	void insert_leaf_onepass(Node & node) CMP_NOEXCEPT(node);
+	void remove_onepass(Node & node, bool in_order) CMP_NOEXCEPT(node);
+	void find_batch_predecessors(Node * sub_root, Node * predecessor,
+	                             Node * const * batch, Node ** predecessors,
+	                             size_t count);
+
 	void fixup_after_insert(Node * node) noexcept;
+	void resolve_red_parent(Node * node) noexcept;
 	void rotate_left(Node * parent) noexcept;
 	void rotate_right(Node * parent) noexcept;
 
@@ -0,0 +1,448 @@
+#ifndef YGG_SHARDED_TREE_CPP
+#define YGG_SHARDED_TREE_CPP
+
+#include "sharded_tree.hpp"
+
+#include "debug.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+namespace ygg {
+
+/*
+ * RangeSplitter
+ */
+template <class Key, class KeyGetter, class Compare>
+RangeSplitter<Key, KeyGetter, Compare>::RangeSplitter(
+    std::vector<Key> boundaries_in)
+    : boundaries(std::move(boundaries_in)), cmp()
+{}
+
+template <class Key, class KeyGetter, class Compare>
+template <class Comparable>
+size_t
+RangeSplitter<Key, KeyGetter, Compare>::get_shard(
+    const Comparable & query) const
+{
+	if constexpr (std::is_convertible<const Comparable &, const Key &>::value) {
+		return this->get_shard_for_key(query);
+	} else {
+		return this->get_shard_for_key(KeyGetter::get_key(query));
+	}
+}
+
+template <class Key, class KeyGetter, class Compare>
+size_t
+RangeSplitter<Key, KeyGetter, Compare>::get_shard_for_key(
+    const Key & key) const
+{
+	return static_cast<size_t>(std::upper_bound(this->boundaries.begin(),
+	                                            this->boundaries.end(), key,
+	                                            this->cmp) -
+	                           this->boundaries.begin());
+}
+
+template <class Key, class KeyGetter, class Compare>
+template <class Node>
+RangeSplitter<Key, KeyGetter, Compare>
+RangeSplitter<Key, KeyGetter, Compare>::split(
+    const std::vector<Node *> & sorted_nodes, size_t shard_count) const
+{
+	if (sorted_nodes.empty()) {
+		return *this;
+	}
+
+	std::vector<Key> new_boundaries;
+	new_boundaries.reserve(shard_count - 1);
+	for (size_t i = 1; i < shard_count; ++i) {
+		size_t first_in_shard = i * sorted_nodes.size() / shard_count;
+		new_boundaries.push_back(KeyGetter::get_key(*sorted_nodes[first_in_shard]));
+	}
+
+	return RangeSplitter(std::move(new_boundaries));
+}
+
+template <class Key, class KeyGetter, class Compare>
+const std::vector<Key> &
+RangeSplitter<Key, KeyGetter, Compare>::get_boundaries() const noexcept
+{
+	return this->boundaries;
+}
+
+/*
+ * ShardedTree iterators
+ */
+template <class Tree, class Splitter>
+template <bool is_const>
+ShardedTree<Tree, Splitter>::IteratorBase<is_const>::IteratorBase(
+    TreeRef st_in, size_t shard_in, TreeIterator it_in)
+    : st(st_in), shard(shard_in), it(it_in)
+{
+	this->skip_empty();
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+void
+ShardedTree<Tree, Splitter>::IteratorBase<is_const>::skip_empty()
+{
+	using TreeReference = std::conditional_t<is_const, const Tree &, Tree &>;
+
+	while (this->shard < this->st->shard_count &&
+	       this->it ==
+	           static_cast<TreeReference>(this->st->shards[this->shard].t).end()) {
+		this->shard++;
+		if (this->shard < this->st->shard_count) {
+			this->it =
+			    static_cast<TreeReference>(this->st->shards[this->shard].t).begin();
+		} else {
+			this->it = TreeIterator();
+		}
+	}
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+typename ShardedTree<Tree, Splitter>::template IteratorBase<is_const>::reference
+    ShardedTree<Tree, Splitter>::IteratorBase<is_const>::operator*() const
+{
+	return *this->it;
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+typename ShardedTree<Tree, Splitter>::template IteratorBase<is_const>::pointer
+    ShardedTree<Tree, Splitter>::IteratorBase<is_const>::operator->() const
+{
+	return &*this->it;
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+typename ShardedTree<Tree, Splitter>::template IteratorBase<is_const> &
+ShardedTree<Tree, Splitter>::IteratorBase<is_const>::operator++()
+{
+	++this->it;
+	this->skip_empty();
+	return *this;
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+typename ShardedTree<Tree, Splitter>::template IteratorBase<is_const>
+ShardedTree<Tree, Splitter>::IteratorBase<is_const>::operator++(int)
+{
+	IteratorBase cpy = *this;
+	++(*this);
+	return cpy;
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+bool
+ShardedTree<Tree, Splitter>::IteratorBase<is_const>::operator==(
+    const IteratorBase & other) const
+{
+	if (this->shard != other.shard) {
+		return false;
+	}
+	if (this->st == nullptr || this->shard == this->st->shard_count) {
+		return true;
+	}
+	return this->it == other.it;
+}
+
+template <class Tree, class Splitter>
+template <bool is_const>
+bool
+ShardedTree<Tree, Splitter>::IteratorBase<is_const>::operator!=(
+    const IteratorBase & other) const
+{
+	return !(*this == other);
+}
+
+/*
+ * ShardedTree
+ */
+template <class Tree, class Splitter>
+ShardedTree<Tree, Splitter>::ShardedTree(size_t shard_count_in,
+                                         Splitter splitter_in)
+    : shard_count(shard_count_in), shards(new Shard[shard_count_in]),
+      splitter(new Splitter(std::move(splitter_in)))
+{
+	assert(this->shard_count > 0);
+	for (size_t i = 0; i < this->shard_count; ++i) {
+		this->shards[i].count.store(0, std::memory_order_relaxed);
+	}
+}
+
+template <class Tree, class Splitter>
+ShardedTree<Tree, Splitter>::~ShardedTree()
+{
+	delete this->splitter.load();
+}
+
+template <class Tree, class Splitter>
+template <class Comparable>
+size_t
+ShardedTree<Tree, Splitter>::lock_shard(const Comparable & query)
+{
+	// The splitter is only ever exchanged while all shards are locked. Thus, if
+	// the splitter is still the same after we locked the shard, the shard is
+	// the right one. Old splitters are kept alive as long as we are registered
+	// with the epoch manager.
+	concurrent_read_internal::EpochGuard guard(this->em);
+	while (true) {
+		const Splitter * sp = this->splitter.load(std::memory_order_acquire);
+		size_t shard = sp->get_shard(query);
+		assert(shard < this->shard_count);
+
+		this->shards[shard].mutex.lock();
+		if (this->splitter.load(std::memory_order_acquire) == sp) {
+			return shard;
+		}
+		this->shards[shard].mutex.unlock();
+	}
+}
+
+template <class Tree, class Splitter>
+void
+ShardedTree<Tree, Splitter>::insert(Node & node)
+{
+	size_t shard = this->lock_shard(node);
+	std::lock_guard<std::mutex> lock(this->shards[shard].mutex, std::adopt_lock);
+
+	this->shards[shard].t.insert(node);
+	this->shards[shard].count.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class Tree, class Splitter>
+void
+ShardedTree<Tree, Splitter>::remove(Node & node)
+{
+	size_t shard = this->lock_shard(node);
+	std::lock_guard<std::mutex> lock(this->shards[shard].mutex, std::adopt_lock);
+
+	this->shards[shard].t.remove(node);
+	this->shards[shard].count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+template <class Tree, class Splitter>
+template <class Comparable>
+typename ShardedTree<Tree, Splitter>::Node *
+ShardedTree<Tree, Splitter>::find(const Comparable & query)
+{
+	size_t shard = this->lock_shard(query);
+	std::lock_guard<std::mutex> lock(this->shards[shard].mutex, std::adopt_lock);
+
+	Tree & t = this->shards[shard].t;
+	auto it = t.find(query);
+	if (it == t.end()) {
+		return nullptr;
+	}
+	return &*it;
+}
+
+template <class Tree, class Splitter>
+template <class Comparable>
+typename ShardedTree<Tree, Splitter>::Node *
+ShardedTree<Tree, Splitter>::lower_bound(const Comparable & query)
+{
+	size_t shard = this->lock_shard(query);
+	std::unique_lock<std::mutex> lock(this->shards[shard].mutex, std::adopt_lock);
+
+	Tree & t = this->shards[shard].t;
+	auto it = t.lower_bound(query);
+	if (it != t.end()) {
+		return &*it;
+	}
+
+	// Continue with the first node of the next non-empty shard. We lock
+	// hand-over-hand (in the same order as rebalance() does), so no
+	// rebalancing can move nodes smaller than <query> into the following shards
+	// in the meantime.
+	for (size_t next = shard + 1; next < this->shard_count; ++next) {
+		std::unique_lock<std::mutex> next_lock(this->shards[next].mutex);
+		lock.unlock();
+		lock = std::move(next_lock);
+
+		Tree & next_t = this->shards[next].t;
+		if (next_t.begin() != next_t.end()) {
+			return &*next_t.begin();
+		}
+	}
+
+	return nullptr;
+}
+
+template <class Tree, class Splitter>
+size_t
+ShardedTree<Tree, Splitter>::size() const noexcept
+{
+	size_t s = 0;
+	for (size_t i = 0; i < this->shard_count; ++i) {
+		s += this->shards[i].count.load(std::memory_order_relaxed);
+	}
+	return s;
+}
+
+template <class Tree, class Splitter>
+bool
+ShardedTree<Tree, Splitter>::empty() const noexcept
+{
+	return this->size() == 0;
+}
+
+template <class Tree, class Splitter>
+void
+ShardedTree<Tree, Splitter>::rebalance()
+{
+	std::lock_guard<std::mutex> rebalance_lock(this->rebalance_mutex);
+
+	std::vector<std::unique_lock<std::mutex>> locks;
+	locks.reserve(this->shard_count);
+	for (size_t i = 0; i < this->shard_count; ++i) {
+		locks.emplace_back(this->shards[i].mutex);
+	}
+
+	std::vector<Node *> nodes;
+	std::vector<size_t> old_shards;
+	nodes.reserve(this->size());
+	old_shards.reserve(this->size());
+	for (size_t i = 0; i < this->shard_count; ++i) {
+		for (auto & n : this->shards[i].t) {
+			nodes.push_back(&n);
+			old_shards.push_back(i);
+		}
+	}
+
+	Splitter * old_splitter = this->splitter.load(std::memory_order_relaxed);
+	Splitter * new_splitter =
+	    new Splitter(old_splitter->split(nodes, this->shard_count));
+
+	// Since shards hold contiguous key ranges, only the nodes around the old
+	// and new boundaries actually move.
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		size_t new_shard = new_splitter->get_shard(*nodes[i]);
+		assert(new_shard < this->shard_count);
+		if (new_shard != old_shards[i]) {
+			this->shards[old_shards[i]].t.remove(*nodes[i]);
+			this->shards[old_shards[i]].count.fetch_sub(1,
+			                                            std::memory_order_relaxed);
+			this->shards[new_shard].t.insert(*nodes[i]);
+			this->shards[new_shard].count.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	this->splitter.store(new_splitter, std::memory_order_release);
+	locks.clear();
+
+	// Wait until nobody is looking at the old splitter anymore
+	this->em.synchronize();
+	delete old_splitter;
+}
+
+template <class Tree, class Splitter>
+bool
+ShardedTree<Tree, Splitter>::rebalance_if_skewed(double max_skew)
+{
+	size_t total = 0;
+	size_t largest = 0;
+	for (size_t i = 0; i < this->shard_count; ++i) {
+		size_t s = this->shards[i].count.load(std::memory_order_relaxed);
+		total += s;
+		largest = std::max(largest, s);
+	}
+
+	if (total == 0 || static_cast<double>(largest) <=
+	                      max_skew * static_cast<double>(total) /
+	                          static_cast<double>(this->shard_count)) {
+		return false;
+	}
+
+	this->rebalance();
+	return true;
+}
+
+template <class Tree, class Splitter>
+size_t
+ShardedTree<Tree, Splitter>::get_shard_count() const noexcept
+{
+	return this->shard_count;
+}
+
+template <class Tree, class Splitter>
+size_t
+ShardedTree<Tree, Splitter>::get_shard_size(size_t shard) const noexcept
+{
+	return this->shards[shard].count.load(std::memory_order_relaxed);
+}
+
+template <class Tree, class Splitter>
+typename ShardedTree<Tree, Splitter>::iterator
+ShardedTree<Tree, Splitter>::begin()
+{
+	return iterator(this, 0, this->shards[0].t.begin());
+}
+
+template <class Tree, class Splitter>
+typename ShardedTree<Tree, Splitter>::const_iterator
+ShardedTree<Tree, Splitter>::begin() const
+{
+	return this->cbegin();
+}
+
+template <class Tree, class Splitter>
+typename ShardedTree<Tree, Splitter>::const_iterator
+ShardedTree<Tree, Splitter>::cbegin() const
+{
+	return const_iterator(this, 0,
+	                      static_cast<const Tree &>(this->shards[0].t).begin());
+}
+
+template <class Tree, class Splitter>
+typename ShardedTree<Tree, Splitter>::iterator
+ShardedTree<Tree, Splitter>::end()
+{
+	return iterator(this, this->shard_count,
+	                typename iterator::TreeIterator());
+}
+
+template <class Tree, class Splitter>
+typename ShardedTree<Tree, Splitter>::const_iterator
+ShardedTree<Tree, Splitter>::end() const
+{
+	return this->cend();
+}
+
+template <class Tree, class Splitter>
+typename ShardedTree<Tree, Splitter>::const_iterator
+ShardedTree<Tree, Splitter>::cend() const
+{
+	return const_iterator(this, this->shard_count,
+	                      typename const_iterator::TreeIterator());
+}
+
+template <class Tree, class Splitter>
+void
+ShardedTree<Tree, Splitter>::dbg_verify() const
+{
+	const Splitter * sp = this->splitter.load();
+	for (size_t i = 0; i < this->shard_count; ++i) {
+		const Tree & t = this->shards[i].t;
+		t.dbg_verify();
+
+		size_t count = 0;
+		for (const auto & n : t) {
+			debug::yggassert(sp->get_shard(n) == i);
+			count++;
+		}
+		debug::yggassert(count == this->shards[i].count.load());
+	}
+}
+
+} // namespace ygg
+
+#endif // YGG_SHARDED_TREE_CPP
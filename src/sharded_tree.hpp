@@ -0,0 +1,299 @@
+#ifndef YGG_SHARDED_TREE_HPP
+#define YGG_SHARDED_TREE_HPP
+
+#include "concurrent_read_tree.hpp"
+#include "options.hpp"
+#include "util.hpp"
+
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ygg {
+
+/**
+ * @brief The default splitter for ShardedTree, splitting by key ranges
+ *
+ * A RangeSplitter holds a sorted list of boundary keys. Shard i contains all
+ * keys k with boundary[i-1] <= k < boundary[i]. When rebalancing, the
+ * boundaries are chosen such that all shards hold equally many nodes.
+ *
+ * Every splitter that you want to use with ShardedTree must offer the same
+ * two methods as this class: get_shard() and split().
+ *
+ * @tparam Key        The type of the keys by which the nodes are sorted.
+ * @tparam KeyGetter  A class that must implement a static Key get_key(const
+ * Node &) function that returns the key of a node. The order of the keys must
+ * be the same as the order of the nodes in the tree.
+ * @tparam Compare    A compare class for keys. Defaults to std::less<Key>.
+ */
+template <class Key, class KeyGetter, class Compare = std::less<Key>>
+class RangeSplitter {
+public:
+	/**
+	 * @brief Creates a splitter from a list of boundary keys
+	 *
+	 * @param boundaries  The sorted boundary keys. n boundaries result in n+1
+	 * shards being used. Empty by default, i.e., everything goes into the first
+	 * shard until the first rebalancing.
+	 */
+	explicit RangeSplitter(std::vector<Key> boundaries = {});
+
+	/**
+	 * @brief Returns the shard into which a node or a key belongs
+	 *
+	 * The returned shard indices must be monotonous in the order of the keys.
+	 *
+	 * @param query  Either a node or a Key
+	 * @return The index of the shard into which <query> belongs
+	 */
+	template <class Comparable>
+	size_t get_shard(const Comparable & query) const;
+
+	/**
+	 * @brief Creates a new splitter that evenly splits the given nodes
+	 *
+	 * @param sorted_nodes  All nodes currently in the tree, sorted.
+	 * @param shard_count   The number of shards to split the nodes into.
+	 * @return A new splitter that splits <sorted_nodes> into <shard_count>
+	 * equally sized ranges.
+	 */
+	template <class Node>
+	RangeSplitter split(const std::vector<Node *> & sorted_nodes,
+	                    size_t shard_count) const;
+
+	/**
+	 * @brief Returns the current boundary keys
+	 */
+	const std::vector<Key> & get_boundaries() const noexcept;
+
+private:
+	size_t get_shard_for_key(const Key & key) const;
+
+	std::vector<Key> boundaries;
+	Compare cmp;
+};
+
+/**
+ * @brief A tree split into multiple shards that can be written concurrently
+ *
+ * A ShardedTree splits the key space into multiple ranges (shards). Every
+ * shard is a separate tree (an RBTree, WBTree, ZTree, …) with its own lock.
+ * Threads inserting, removing or searching in different shards never contend
+ * for the same lock or the same root, so writers working on disjoint key
+ * ranges scale with the number of shards.
+ *
+ * Which key goes into which shard is decided by the Splitter (see
+ * RangeSplitter). As the distribution of the keys drifts, some shards might
+ * grow much larger than others. Call rebalance() (or rebalance_if_skewed())
+ * periodically to compute new splitter keys and move the nodes accordingly.
+ * Rebalancing locks all shards, but may be called concurrently to all other
+ * modifying and searching methods.
+ *
+ * Iteration and the debugging methods must not be used concurrently to any
+ * modification.
+ *
+ * @tparam Tree      The tree to be used for every shard, e.g., an RBTree.
+ * @tparam Splitter  A class that decides which node goes into which shard. See
+ * RangeSplitter for the interface a splitter must offer.
+ */
+template <class Tree, class Splitter>
+class ShardedTree {
+public:
+	using Node = concurrent_read_internal::tree_node_t<Tree>;
+	using MyClass = ShardedTree<Tree, Splitter>;
+
+	/// @cond INTERNAL
+	template <bool is_const>
+	class IteratorBase {
+	public:
+		using difference_type = ptrdiff_t;
+		using value_type = Node;
+		using reference = std::conditional_t<is_const, const Node &, Node &>;
+		using pointer = std::conditional_t<is_const, const Node *, Node *>;
+		using iterator_category = std::forward_iterator_tag;
+
+		IteratorBase() = default;
+
+		reference operator*() const;
+		pointer operator->() const;
+
+		IteratorBase & operator++();
+		IteratorBase operator++(int);
+
+		bool operator==(const IteratorBase & other) const;
+		bool operator!=(const IteratorBase & other) const;
+
+	private:
+		friend class ShardedTree;
+
+		using TreeRef = std::conditional_t<is_const, const MyClass *, MyClass *>;
+		using TreeIterator = decltype(std::declval<
+		                              std::conditional_t<is_const, const Tree &,
+		                                                 Tree &>>()
+		                                  .begin());
+
+		IteratorBase(TreeRef st, size_t shard, TreeIterator it);
+		void skip_empty();
+
+		TreeRef st = nullptr;
+		size_t shard = 0;
+		TreeIterator it;
+	};
+	/// @endcond
+
+	using iterator = IteratorBase<false>;
+	using const_iterator = IteratorBase<true>;
+
+	/**
+	 * @brief Constructs a new, empty sharded tree
+	 *
+	 * @param shard_count  The number of shards
+	 * @param splitter     The initial splitter. Must not return shard indices
+	 * greater than or equal to <shard_count>.
+	 */
+	explicit ShardedTree(size_t shard_count, Splitter splitter = Splitter());
+	~ShardedTree();
+
+	// Trees that are shared between threads may not move.
+	ShardedTree(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * Only locks the shard that <node> belongs to.
+	 *
+	 * @param node The node to be inserted
+	 */
+	void insert(Node & node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * Only locks the shard that <node> belongs to.
+	 *
+	 * @param node The node to be removed
+	 */
+	void remove(Node & node);
+
+	/**
+	 * @brief Finds an element in the tree
+	 *
+	 * Only locks the shard that <query> belongs to. See Tree::find() for the
+	 * semantics.
+	 *
+	 * @param query An object comparing equally to the element that should be
+	 * found. Must be accepted by Splitter::get_shard().
+	 * @return A pointer to the found node or nullptr if no such node exists.
+	 */
+	template <class Comparable>
+	Node * find(const Comparable & query);
+
+	/**
+	 * @brief Lower-bounds an element
+	 *
+	 * Locks the shard that <query> belongs to, and (one at a time) the
+	 * following shards if necessary. See Tree::lower_bound() for the semantics.
+	 *
+	 * @param query An object comparable to Node that should be lower-bounded.
+	 * Must be accepted by Splitter::get_shard().
+	 * @return A pointer to the found node or nullptr if no such node exists.
+	 */
+	template <class Comparable>
+	Node * lower_bound(const Comparable & query);
+
+	/**
+	 * @brief Returns the number of elements in the tree
+	 *
+	 * If called concurrently with insertions or removals, any value between the
+	 * sizes before and after these operations may be returned.
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Returns whether the tree is empty
+	 */
+	bool empty() const noexcept;
+
+	/**
+	 * @brief Computes new splitter keys and moves the nodes accordingly
+	 *
+	 * Locks all shards, asks the splitter for a new split of all nodes (see
+	 * Splitter::split()) and moves all nodes that now belong to a different
+	 * shard.
+	 */
+	void rebalance();
+
+	/**
+	 * @brief Rebalances if the shards' sizes have drifted apart too far
+	 *
+	 * Cheap to call (without locking anything) if no rebalancing is necessary.
+	 *
+	 * @param max_skew  Rebalance if the largest shard is more than <max_skew>
+	 * times as large as an average shard.
+	 * @return true if the tree was rebalanced
+	 */
+	bool rebalance_if_skewed(double max_skew = 2.0);
+
+	/**
+	 * @brief Returns the number of shards
+	 */
+	size_t get_shard_count() const noexcept;
+
+	/**
+	 * @brief Returns the number of nodes in a shard
+	 *
+	 * @param shard  The index of the shard
+	 */
+	size_t get_shard_size(size_t shard) const noexcept;
+
+	/**
+	 * @brief Returns an iterator over all nodes in all shards, in order
+	 *
+	 * Must not be used concurrently to any modification.
+	 */
+	iterator begin();
+	const_iterator begin() const;
+	const_iterator cbegin() const;
+
+	/**
+	 * @brief Returns an iterator pointing after the last node
+	 */
+	iterator end();
+	const_iterator end() const;
+	const_iterator cend() const;
+
+	// Debugging methods. These must not be called concurrently with anything.
+	void dbg_verify() const;
+
+private:
+	struct alignas(64) Shard
+	{
+		Tree t;
+		std::mutex mutex;
+		std::atomic<size_t> count;
+	};
+
+	template <class Comparable>
+	size_t lock_shard(const Comparable & query);
+	size_t get_first_nonempty_shard(size_t from) const noexcept;
+
+	size_t shard_count;
+	std::unique_ptr<Shard[]> shards;
+
+	std::atomic<Splitter *> splitter;
+	concurrent_read_internal::EpochManager em;
+	std::mutex rebalance_mutex;
+};
+
+} // namespace ygg
+
+#ifndef YGG_SHARDED_TREE_CPP
+#include "sharded_tree.cpp"
+#endif
+
+#endif // YGG_SHARDED_TREE_HPP
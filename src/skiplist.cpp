@@ -0,0 +1,516 @@
+#ifndef YGG_SKIPLIST_CPP
+#define YGG_SKIPLIST_CPP
+
+#include "skiplist.hpp"
+
+namespace ygg {
+
+namespace skiplist_internal {
+// @cond INTERNAL
+
+template <size_t height>
+Tower<height>::Tower() noexcept
+{
+	for (size_t level = 0; level < height; ++level) {
+		this->next[level].store(0, std::memory_order_relaxed);
+	}
+}
+
+template <size_t height>
+Tower<height>::Tower(const Tower<height> & other) noexcept : Tower()
+{
+	(void)other;
+}
+
+template <size_t height>
+Tower<height> &
+Tower<height>::operator=(const Tower<height> & other) noexcept
+{
+	(void)other;
+	return *this;
+}
+
+// @endcond
+} // namespace skiplist_internal
+
+template <class Node, class Options, class Tag>
+size_t
+SkipListNodeBase<Node, Options, Tag>::dbg_get_height() const noexcept
+{
+	return this->_sl_height;
+}
+
+/*
+ * Iterators
+ */
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::IteratorBase(
+    Node * n_in)
+    : n(n_in)
+{}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::IteratorBase(
+    const IteratorBase<false> & other)
+    : n(other.n)
+{}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+typename SkipList<Node, Options, Tag,
+                  Compare>::template IteratorBase<is_const>::reference
+    SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::operator*()
+        const
+{
+	return *this->n;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+typename SkipList<Node, Options, Tag,
+                  Compare>::template IteratorBase<is_const>::pointer
+    SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::operator->()
+        const
+{
+	return this->n;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+typename SkipList<Node, Options, Tag,
+                  Compare>::template IteratorBase<is_const> &
+SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::operator++()
+{
+	this->n = MyClass::skip_marked(MyClass::get_node(
+	    MyClass::tower(this->n).next[0].load(std::memory_order_acquire)));
+	return *this;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+typename SkipList<Node, Options, Tag, Compare>::template IteratorBase<is_const>
+SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::operator++(int)
+{
+	IteratorBase cpy = *this;
+	++(*this);
+	return cpy;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+bool
+SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::operator==(
+    const IteratorBase & other) const
+{
+	return this->n == other.n;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool is_const>
+bool
+SkipList<Node, Options, Tag, Compare>::IteratorBase<is_const>::operator!=(
+    const IteratorBase & other) const
+{
+	return this->n != other.n;
+}
+
+/*
+ * SkipList
+ */
+template <class Node, class Options, class Tag, class Compare>
+SkipList<Node, Options, Tag, Compare>::SkipList() noexcept : s(0)
+{}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::Tower &
+SkipList<Node, Options, Tag, Compare>::tower(Node * n) noexcept
+{
+	return n->NB::_sl_tower;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+const typename SkipList<Node, Options, Tag, Compare>::Tower &
+SkipList<Node, Options, Tag, Compare>::tower(const Node * n) noexcept
+{
+	return n->NB::_sl_tower;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+Node *
+SkipList<Node, Options, Tag, Compare>::get_node(uintptr_t link) noexcept
+{
+	return reinterpret_cast<Node *>(link & ~static_cast<uintptr_t>(1));
+}
+
+template <class Node, class Options, class Tag, class Compare>
+uintptr_t
+SkipList<Node, Options, Tag, Compare>::get_link(const Node * n) noexcept
+{
+	return reinterpret_cast<uintptr_t>(n);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+size_t
+SkipList<Node, Options, Tag, Compare>::choose_height(const Node & node) noexcept
+{
+	// Mix the bits of the address, then every pair of zero bits adds a level.
+	uint64_t hash =
+	    utilities::mix_hash(static_cast<uint64_t>(get_link(&node)));
+
+	size_t height = 1;
+	while ((height < max_height) && ((hash & 3) == 0)) {
+		height++;
+		hash >>= 2;
+	}
+	return height;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+Node *
+SkipList<Node, Options, Tag, Compare>::skip_marked(Node * n) noexcept
+{
+	while (n != nullptr) {
+		const uintptr_t next = tower(n).next[0].load(std::memory_order_acquire);
+		if (!Tower::is_marked(next)) {
+			break;
+		}
+		n = get_node(next);
+	}
+	return n;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+bool
+SkipList<Node, Options, Tag, Compare>::locate(const Comparable & query,
+                                              Tower ** preds, Node ** succs)
+    CMP_NOEXCEPT(query)
+{
+	bool restart = true;
+	Node * cur = nullptr;
+
+	while (restart) {
+		restart = false;
+		Tower * pred = &this->head;
+
+		for (size_t level = max_height; (level > 0) && !restart; --level) {
+			cur = get_node(pred->next[level - 1].load(std::memory_order_acquire));
+
+			while (cur != nullptr) {
+				const uintptr_t next =
+				    tower(cur).next[level - 1].load(std::memory_order_acquire);
+
+				if (Tower::is_marked(next)) {
+					// cur is being removed - help unlinking it. If pred has changed (or
+					// is being removed itself), start over.
+					uintptr_t expected = get_link(cur);
+					if (!pred->next[level - 1].compare_exchange_strong(
+					        expected, next & ~static_cast<uintptr_t>(1),
+					        std::memory_order_acq_rel, std::memory_order_acquire)) {
+						restart = true;
+						break;
+					}
+					cur = get_node(next);
+				} else if (this->cmp(*cur, query)) {
+					pred = &tower(cur);
+					cur = get_node(next);
+				} else {
+					break;
+				}
+			}
+
+			preds[level - 1] = pred;
+			succs[level - 1] = cur;
+		}
+	}
+
+	return (cur != nullptr) && !this->cmp(query, *cur);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+Node *
+SkipList<Node, Options, Tag, Compare>::search(const Comparable & query) const
+    CMP_NOEXCEPT(query)
+{
+	const Tower * pred = &this->head;
+	Node * cur = nullptr;
+
+	for (size_t level = max_height; level > 0; --level) {
+		cur = get_node(pred->next[level - 1].load(std::memory_order_acquire));
+
+		while (cur != nullptr) {
+			const uintptr_t next =
+			    tower(cur).next[level - 1].load(std::memory_order_acquire);
+
+			if (Tower::is_marked(next)) {
+				// Skip over nodes that are being removed
+				cur = get_node(next);
+			} else if (this->cmp(*cur, query)) {
+				pred = &tower(cur);
+				cur = get_node(next);
+			} else {
+				break;
+			}
+		}
+	}
+
+	return cur;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+bool
+SkipList<Node, Options, Tag, Compare>::insert(Node & node) CMP_NOEXCEPT(node)
+{
+	Tower * preds[max_height];
+	Node * succs[max_height];
+
+	const size_t height = choose_height(node);
+	node.NB::_sl_height = static_cast<uint8_t>(height);
+	Tower & own = tower(&node);
+
+	// Linking into the lowest level makes the node part of the list
+	while (true) {
+		if (this->locate(node, preds, succs)) {
+			// Leave the node marked on all levels, so that remove() knows that it
+			// is not in the list.
+			for (size_t level = 0; level < height; ++level) {
+				own.next[level].store(1, std::memory_order_relaxed);
+			}
+			return false;
+		}
+
+		own.next[0].store(get_link(succs[0]), std::memory_order_relaxed);
+		uintptr_t expected = get_link(succs[0]);
+		if (preds[0]->next[0].compare_exchange_strong(expected, get_link(&node),
+		                                              std::memory_order_release,
+		                                              std::memory_order_relaxed)) {
+			break;
+		}
+	}
+	this->s.fetch_add(1, std::memory_order_relaxed);
+
+	// The upper levels are only shortcuts. Since the node cannot be removed
+	// before insert() has returned, nobody else writes to its forward links on
+	// these levels.
+	for (size_t level = 1; level < height; ++level) {
+		while (true) {
+			// The search after a failed attempt may have moved the successor
+			own.next[level].store(get_link(succs[level]), std::memory_order_relaxed);
+
+			uintptr_t expected = get_link(succs[level]);
+			if (preds[level]->next[level].compare_exchange_strong(
+			        expected, get_link(&node), std::memory_order_release,
+			        std::memory_order_relaxed)) {
+				break;
+			}
+
+			// Something changed around the node - search the new position
+			this->locate(node, preds, succs);
+		}
+	}
+
+	return true;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+bool
+SkipList<Node, Options, Tag, Compare>::remove(Node & node) CMP_NOEXCEPT(node)
+{
+	Tower & own = tower(&node);
+	const size_t height = node.NB::_sl_height;
+
+	// Marking the links (from top to bottom) makes sure that no node is ever
+	// linked in behind this node again. The upper levels may be marked by
+	// several threads removing the same node.
+	for (size_t level = height - 1; level > 0; --level) {
+		uintptr_t next = own.next[level].load(std::memory_order_relaxed);
+		while (!Tower::is_marked(next)) {
+			own.next[level].compare_exchange_weak(next, next | 1,
+			                                      std::memory_order_acq_rel,
+			                                      std::memory_order_relaxed);
+		}
+	}
+
+	// The node is logically removed as soon as the link on the lowest level is
+	// marked. Only the thread that sets this mark has removed the node.
+	uintptr_t next = own.next[0].load(std::memory_order_relaxed);
+	do {
+		if (Tower::is_marked(next)) {
+			return false;
+		}
+	} while (!own.next[0].compare_exchange_weak(next, next | 1,
+	                                            std::memory_order_acq_rel,
+	                                            std::memory_order_relaxed));
+	this->s.fetch_sub(1, std::memory_order_relaxed);
+
+	// Searching for the node unlinks it from all levels
+	Tower * preds[max_height];
+	Node * succs[max_height];
+	this->locate(node, preds, succs);
+
+	return true;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+typename SkipList<Node, Options, Tag, Compare>::iterator
+SkipList<Node, Options, Tag, Compare>::find(const Comparable & query)
+    CMP_NOEXCEPT(query)
+{
+	Node * n = this->search(query);
+	if ((n == nullptr) || this->cmp(query, *n)) {
+		return this->end();
+	}
+	return iterator(n);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+typename SkipList<Node, Options, Tag, Compare>::const_iterator
+SkipList<Node, Options, Tag, Compare>::find(const Comparable & query) const
+    CMP_NOEXCEPT(query)
+{
+	Node * n = this->search(query);
+	if ((n == nullptr) || this->cmp(query, *n)) {
+		return this->end();
+	}
+	return const_iterator(n);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+typename SkipList<Node, Options, Tag, Compare>::iterator
+SkipList<Node, Options, Tag, Compare>::lower_bound(const Comparable & query)
+    CMP_NOEXCEPT(query)
+{
+	return iterator(this->search(query));
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+typename SkipList<Node, Options, Tag, Compare>::const_iterator
+SkipList<Node, Options, Tag, Compare>::lower_bound(
+    const Comparable & query) const CMP_NOEXCEPT(query)
+{
+	return const_iterator(this->search(query));
+}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::iterator
+SkipList<Node, Options, Tag, Compare>::begin() noexcept
+{
+	return iterator(skip_marked(
+	    get_node(this->head.next[0].load(std::memory_order_acquire))));
+}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::const_iterator
+SkipList<Node, Options, Tag, Compare>::begin() const noexcept
+{
+	return const_iterator(skip_marked(
+	    get_node(this->head.next[0].load(std::memory_order_acquire))));
+}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::const_iterator
+SkipList<Node, Options, Tag, Compare>::cbegin() const noexcept
+{
+	return this->begin();
+}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::iterator
+SkipList<Node, Options, Tag, Compare>::end() noexcept
+{
+	return iterator(nullptr);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::const_iterator
+SkipList<Node, Options, Tag, Compare>::end() const noexcept
+{
+	return const_iterator(nullptr);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+typename SkipList<Node, Options, Tag, Compare>::const_iterator
+SkipList<Node, Options, Tag, Compare>::cend() const noexcept
+{
+	return this->end();
+}
+
+template <class Node, class Options, class Tag, class Compare>
+size_t
+SkipList<Node, Options, Tag, Compare>::size() const noexcept
+{
+	static_assert(Options::constant_time_size,
+	              "size() requires CONSTANT_TIME_SIZE to be set.");
+	return this->s.load(std::memory_order_relaxed);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+bool
+SkipList<Node, Options, Tag, Compare>::empty() const noexcept
+{
+	return this->begin() == this->end();
+}
+
+template <class Node, class Options, class Tag, class Compare>
+size_t
+SkipList<Node, Options, Tag, Compare>::dbg_count() const noexcept
+{
+	size_t count = 0;
+	for (auto it = this->begin(); it != this->end(); ++it) {
+		count++;
+	}
+	return count;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+SkipList<Node, Options, Tag, Compare>::dbg_verify() const
+{
+	for (size_t level = 0; level < max_height; ++level) {
+		const Node * prev = nullptr;
+		// Every level must be a sublist of the level below
+		const Node * below = nullptr;
+		if (level > 0) {
+			below = get_node(
+			    this->head.next[level - 1].load(std::memory_order_relaxed));
+		}
+
+		const Node * cur =
+		    get_node(this->head.next[level].load(std::memory_order_relaxed));
+		while (cur != nullptr) {
+			const uintptr_t next =
+			    tower(cur).next[level].load(std::memory_order_relaxed);
+			debug::yggassert(!Tower::is_marked(next));
+			debug::yggassert(cur->NB::_sl_height > level);
+			if (prev != nullptr) {
+				debug::yggassert(this->cmp(*prev, *cur));
+			}
+
+			if (level > 0) {
+				while ((below != nullptr) && (below != cur)) {
+					below = get_node(
+					    tower(below).next[level - 1].load(std::memory_order_relaxed));
+				}
+				debug::yggassert(below == cur);
+			}
+
+			prev = cur;
+			cur = get_node(next);
+		}
+	}
+
+	if constexpr (Options::constant_time_size) {
+		debug::yggassert(this->size() == this->dbg_count());
+	}
+}
+
+} // namespace ygg
+
+#endif // YGG_SKIPLIST_CPP
@@ -0,0 +1,322 @@
+#ifndef YGG_SKIPLIST_HPP
+#define YGG_SKIPLIST_HPP
+
+#include "debug.hpp"
+#include "options.hpp"
+#include "util.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace ygg {
+
+namespace skiplist_internal {
+/// @cond INTERNAL
+
+/*
+ * The forward links of a node, or of the head of a SkipList. The lowest bit of
+ * a link is set ("marked") if the node owning the link is being removed. A
+ * marked link is never changed again.
+ */
+template <size_t height>
+class Tower {
+public:
+	Tower() noexcept;
+	// Copying a node does not copy its position in a list.
+	Tower(const Tower<height> & other) noexcept;
+	Tower<height> & operator=(const Tower<height> & other) noexcept;
+
+	static bool
+	is_marked(uintptr_t link) noexcept
+	{
+		return (link & 1) != 0;
+	}
+
+	std::atomic<uintptr_t> next[height];
+};
+
+/// @endcond
+} // namespace skiplist_internal
+
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the SkipList *must* derive from this class
+ * (template). It supplies your class with the tower of forward links. Every
+ * node stores TreeFlags::SKIPLIST_MAX_HEIGHT links, of which it uses a random
+ * number.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam Options  The options class (a version of TreeOptions) that you
+ * parameterize the list with. (See the options parameter of SkipList.)
+ * @tparam Tag 		The tag used to identify the list that this node should
+ * be inserted into. See SkipList for details.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class SkipListNodeBase {
+public:
+	// Debugging methods
+	size_t dbg_get_height() const noexcept;
+
+private:
+	template <class, class, class, class>
+	friend class SkipList;
+
+	skiplist_internal::Tower<Options::skiplist_max_height> _sl_tower;
+	uint8_t _sl_height = 0;
+};
+
+/**
+ * @brief A lock-free skip list that can be used by many threads at the same
+ * time
+ *
+ * This is an ordered container that allows to call insert(), remove(), find()
+ * and lower_bound() from many threads concurrently, without any external
+ * synchronization. No operation ever takes a lock: all changes to the list are
+ * single compare-and-swap operations on the forward links of the nodes.
+ *
+ * Every node takes part in a random number of levels (its "height"), where
+ * each level contains about a quarter of the nodes of the level below. The
+ * height of a node is derived from a hash of its address, so no random number
+ * generator is shared between threads. Removing a node first marks its
+ * forward links, which stops any thread from linking new nodes behind it, and
+ * then unlinks it level by level. Any operation that runs into a marked node
+ * helps unlinking it.
+ *
+ * Iterators are forward iterators that skip over nodes that are being
+ * removed. Iterating while other threads modify the list is allowed; you will
+ * see every node that is in the list during the whole iteration, and you may
+ * or may not see nodes that are inserted or removed concurrently.
+ *
+ * @warning A removed node may still be looked at by threads that were running
+ * concurrently to its removal. You must not destroy, modify or re-insert a
+ * removed node until all operations (and iterations) that have been running
+ * while remove() was called have finished. Also, remove() may only be called on
+ * a node after its insert() has returned.
+ *
+ * @warning The list does not support multiple nodes comparing equally. Setting
+ * TreeFlags::MULTIPLE is an error.
+ *
+ * @tparam Node         The node class for this list. It must be derived from
+ * SkipListNodeBase.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this list. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies
+ * this list. Can be used to insert the same nodes into multiple lists. Can be
+ * any class, the class can be empty.
+ * @tparam Compare      A compare class. The Skip List follows STL
+ * semantics for 'Compare'. Defaults to ygg::utilities::flexible_less. Implement
+ * operator<(const Node & lhs, const Node & rhs) if you want to use it.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int,
+          class Compare = ygg::utilities::flexible_less>
+class SkipList {
+public:
+	using NB = SkipListNodeBase<Node, Options, Tag>;
+	using MyClass = SkipList<Node, Options, Tag, Compare>;
+
+	/**********************************************
+	 * Sanity Checks                              *
+	 **********************************************/
+	static_assert(std::is_base_of<NB, Node>::value,
+	              "Node class not properly derived from node base!");
+	static_assert(!Options::multiple,
+	              "The Skip List does not support MULTIPLE.");
+	static_assert((Options::skiplist_max_height >= 1) &&
+	                  (Options::skiplist_max_height <= 32),
+	              "SKIPLIST_MAX_HEIGHT must be between 1 and 32.");
+
+	/// @cond INTERNAL
+	template <bool is_const>
+	class IteratorBase {
+	public:
+		using difference_type = ptrdiff_t;
+		using value_type = Node;
+		using reference = std::conditional_t<is_const, const Node &, Node &>;
+		using pointer = std::conditional_t<is_const, const Node *, Node *>;
+		using iterator_category = std::forward_iterator_tag;
+
+		IteratorBase() = default;
+		// Allows conversion from iterator to const_iterator
+		IteratorBase(const IteratorBase<false> & other);
+
+		reference operator*() const;
+		pointer operator->() const;
+
+		IteratorBase & operator++();
+		IteratorBase operator++(int);
+
+		bool operator==(const IteratorBase & other) const;
+		bool operator!=(const IteratorBase & other) const;
+
+	private:
+		friend class SkipList;
+		template <bool>
+		friend class IteratorBase;
+
+		explicit IteratorBase(Node * n);
+
+		Node * n = nullptr;
+	};
+	/// @endcond
+
+	/**
+	 * @brief Iterators over the nodes of the list, in sorted order
+	 */
+	using iterator = IteratorBase<false>;
+	using const_iterator = IteratorBase<true>;
+
+	/**
+	 * @brief Construct a new empty Skip List.
+	 */
+	SkipList() noexcept;
+
+	// Lists that are shared between threads may not move.
+	SkipList(const MyClass & other) = delete;
+	MyClass & operator=(const MyClass & other) = delete;
+
+	/**
+	 * @brief Inserts <node> into the list
+	 *
+	 * Inserts <node> into the list. If a node comparing equally to <node> is
+	 * already in the list, <node> is not inserted. May be called concurrently to
+	 * all other methods except for the debugging methods.
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*.
+	 *
+	 * @param   node  The node to be inserted.
+	 * @return true if <node> was inserted, false if an equal node was already in
+	 * the list
+	 */
+	bool insert(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Removes <node> from the list
+	 *
+	 * Removes <node> from the list. May be called concurrently to all other
+	 * methods except for the debugging methods. If several threads remove the
+	 * same node at the same time, exactly one of them removes it. See the class
+	 * documentation for when <node> may be reused.
+	 *
+	 * @param   node  The node to be removed.
+	 * @return true if this call removed <node>, false if it had already been
+	 * removed or insert() had rejected it
+	 */
+	bool remove(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Finds an element in the list
+	 *
+	 * Returns an iterator to the element that compares equally to <query>. Note
+	 * that <query> does not have to be a Node, but can be anything that can be
+	 * compared to a Node (see BinarySearchTree::find()).
+	 *
+	 * This never writes to shared memory and may be called concurrently to all
+	 * other methods except for the debugging methods.
+	 *
+	 * @param query An object comparing equally to the element that should be
+	 * found.
+	 * @returns An iterator to the element comparing equally to <query>, or end()
+	 * if no such element exists
+	 */
+	template <class Comparable>
+	iterator find(const Comparable & query) CMP_NOEXCEPT(query);
+	template <class Comparable>
+	const_iterator find(const Comparable & query) const CMP_NOEXCEPT(query);
+
+	/**
+	 * @brief Returns an iterator to the first element not smaller than <query>
+	 *
+	 * See find() for what <query> can be, and for concurrency.
+	 *
+	 * @param query An object that can be compared to a Node
+	 * @returns An iterator to the first element not smaller than <query>, or
+	 * end() if no such element exists
+	 */
+	template <class Comparable>
+	iterator lower_bound(const Comparable & query) CMP_NOEXCEPT(query);
+	template <class Comparable>
+	const_iterator lower_bound(const Comparable & query) const
+	    CMP_NOEXCEPT(query);
+
+	/**
+	 * @brief Returns an iterator to the smallest element
+	 */
+	iterator begin() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+
+	/**
+	 * @brief Returns an iterator pointing after the largest element
+	 */
+	iterator end() noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+
+	/**
+	 * @brief Returns the number of elements in the list
+	 *
+	 * Only available if TreeFlags::CONSTANT_TIME_SIZE is set. If called
+	 * concurrently with insertions or removals, any value between the sizes
+	 * before and after these operations may be returned.
+	 *
+	 * @return The number of elements in the list
+	 */
+	size_t size() const noexcept;
+
+	/**
+	 * @brief Returns whether the list is empty
+	 *
+	 * @return true if the list is empty, false otherwise
+	 */
+	bool empty() const noexcept;
+
+	// Debugging methods. These must not be called concurrently with anything.
+	void dbg_verify() const;
+	size_t dbg_count() const noexcept;
+
+private:
+	static constexpr size_t max_height = Options::skiplist_max_height;
+	using Tower = skiplist_internal::Tower<max_height>;
+
+	static Tower & tower(Node * n) noexcept;
+	static const Tower & tower(const Node * n) noexcept;
+	static Node * get_node(uintptr_t link) noexcept;
+	static uintptr_t get_link(const Node * n) noexcept;
+	static size_t choose_height(const Node & node) noexcept;
+	static Node * skip_marked(Node * n) noexcept;
+
+	/*
+	 * Finds the last node smaller than <query> and the first node not smaller
+	 * than <query> on every level. Marked nodes on the way are unlinked.
+	 * Returns whether the first node not smaller than <query> on the lowest
+	 * level compares equally to <query>.
+	 */
+	template <class Comparable>
+	bool locate(const Comparable & query, Tower ** preds,
+	            Node ** succs) CMP_NOEXCEPT(query);
+
+	// Same as locate(), but only returns the node on the lowest level, and
+	// never writes.
+	template <class Comparable>
+	Node * search(const Comparable & query) const CMP_NOEXCEPT(query);
+
+	Tower head;
+	Compare cmp;
+	std::atomic<size_t> s;
+};
+
+} // namespace ygg
+
+#ifndef YGG_SKIPLIST_CPP
+#include "skiplist.cpp"
+#endif
+
+#endif // YGG_SKIPLIST_HPP
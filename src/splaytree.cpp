@@ -0,0 +1,448 @@
+#ifndef YGG_SPLAYTREE_CPP
+#define YGG_SPLAYTREE_CPP
+
+#include "splaytree.hpp"
+
+#include "util.hpp"
+
+namespace ygg {
+
+template <class Node, class Options, class Tag, class Compare>
+SplayTree<Node, Options, Tag, Compare>::SplayTree() noexcept
+{}
+
+template <class Node, class Options, class Tag, class Compare>
+SplayTree<Node, Options, Tag, Compare>::SplayTree(MyClass && other) noexcept
+{
+	this->root = other.root;
+	other.root = nullptr;
+	this->s = other.s;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+SplayTree<Node, Options, Tag, Compare>::insert(Node & node) CMP_NOEXCEPT(node)
+{
+	this->s.add(1);
+
+	node.NB::set_left(nullptr);
+	node.NB::set_right(nullptr);
+
+	if (__builtin_expect(this->root == nullptr, false)) {
+		node.NB::set_parent(nullptr);
+		this->root = &node;
+		return;
+	}
+
+	if constexpr (Options::splay_semi) {
+		// Insert as a leaf, then semi-splay the new leaf.
+		Node * parent = this->template search_path_end<Node, true>(node);
+		if constexpr (!Options::multiple) {
+			if (!this->cmp(*parent, node) && !this->cmp(node, *parent)) {
+				// Same as existing. Reduce size (because we increased it earlier)
+				// and exit.
+				this->s.reduce(1);
+				this->template splay_up<true>(parent, nullptr);
+				return;
+			}
+		}
+
+		if (this->cmp(*parent, node)) {
+			parent->NB::set_right(&node);
+		} else {
+			parent->NB::set_left(&node);
+		}
+		node.NB::set_parent(parent);
+
+		this->template splay_up<true>(&node, nullptr);
+	} else {
+		Node * top = this->splay_top_down(node);
+
+		// After splaying, everything in the right subtree of top is larger than
+		// node, and everything in the left subtree is smaller (or equal).
+		if (this->cmp(*top, node)) {
+			node.NB::set_right(top->NB::get_right());
+			node.NB::set_left(top);
+			top->NB::set_right(nullptr);
+		} else {
+			if constexpr (!Options::multiple) {
+				if (!this->cmp(node, *top)) {
+					this->s.reduce(1);
+					return;
+				}
+			}
+
+			node.NB::set_left(top->NB::get_left());
+			node.NB::set_right(top);
+			top->NB::set_left(nullptr);
+		}
+
+		if (node.NB::get_left() != nullptr) {
+			node.NB::get_left()->NB::set_parent(&node);
+		}
+		if (node.NB::get_right() != nullptr) {
+			node.NB::get_right()->NB::set_parent(&node);
+		}
+		node.NB::set_parent(nullptr);
+		this->root = &node;
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+SplayTree<Node, Options, Tag, Compare>::remove(Node & node) CMP_NOEXCEPT(node)
+{
+	this->s.reduce(1);
+
+	// Splay the node to the root, then join its two subtrees below the maximum
+	// of the left subtree.
+	this->template splay_up<false>(&node, nullptr);
+
+	Node * left = node.NB::get_left();
+	Node * right = node.NB::get_right();
+
+	if (left == nullptr) {
+		this->root = right;
+		if (right != nullptr) {
+			right->NB::set_parent(nullptr);
+		}
+		return;
+	}
+
+	Node * max = left;
+	while (max->NB::get_right() != nullptr) {
+		max = max->NB::get_right();
+	}
+	this->template splay_up<false>(max, &node);
+
+	// max now is the left child of node, and has no right child.
+	max->NB::set_right(right);
+	if (right != nullptr) {
+		right->NB::set_parent(max);
+	}
+	max->NB::set_parent(nullptr);
+	this->root = max;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+ygg::utilities::select_type_t<size_t, Node *, Options::stl_erase>
+SplayTree<Node, Options, Tag, Compare>::erase(const Comparable & c)
+    CMP_NOEXCEPT(c)
+{
+	// If we allow multisets and want to be STL-conform, we must find the *first*
+	// node carrying c, so that we can iteratively delete all of them
+	auto el = this->TB::template find<Comparable,
+	                                  (Options::stl_erase && Options::multiple)>(
+	    c);
+
+	if (el != this->end()) {
+		if constexpr (Options::stl_erase) {
+			size_t count = 1;
+
+			auto next = el + 1;
+			this->remove(*el);
+			if (Options::multiple) {
+				el = next;
+
+				while (__builtin_expect((el != this->end()) && (!this->cmp(c, *el)),
+				                        false)) {
+					count++;
+					next = el + 1;
+					this->remove(*el);
+					el = next;
+				}
+			} else {
+				(void)next;
+			}
+			return count;
+		} else {
+			Node * n = &(*el);
+			this->remove(*el);
+			return n;
+		}
+	}
+
+	if constexpr (Options::stl_erase) {
+		return 0;
+	} else {
+		return static_cast<Node *>(nullptr);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+typename SplayTree<Node, Options, Tag, Compare>::template iterator<false>
+SplayTree<Node, Options, Tag, Compare>::find(const Comparable & query)
+    CMP_NOEXCEPT(query)
+{
+	if constexpr (Options::splay_every > 1) {
+		if (--this->lookups_until_splay != 0) {
+			return this->TB::template find<Comparable>(query);
+		}
+		this->lookups_until_splay = Options::splay_every;
+	}
+
+	if (this->root == nullptr) {
+		return this->end();
+	}
+
+	Node * last;
+	if constexpr (Options::splay_semi) {
+		last = this->template search_path_end<Comparable, false>(query);
+		this->template splay_up<true>(last, nullptr);
+	} else {
+		last = this->splay_top_down(query);
+	}
+
+	if (!this->cmp(*last, query) && !this->cmp(query, *last)) {
+		return iterator<false>(last);
+	}
+	return this->end();
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+typename SplayTree<Node, Options, Tag, Compare>::template const_iterator<false>
+SplayTree<Node, Options, Tag, Compare>::find(const Comparable & query) const
+    CMP_NOEXCEPT(query)
+{
+	return this->TB::template find<Comparable>(query);
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable, bool to_leaf>
+Node *
+SplayTree<Node, Options, Tag, Compare>::search_path_end(
+    const Comparable & query) const CMP_NOEXCEPT(query)
+{
+	Node * cur = this->root;
+	Node * last = nullptr;
+
+	while (cur != nullptr) {
+		last = cur;
+
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(cur->NB::get_left());
+			__builtin_prefetch(cur->NB::get_right());
+		}
+
+		// When looking for a leaf position in a multiset, equal nodes are passed
+		// on the left.
+		const bool go_right = this->cmp(*cur, query);
+		if constexpr (!(to_leaf && Options::multiple)) {
+			if (!go_right && !this->cmp(query, *cur)) {
+				return cur;
+			}
+		}
+
+		if constexpr (Options::micro_avoid_conditionals) {
+			cur = utilities::go_right_if(go_right, cur);
+		} else {
+			if (go_right) {
+				cur = cur->NB::get_right();
+			} else {
+				cur = cur->NB::get_left();
+			}
+		}
+	}
+
+	return last;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <class Comparable>
+Node *
+SplayTree<Node, Options, Tag, Compare>::splay_top_down(const Comparable & query)
+    CMP_NOEXCEPT(query)
+{
+	// The left tree collects nodes smaller than query, the right tree nodes
+	// larger than query. We keep pointers to their roots and to the nodes at
+	// which the next node is attached (the maximum resp. minimum).
+	Node * left_root = nullptr;
+	Node * left_max = nullptr;
+	Node * right_root = nullptr;
+	Node * right_min = nullptr;
+
+	Node * cur = this->root;
+	while (true) {
+		if constexpr (Options::micro_prefetch) {
+			__builtin_prefetch(cur->NB::get_left());
+			__builtin_prefetch(cur->NB::get_right());
+		}
+
+		if (this->cmp(query, *cur)) {
+			Node * left = cur->NB::get_left();
+			if (left == nullptr) {
+				break;
+			}
+			if (this->cmp(query, *left)) {
+				// zig-zig: rotate right at cur
+				cur->NB::set_left(left->NB::get_right());
+				if (cur->NB::get_left() != nullptr) {
+					cur->NB::get_left()->NB::set_parent(cur);
+				}
+				left->NB::set_right(cur);
+				cur->NB::set_parent(left);
+				cur = left;
+				if (cur->NB::get_left() == nullptr) {
+					break;
+				}
+			}
+
+			// Link cur into the right tree as its new minimum
+			if (right_min == nullptr) {
+				right_root = cur;
+			} else {
+				right_min->NB::set_left(cur);
+				cur->NB::set_parent(right_min);
+			}
+			right_min = cur;
+			cur = cur->NB::get_left();
+		} else if (this->cmp(*cur, query)) {
+			Node * right = cur->NB::get_right();
+			if (right == nullptr) {
+				break;
+			}
+			if (this->cmp(*right, query)) {
+				// zag-zag: rotate left at cur
+				cur->NB::set_right(right->NB::get_left());
+				if (cur->NB::get_right() != nullptr) {
+					cur->NB::get_right()->NB::set_parent(cur);
+				}
+				right->NB::set_left(cur);
+				cur->NB::set_parent(right);
+				cur = right;
+				if (cur->NB::get_right() == nullptr) {
+					break;
+				}
+			}
+
+			// Link cur into the left tree as its new maximum
+			if (left_max == nullptr) {
+				left_root = cur;
+			} else {
+				left_max->NB::set_right(cur);
+				cur->NB::set_parent(left_max);
+			}
+			left_max = cur;
+			cur = cur->NB::get_right();
+		} else {
+			break;
+		}
+	}
+
+	// Reassemble
+	if (left_root != nullptr) {
+		left_max->NB::set_right(cur->NB::get_left());
+		if (left_max->NB::get_right() != nullptr) {
+			left_max->NB::get_right()->NB::set_parent(left_max);
+		}
+		cur->NB::set_left(left_root);
+		left_root->NB::set_parent(cur);
+	}
+	if (right_root != nullptr) {
+		right_min->NB::set_left(cur->NB::get_right());
+		if (right_min->NB::get_left() != nullptr) {
+			right_min->NB::get_left()->NB::set_parent(right_min);
+		}
+		cur->NB::set_right(right_root);
+		right_root->NB::set_parent(cur);
+	}
+	cur->NB::set_parent(nullptr);
+	this->root = cur;
+
+	return cur;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+template <bool semi>
+void
+SplayTree<Node, Options, Tag, Compare>::splay_up(Node * node,
+                                                 Node * stop) noexcept
+{
+	while (node->NB::get_parent() != stop) {
+		Node * parent = node->NB::get_parent();
+		Node * grandparent = parent->NB::get_parent();
+
+		if (grandparent == stop) {
+			// zig
+			this->rotate_up(node);
+			return;
+		}
+
+		const bool node_left = (parent->NB::get_left() == node);
+		const bool parent_left = (grandparent->NB::get_left() == parent);
+
+		if (node_left == parent_left) {
+			// zig-zig
+			this->rotate_up(parent);
+			if constexpr (semi) {
+				// Continue from the parent, which took the grandparent's place
+				node = parent;
+				continue;
+			}
+			this->rotate_up(node);
+		} else {
+			// zig-zag
+			this->rotate_up(node);
+			this->rotate_up(node);
+		}
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+SplayTree<Node, Options, Tag, Compare>::rotate_up(Node * node) noexcept
+{
+	Node * parent = node->NB::get_parent();
+	Node * grandparent = parent->NB::get_parent();
+
+	if (parent->NB::get_left() == node) {
+		parent->NB::set_left(node->NB::get_right());
+		if (parent->NB::get_left() != nullptr) {
+			parent->NB::get_left()->NB::set_parent(parent);
+		}
+		node->NB::set_right(parent);
+	} else {
+		parent->NB::set_right(node->NB::get_left());
+		if (parent->NB::get_right() != nullptr) {
+			parent->NB::get_right()->NB::set_parent(parent);
+		}
+		node->NB::set_left(parent);
+	}
+	parent->NB::set_parent(node);
+	node->NB::set_parent(grandparent);
+
+	if (grandparent == nullptr) {
+		this->root = node;
+	} else if (grandparent->NB::get_left() == parent) {
+		grandparent->NB::set_left(node);
+	} else {
+		grandparent->NB::set_right(node);
+	}
+}
+
+template <class Node, class Options, class Tag, class Compare>
+bool
+SplayTree<Node, Options, Tag, Compare>::verify_integrity() const
+{
+	try {
+		this->dbg_verify();
+	} catch (debug::VerifyException & e) {
+		return false;
+	}
+
+	return true;
+}
+
+template <class Node, class Options, class Tag, class Compare>
+void
+SplayTree<Node, Options, Tag, Compare>::dbg_verify() const
+{
+	this->TB::dbg_verify();
+}
+
+} // namespace ygg
+
+#endif // YGG_SPLAYTREE_CPP
@@ -0,0 +1,195 @@
+#ifndef YGG_SPLAYTREE_HPP
+#define YGG_SPLAYTREE_HPP
+
+#include "bst.hpp"
+#include "debug.hpp"
+#include "options.hpp"
+#include "size_holder.hpp"
+#include "tree_iterator.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+namespace ygg {
+
+/**
+ * @brief Base class (template) to supply your node class with metainformation
+ *
+ * The class you use as nodes for the Splay Tree *must* derive from this class
+ * (template). It supplies your class with the necessary members to contain the
+ * linking between the tree nodes.
+ *
+ * @tparam Node    The node class itself. Yes, that's the class derived from
+ * this template. This sounds weird, but is correct. See the examples if you're
+ * confused.
+ * @tparam options  The options class (a version of TreeOptions) that you
+ * parameterize the tree with. (See the options parameter of RBTree.)
+ * @tparam Tag 		The tag used to identify the tree that this node should
+ * be inserted into. See RBTree for details.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int>
+class SplayTreeNodeBase : public bst::BSTNodeBase<Node, Options, Tag> {
+};
+
+/**
+ * @brief The Splay Tree
+ *
+ * A self-adjusting binary search tree: every insertion and every lookup via
+ * find() moves the accessed node to the root. Recently and frequently accessed
+ * nodes therefore stay close to the root, which makes the splay tree a good
+ * choice for skewed access patterns with strong temporal locality. All
+ * operations take O(log n) amortized time, but a single operation may take
+ * O(n).
+ *
+ * Insertions and lookups use top-down splaying. See TreeFlags::SPLAY_SEMI for
+ * semi-splaying and TreeFlags::SPLAY_EVERY to splay only on some lookups.
+ * Since find() modifies the tree, only the const version of find() and the
+ * lower_bound() / upper_bound() methods are read-only.
+ *
+ * @tparam Node         The node class for this tree. It must be derived from
+ * SplayTreeNodeBase.
+ * @tparam Options			The TreeOptions class specifying the
+ * parameters of this tree. See the TreeOptions and TreeFlags classes for
+ * details.
+ * @tparam Tag					An class tag that identifies this tree. Can be used
+ * to insert the same nodes into multiple trees. Can be any class, the class can
+ * be empty.
+ * @tparam Compare      A compare class. The tree follows STL semantics for
+ * 'Compare'. Defaults to ygg::utilities::flexible_less. Implement
+ * operator<(const Node & lhs, const Node & rhs) if you want to use it.
+ */
+template <class Node, class Options = DefaultOptions, class Tag = int,
+          class Compare = ygg::utilities::flexible_less>
+class SplayTree : public bst::BinarySearchTree<Node, Options, Tag, Compare> {
+public:
+	using MyClass = SplayTree<Node, Options, Tag, Compare>;
+	// Node Base
+	using NB = SplayTreeNodeBase<Node, Options, Tag>;
+	using TB = bst::BinarySearchTree<Node, Options, Tag, Compare>;
+	static_assert(std::is_base_of<NB, Node>::value,
+	              "Node class not properly derived from SplayTreeNodeBase");
+	static_assert(Options::splay_every >= 1, "SPLAY_EVERY must be at least 1.");
+
+	/**
+	 * @brief Create a new empty splay tree.
+	 */
+	SplayTree() noexcept;
+
+	/**
+	 * @brief Create a new splay tree from a different splay tree.
+	 *
+	 * The other splay tree is moved into this one, i.e., using it afterwards is
+	 * undefined behavior.
+	 *
+	 * @param other  The splay tree that this one is constructed from
+	 */
+	SplayTree(MyClass && other) noexcept;
+
+	/*
+	 * Pull in classes from base tree
+	 */
+	template <bool reverse>
+	using iterator = typename TB::template iterator<reverse>;
+	template <bool reverse>
+	using const_iterator = typename TB::template const_iterator<reverse>;
+
+	/**
+	 * @brief Inserts <node> into the tree
+	 *
+	 * Inserts <node> into the tree and makes it the root (unless SPLAY_SEMI is
+	 * set).
+	 *
+	 * *Warning*: Please note that after calling insert() on a node (and before
+	 * removing that node again), that node *may not move in memory*. A common
+	 * pitfall is to store nodes in a std::vector (or other STL container), which
+	 * reallocates (and thereby moves objecs around).
+	 *
+	 * @param   Node  The node to be inserted.
+	 */
+	void insert(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Removes <node> from the tree
+	 *
+	 * @param   Node  The node to be removed.
+	 */
+	void remove(Node & node) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Deletes a node that compares equally to <c>
+	 *
+	 * See RBTree::erase(const Comparable &) for the semantics with and without
+	 * STL_ERASE.
+	 */
+	template <class Comparable>
+	utilities::select_type_t<size_t, Node *, Options::stl_erase>
+	erase(const Comparable & c) CMP_NOEXCEPT(c);
+
+	/**
+	 * @brief Finds an element in the tree and splays it to the root
+	 *
+	 * Returns an iterator to an element that compares equally to <query>, or
+	 * end() if no such element exists. The last node on the search path is
+	 * splayed, i.e., moved to the root of the tree (unless SPLAY_SEMI or
+	 * SPLAY_EVERY are set). If MULTIPLE is set and several elements compare
+	 * equally to <query>, it is not specified which one is returned.
+	 *
+	 * @param query An object comparing equally to the element that should be
+	 * found.
+	 */
+	template <class Comparable>
+	iterator<false> find(const Comparable & query) CMP_NOEXCEPT(query);
+
+	/**
+	 * @brief Finds an element in the tree without splaying
+	 *
+	 * See BinarySearchTree::find().
+	 */
+	template <class Comparable>
+	const_iterator<false> find(const Comparable & query) const
+	    CMP_NOEXCEPT(query);
+
+	// Mainly debugging methods
+	/// @cond INTERNAL
+	void dbg_verify() const;
+	bool verify_integrity() const;
+	/// @endcond
+
+private:
+	/*
+	 * Top-down splaying (Sleator and Tarjan): Splits the tree along the search
+	 * path of <query> into a left and a right tree, and reassembles them below
+	 * the last node on the search path, which becomes the root.
+	 */
+	template <class Comparable>
+	Node * splay_top_down(const Comparable & query) CMP_NOEXCEPT(query);
+
+	/*
+	 * Bottom-up splaying: Rotates <node> up until its parent is <stop>. If
+	 * <semi> is set, only semi-splays.
+	 */
+	template <bool semi>
+	void splay_up(Node * node, Node * stop) noexcept;
+
+	// Rotates <node> above its parent
+	void rotate_up(Node * node) noexcept;
+
+	/*
+	 * Returns the node at which the search for <query> ends, i.e., an equal
+	 * node or the last node on the search path. If <to_leaf> is set, the search
+	 * always continues to a leaf position in multisets.
+	 */
+	template <class Comparable, bool to_leaf>
+	Node * search_path_end(const Comparable & query) const CMP_NOEXCEPT(query);
+
+	size_t lookups_until_splay = Options::splay_every;
+};
+
+} // namespace ygg
+
+#ifndef YGG_SPLAYTREE_CPP
+#include "splaytree.cpp"
+#endif
+
+#endif // YGG_SPLAYTREE_HPP
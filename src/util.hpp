@@ -2,7 +2,10 @@
 #ifndef YGG_UTIL_HPP
 #define YGG_UTIL_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <iterator>
+#include <thread>
 #include <type_traits>
 
 namespace ygg {
@@ -558,6 +561,48 @@ template <class TypeWhenTrue, class TypeWhenFalse, bool b>
 using select_type_t =
     typename select_type<TypeWhenTrue, TypeWhenFalse, b>::type;
 
+/*
+ * Tells the CPU that we are busy-waiting.
+ */
+inline void
+cpu_relax() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+/*
+ * Returns a small, dense, per-thread index. The first thread calling this gets
+ * 0, the next one 1, and so on.
+ */
+inline size_t
+get_thread_index() noexcept
+{
+	static std::atomic<size_t> next_index(0);
+	thread_local size_t index =
+	    next_index.fetch_add(1, std::memory_order_relaxed);
+	return index;
+}
+
+/*
+ * Spreads the bits of a hash value (this is the finalizer of MurmurHash3). Many
+ * hashers are the identity on integers, which is bad if we use only some of
+ * the bits.
+ */
+constexpr uint64_t
+mix_hash(uint64_t hash) noexcept
+{
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
 } // namespace utilities
 } // namespace ygg
 
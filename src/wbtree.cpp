@@ -715,6 +715,35 @@ WBTree<Node, NodeTraits, Options, Tag, Compare>::insert_right_leaning(
 	this->insert_leaf_base_twopass<false>(node, this->root);
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class InputIt>
+void
+WBTree<Node, NodeTraits, Options, Tag, Compare>::build_parallel(
+    InputIt nodes_begin, InputIt nodes_end, size_t threads)
+{
+	assert(this->root == nullptr);
+
+	threads = parallel_internal::effective_threads(threads);
+	std::vector<Node *> nodes =
+	    this->collect_sorted_nodes(nodes_begin, nodes_end, threads);
+
+	constexpr bool call_hooks =
+	    !std::is_same<NodeTraits, WBDefaultNodeTraits>::value;
+	auto init = [&](Node & node, size_t depth, size_t subtree_size) {
+		(void)depth;
+		node.NB::_wbt_size = subtree_size + 1;
+		if constexpr (call_hooks) {
+			// Hooks may walk up to the root, so they are never called
+			// concurrently.
+			NodeTraits::leaf_inserted(node, *this);
+		}
+	};
+
+	this->root = TB::build_balanced(nodes.data(), nodes.size(), nullptr, 0, 0,
+	                                call_hooks ? 1 : threads, init);
+	this->s.set(nodes.size());
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
 void
 WBTree<Node, NodeTraits, Options, Tag, Compare>::verify_sizes() const
@@ -818,6 +847,157 @@ WBTree<Node, NodeTraits, Options, Tag, Compare>::dbg_verify() const
 	this->verify_sizes();
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+size_t
+WBTree<Node, NodeTraits, Options, Tag, Compare>::get_subtree_size(
+    const Node * n) noexcept
+{
+	return n->NB::_wbt_size - 1;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+typename WBTree<Node, NodeTraits, Options, Tag,
+                Compare>::template iterator<false>
+WBTree<Node, NodeTraits, Options, Tag, Compare>::select(size_t k) noexcept
+{
+	Node * cur = this->root;
+
+	while (cur != nullptr) {
+		size_t left_size = 0;
+		if (cur->NB::get_left() != nullptr) {
+			left_size = get_subtree_size(cur->NB::get_left());
+		}
+
+		if (k < left_size) {
+			cur = cur->NB::get_left();
+		} else if (k == left_size) {
+			return iterator<false>(cur);
+		} else {
+			k -= left_size + 1;
+			cur = cur->NB::get_right();
+		}
+	}
+
+	return this->end();
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+typename WBTree<Node, NodeTraits, Options, Tag,
+                Compare>::template const_iterator<false>
+WBTree<Node, NodeTraits, Options, Tag, Compare>::select(size_t k) const noexcept
+{
+	return const_iterator<false>(const_cast<MyClass *>(this)->select(k));
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+size_t
+WBTree<Node, NodeTraits, Options, Tag, Compare>::rank(
+    const Node & node) const noexcept
+{
+	size_t result = 0;
+	if (node.NB::get_left() != nullptr) {
+		result = get_subtree_size(node.NB::get_left());
+	}
+
+	// Every time we are a right child, the parent and its left subtree come
+	// before us.
+	const Node * cur = &node;
+	const Node * parent = cur->NB::get_parent();
+	while (parent != nullptr) {
+		if (parent->NB::get_right() == cur) {
+			result += 1;
+			if (parent->NB::get_left() != nullptr) {
+				result += get_subtree_size(parent->NB::get_left());
+			}
+		}
+		cur = parent;
+		parent = cur->NB::get_parent();
+	}
+
+	return result;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+typename WBTree<Node, NodeTraits, Options, Tag,
+                Compare>::template iterator<false>
+WBTree<Node, NodeTraits, Options, Tag, Compare>::quantile(double q) noexcept
+{
+	if (this->root == nullptr) {
+		return this->end();
+	}
+
+	size_t n = get_subtree_size(this->root);
+	double position = std::ceil(q * static_cast<double>(n));
+	size_t k = 0;
+	if (position >= static_cast<double>(n)) {
+		k = n - 1;
+	} else if (position >= 1) {
+		k = static_cast<size_t>(position) - 1;
+	}
+
+	return this->select(k);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+typename WBTree<Node, NodeTraits, Options, Tag,
+                Compare>::template const_iterator<false>
+WBTree<Node, NodeTraits, Options, Tag, Compare>::quantile(
+    double q) const noexcept
+{
+	return const_iterator<false>(const_cast<MyClass *>(this)->quantile(q));
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class Comparable>
+size_t
+WBTree<Node, NodeTraits, Options, Tag, Compare>::count_smaller(
+    const Comparable & query) const CMP_NOEXCEPT(query)
+{
+	size_t result = 0;
+	const Node * cur = this->root;
+
+	while (cur != nullptr) {
+		if (this->cmp(*cur, query)) {
+			result += 1;
+			if (cur->NB::get_left() != nullptr) {
+				result += get_subtree_size(cur->NB::get_left());
+			}
+			cur = cur->NB::get_right();
+		} else {
+			cur = cur->NB::get_left();
+		}
+	}
+
+	return result;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class Comparable1, class Comparable2>
+size_t
+WBTree<Node, NodeTraits, Options, Tag, Compare>::count_between(
+    const Comparable1 & lower, const Comparable2 & upper) const
+    CMP_NOEXCEPT(lower)
+{
+	size_t below_upper = this->count_smaller(upper);
+	size_t below_lower = this->count_smaller(lower);
+
+	if (below_upper <= below_lower) {
+		return 0;
+	}
+	return below_upper - below_lower;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+void
+WBTree<Node, NodeTraits, Options, Tag, Compare>::rebalance_subtree(
+    Node & node) noexcept
+{
+	this->rebuild_subtree_dsw(node, node.NB::_wbt_size - 1,
+	                          [this](Node * n) { this->rotate_left(n); },
+	                          [this](Node * n) { this->rotate_right(n); },
+	                          [](Node * n) { (void)n; });
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare>
 bool
 WBTree<Node, NodeTraits, Options, Tag, Compare>::verify_integrity() const
@@ -1718,6 +1898,49 @@ WBTree<Node, NodeTraits, Options, Tag, Compare>::remove(Node & node)
 	}
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare>
+template <class Mutator>
+bool
+WBTree<Node, NodeTraits, Options, Tag, Compare>::update_key(Node & node,
+                                                            Mutator && mutator)
+    CMP_NOEXCEPT(node)
+{
+	mutator(node);
+
+	// The mutator does not change the tree's structure, so the in-order
+	// neighbors are the same as before. Removing never compares anything.
+	Node * moved_past = this->get_moved_past(node);
+	if (moved_past == nullptr) {
+		// Data stored in the nodes might depend on the key
+		NodeTraits::deleted_below(node, *this);
+		return true;
+	}
+	this->remove(node);
+
+	if constexpr (!Options::multiple) {
+		// The hinted insertion would not see an equal node above the hint
+		if (this->find(node) != this->end()) {
+			return false;
+		}
+	}
+
+	if constexpr (Options::wbt_single_pass) {
+		// Top-down insertion must rebalance from the root on
+		this->insert(node);
+	} else {
+		Node * start = this->get_hint_subtree(node, *moved_past);
+		// The insertion only counts the new node in the subtrees below <start>
+		for (Node * cur = start->NB::get_parent(); cur != nullptr;
+		     cur = cur->NB::get_parent()) {
+			cur->NB::_wbt_size += 1;
+		}
+		this->s.add(1);
+		this->insert_leaf_base_twopass<true>(node, start);
+	}
+
+	return true;
+}
+
 } // namespace ygg
 
 #endif // YGG_RBTREE_CPP
@@ -192,6 +192,30 @@ public:
 	void insert_left_leaning(Node & node) CMP_NOEXCEPT(node);
 	void insert_right_leaning(Node & node) CMP_NOEXCEPT(node);
 
+	/**
+	 * @brief Builds the tree from a range of nodes, using multiple threads
+	 *
+	 * Inserts all nodes in [nodes_begin, nodes_end) into the tree, which must be
+	 * empty. The range does not need to be sorted. The nodes are sorted in
+	 * parallel and then linked into a perfectly balanced tree, with different
+	 * threads building disjoint subtrees.
+	 *
+	 * If MULTIPLE is not set, of several equal nodes only the first one in the
+	 * range is inserted.
+	 *
+	 * If NodeTraits is not WBDefaultNodeTraits, its leaf_inserted() hook is
+	 * called for every node in top-down order, and the tree is linked by a
+	 * single thread.
+	 *
+	 * @param nodes_begin Iterator to the first node to be inserted
+	 * @param nodes_end   Iterator past the last node to be inserted
+	 * @param threads     The number of threads to use. 0 means as many as
+	 * there are hardware threads.
+	 */
+	template <class InputIt>
+	void build_parallel(InputIt nodes_begin, InputIt nodes_end,
+	                    size_t threads = 0);
+
 	/**
 	 * @brief Deletes a node that compares equally to <c> from the tree
 	 *
@@ -249,6 +273,103 @@ public:
 	 */
 	void remove(Node & node) CMP_NOEXCEPT(node);
 
+	/**
+	 * @brief Changes the key of <node> in place
+	 *
+	 * Calls mutator(node), which may change anything that <node> is compared
+	 * by. If <node> still is in order with its in-order neighbors afterwards,
+	 * nothing else happens, which usually costs O(1). Otherwise, <node> is
+	 * removed and re-inserted. Unless WBT_SINGLE_PASS is set, the search for
+	 * its new position starts at the neighbor it has moved past instead of at
+	 * the root.
+	 *
+	 * If <node> stays where it is, NodeTraits::deleted_below(node, tree) is
+	 * called, so that data stored in the nodes can be updated for the new key.
+	 *
+	 * @param node    The node whose key should be changed. Must be in the tree.
+	 * @param mutator Called as mutator(node) to change the key.
+	 * @return true if <node> is in the tree afterwards. If MULTIPLE is not set
+	 * and <node> compares equally to another node after the change, <node> is
+	 * removed from the tree and false is returned.
+	 */
+	template <class Mutator>
+	bool update_key(Node & node, Mutator && mutator) CMP_NOEXCEPT(node);
+
+	/**
+	 * @brief Returns the number of nodes in the subtree rooted at <n>
+	 *
+	 * This method runs in O(1).
+	 */
+	static size_t get_subtree_size(const Node * n) noexcept;
+
+	/**
+	 * @brief Returns the k-th smallest node in the tree
+	 *
+	 * Counting starts at zero, i.e., select(0) returns begin(). Uses the subtree
+	 * sizes that the tree stores for balancing anyways. This method runs in
+	 * O(log n).
+	 *
+	 * @param k The position of the node to be returned
+	 * @return An iterator to the k-th smallest node, or end() if the tree has
+	 * at most k nodes
+	 */
+	const_iterator<false> select(size_t k) const noexcept;
+	iterator<false> select(size_t k) noexcept;
+
+	/**
+	 * @brief Returns the position of <node> in the tree
+	 *
+	 * This is the inverse of select(), i.e., returns the number of nodes that
+	 * come before <node>. This method runs in O(log n).
+	 *
+	 * @param node A node in this tree
+	 * @return The number of nodes before <node>
+	 */
+	size_t rank(const Node & node) const noexcept;
+
+	/**
+	 * @brief Returns the q-quantile of the nodes in the tree
+	 *
+	 * Uses the nearest-rank definition: for n nodes, this is the node at position
+	 * ceil(q * n) - 1 (clamped to [0, n - 1]). For example, quantile(0.5)
+	 * returns the median and quantile(0.99) the 99th percentile. This method runs
+	 * in O(log n).
+	 *
+	 * @param q A value in [0, 1]
+	 * @return An iterator to the q-quantile, or end() if the tree is empty
+	 */
+	const_iterator<false> quantile(double q) const noexcept;
+	iterator<false> quantile(double q) noexcept;
+
+	/**
+	 * @brief Counts the nodes in [lower, upper)
+	 *
+	 * Counts the nodes that are not smaller than <lower> and smaller than
+	 * <upper>. This method runs in O(log n).
+	 *
+	 * @param lower Anything comparable to a node. The lower end of the range.
+	 * @param upper Anything comparable to a node. The upper end of the range
+	 * (exclusive).
+	 * @return The number of nodes in the range
+	 */
+	template <class Comparable1, class Comparable2>
+	size_t count_between(const Comparable1 & lower,
+	                     const Comparable2 & upper) const CMP_NOEXCEPT(lower);
+
+	/**
+	 * @brief Rebuilds the subtree rooted at <node> into a balanced tree
+	 *
+	 * The subtree is rebuilt in place using the Day-Stout-Warren algorithm, i.e.,
+	 * in O(m) time for a subtree of m nodes and with O(1) additional memory. The
+	 * result is a complete tree, in which siblings differ in weight by at most a
+	 * factor of two. It thus satisfies the balance criterion for every Delta of
+	 * at least 2. Since the rebuild uses rotations, the rotated_left and
+	 * rotated_right hooks of the NodeTraits are called.
+	 *
+	 * @param node  The root of the subtree to be rebuilt
+	 */
+	void rebalance_subtree(Node & node) noexcept;
+
 	// Mainly debugging methods
 	/// @cond INTERNAL
 	bool verify_integrity() const;
@@ -293,6 +414,9 @@ protected:
 	void swap_neighbors(Node * parent, Node * child) noexcept;
 
 	void verify_sizes() const;
+
+	template <class Comparable>
+	size_t count_smaller(const Comparable & query) const CMP_NOEXCEPT(query);
 };
 
 } // namespace ygg
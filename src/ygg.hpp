@@ -1,8 +1,23 @@
+#include "augmented.hpp"
+#include "avltree.hpp"
+#include "biased_wbtree.hpp"
+#include "bloom_filtered.hpp"
+#include "btree_index.hpp"
+#include "concurrent_read_tree.hpp"
+#include "concurrent_ziptree.hpp"
+#include "critbit_tree.hpp"
 #include "dynamic_segment_tree.hpp"
+#include "flat_combining_tree.hpp"
+#include "hash_accelerated.hpp"
 #include "intervaltree.hpp"
 #include "list.hpp"
+#include "multi_index.hpp"
 #include "options.hpp"
+#include "parallel.hpp"
 #include "rbtree.hpp"
+#include "sharded_tree.hpp"
+#include "skiplist.hpp"
+#include "splaytree.hpp"
 #include "ziptree.hpp"
 #include "energy.hpp"
 #include "wbtree.hpp"
@@ -3,6 +3,8 @@
 
 #include "ziptree.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <fstream>
 #include <iostream>
 #include <vector>
@@ -90,18 +92,31 @@ ZTreeRankGenerator<Node, Options, true, true>::update_rank(Node & node) noexcept
 		size_t universalized =
 		    (hasher(node) * Options::ztree_universalize_coefficient) %
 		    Options::ztree_universalize_modul;
-		node._zt_rank.rank = static_cast<decltype(node._zt_rank.rank)>(
-		    __builtin_ffsl(static_cast<long int>(universalized)));
+		store_rank(node, static_cast<size_t>(
+		                     __builtin_ffsl(static_cast<long int>(universalized))));
 	} else if constexpr (Options::ztree_universalize_multiply) {
 		// This is a variant of the multiply-shift method by Dietzfelbinger et al.
 		// Since we hash to all of size_t, we don't need a shift.
 		size_t universalized =
 		    (hasher(node) * Options::ztree_universalize_coefficient);
-		node._zt_rank.rank = static_cast<decltype(node._zt_rank.rank)>(
-		    __builtin_ffsl(static_cast<long int>(universalized)));
+		store_rank(node, static_cast<size_t>(
+		                     __builtin_ffsl(static_cast<long int>(universalized))));
 	} else {
-		node._zt_rank.rank = static_cast<decltype(node._zt_rank.rank)>(
-		    __builtin_ffsl(static_cast<long int>(hasher(node))));
+		store_rank(node, static_cast<size_t>(
+		                     __builtin_ffsl(static_cast<long int>(hasher(node)))));
+	}
+}
+
+template <class Node, class Options>
+void
+ZTreeRankGenerator<Node, Options, true, true>::store_rank(Node & node,
+                                                         size_t rank) noexcept
+{
+	if constexpr (Options::ztree_compress_rank) {
+		node._bst_parent.set_rank(rank);
+	} else {
+		node._zt_rank.rank =
+		    static_cast<typename Options::ztree_rank_type::type>(rank);
 	}
 }
 
@@ -110,21 +125,18 @@ size_t
 ZTreeRankGenerator<Node, Options, true, true>::get_rank(
     const Node & node) noexcept
 {
-	return static_cast<size_t>(node._zt_rank.rank);
+	if constexpr (Options::ztree_compress_rank) {
+		return node._bst_parent.get_rank();
+	} else {
+		return static_cast<size_t>(node._zt_rank.rank);
+	}
 }
 
 template <class Node, class Options>
 ZTreeRankGenerator<Node, Options, false, true>::ZTreeRankGenerator()
 {
-	auto rand_val = std::rand();
-	this->rank = 0;
-	while (rand_val == RAND_MAX) {
-		this->rank = static_cast<decltype(this->rank)>(
-		    (this->rank + static_cast<decltype(this->rank)>(std::log2(RAND_MAX))));
-		rand_val = std::rand();
-	}
-	this->rank = static_cast<decltype(this->rank)>(
-	    __builtin_ffsl(static_cast<long int>(rand_val)));
+	this->rank =
+	    static_cast<typename Options::ztree_rank_type::type>(draw_rank());
 }
 
 template <class Node, class Options>
@@ -141,21 +153,27 @@ ZTreeRankGenerator<Node, Options, false, true>::ZTreeRankGenerator(URBG && g)
 }
 
 template <class Node, class Options>
-void
-ZTreeRankGenerator<Node, Options, false, true>::update_rank(
-    Node & node) noexcept
+size_t
+ZTreeRankGenerator<Node, Options, false, true>::draw_rank() noexcept
 {
-	// Re-Randomize!
 	auto rand_val = std::rand();
-	node._zt_rank.rank = 0;
+	size_t rank = 0;
 	while (rand_val == RAND_MAX) {
-		node._zt_rank.rank = static_cast<decltype(node._zt_rank.rank)>(
-		    (node._zt_rank.rank +
-		     static_cast<decltype(node._zt_rank.rank)>(std::log2(RAND_MAX))));
+		rank += static_cast<size_t>(std::log2(RAND_MAX));
 		rand_val = std::rand();
 	}
-	node._zt_rank.rank = static_cast<decltype(node._zt_rank.rank)>(
-	    __builtin_ffsl(static_cast<long int>(rand_val)));
+	rank = static_cast<size_t>(__builtin_ffsl(static_cast<long int>(rand_val)));
+
+	return rank;
+}
+
+template <class Node, class Options>
+void
+ZTreeRankGenerator<Node, Options, false, true>::update_rank(
+    Node & node) noexcept
+{
+	// Re-Randomize!
+	store_rank(node, draw_rank());
 }
 
 template <class Node, class Options>
@@ -166,12 +184,26 @@ ZTreeRankGenerator<Node, Options, false, true>::update_rank(Node & node,
 {
 	// Re-Randomize!
 	auto rand_val = g();
-	node._zt_rank.rank = 0;
+	size_t rank = 0;
 	while (rand_val == g.max()) {
-		node._zt_rank.rank += static_cast<size_t>(std::log2(g.max()));
+		rank += static_cast<size_t>(std::log2(g.max()));
 		rand_val = g();
 	}
-	node._zt_rank.rank = __builtin_ffsl(static_cast<long int>(rand_val));
+	rank = static_cast<size_t>(__builtin_ffsl(static_cast<long int>(rand_val)));
+	store_rank(node, rank);
+}
+
+template <class Node, class Options>
+void
+ZTreeRankGenerator<Node, Options, false, true>::store_rank(
+    Node & node, size_t rank) noexcept
+{
+	if constexpr (Options::ztree_compress_rank) {
+		node._bst_parent.set_rank(rank);
+	} else {
+		node._zt_rank.rank =
+		    static_cast<typename Options::ztree_rank_type::type>(rank);
+	}
 }
 
 template <class Node, class Options>
@@ -179,7 +211,62 @@ size_t
 ZTreeRankGenerator<Node, Options, false, true>::get_rank(
     const Node & node) noexcept
 {
-	return static_cast<size_t>(node._zt_rank.rank);
+	if constexpr (Options::ztree_compress_rank) {
+		return node._bst_parent.get_rank();
+	} else {
+		return static_cast<size_t>(node._zt_rank.rank);
+	}
+}
+
+template <class Node>
+void
+RankParentStorage<Node>::set_parent(Node * new_parent) noexcept
+{
+	// Tagged pointers would lose their tag and clobber the rank
+	assert((reinterpret_cast<size_t>(new_parent) & ~pointer_mask) == 0);
+
+	this->parent = reinterpret_cast<Node *>(
+	    reinterpret_cast<size_t>(new_parent) |
+	    (reinterpret_cast<size_t>(this->parent) & ~pointer_mask));
+}
+
+template <class Node>
+Node *
+RankParentStorage<Node>::get_parent() const noexcept
+{
+	return reinterpret_cast<Node *>(reinterpret_cast<size_t>(this->parent) &
+	                                pointer_mask);
+}
+
+template <class Node>
+void
+RankParentStorage<Node>::set_rank(size_t new_rank) noexcept
+{
+	// Capping the rank does not harm correctness, it just (very, very rarely)
+	// creates a tie that would not have been there otherwise.
+	if (__builtin_expect(new_rank > max_rank, false)) {
+		new_rank = max_rank;
+	}
+
+	this->parent = reinterpret_cast<Node *>(
+	    (reinterpret_cast<size_t>(this->parent) & pointer_mask) |
+	    (new_rank << rank_shift));
+}
+
+template <class Node>
+size_t
+RankParentStorage<Node>::get_rank() const noexcept
+{
+	return reinterpret_cast<size_t>(this->parent) >> rank_shift;
+}
+
+template <class Node, class Options, class Tag>
+ZTreeNodeStorage<Node, Options, Tag, true>::ZTreeNodeStorage() noexcept
+{
+	if constexpr (!Options::ztree_use_hash) {
+		this->_bst_parent.set_rank(
+		    ZTreeRankGenerator<Node, Options, false, true>::draw_rank());
+	}
 }
 
 // @endcond
@@ -204,7 +291,7 @@ template <class Node, class Options, class Tag>
 auto
 ZTreeNodeBase<Node, Options, Tag>::dbg_get_rank() const noexcept
 {
-	return decltype(this->_zt_rank)::get_rank(*(static_cast<const Node *>(this)));
+	return RankGenerator::get_rank(*(static_cast<const Node *>(this)));
 }
 
 template <class Node, class NodeTraits, class Options, class Tag, class Compare,
@@ -316,6 +403,183 @@ ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::insert(
 	}
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare,
+          class RankGetter>
+template <class InputIt>
+void
+ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::build_parallel(
+    InputIt nodes_begin, InputIt nodes_end, size_t threads)
+{
+	assert(this->root == nullptr);
+
+	threads = parallel_internal::effective_threads(threads);
+	std::vector<Node *> nodes =
+	    this->collect_sorted_nodes(nodes_begin, nodes_end, threads);
+
+	if constexpr (!std::is_same<NodeTraits, ZTreeDefaultNodeTraits<Node>>::value) {
+		// Hooks need to see every single unzipping.
+		for (Node * node : nodes) {
+			this->insert(*node);
+		}
+		return;
+	}
+
+#ifdef YGG_STORE_SEQUENCE
+	for (Node * node : nodes) {
+		this->bss.register_insert(reinterpret_cast<const void *>(node),
+		                          Options::SequenceInterface::get_key(*node));
+	}
+#endif
+
+	if constexpr (Options::multiple) {
+		// Equal nodes always form a path of left children, thus within a run of
+		// equal nodes, the ranks must increase.
+		auto run_begin = nodes.begin();
+		while (run_begin != nodes.end()) {
+			auto run_end = std::next(run_begin);
+			while ((run_end != nodes.end()) && !this->cmp(**run_begin, **run_end)) {
+				++run_end;
+			}
+			if (std::distance(run_begin, run_end) > 1) {
+				std::stable_sort(run_begin, run_end,
+				                 [](const Node * lhs, const Node * rhs) {
+					                 return RankGetter::get_rank(*lhs) <
+					                        RankGetter::get_rank(*rhs);
+				                 });
+			}
+			run_begin = run_end;
+		}
+	}
+
+	size_t n = nodes.size();
+	size_t chunks = std::min(threads,
+	                         std::max(n / parallel_internal::PARALLEL_CUTOFF,
+	                                  size_t{1}));
+
+	// Chunk i is [i * n / chunks, (i+1) * n / chunks)
+	std::vector<Node *> chunk_roots(chunks, nullptr);
+	parallel_internal::run_on_threads(chunks, [&](size_t i) {
+		size_t begin = i * n / chunks;
+		size_t end = (i + 1) * n / chunks;
+		chunk_roots[i] = build_from_sorted(nodes.data() + begin, end - begin);
+	});
+
+	Node * new_root = nullptr;
+	for (Node * chunk_root : chunk_roots) {
+		new_root = join(new_root, chunk_root);
+	}
+
+	this->root = new_root;
+	this->s.set(n);
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare,
+          class RankGetter>
+Node *
+ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::build_from_sorted(
+    Node * const * nodes, size_t count) noexcept
+{
+	// Builds the tree that is heap-ordered by rank. The right spine of the tree
+	// built so far is walked up via the parent pointers, which makes this linear
+	// in total. On rank ties, the right one of two equal nodes must become the
+	// parent, since right children must be strictly larger.
+	Node * sub_root = nullptr;
+	Node * last = nullptr;
+	Compare cmp;
+
+	for (size_t i = 0; i < count; ++i) {
+		Node * node = nodes[i];
+		auto node_rank = RankGetter::get_rank(*node);
+
+		Node * below = nullptr;
+		Node * above = last;
+		while ((above != nullptr) &&
+		       ((RankGetter::get_rank(*above) < node_rank) ||
+		        ((RankGetter::get_rank(*above) == node_rank) &&
+		         !cmp(*above, *node)))) {
+			below = above;
+			above = above->NB::get_parent();
+		}
+
+		node->NB::set_left(below);
+		node->NB::set_right(nullptr);
+		if (below != nullptr) {
+			below->NB::set_parent(node);
+		}
+
+		node->NB::set_parent(above);
+		if (above != nullptr) {
+			above->NB::set_right(node);
+		} else {
+			sub_root = node;
+		}
+
+		last = node;
+	}
+
+	return sub_root;
+}
+
+template <class Node, class NodeTraits, class Options, class Tag, class Compare,
+          class RankGetter>
+Node *
+ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::join(
+    Node * left, Node * right) noexcept
+{
+	// All nodes in <left> are smaller than all nodes in <right>. Zips the right
+	// spine of <left> with the left spine of <right>.
+	Node * result = nullptr;
+	Node * parent = nullptr;
+	bool parent_left = false;
+
+	Compare cmp;
+
+	while ((left != nullptr) && (right != nullptr)) {
+		Node * next;
+		bool next_left;
+		auto left_rank = RankGetter::get_rank(*left);
+		auto right_rank = RankGetter::get_rank(*right);
+		// See build_from_sorted() for the tie-breaking
+		if ((left_rank > right_rank) ||
+		    ((left_rank == right_rank) && cmp(*left, *right))) {
+			next = left;
+			left = left->NB::get_right();
+			next_left = false;
+		} else {
+			next = right;
+			right = right->NB::get_left();
+			next_left = true;
+		}
+
+		next->NB::set_parent(parent);
+		if (parent == nullptr) {
+			result = next;
+		} else if (parent_left) {
+			parent->NB::set_left(next);
+		} else {
+			parent->NB::set_right(next);
+		}
+
+		parent = next;
+		parent_left = next_left;
+	}
+
+	Node * rest = (left != nullptr) ? left : right;
+	if (parent == nullptr) {
+		return rest;
+	}
+	if (rest != nullptr) {
+		rest->NB::set_parent(parent);
+	}
+	if (parent_left) {
+		parent->NB::set_left(rest);
+	} else {
+		parent->NB::set_right(rest);
+	}
+
+	return result;
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare,
           class RankGetter>
 void
@@ -559,6 +823,40 @@ ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::remove(Node & n)
 	this->zip(n);
 }
 
+template <class Node, class NodeTraits, class Options, class Tag, class Compare,
+          class RankGetter>
+template <class Mutator>
+bool
+ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::update_key(
+    Node & node, Mutator && mutator) CMP_NOEXCEPT(node)
+{
+	if constexpr (Options::ztree_use_hash && !Options::ztree_store_rank) {
+		this->remove(node);
+		mutator(node);
+	} else {
+		mutator(node);
+
+		// The mutator does not change the tree's structure, so the in-order
+		// neighbors are the same as before. Removing never compares anything.
+		// Whether an equal neighbor may be left or right of <node> depends on
+		// which of them is higher up, so equal neighbors always trigger the
+		// re-insertion.
+		if (this->template get_moved_past<true>(node) == nullptr) {
+			return true;
+		}
+		this->remove(node);
+	}
+
+	if constexpr (!Options::multiple) {
+		if (this->find(node) != this->end()) {
+			return false;
+		}
+	}
+
+	this->insert(node);
+	return true;
+}
+
 template <class Node, class NodeTraits, class Options, class Tag, class Compare,
           class RankGetter>
 template <class Comparable>
@@ -806,7 +1104,7 @@ void
 ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>::dbg_verify() const
 {
 	if (this->root != nullptr) {
-		assert(this->root->get_parent() == nullptr);
+		assert(this->root->NB::get_parent() == nullptr);
 	}
 
 	this->dbg_verify_consistency(this->root, nullptr, nullptr);
@@ -32,6 +32,9 @@ struct dbg_verify_size_helper
 template <class Node, class Options, bool use_hash, bool store>
 class ZTreeRankGenerator;
 
+template <class Node, class Options, class Tag, bool compress_rank>
+class ZTreeNodeStorage;
+
 template <class Node, class Options>
 class ZTreeRankGenerator<Node, Options, true, false> {
 public:
@@ -51,6 +54,9 @@ public:
 private:
 	template <class, class, class>
 	friend class ZTreeNodeBase;
+
+	static void store_rank(Node & node, size_t rank) noexcept;
+
 	typename Options::ztree_rank_type::type rank;
 };
 
@@ -66,8 +72,14 @@ public:
 	static size_t get_rank(const Node & node) noexcept;
 
 private:
+	template <class, class, class, bool>
+	friend class ZTreeNodeStorage;
 	template <class, class, class>
 	friend class ZTreeNodeBase;
+
+	static size_t draw_rank() noexcept;
+	static void store_rank(Node & node, size_t rank) noexcept;
+
 	typename Options::ztree_rank_type::type rank;
 };
 
@@ -79,6 +91,79 @@ class ZTreeRankGenerator<Node, Options, false, false> {
 	static_assert(!std::is_class<Node>::value || std::is_class<Node>::value,
 	              "If rank-by-hash is not used, ranks must be stored.");
 };
+
+/*
+ * Stores the rank of a node in the uppermost bits of its parent pointer. See
+ * TreeFlags::ZTREE_COMPRESS_RANK.
+ */
+template <class Node>
+class RankParentStorage {
+public:
+	void set_parent(Node * new_parent) noexcept;
+	Node * get_parent() const noexcept;
+
+	void set_rank(size_t new_rank) noexcept;
+	size_t get_rank() const noexcept;
+
+	static constexpr bool parent_reference = false;
+
+	// User space addresses on x86-64 (even with five-level paging) and AArch64
+	// never use the upper seven bits, unless pointers are tagged (AArch64
+	// TBI / MTE, Intel LAM). set_parent() asserts that these bits are free.
+	// The low alignment bits are no alternative: they would cap ranks at 7.
+	static constexpr size_t rank_bits = 7;
+	static constexpr size_t rank_shift = (sizeof(size_t) * 8) - rank_bits;
+	static constexpr size_t max_rank = (size_t{1} << rank_bits) - 1;
+	static constexpr size_t pointer_mask = (size_t{1} << rank_shift) - 1;
+
+	static_assert(sizeof(Node *) == sizeof(size_t) && sizeof(size_t) == 8,
+	              "Compressing ranks into pointers requires 64 bit pointers.");
+#if defined(__SANITIZE_HWADDRESS__)
+	// Depends on Node, so that it only fires if compressed ranks are used
+	static_assert(sizeof(Node *) == 0,
+	              "Compressing ranks into pointers does not work with HWASan, "
+	              "which tags the upper bits of pointers.");
+#endif
+
+private:
+	Node * parent = nullptr;
+};
+
+template <class Node, class Options>
+using ZTreeParentContainer =
+    utilities::select_type_t<RankParentStorage<Node>,
+                             bst::DefaultParentContainer<Node>,
+                             Options::ztree_compress_rank>;
+
+/*
+ * Holds the per-node rank information of the Zip Tree, either as a separate
+ * member or compressed into the parent pointer. This is a base class (and not
+ * a member) of ZTreeNodeBase so that it takes up no space in the latter case.
+ */
+template <class Node, class Options, class Tag>
+class ZTreeNodeStorage<Node, Options, Tag, false>
+    : public bst::BSTNodeBase<Node, Options, Tag> {
+private:
+	template <class, class, bool, bool>
+	friend class ZTreeRankGenerator;
+
+	ZTreeRankGenerator<Node, Options, Options::ztree_use_hash,
+	                   Options::ztree_store_rank>
+	    _zt_rank;
+};
+
+template <class Node, class Options, class Tag>
+class ZTreeNodeStorage<Node, Options, Tag, true>
+    : public bst::BSTNodeBase<Node, Options, Tag,
+                              RankParentStorage<Node>> {
+protected:
+	ZTreeNodeStorage() noexcept;
+
+private:
+	template <class, class, bool, bool>
+	friend class ZTreeRankGenerator;
+};
+
 /// @endcond
 } // namespace ztree_internal
 
@@ -98,7 +183,9 @@ class ZTreeRankGenerator<Node, Options, false, false> {
  * be inserted into. See ZTree for details.
  */
 template <class Node, class Options, class Tag>
-class ZTreeNodeBase : public bst::BSTNodeBase<Node, Options, Tag> {
+class ZTreeNodeBase
+    : public ztree_internal::ZTreeNodeStorage<Node, Options, Tag,
+                                              Options::ztree_compress_rank> {
 public:
 	// Debugging methods
 	size_t get_depth() const noexcept;
@@ -113,6 +200,9 @@ protected:
 	 * TreeFlags::ZTREE_RANK_TYPE), you **must** call this method *before* adding
 	 * the node to your tree, but *after* the node's hash has become valid.
 	 *
+	 * The same holds if you set TreeFlags::ZTREE_USE_HASH together with
+	 * TreeFlags::ZTREE_COMPRESS_RANK.
+	 *
 	 * If you use true randomness (i.e., do not set TreeFlags::ZTREE_USE_HASH),
 	 * the ranks of nodes will be set in the constructor. However, you can call
 	 * update_rank() to re-randomize the rank of this node.
@@ -132,9 +222,9 @@ private:
 	template <class, class, bool, bool>
 	friend class ztree_internal::ZTreeRankGenerator;
 
-	ztree_internal::ZTreeRankGenerator<Node, Options, Options::ztree_use_hash,
-	                                   Options::ztree_store_rank>
-	    _zt_rank;
+	using RankGenerator =
+	    ztree_internal::ZTreeRankGenerator<Node, Options, Options::ztree_use_hash,
+	                                       Options::ztree_store_rank>;
 };
 
 template <class Node>
@@ -199,10 +289,14 @@ template <
     class Tag = int, class Compare = ygg::utilities::flexible_less,
     class RankGetter = ztree_internal::ZTreeRankGenerator<
         Node, Options, Options::ztree_use_hash, Options::ztree_store_rank>>
-class ZTree : public bst::BinarySearchTree<Node, Options, Tag, Compare> {
+class ZTree : public bst::BinarySearchTree<
+                  Node, Options, Tag, Compare,
+                  ztree_internal::ZTreeParentContainer<Node, Options>> {
 public:
 	using NB = ZTreeNodeBase<Node, Options, Tag>;
-	using TB = bst::BinarySearchTree<Node, Options, Tag, Compare>;
+	using TB = bst::BinarySearchTree<
+	    Node, Options, Tag, Compare,
+	    ztree_internal::ZTreeParentContainer<Node, Options>>;
 	using MyClass = ZTree<Node, NodeTraits, Options, Tag, Compare, RankGetter>;
 
 	/**********************************************
@@ -265,6 +359,32 @@ public:
 	void insert(Node & node) noexcept;
 	void insert(Node & node, Node & hint) noexcept;
 
+	/**
+	 * @brief Builds the tree from a range of nodes, using multiple threads
+	 *
+	 * Inserts all nodes in [nodes_begin, nodes_end) into the tree, which must be
+	 * empty. The range does not need to be sorted. The nodes are sorted in
+	 * parallel. Since the shape of a zip tree is determined by the ranks of its
+	 * nodes, the sorted range is then cut into chunks, the tree for each chunk
+	 * is built by its own thread, and the chunk trees are finally zipped
+	 * together along their spines.
+	 *
+	 * If MULTIPLE is not set, of several equal nodes only the first one in the
+	 * range is inserted. If MULTIPLE is set, equal nodes end up ordered by rank,
+	 * just like insert() would order them.
+	 *
+	 * If NodeTraits is not ZTreeDefaultNodeTraits, the sorted nodes are inserted
+	 * one by one using insert(), such that all hooks are called.
+	 *
+	 * @param nodes_begin Iterator to the first node to be inserted
+	 * @param nodes_end   Iterator past the last node to be inserted
+	 * @param threads     The number of threads to use. 0 means as many as
+	 * there are hardware threads.
+	 */
+	template <class InputIt>
+	void build_parallel(InputIt nodes_begin, InputIt nodes_end,
+	                    size_t threads = 0);
+
 	/**
 	 * @brief Removes <node> from the tree
 	 *
@@ -274,6 +394,33 @@ public:
 	 */
 	void remove(Node & node) CMP_NOEXCEPT(node);
 
+	/**
+	 * @brief Changes the key of <node> in place
+	 *
+	 * Calls mutator(node), which may change anything that <node> is compared
+	 * by. If <node> still is strictly between its in-order neighbors
+	 * afterwards, nothing else happens, which usually costs O(1). Otherwise,
+	 * <node> is removed and re-inserted. Since the position of a node in a zip
+	 * tree depends on its rank, the re-insertion starts at the root.
+	 *
+	 * The mutator must not change the rank of <node>. If ranks are computed
+	 * from a hash of the node and not stored (ZTREE_USE_HASH without
+	 * ZTREE_RANK_TYPE), the hash might depend on the key, so <node> is always
+	 * removed before and re-inserted after calling the mutator.
+	 *
+	 * If <node> stays where it is, no NodeTraits hook is called. If your
+	 * NodeTraits store data that depends on the key, use remove() and insert()
+	 * instead.
+	 *
+	 * @param node    The node whose key should be changed. Must be in the tree.
+	 * @param mutator Called as mutator(node) to change the key.
+	 * @return true if <node> is in the tree afterwards. If MULTIPLE is not set
+	 * and <node> compares equally to another node after the change, <node> is
+	 * removed from the tree and false is returned.
+	 */
+	template <class Mutator>
+	bool update_key(Node & node, Mutator && mutator) CMP_NOEXCEPT(node);
+
 	/**
 	 * @brief Deletes a node that compares equally to <c> from the tree
 	 *
@@ -336,6 +483,10 @@ private:
 	void unzip(Node & oldn, Node & newn) noexcept;
 	void zip(Node & old_root) noexcept;
 
+	// Helpers for build_parallel()
+	static Node * build_from_sorted(Node * const * nodes, size_t count) noexcept;
+	static Node * join(Node * left, Node * right) noexcept;
+
 	// Debugging methods
 	void dbg_verify_consistency(Node * sub_root, Node * lower_bound,
 	                            Node * upper_bound) const;
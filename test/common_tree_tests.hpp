@@ -0,0 +1,249 @@
+#pragma once
+#ifndef YGG_COMMON_TREE_TESTS_HPP
+#define YGG_COMMON_TREE_TESTS_HPP
+
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace utilities {
+
+/*
+ * Test bodies shared between several tree types. Unless stated otherwise,
+ * <Node> must be default constructible, constructible from an int, and
+ * compared by its public int member 'data'.
+ */
+
+/*
+ * Builds a tree from <count> nodes in random order via build_parallel() and
+ * compares it to a sequential reference: the nodes in range order, sorted
+ * stably by <less>. Unless <multiple> is set, only the first of several equal
+ * nodes is expected in the tree. init_node(node, i) must make <node> the i-th
+ * node; it is called in range order. Afterwards, some nodes are removed to
+ * check that the tree is still usable.
+ */
+template <class Tree, class Node, class InitNode, class Less>
+void
+run_parallel_build_test(size_t count, size_t seed, size_t threads,
+                        bool multiple, InitNode init_node, Less less)
+{
+	std::vector<size_t> indices(count);
+	for (size_t i = 0; i < count; ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(), Randomizer(seed));
+
+	// Some nodes do not copy their rank, so they are initialized in place.
+	std::vector<Node> nodes(count);
+	for (size_t i = 0; i < count; ++i) {
+		init_node(nodes[i], indices[i]);
+	}
+
+	std::vector<Node *> expected;
+	for (auto & n : nodes) {
+		expected.push_back(&n);
+	}
+	auto node_less = [&](const Node * lhs, const Node * rhs) {
+		return less(*lhs, *rhs);
+	};
+	std::stable_sort(expected.begin(), expected.end(), node_less);
+	if (!multiple) {
+		auto equal = [&](const Node * lhs, const Node * rhs) {
+			return !less(*lhs, *rhs);
+		};
+		expected.erase(std::unique(expected.begin(), expected.end(), equal),
+		               expected.end());
+	}
+
+	Tree tree;
+	tree.build_parallel(nodes.begin(), nodes.end(), threads);
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), expected.size());
+
+	size_t i = 0;
+	for (const auto & n : tree) {
+		ASSERT_LT(i, expected.size());
+		ASSERT_EQ(&n, expected[i]);
+		i++;
+	}
+	ASSERT_EQ(i, expected.size());
+
+	// The tree must still be usable afterwards
+	size_t removed = 0;
+	for (size_t j = 0; j < expected.size(); j += 3) {
+		tree.remove(*expected[j]);
+		removed++;
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), expected.size() - removed);
+}
+
+template <class Tree, class Node>
+void
+run_update_key_test(size_t count, size_t seed)
+{
+	Tree tree;
+	std::mt19937 rng(static_cast<std::mt19937::result_type>(seed));
+
+	std::vector<Node> nodes(count);
+	std::unordered_set<int> keys;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(100 * i));
+		keys.insert(nodes[i].data);
+		tree.insert(nodes[i]);
+	}
+
+	// Mostly small nudges that keep the order, some large jumps
+	const int range = static_cast<int>(100 * count);
+	std::uniform_int_distribution<size_t> node_distr(0, nodes.size() - 1);
+	std::uniform_int_distribution<int> nudge_distr(-40, 40);
+	std::uniform_int_distribution<int> jump_distr(-range, range);
+	for (size_t i = 0; i < 5 * nodes.size(); ++i) {
+		Node & n = nodes[node_distr(rng)];
+		int new_key;
+		do {
+			new_key = (i % 5 == 0) ? jump_distr(rng) : n.data + nudge_distr(rng);
+		} while (keys.find(new_key) != keys.end());
+		keys.erase(n.data);
+		keys.insert(new_key);
+
+		ASSERT_TRUE(
+		    tree.update_key(n, [&](Node & node) { node.data = new_key; }));
+		if (i % 100 == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	for (const auto & n : nodes) {
+		ASSERT_EQ(&*tree.find(n.data), &n);
+	}
+}
+
+template <class Tree, class Node>
+void
+run_update_key_multiple_test(size_t count, size_t seed)
+{
+	Tree tree;
+	std::mt19937 rng(static_cast<std::mt19937::result_type>(seed));
+
+	std::vector<Node> nodes(count);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(i / 4));
+		tree.insert(nodes[i]);
+	}
+
+	std::uniform_int_distribution<size_t> node_distr(0, nodes.size() - 1);
+	std::uniform_int_distribution<int> nudge_distr(-2, 2);
+	for (size_t i = 0; i < 5 * nodes.size(); ++i) {
+		Node & n = nodes[node_distr(rng)];
+		const int delta = nudge_distr(rng);
+		ASSERT_TRUE(
+		    tree.update_key(n, [&](Node & node) { node.data += delta; }));
+		if (i % 100 == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	// Every node can still be removed
+	for (auto & n : nodes) {
+		tree.remove(n);
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+/*
+ * Without MULTIPLE, a node whose new key collides with another node must end
+ * up removed from the tree, whether it was its neighbor or far away.
+ */
+template <class Tree, class Node>
+void
+run_update_key_collision_test(size_t count)
+{
+	Tree tree;
+	std::vector<Node> nodes(count);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(100 * i));
+		tree.insert(nodes[i]);
+	}
+
+	std::vector<bool> removed(nodes.size(), false);
+	size_t expected_size = nodes.size();
+	for (size_t i = 1; i + 1 < nodes.size(); i += 3) {
+		Node & n = nodes[i];
+		// Alternate between the right neighbor and some node far away
+		const size_t other_index = (i % 2 == 0) ? i + 1 : (i * 7 + 2) % count;
+		if ((other_index == i) || removed[other_index]) {
+			continue;
+		}
+		const Node & other = nodes[other_index];
+		const int new_key = other.data;
+
+		ASSERT_FALSE(
+		    tree.update_key(n, [&](Node & node) { node.data = new_key; }));
+		removed[i] = true;
+		expected_size -= 1;
+
+		ASSERT_EQ(tree.size(), expected_size);
+		ASSERT_EQ(&*tree.find(new_key), &other);
+		for (const auto & in_tree : tree) {
+			ASSERT_NE(&in_tree, &n);
+		}
+		tree.dbg_verify();
+	}
+}
+
+/*
+ * A change that keeps <node> between its neighbors must not touch the tree's
+ * structure at all.
+ */
+template <class Tree, class Node>
+void
+run_update_key_in_place_test(size_t count)
+{
+	Tree tree;
+	std::vector<Node> nodes(count);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(100 * i));
+		tree.insert(nodes[i]);
+	}
+
+	using Links = std::tuple<const Node *, const Node *, const Node *>;
+	auto get_links = [&]() {
+		std::vector<Links> links;
+		for (const auto & n : nodes) {
+			links.emplace_back(n.get_parent(), n.get_left(), n.get_right());
+		}
+		return links;
+	};
+	const std::vector<Links> before = get_links();
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		// Keys are 100 apart, so the order is kept
+		const int delta = (i % 2 == 0) ? 49 : -49;
+		ASSERT_TRUE(
+		    tree.update_key(nodes[i], [&](Node & node) { node.data += delta; }));
+	}
+
+	ASSERT_TRUE(get_links() == before);
+	tree.dbg_verify();
+	for (const auto & n : nodes) {
+		ASSERT_EQ(&*tree.find(n.data), &n);
+	}
+}
+
+} // namespace utilities
+} // namespace testing
+} // namespace ygg
+
+#endif // YGG_COMMON_TREE_TESTS_HPP
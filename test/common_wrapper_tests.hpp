@@ -0,0 +1,308 @@
+#pragma once
+#ifndef YGG_COMMON_WRAPPER_TESTS_HPP
+#define YGG_COMMON_WRAPPER_TESTS_HPP
+
+#include "../src/rbtree.hpp"
+#include "../src/ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace keyed_wrapper {
+
+/*
+ * Nodes and test bodies shared between the wrappers that index the keys of a
+ * tree (HashAccelerated, BloomFiltered). The test bodies work on any such
+ * wrapper around a tree of the nodes below.
+ */
+
+using namespace ygg;
+
+constexpr size_t WRAPPER_TESTSIZE = 5000;
+constexpr size_t WRAPPER_CHECK_INTERVAL = 250;
+constexpr size_t WRAPPER_SEED = 4;
+
+using MultiOptions = ygg::TreeOptions<TreeFlags::MULTIPLE,
+                                      TreeFlags::CONSTANT_TIME_SIZE,
+                                      TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+using SetOptions = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE,
+                                    TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+using STLMultiOptions =
+    ygg::TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                     TreeFlags::STL_ERASE, TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+template <template <class, class, class> class NodeBase, class Options>
+class Node : public NodeBase<Node<NodeBase, Options>, Options, int> {
+public:
+	int data;
+
+	Node() : data(0){};
+	Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+template <template <class, class, class> class NodeBase, class Options>
+bool
+operator<(const Node<NodeBase, Options> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <template <class, class, class> class NodeBase, class Options>
+bool
+operator<(const int lhs, const Node<NodeBase, Options> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+class KeyGetter {
+public:
+	template <class N>
+	static int
+	get_key(const N & n)
+	{
+		return n.data;
+	}
+};
+
+template <class Options>
+using RBNode = Node<RBTreeNodeBase, Options>;
+template <class Options>
+using ZNode = Node<ZTreeNodeBase, Options>;
+
+// <Wrapper> around an RBTree or a ZTree, keyed by KeyGetter
+template <template <class, class...> class Wrapper, class Options>
+using RBWrapped =
+    Wrapper<RBTree<RBNode<Options>, RBDefaultNodeTraits, Options>, KeyGetter>;
+template <template <class, class...> class Wrapper, class Options>
+using ZWrapped = Wrapper<
+    ZTree<ZNode<Options>, ZTreeDefaultNodeTraits<ZNode<Options>>, Options>,
+    KeyGetter>;
+
+template <class WTree>
+void
+run_random_test()
+{
+	using N = typename WTree::Node;
+	WTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE);
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(3 * i));
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(WRAPPER_SEED));
+
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.insert(nodes[indices[i]]);
+		if (i % WRAPPER_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*tree.find(static_cast<int>(3 * i)), &nodes[i]);
+		ASSERT_EQ(tree.find(static_cast<int>(3 * i + 1)), tree.end());
+		// Ordered queries still work, and agree with find()
+		ASSERT_EQ(tree.lower_bound(static_cast<int>(3 * i)),
+		          tree.find(static_cast<int>(3 * i)));
+	}
+
+	size_t i = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i++;
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(WRAPPER_SEED + 1));
+	for (i = 0; i < indices.size(); ++i) {
+		tree.remove(nodes[indices[i]]);
+		ASSERT_EQ(tree.find(nodes[indices[i]].data), tree.end());
+		if (i % WRAPPER_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+	ASSERT_EQ(tree.find(0), tree.end());
+}
+
+/*
+ * Removes nodes with equal keys in random order. As long as some node with a
+ * key is left, find() must return one of them.
+ */
+template <class WTree>
+void
+run_remove_duplicates_test()
+{
+	using N = typename WTree::Node;
+	WTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(WRAPPER_SEED));
+
+	std::vector<size_t> remaining(10, WRAPPER_TESTSIZE / 10);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		const int key = nodes[indices[i]].data;
+		tree.remove(nodes[indices[i]]);
+		remaining[static_cast<size_t>(key)]--;
+
+		auto it = tree.find(key);
+		if (remaining[static_cast<size_t>(key)] > 0) {
+			ASSERT_NE(it, tree.end());
+			ASSERT_EQ(it->data, key);
+			ASSERT_NE(&*it, &nodes[indices[i]]);
+		} else {
+			ASSERT_EQ(it, tree.end());
+		}
+
+		if (i % WRAPPER_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+/*
+ * Without STL_ERASE, every erase() removes one node with the key, and the
+ * remaining nodes with that key can still be found.
+ */
+template <class WTree>
+void
+run_erase_duplicates_test()
+{
+	using N = typename WTree::Node;
+	WTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+	}
+	tree.dbg_verify();
+
+	std::vector<size_t> remaining(10, WRAPPER_TESTSIZE / 10);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const int key = nodes[i].data;
+		N * removed = tree.erase(key);
+		ASSERT_NE(removed, nullptr);
+		ASSERT_EQ(removed->data, key);
+		remaining[static_cast<size_t>(key)]--;
+		ASSERT_EQ(tree.size(), nodes.size() - i - 1);
+
+		if (remaining[static_cast<size_t>(key)] > 0) {
+			ASSERT_NE(tree.find(key), tree.end());
+			ASSERT_NE(&*tree.find(key), removed);
+		} else {
+			ASSERT_EQ(tree.find(key), tree.end());
+			ASSERT_EQ(tree.erase(key), nullptr);
+		}
+
+		if (i % WRAPPER_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+	ASSERT_EQ(tree.erase(0), nullptr);
+}
+
+// Like the wrapped tree, erase() removes all nodes with the key
+template <class WTree>
+void
+run_stl_erase_test()
+{
+	using N = typename WTree::Node;
+	WTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+	}
+
+	size_t expected_size = nodes.size();
+	for (int key = 0; key < 10; ++key) {
+		ASSERT_EQ(tree.erase(key), WRAPPER_TESTSIZE / 10);
+		expected_size -= WRAPPER_TESTSIZE / 10;
+
+		ASSERT_EQ(tree.size(), expected_size);
+		ASSERT_EQ(tree.find(key), tree.end());
+		ASSERT_EQ(tree.erase(key), size_t{0});
+		tree.dbg_verify();
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+template <class WTree>
+void
+run_set_test()
+{
+	using N = typename WTree::Node;
+	WTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE);
+	std::vector<N> duplicates(WRAPPER_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		duplicates[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		tree.insert(duplicates[i]);
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size());
+	ASSERT_EQ(&*tree.find(7), &nodes[7]);
+
+	const auto & const_tree = tree;
+	ASSERT_EQ(&*const_tree.find(7), &nodes[7]);
+	ASSERT_EQ(const_tree.find(-1), const_tree.end());
+	ASSERT_EQ(&*const_tree.get_tree().find(7), &nodes[7]);
+
+	ASSERT_EQ(tree.erase(7), &nodes[7]);
+	ASSERT_EQ(tree.erase(7), nullptr);
+	ASSERT_EQ(tree.find(7), tree.end());
+	tree.dbg_verify();
+
+	tree.clear();
+	ASSERT_TRUE(tree.empty());
+	ASSERT_EQ(tree.find(8), tree.end());
+	tree.dbg_verify();
+
+	// The tree is usable again after clearing
+	tree.insert(duplicates[8]);
+	ASSERT_EQ(&*tree.find(8), &duplicates[8]);
+	tree.dbg_verify();
+}
+
+} // namespace keyed_wrapper
+} // namespace testing
+} // namespace ygg
+
+#endif // YGG_COMMON_WRAPPER_TESTS_HPP
@@ -1,10 +1,25 @@
 #include <gtest/gtest.h>
 
+#include "test_augmented.hpp"
+#include "test_avltree.hpp"
+#include "test_biased_wbtree.hpp"
+#include "test_bloom_filtered.hpp"
+#include "test_btree_index.hpp"
+#include "test_concurrent_read_tree.hpp"
+#include "test_concurrent_ziptree.hpp"
+#include "test_critbit_tree.hpp"
 #include "test_dynamic_segment_tree.hpp"
+#include "test_flat_combining_tree.hpp"
+#include "test_hash_accelerated.hpp"
 #include "test_intervaltree.hpp"
 #include "test_list.hpp"
+#include "test_multi_index.hpp"
 #include "test_multi_rbtree.hpp"
+#include "test_parallel.hpp"
 #include "test_rbtree.hpp"
+#include "test_sharded_tree.hpp"
+#include "test_skiplist.hpp"
+#include "test_splaytree.hpp"
 #include "test_ziptree.hpp"
 #include "test_energy.hpp"
 #include "test_wbtree.hpp"
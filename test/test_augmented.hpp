@@ -0,0 +1,423 @@
+#ifndef TEST_AUGMENTED_HPP
+#define TEST_AUGMENTED_HPP
+
+#include "../src/augmented.hpp"
+#include "../src/rbtree.hpp"
+#include "../src/wbtree.hpp"
+#include "../src/ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace augmented {
+
+using namespace ygg;
+
+constexpr size_t AUGMENTED_TESTSIZE = 2000;
+constexpr size_t AUGMENTED_QUERIES = 50;
+constexpr int AUGMENTED_KEYRANGE = 500;
+constexpr size_t AUGMENTED_SEED = 4;
+
+using Options = ygg::TreeOptions<TreeFlags::MULTIPLE,
+                                 TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+/*
+ * Summary of a sequence of nodes. Since 'first' and 'last' depend on the
+ * order, combining is not commutative.
+ */
+struct Summary
+{
+	bool empty;
+	size_t first;
+	size_t last;
+	size_t count;
+	long sum;
+
+	bool
+	operator==(const Summary & other) const
+	{
+		if (this->empty || other.empty) {
+			return this->empty == other.empty;
+		}
+		return (this->first == other.first) && (this->last == other.last) &&
+		       (this->count == other.count) && (this->sum == other.sum);
+	}
+};
+
+Summary
+concat_summaries(const Summary & lhs, const Summary & rhs)
+{
+	if (lhs.empty) {
+		return rhs;
+	}
+	if (rhs.empty) {
+		return lhs;
+	}
+	return {false, lhs.first, rhs.last, lhs.count + rhs.count, lhs.sum + rhs.sum};
+}
+
+template <class Node>
+class SummaryMonoid {
+public:
+	using value_type = Summary;
+
+	static Summary
+	identity()
+	{
+		return {true, 0, 0, 0, 0};
+	}
+
+	static Summary
+	get_value(const Node & node)
+	{
+		return {false, node.id, node.id, 1, node.weight};
+	}
+
+	static Summary
+	combine(const Summary & left, const Summary & self, const Summary & right)
+	{
+		return concat_summaries(concat_summaries(left, self), right);
+	}
+};
+
+template <template <class, class, class> class NodeBase>
+class Node : public NodeBase<Node<NodeBase>, Options, int>,
+             public AugmentedNodeBase<Node<NodeBase>,
+                                      SummaryMonoid<Node<NodeBase>>> {
+public:
+	int data;
+	size_t id;
+	long weight;
+
+	Node() : data(0), id(0), weight(0){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const Node<NodeBase> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const int lhs, const Node<NodeBase> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using RBNode = Node<RBTreeNodeBase>;
+using WBNode = Node<WBTreeNodeBase>;
+using ZNode = Node<ZTreeNodeBase>;
+
+using RBAugmented = Augmented<RBTree<RBNode, RBDefaultNodeTraits, Options>,
+                              SummaryMonoid<RBNode>>;
+using WBAugmented = Augmented<WBTree<WBNode, WBDefaultNodeTraits, Options>,
+                              SummaryMonoid<WBNode>>;
+using ZAugmented =
+    Augmented<ZTree<ZNode, ZTreeDefaultNodeTraits<ZNode>, Options>,
+              SummaryMonoid<ZNode>>;
+
+template <class Tree, class N>
+Summary
+brute_force_aggregate(const Tree & tree, int lower, int upper)
+{
+	Summary result = SummaryMonoid<N>::identity();
+	for (const auto & n : tree) {
+		if ((n.data >= lower) && (n.data < upper)) {
+			result = concat_summaries(result, SummaryMonoid<N>::get_value(n));
+		}
+	}
+	return result;
+}
+
+template <class Tree, class N>
+void
+check_aggregates(const Tree & tree, ygg::testing::utilities::Randomizer & rnd)
+{
+	tree.dbg_verify();
+
+	Summary expected =
+	    brute_force_aggregate<Tree, N>(tree, -1, AUGMENTED_KEYRANGE + 1);
+	ASSERT_EQ(tree.aggregate(), expected);
+
+	for (size_t i = 0; i < AUGMENTED_QUERIES; ++i) {
+		int lower = static_cast<int>(rnd() % AUGMENTED_KEYRANGE);
+		int upper = static_cast<int>(rnd() % AUGMENTED_KEYRANGE);
+		expected = brute_force_aggregate<Tree, N>(tree, lower, upper);
+		ASSERT_EQ(tree.aggregate(lower, upper), expected);
+	}
+}
+
+template <class Tree, class N>
+void
+run_random_test()
+{
+	ygg::testing::utilities::Randomizer rnd(AUGMENTED_SEED);
+	Tree tree;
+	std::vector<N> nodes(AUGMENTED_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i].data = static_cast<int>(rnd() % AUGMENTED_KEYRANGE);
+		nodes[i].id = i;
+		nodes[i].weight = static_cast<long>(rnd() % 1000);
+	}
+
+	ASSERT_TRUE(tree.aggregate().empty);
+	ASSERT_TRUE(tree.aggregate(0, AUGMENTED_KEYRANGE).empty);
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		tree.insert(nodes[i]);
+		if (i % 100 == 0) {
+			check_aggregates<Tree, N>(tree, rnd);
+		}
+	}
+	check_aggregates<Tree, N>(tree, rnd);
+
+	// Change some values in place
+	for (size_t i = 0; i < nodes.size(); i += 7) {
+		nodes[i].weight += 13;
+		tree.fixup_aggregates(nodes[i]);
+	}
+	check_aggregates<Tree, N>(tree, rnd);
+
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(), rnd);
+
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.remove(nodes[indices[i]]);
+		if (i % 100 == 0) {
+			check_aggregates<Tree, N>(tree, rnd);
+		}
+	}
+
+	ASSERT_TRUE(tree.empty());
+	ASSERT_TRUE(tree.aggregate().empty);
+}
+
+TEST(AugmentedTest, RBTreeTest) { run_random_test<RBAugmented, RBNode>(); }
+
+TEST(AugmentedTest, WBTreeTest) { run_random_test<WBAugmented, WBNode>(); }
+
+TEST(AugmentedTest, ZTreeTest) { run_random_test<ZAugmented, ZNode>(); }
+
+/*
+ * Lazy updates: every node has a value modulo a prime, updates apply x -> a*x
+ * + b to all values in a range. Composing such updates is not commutative.
+ */
+constexpr uint64_t LAZY_PRIME = 1000000007;
+
+struct AffineTag
+{
+	uint64_t mul;
+	uint64_t add;
+};
+
+struct SumCount
+{
+	uint64_t sum;
+	uint64_t count;
+
+	bool
+	operator==(const SumCount & other) const
+	{
+		return (this->sum == other.sum) && (this->count == other.count);
+	}
+};
+
+uint64_t
+apply_affine(uint64_t value, const AffineTag & tag)
+{
+	return (tag.mul * value + tag.add) % LAZY_PRIME;
+}
+
+template <class Node>
+class AffineMonoid {
+public:
+	using value_type = SumCount;
+	using tag_type = AffineTag;
+
+	static SumCount
+	identity()
+	{
+		return {0, 0};
+	}
+
+	static SumCount
+	get_value(const Node & node)
+	{
+		return {node.value, 1};
+	}
+
+	static SumCount
+	combine(const SumCount & left, const SumCount & self, const SumCount & right)
+	{
+		return {(left.sum + self.sum + right.sum) % LAZY_PRIME,
+		        left.count + self.count + right.count};
+	}
+
+	static void
+	apply_to_node(Node & node, const AffineTag & tag)
+	{
+		node.value = apply_affine(node.value, tag);
+	}
+
+	static SumCount
+	apply(const SumCount & aggregate, const AffineTag & tag)
+	{
+		return {(tag.mul * aggregate.sum + (tag.add * aggregate.count) % LAZY_PRIME) %
+		            LAZY_PRIME,
+		        aggregate.count};
+	}
+
+	static AffineTag
+	compose(const AffineTag & first, const AffineTag & second)
+	{
+		return {(second.mul * first.mul) % LAZY_PRIME,
+		        apply_affine(first.add, second)};
+	}
+};
+
+template <template <class, class, class> class NodeBase>
+class LazyNode
+    : public NodeBase<LazyNode<NodeBase>, Options, int>,
+      public AugmentedNodeBase<LazyNode<NodeBase>,
+                               AffineMonoid<LazyNode<NodeBase>>> {
+public:
+	int data;
+	uint64_t value;
+
+	LazyNode() : data(0), value(0){};
+
+	bool
+	operator<(const LazyNode & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const LazyNode<NodeBase> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const int lhs, const LazyNode<NodeBase> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using LazyRBNode = LazyNode<RBTreeNodeBase>;
+using LazyZNode = LazyNode<ZTreeNodeBase>;
+
+using LazyRBAugmented =
+    Augmented<RBTree<LazyRBNode, RBDefaultNodeTraits, Options>,
+              AffineMonoid<LazyRBNode>>;
+using LazyZAugmented =
+    Augmented<ZTree<LazyZNode, ZTreeDefaultNodeTraits<LazyZNode>, Options>,
+              AffineMonoid<LazyZNode>>;
+
+template <class Tree, class N>
+void
+run_lazy_test()
+{
+	ygg::testing::utilities::Randomizer rnd(AUGMENTED_SEED);
+	Tree tree;
+	std::vector<N> nodes(AUGMENTED_TESTSIZE);
+	// The values the nodes should have, and whether they are in the tree
+	std::vector<uint64_t> expected(nodes.size());
+	std::vector<bool> in_tree(nodes.size(), false);
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i].data = static_cast<int>(rnd() % AUGMENTED_KEYRANGE);
+		nodes[i].value = rnd() % LAZY_PRIME;
+		expected[i] = nodes[i].value;
+	}
+
+	for (size_t round = 0; round < 10 * AUGMENTED_TESTSIZE; ++round) {
+		size_t index = rnd() % nodes.size();
+		int lower = static_cast<int>(rnd() % AUGMENTED_KEYRANGE);
+		int upper = static_cast<int>(rnd() % AUGMENTED_KEYRANGE);
+
+		switch (rnd() % 4) {
+		case 0:
+			if (in_tree[index]) {
+				tree.remove(nodes[index]);
+				// Removed nodes have all their updates applied
+				ASSERT_EQ(nodes[index].value, expected[index]);
+			} else {
+				tree.insert(nodes[index]);
+			}
+			in_tree[index] = !in_tree[index];
+			break;
+		case 1: {
+			AffineTag tag{rnd() % LAZY_PRIME, rnd() % LAZY_PRIME};
+			tree.range_apply(lower, upper, tag);
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				if (in_tree[i] && (nodes[i].data >= lower) &&
+				    (nodes[i].data < upper)) {
+					expected[i] = apply_affine(expected[i], tag);
+				}
+			}
+			break;
+		}
+		case 2: {
+			SumCount brute{0, 0};
+			for (size_t i = 0; i < nodes.size(); ++i) {
+				if (in_tree[i] && (nodes[i].data >= lower) &&
+				    (nodes[i].data < upper)) {
+					brute.sum = (brute.sum + expected[i]) % LAZY_PRIME;
+					brute.count++;
+				}
+			}
+			ASSERT_EQ(tree.aggregate(lower, upper), brute);
+			break;
+		}
+		default:
+			if (in_tree[index]) {
+				tree.push_tags_to(nodes[index]);
+				ASSERT_EQ(nodes[index].value, expected[index]);
+			}
+			break;
+		}
+
+		if (round % 1000 == 0) {
+			tree.dbg_verify();
+		}
+	}
+
+	tree.dbg_verify();
+	tree.push_all_tags();
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (in_tree[i]) {
+			ASSERT_EQ(nodes[i].value, expected[i]);
+		}
+	}
+	tree.dbg_verify();
+}
+
+TEST(AugmentedTest, LazyRBTreeTest) { run_lazy_test<LazyRBAugmented, LazyRBNode>(); }
+
+TEST(AugmentedTest, LazyZTreeTest) { run_lazy_test<LazyZAugmented, LazyZNode>(); }
+
+} // namespace augmented
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_AUGMENTED_HPP
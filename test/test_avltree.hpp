@@ -0,0 +1,311 @@
+#ifndef TEST_AVLTREE_HPP
+#define TEST_AVLTREE_HPP
+
+#include "../src/avltree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace avltree {
+
+using namespace ygg;
+
+constexpr size_t AVLTREE_TESTSIZE = 3000;
+constexpr size_t AVLTREE_CHECK_INTERVAL = 100;
+constexpr size_t AVLTREE_SEED = 4;
+
+template <class Opts>
+class Node : public AVLTreeNodeBase<Node<Opts>, Opts> {
+public:
+	int data;
+	size_t size; // Maintained by SizeNodeTraits
+
+	Node() : data(0){};
+	explicit Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+template <class Opts>
+bool
+operator<(const Node<Opts> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+template <class Opts>
+bool
+operator<(const int lhs, const Node<Opts> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using Options = TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE>;
+using CompressedOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                TreeFlags::AVL_COMPRESS_BALANCE, TreeFlags::MICRO_PREFETCH,
+                TreeFlags::MICRO_AVOID_CONDITIONALS>;
+using EraseOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                TreeFlags::STL_ERASE>;
+using SetOptions = TreeOptions<TreeFlags::CONSTANT_TIME_SIZE>;
+
+/*
+ * Maintains subtree sizes, to check that the hooks are called correctly.
+ */
+class SizeNodeTraits : public AVLDefaultNodeTraits {
+public:
+	template <class N>
+	static size_t
+	get_size(const N * n)
+	{
+		return (n == nullptr) ? 0 : n->size;
+	}
+
+	template <class N, class Tree>
+	static void
+	leaf_inserted(N & node, Tree & t) noexcept
+	{
+		(void)t;
+		node.size = 1;
+		for (N * cur = node.get_parent(); cur != nullptr;
+		     cur = cur->get_parent()) {
+			cur->size++;
+		}
+	}
+
+	template <class N, class Tree>
+	static void
+	rotated_left(N & node, Tree & t) noexcept
+	{
+		(void)t;
+		node.get_parent()->size = node.size;
+		node.size = 1 + get_size(node.get_left()) + get_size(node.get_right());
+	}
+
+	template <class N, class Tree>
+	static void
+	rotated_right(N & node, Tree & t) noexcept
+	{
+		rotated_left(node, t);
+	}
+
+	template <class N, class Tree>
+	static void
+	delete_leaf(N & node, Tree & t) noexcept
+	{
+		(void)t;
+		for (N * cur = node.get_parent(); cur != nullptr;
+		     cur = cur->get_parent()) {
+			cur->size--;
+		}
+	}
+
+	template <class N, class Tree>
+	static void
+	swapped(N & old_ancestor, N & old_descendant, Tree & t) noexcept
+	{
+		(void)t;
+		std::swap(old_ancestor.size, old_descendant.size);
+	}
+};
+
+template <class Tree>
+void
+check_sizes(const Tree & tree)
+{
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.size, 1 + SizeNodeTraits::get_size(n.get_left()) +
+		                      SizeNodeTraits::get_size(n.get_right()));
+	}
+}
+
+template <class Tree>
+void
+check_height(const Tree & tree)
+{
+	size_t height = 0;
+	for (const auto & n : tree) {
+		height = std::max(height, n.get_depth() + 1);
+	}
+	// An AVL tree with n nodes is at most 1.44 * log2(n + 2) deep
+	ASSERT_LE(static_cast<double>(height),
+	          1.4405 * std::log2(static_cast<double>(tree.size() + 2)));
+}
+
+template <class Opts>
+void
+run_random_test()
+{
+	using N = Node<Opts>;
+	AVLTree<N, SizeNodeTraits, Opts> tree;
+
+	std::vector<N> nodes(AVLTREE_TESTSIZE);
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(AVLTREE_SEED));
+
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.insert(nodes[indices[i]]);
+		if (i % AVLTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+			check_sizes(tree);
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	check_sizes(tree);
+	check_height(tree);
+	ASSERT_EQ(tree.size(), AVLTREE_TESTSIZE);
+
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+	}
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*tree.find(static_cast<int>(i)), &nodes[i]);
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(AVLTREE_SEED + 1));
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.remove(nodes[indices[i]]);
+		if (i % AVLTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+			check_sizes(tree);
+			check_height(tree);
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(AVLTreeTest, RandomInsertionDeletionTest)
+{
+	run_random_test<Options>();
+}
+
+TEST(AVLTreeTest, CompressedBalanceTest)
+{
+	run_random_test<CompressedOptions>();
+
+	// The balance factor lives in the parent pointer
+	ASSERT_EQ(sizeof(AVLTreeNodeBase<Node<CompressedOptions>, CompressedOptions>),
+	          3 * sizeof(void *));
+}
+
+TEST(AVLTreeTest, LinearInsertionDeletionTest)
+{
+	using N = Node<Options>;
+	AVLTree<N, AVLDefaultNodeTraits, Options> tree;
+
+	std::vector<N> nodes(AVLTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		if (i % AVLTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	check_height(tree);
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		tree.remove(nodes[i]);
+		if (i % AVLTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+			check_height(tree);
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(AVLTreeTest, HintedInsertionTest)
+{
+	using N = Node<Options>;
+	AVLTree<N, AVLDefaultNodeTraits, Options> tree;
+	std::vector<N> nodes(AVLTREE_TESTSIZE);
+
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		nodes[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i], tree.end());
+	}
+	for (size_t i = 1; i + 1 < nodes.size(); i += 2) {
+		nodes[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i], nodes[i + 1]);
+	}
+	nodes.back() = N(static_cast<int>(nodes.size() - 1));
+	tree.insert(nodes.back(), tree.end());
+
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+	}
+}
+
+TEST(AVLTreeTest, MultipleEraseTest)
+{
+	using N = Node<EraseOptions>;
+	AVLTree<N, SizeNodeTraits, EraseOptions> tree;
+
+	std::vector<N> nodes(AVLTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	check_sizes(tree);
+
+	ASSERT_EQ(tree.erase(3), AVLTREE_TESTSIZE / 10);
+	ASSERT_EQ(tree.erase(3), 0);
+	ASSERT_TRUE(tree.verify_integrity());
+	check_sizes(tree);
+	ASSERT_EQ(tree.size(), AVLTREE_TESTSIZE - AVLTREE_TESTSIZE / 10);
+
+	auto it = tree.find(4);
+	auto next = tree.erase(it);
+	ASSERT_EQ(next->data, 4);
+	ASSERT_TRUE(tree.verify_integrity());
+	check_sizes(tree);
+}
+
+TEST(AVLTreeTest, SetTest)
+{
+	using N = Node<SetOptions>;
+	AVLTree<N, AVLDefaultNodeTraits, SetOptions> tree;
+
+	std::vector<N> nodes(AVLTREE_TESTSIZE);
+	std::vector<N> duplicates(AVLTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		duplicates[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		tree.insert(duplicates[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	ASSERT_EQ(tree.erase(7), &nodes[7]);
+	ASSERT_EQ(tree.erase(7), nullptr);
+	ASSERT_TRUE(tree.verify_integrity());
+}
+
+} // namespace avltree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_AVLTREE_HPP
@@ -0,0 +1,193 @@
+#ifndef TEST_BIASED_WBTREE_HPP
+#define TEST_BIASED_WBTREE_HPP
+
+#include "../src/biased_wbtree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace biased_wbtree {
+
+using namespace ygg;
+
+constexpr size_t BWBTREE_TESTSIZE = 3000;
+constexpr size_t BWBTREE_CHECK_INTERVAL = 100;
+constexpr size_t BWBTREE_SEED = 4;
+
+using Options = TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE>;
+
+class Node : public BiasedWBTreeNodeBase<Node, Options> {
+public:
+	int data;
+
+	Node() : data(0){};
+	explicit Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+using Tree = BiasedWBTree<Node, WBDefaultNodeTraits, Options>;
+
+/*
+ * Every step down from a node loses a third of the weight, thus a node of
+ * weight w has depth at most log_{3/2}(W / w).
+ */
+void
+check_depths(const Tree & tree)
+{
+	if (tree.empty()) {
+		return;
+	}
+	double total = static_cast<double>(Tree::get_total_weight(tree.get_root()));
+	for (const auto & n : tree) {
+		double bound = std::log(total / static_cast<double>(Tree::get_weight(n))) /
+		               std::log(1.5);
+		ASSERT_LE(static_cast<double>(n.get_depth()), bound + 1e-9);
+	}
+}
+
+TEST(BiasedWBTreeTest, UniformWeightsTest)
+{
+	Tree tree;
+	std::vector<Node> nodes(BWBTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(i));
+	}
+
+	// Sorted insertion must not degenerate
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		tree.insert(nodes[i]);
+		if (i % BWBTREE_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	check_depths(tree);
+	ASSERT_EQ(tree.size(), BWBTREE_TESTSIZE);
+	ASSERT_EQ(Tree::get_total_weight(tree.get_root()), BWBTREE_TESTSIZE);
+
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+	}
+
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(BWBTREE_SEED));
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.remove(nodes[indices[i]]);
+		if (i % BWBTREE_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+			check_depths(tree);
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(BiasedWBTreeTest, ZipfWeightsTest)
+{
+	Tree tree;
+	std::vector<Node> nodes(BWBTREE_TESTSIZE);
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(i));
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(BWBTREE_SEED));
+
+	// The node at position i in the shuffled order gets weight ~ 1 / (i+1)
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.insert(nodes[indices[i]], (1000000 / (i + 1)) + 1);
+	}
+	tree.dbg_verify();
+	check_depths(tree);
+
+	// The heaviest node sits at the root
+	ASSERT_EQ(tree.get_root(), &nodes[indices[0]]);
+
+	// Average depth weighted by access frequency must be far below the depth of
+	// a balanced tree.
+	double weighted_depth = 0;
+	for (const auto & n : tree) {
+		weighted_depth += static_cast<double>(n.get_depth() * Tree::get_weight(n));
+	}
+	weighted_depth /=
+	    static_cast<double>(Tree::get_total_weight(tree.get_root()));
+	ASSERT_LT(weighted_depth, std::log2(static_cast<double>(BWBTREE_TESTSIZE)));
+
+	// Make a light node very heavy, it must move to the root
+	Node & light = nodes[indices[indices.size() - 1]];
+	tree.update_weight(light, 100000000);
+	tree.dbg_verify();
+	ASSERT_EQ(tree.get_root(), &light);
+
+	// And make it light again
+	tree.update_weight(light, 1);
+	tree.dbg_verify();
+	check_depths(tree);
+	ASSERT_EQ(tree.get_root(), &nodes[indices[0]]);
+
+	ygg::testing::utilities::Randomizer rnd(BWBTREE_SEED);
+	for (size_t i = 0; i < BWBTREE_TESTSIZE; ++i) {
+		tree.update_weight(nodes[rnd() % nodes.size()], (rnd() % 10000) + 1);
+		if (i % BWBTREE_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+			check_depths(tree);
+		}
+	}
+
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+	}
+}
+
+TEST(BiasedWBTreeTest, MultipleTest)
+{
+	Tree tree;
+	std::vector<Node> nodes(BWBTREE_TESTSIZE);
+	ygg::testing::utilities::Randomizer rnd(BWBTREE_SEED);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(i % 10));
+		tree.insert(nodes[i], (rnd() % 100) + 1);
+	}
+	tree.dbg_verify();
+	check_depths(tree);
+	ASSERT_EQ(tree.size(), BWBTREE_TESTSIZE);
+
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		tree.remove(nodes[i]);
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), BWBTREE_TESTSIZE / 2);
+
+	for (int i = 0; i < 10; ++i) {
+		auto it = tree.find(Node(i));
+		if (i % 2 == 0) {
+			ASSERT_EQ(it, tree.end());
+		} else {
+			ASSERT_EQ(it->data, i);
+		}
+	}
+}
+
+} // namespace biased_wbtree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_BIASED_WBTREE_HPP
@@ -0,0 +1,155 @@
+#ifndef TEST_BLOOM_FILTERED_HPP
+#define TEST_BLOOM_FILTERED_HPP
+
+#include "../src/bloom_filtered.hpp"
+#include "common_wrapper_tests.hpp"
+
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace bloom_filtered {
+
+using namespace ygg;
+using namespace ygg::testing::keyed_wrapper;
+
+template <class Options>
+using RBBloomTree = RBWrapped<BloomFiltered, Options>;
+template <class Options>
+using ZBloomTree = ZWrapped<BloomFiltered, Options>;
+
+// Maps all keys to the same counters, so every key is a possible false positive
+struct ConstantHasher
+{
+	size_t
+	operator()(int) const noexcept
+	{
+		return 0;
+	}
+};
+
+template <class Tree, class KG>
+using ConstantBloomFiltered = BloomFiltered<Tree, KG, ConstantHasher>;
+using RBConstantBloomTree = RBWrapped<ConstantBloomFiltered, MultiOptions>;
+
+TEST(BloomFilteredTest, RandomInsertionDeletionTest)
+{
+	run_random_test<RBBloomTree<MultiOptions>>();
+	run_random_test<RBBloomTree<SetOptions>>();
+	run_random_test<ZBloomTree<MultiOptions>>();
+}
+
+TEST(BloomFilteredTest, DuplicatesTest)
+{
+	run_remove_duplicates_test<RBBloomTree<MultiOptions>>();
+}
+
+TEST(BloomFilteredTest, EraseTest)
+{
+	run_erase_duplicates_test<RBBloomTree<MultiOptions>>();
+}
+
+TEST(BloomFilteredTest, STLEraseTest)
+{
+	run_stl_erase_test<RBBloomTree<STLMultiOptions>>();
+}
+
+TEST(BloomFilteredTest, SetTest)
+{
+	run_set_test<RBBloomTree<SetOptions>>();
+}
+
+TEST(BloomFilteredTest, FalsePositiveRateTest)
+{
+	using BTree = RBBloomTree<SetOptions>;
+	using N = typename BTree::Node;
+	BTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(2 * i));
+		tree.insert(nodes[i]);
+	}
+
+	// No false negatives, and (with about 3% expected) few false positives
+	size_t false_positives = 0;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_TRUE(tree.may_contain(static_cast<int>(2 * i)));
+		if (tree.may_contain(static_cast<int>(2 * i + 1))) {
+			false_positives++;
+		}
+	}
+	ASSERT_LT(false_positives, nodes.size() / 10);
+
+	// Without saturated counters, an empty tree rules out every key
+	for (auto & n : nodes) {
+		tree.remove(n);
+	}
+	tree.dbg_verify();
+	for (size_t i = 0; i < 2 * nodes.size(); ++i) {
+		ASSERT_FALSE(tree.may_contain(static_cast<int>(i)));
+	}
+}
+
+TEST(BloomFilteredTest, FalsePositiveFallthroughTest)
+{
+	using BTree = RBConstantBloomTree;
+	using N = typename BTree::Node;
+	BTree tree;
+
+	std::vector<N> nodes(WRAPPER_TESTSIZE / 10);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(2 * i));
+		tree.insert(nodes[i]);
+	}
+	tree.dbg_verify();
+
+	// The filter can't rule out any key, so the tree must answer
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const int absent = static_cast<int>(2 * i + 1);
+		ASSERT_TRUE(tree.may_contain(absent));
+		ASSERT_EQ(tree.find(absent), tree.end());
+		ASSERT_EQ(tree.erase(absent), nullptr);
+		ASSERT_EQ(&*tree.find(static_cast<int>(2 * i)), &nodes[i]);
+	}
+	ASSERT_EQ(tree.size(), nodes.size());
+	tree.dbg_verify();
+}
+
+TEST(BloomFilteredTest, SaturationTest)
+{
+	using BTree = RBConstantBloomTree;
+	using N = typename BTree::Node;
+	BTree tree;
+
+	// More distinct keys on the same counters than a counter can count
+	std::vector<N> nodes(WRAPPER_TESTSIZE / 5);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+	}
+	tree.dbg_verify();
+
+	// Saturated counters never drop to zero, so no key is ever ruled out wrongly
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(tree.erase(static_cast<int>(i)), &nodes[i]);
+		ASSERT_EQ(tree.find(static_cast<int>(i)), tree.end());
+		if (i + 1 < nodes.size()) {
+			ASSERT_TRUE(tree.may_contain(static_cast<int>(i + 1)));
+			ASSERT_EQ(&*tree.find(static_cast<int>(i + 1)), &nodes[i + 1]);
+		}
+		if (i % WRAPPER_CHECK_INTERVAL == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+}
+
+} // namespace bloom_filtered
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_BLOOM_FILTERED_HPP
@@ -0,0 +1,248 @@
+#ifndef TEST_BTREE_INDEX_HPP
+#define TEST_BTREE_INDEX_HPP
+
+#include "../src/btree_index.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace btree_index {
+
+using namespace ygg;
+
+constexpr size_t BTREE_INDEX_TESTSIZE = 5000;
+constexpr size_t BTREE_INDEX_CHECK_INTERVAL = 250;
+constexpr size_t BTREE_INDEX_SEED = 4;
+
+template <class Key>
+class Node {
+public:
+	Key key;
+
+	Node() : key(){};
+	explicit Node(Key key_in) : key(key_in){};
+};
+
+template <class Key>
+class KeyGetter {
+public:
+	static Key
+	get_key(const Node<Key> & n)
+	{
+		return n.key;
+	}
+};
+
+template <class Key, class Opts>
+using Index = IntrusiveBTreeIndex<Node<Key>, KeyGetter<Key>, Opts>;
+
+using Options = TreeOptions<TreeFlags::MULTIPLE>;
+using SetOptions = TreeOptions<>;
+using SmallPageOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::BTREE_PAGE_KEYS<5>,
+                TreeFlags::MICRO_PREFETCH>;
+
+template <class Key, class Opts>
+void
+run_random_test(const std::vector<Key> & keys)
+{
+	using N = Node<Key>;
+	Index<Key, Opts> index;
+
+	std::vector<N> nodes(keys.size());
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(keys[i]);
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(BTREE_INDEX_SEED));
+
+	for (size_t i = 0; i < indices.size(); ++i) {
+		index.insert(nodes[indices[i]]);
+		if (i % BTREE_INDEX_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(index.verify_integrity());
+		}
+	}
+	ASSERT_TRUE(index.verify_integrity());
+	ASSERT_EQ(index.size(), keys.size());
+
+	// keys are sorted and unique
+	size_t i = 0;
+	for (const auto & n : index) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i++;
+	}
+	ASSERT_EQ(i, keys.size());
+
+	for (i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*index.find(keys[i]), &nodes[i]);
+		ASSERT_EQ(&*index.lower_bound(keys[i]), &nodes[i]);
+		if (i + 1 < nodes.size()) {
+			ASSERT_EQ(&*index.upper_bound(keys[i]), &nodes[i + 1]);
+		} else {
+			ASSERT_EQ(index.upper_bound(keys[i]), index.end());
+		}
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(BTREE_INDEX_SEED + 1));
+	for (i = 0; i < indices.size(); ++i) {
+		index.remove(nodes[indices[i]]);
+		ASSERT_EQ(index.find(keys[indices[i]]), index.end());
+		if (i % BTREE_INDEX_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(index.verify_integrity());
+			ASSERT_EQ(index.size(), keys.size() - i - 1);
+		}
+	}
+	ASSERT_TRUE(index.empty());
+	ASSERT_EQ(index.get_height(), 0);
+	ASSERT_EQ(index.begin(), index.end());
+}
+
+TEST(BTreeIndexTest, RandomInsertionDeletionTest)
+{
+	std::vector<int64_t> keys;
+	for (size_t i = 0; i < BTREE_INDEX_TESTSIZE; ++i) {
+		keys.push_back(static_cast<int64_t>(i) * 3 - 5000);
+	}
+	run_random_test<int64_t, Options>(keys);
+	run_random_test<int64_t, SmallPageOptions>(keys);
+}
+
+TEST(BTreeIndexTest, UnsignedKeysTest)
+{
+	// Keys above the signed range must be ordered correctly by the SIMD search,
+	// and the largest key must not be confused with the padding.
+	std::vector<uint32_t> keys32;
+	std::vector<uint64_t> keys64;
+	for (size_t i = 0; i < BTREE_INDEX_TESTSIZE; ++i) {
+		keys32.push_back(static_cast<uint32_t>(i * 858993u));
+		keys64.push_back(static_cast<uint64_t>(i) * 3689348814741910ul);
+	}
+	keys32.push_back(std::numeric_limits<uint32_t>::max());
+	keys64.push_back(std::numeric_limits<uint64_t>::max());
+
+	run_random_test<uint32_t, Options>(keys32);
+	run_random_test<uint32_t, SmallPageOptions>(keys32);
+	run_random_test<uint64_t, Options>(keys64);
+	run_random_test<uint64_t, SmallPageOptions>(keys64);
+}
+
+TEST(BTreeIndexTest, NonIntegralKeysTest)
+{
+	std::vector<std::string> keys;
+	for (size_t i = 0; i < BTREE_INDEX_TESTSIZE / 5; ++i) {
+		keys.push_back(std::to_string(i));
+	}
+	std::sort(keys.begin(), keys.end());
+	run_random_test<std::string, Options>(keys);
+}
+
+TEST(BTreeIndexTest, HeightTest)
+{
+	using N = Node<int64_t>;
+	Index<int64_t, Options> index;
+
+	std::vector<N> nodes(BTREE_INDEX_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int64_t>(i));
+		index.insert(nodes[i]);
+	}
+	ASSERT_TRUE(index.verify_integrity());
+
+	// Every page (except for the root) is at least half full
+	static_assert(Index<int64_t, Options>::page_keys == 16);
+	ASSERT_LE(index.get_height(), 4);
+}
+
+template <class Opts>
+void
+run_duplicates_test()
+{
+	using N = Node<int>;
+	Index<int, Opts> index;
+
+	std::vector<N> nodes(BTREE_INDEX_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		index.insert(nodes[i]);
+	}
+	ASSERT_TRUE(index.verify_integrity());
+	ASSERT_EQ(index.size(), nodes.size());
+
+	size_t count = 0;
+	for (auto it = index.lower_bound(3); it != index.upper_bound(3); ++it) {
+		ASSERT_EQ(it->key, 3);
+		count++;
+	}
+	ASSERT_EQ(count, BTREE_INDEX_TESTSIZE / 10);
+	ASSERT_EQ(index.find(3)->key, 3);
+
+	// Remove the nodes with even keys, in random order
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(BTREE_INDEX_SEED));
+	size_t removed = 0;
+	for (size_t i : indices) {
+		if (nodes[i].key % 2 == 0) {
+			index.remove(nodes[i]);
+			removed++;
+			if (removed % BTREE_INDEX_CHECK_INTERVAL == 0) {
+				ASSERT_TRUE(index.verify_integrity());
+			}
+		}
+	}
+	ASSERT_TRUE(index.verify_integrity());
+	ASSERT_EQ(index.size(), BTREE_INDEX_TESTSIZE / 2);
+	ASSERT_EQ(index.find(4), index.end());
+	ASSERT_EQ(index.lower_bound(4)->key, 5);
+	for (const auto & n : index) {
+		ASSERT_EQ(n.key % 2, 1);
+	}
+}
+
+TEST(BTreeIndexTest, DuplicatesTest)
+{
+	run_duplicates_test<Options>();
+	run_duplicates_test<SmallPageOptions>();
+}
+
+TEST(BTreeIndexTest, SetTest)
+{
+	using N = Node<int>;
+	Index<int, SetOptions> index;
+
+	std::vector<N> nodes(BTREE_INDEX_TESTSIZE);
+	std::vector<N> duplicates(BTREE_INDEX_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		duplicates[i] = N(static_cast<int>(i));
+		index.insert(nodes[i]);
+		index.insert(duplicates[i]);
+	}
+	ASSERT_TRUE(index.verify_integrity());
+	ASSERT_EQ(index.size(), nodes.size());
+	ASSERT_EQ(&*index.find(7), &nodes[7]);
+
+	index.clear();
+	ASSERT_TRUE(index.empty());
+	ASSERT_EQ(index.find(7), index.end());
+	ASSERT_TRUE(index.verify_integrity());
+}
+
+} // namespace btree_index
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_BTREE_INDEX_HPP
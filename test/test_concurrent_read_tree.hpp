@@ -0,0 +1,306 @@
+#ifndef TEST_CONCURRENT_READ_TREE_HPP
+#define TEST_CONCURRENT_READ_TREE_HPP
+
+#include "../src/concurrent_read_tree.hpp"
+#include "../src/energy.hpp"
+#include "../src/rbtree.hpp"
+#include "../src/wbtree.hpp"
+#include "../src/ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace concurrent_read_tree {
+
+using namespace ygg;
+
+constexpr size_t CRTREE_TESTSIZE = 3000;
+constexpr size_t CRTREE_READERS = 4;
+constexpr size_t CRTREE_ROUNDS = 3;
+constexpr size_t CRTREE_SEED = 4;
+
+using Options = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE,
+                                 TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+template <template <class, class, class> class NodeBase>
+class Node : public NodeBase<Node<NodeBase>, Options, int> {
+public:
+	int data;
+
+	Node() : data(0){};
+	Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const Node<NodeBase> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const int lhs, const Node<NodeBase> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using RBNode = Node<RBTreeNodeBase>;
+using WBNode = Node<WBTreeNodeBase>;
+using ZNode = Node<ZTreeNodeBase>;
+using EnergyNode = Node<EnergyTreeNodeBase>;
+
+using RBConcurrentTree =
+    ConcurrentReadTree<RBTree<RBNode, RBDefaultNodeTraits, Options>>;
+using WBConcurrentTree =
+    ConcurrentReadTree<WBTree<WBNode, WBDefaultNodeTraits, Options>>;
+using ZConcurrentTree = ConcurrentReadTree<
+    ZTree<ZNode, ZTreeDefaultNodeTraits<ZNode>, Options>>;
+using EnergyConcurrentTree = ConcurrentReadTree<EnergyTree<EnergyNode, Options>>;
+
+template <class CTree>
+void
+run_sequential_test()
+{
+	using N = typename CTree::Node;
+	CTree tree;
+
+	std::vector<N> nodes(CRTREE_TESTSIZE);
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < CRTREE_TESTSIZE; ++i) {
+		nodes[i] = N(static_cast<int>(2 * i));
+		indices.push_back(i);
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(CRTREE_SEED));
+
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), CRTREE_TESTSIZE);
+
+	for (size_t i = 0; i < CRTREE_TESTSIZE; ++i) {
+		int key = static_cast<int>(2 * i);
+		ASSERT_EQ(tree.find(key), &nodes[i]);
+		ASSERT_EQ(tree.find(key + 1), nullptr);
+		ASSERT_EQ(tree.lower_bound(key), &nodes[i]);
+		ASSERT_EQ(tree.lower_bound(key - 1), &nodes[i]);
+		if (i + 1 < CRTREE_TESTSIZE) {
+			ASSERT_EQ(tree.upper_bound(key), &nodes[i + 1]);
+		} else {
+			ASSERT_EQ(tree.upper_bound(key), nullptr);
+		}
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(CRTREE_SEED + 1));
+	for (auto index : indices) {
+		tree.remove(nodes[index]);
+		ASSERT_EQ(tree.find(static_cast<int>(2 * index)), nullptr);
+	}
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+}
+
+template <class CTree>
+void
+run_concurrent_test()
+{
+	using N = typename CTree::Node;
+	CTree tree;
+
+	// The nodes with odd keys stay in the tree all the time, the readers must
+	// always find them. The writer repeatedly inserts and retires the nodes
+	// with even keys, reusing them as soon as they are reclaimed.
+	std::vector<N> fixed_nodes(CRTREE_TESTSIZE);
+	std::vector<N> nodes(CRTREE_TESTSIZE);
+	for (size_t i = 0; i < CRTREE_TESTSIZE; ++i) {
+		fixed_nodes[i] = N(static_cast<int>(2 * i + 1));
+		tree.insert(fixed_nodes[i]);
+		nodes[i] = N(static_cast<int>(2 * i));
+	}
+
+	std::atomic<bool> writer_done(false);
+	std::atomic<size_t> reader_errors(0);
+
+	auto writer = [&]() {
+		std::vector<N *> free_nodes;
+		for (auto & n : nodes) {
+			free_nodes.push_back(&n);
+		}
+		std::vector<N *> used_nodes;
+
+		for (size_t round = 0; round < CRTREE_ROUNDS; ++round) {
+			for (auto * n : free_nodes) {
+				tree.insert(*n);
+				used_nodes.push_back(n);
+			}
+			free_nodes.clear();
+			for (auto * n : used_nodes) {
+				tree.retire(*n);
+				tree.reclaim([&](N & reclaimed) { free_nodes.push_back(&reclaimed); });
+			}
+			used_nodes.clear();
+			tree.synchronize();
+			tree.reclaim([&](N & reclaimed) { free_nodes.push_back(&reclaimed); });
+			if (free_nodes.size() != CRTREE_TESTSIZE) {
+				reader_errors++;
+			}
+		}
+	};
+
+	auto reader = [&]() {
+		while (!writer_done.load()) {
+			for (size_t i = 0; i + 1 < CRTREE_TESTSIZE; i += 7) {
+				int key = static_cast<int>(2 * i + 1);
+				if (tree.find(key) != &fixed_nodes[i]) {
+					reader_errors++;
+				}
+				if (tree.lower_bound(key) != &fixed_nodes[i]) {
+					reader_errors++;
+				}
+				// The next node is either the even node (if it is in the tree right
+				// now) or the next fixed node.
+				const N * next = tree.upper_bound(key);
+				if (next != &nodes[i + 1] && next != &fixed_nodes[i + 1]) {
+					reader_errors++;
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> readers;
+	for (size_t t = 0; t < CRTREE_READERS; ++t) {
+		readers.emplace_back(reader);
+	}
+	std::thread writer_thread(writer);
+	writer_thread.join();
+	writer_done.store(true);
+	for (auto & t : readers) {
+		t.join();
+	}
+
+	ASSERT_EQ(reader_errors.load(), size_t{0});
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), CRTREE_TESTSIZE);
+	for (size_t i = 0; i < CRTREE_TESTSIZE; ++i) {
+		ASSERT_EQ(tree.find(fixed_nodes[i].data), &fixed_nodes[i]);
+		ASSERT_EQ(tree.find(nodes[i].data), nullptr);
+	}
+}
+
+TEST(ConcurrentReadTreeTest, RBTreeSequentialTest)
+{
+	run_sequential_test<RBConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, WBTreeSequentialTest)
+{
+	run_sequential_test<WBConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, ZTreeSequentialTest)
+{
+	run_sequential_test<ZConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, EnergyTreeSequentialTest)
+{
+	run_sequential_test<EnergyConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, RBTreeConcurrentTest)
+{
+	run_concurrent_test<RBConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, WBTreeConcurrentTest)
+{
+	run_concurrent_test<WBConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, ZTreeConcurrentTest)
+{
+	run_concurrent_test<ZConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, EnergyTreeConcurrentTest)
+{
+	run_concurrent_test<EnergyConcurrentTree>();
+}
+
+TEST(ConcurrentReadTreeTest, ReclamationTest)
+{
+	RBConcurrentTree tree;
+	std::vector<RBNode> nodes(10);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = RBNode(static_cast<int>(i));
+		tree.insert(nodes[i]);
+	}
+
+	size_t reclaimed = 0;
+	auto count = [&](RBNode & n) {
+		(void)n;
+		reclaimed++;
+	};
+
+	// A reader that is still running keeps the retired node from being
+	// reclaimed.
+	std::atomic<bool> reader_entered(false);
+	std::atomic<bool> reader_may_leave(false);
+	std::thread reader([&]() {
+		tree.read([&](const auto & t) {
+			(void)t;
+			reader_entered.store(true);
+			while (!reader_may_leave.load()) {
+				std::this_thread::yield();
+			}
+			return 0;
+		});
+	});
+	while (!reader_entered.load()) {
+		std::this_thread::yield();
+	}
+
+	tree.retire(nodes[0]);
+	ASSERT_EQ(tree.find(0), nullptr);
+	for (size_t i = 0; i < 10; ++i) {
+		ASSERT_EQ(tree.reclaim(count), size_t{0});
+	}
+	ASSERT_EQ(reclaimed, size_t{0});
+
+	reader_may_leave.store(true);
+	reader.join();
+
+	// Without readers, at most two calls are necessary
+	tree.reclaim(count);
+	tree.reclaim(count);
+	ASSERT_EQ(reclaimed, size_t{1});
+
+	tree.retire(nodes[1]);
+	tree.retire(nodes[2]);
+	tree.synchronize();
+	ASSERT_EQ(tree.reclaim(count), size_t{2});
+	ASSERT_EQ(reclaimed, size_t{3});
+	ASSERT_EQ(tree.size(), size_t{7});
+}
+
+} // namespace concurrent_read_tree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_CONCURRENT_READ_TREE_HPP
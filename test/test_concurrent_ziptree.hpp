@@ -0,0 +1,208 @@
+#ifndef TEST_CONCURRENT_ZIPTREE_HPP
+#define TEST_CONCURRENT_ZIPTREE_HPP
+
+#include "../src/concurrent_ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace concurrent_ziptree {
+
+using namespace ygg;
+
+constexpr size_t CZIPTREE_TESTSIZE = 5000;
+constexpr size_t CZIPTREE_THREADS = 4;
+constexpr size_t CZIPTREE_SEED = 4;
+
+using RandomRankOptions =
+    ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE,
+                     TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+class Node : public ConcurrentZTreeNodeBase<Node, RandomRankOptions> {
+public:
+	int data;
+
+	Node() : data(0){};
+	Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+bool
+operator<(const Node & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+bool
+operator<(const int lhs, const Node & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using Tree = ConcurrentZTree<Node, RandomRankOptions>;
+
+TEST(ConcurrentZipTreeTest, TrivialInsertionTest)
+{
+	Tree tree;
+
+	Node n(0);
+	tree.insert(n);
+
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), size_t{1});
+	ASSERT_EQ(tree.find(0), &n);
+	ASSERT_EQ(tree.find(1), nullptr);
+
+	ASSERT_TRUE(tree.remove(n));
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+	ASSERT_EQ(tree.find(0), nullptr);
+
+	// Removing a node that is not in the tree does nothing
+	Node other(1);
+	tree.insert(n);
+	ASSERT_FALSE(tree.remove(other));
+	ASSERT_TRUE(tree.remove(n));
+	ASSERT_FALSE(tree.remove(n));
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(ConcurrentZipTreeTest, SequentialInsertionAndDeletionTest)
+{
+	Tree tree;
+
+	std::vector<Node> nodes(CZIPTREE_TESTSIZE);
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < CZIPTREE_TESTSIZE; ++i) {
+		nodes[i] = Node(static_cast<int>(2 * i));
+		indices.push_back(i);
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(CZIPTREE_SEED));
+
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), CZIPTREE_TESTSIZE);
+
+	for (size_t i = 0; i < CZIPTREE_TESTSIZE; ++i) {
+		ASSERT_EQ(tree.find(static_cast<int>(2 * i)), &nodes[i]);
+		ASSERT_EQ(tree.find(static_cast<int>(2 * i + 1)), nullptr);
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(CZIPTREE_SEED + 1));
+
+	size_t remaining = CZIPTREE_TESTSIZE;
+	for (auto index : indices) {
+		tree.remove(nodes[index]);
+		remaining--;
+		ASSERT_EQ(tree.find(static_cast<int>(2 * index)), nullptr);
+		ASSERT_EQ(tree.size(), remaining);
+	}
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(ConcurrentZipTreeTest, ConcurrentInsertionAndDeletionTest)
+{
+	Tree tree;
+
+	// Every writer thread works on its own set of nodes with negative keys. The
+	// nodes with positive odd keys stay in the tree all the time, the readers
+	// must always find them.
+	std::vector<Node> fixed_nodes(CZIPTREE_TESTSIZE);
+	std::vector<Node> nodes(CZIPTREE_TESTSIZE * CZIPTREE_THREADS);
+	for (size_t i = 0; i < CZIPTREE_TESTSIZE; ++i) {
+		fixed_nodes[i] = Node(static_cast<int>(2 * i + 1));
+		tree.insert(fixed_nodes[i]);
+	}
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(-static_cast<int>(2 * i + 2));
+	}
+
+	std::atomic<bool> writers_done(false);
+	std::atomic<size_t> reader_errors(0);
+
+	auto writer = [&](size_t thread_id) {
+		std::vector<size_t> indices;
+		for (size_t i = 0; i < CZIPTREE_TESTSIZE; ++i) {
+			indices.push_back(thread_id * CZIPTREE_TESTSIZE + i);
+		}
+		std::shuffle(indices.begin(), indices.end(),
+		             ygg::testing::utilities::Randomizer(CZIPTREE_SEED + thread_id));
+
+		for (auto index : indices) {
+			tree.insert(nodes[index]);
+		}
+		// Remove every second one again
+		for (auto index : indices) {
+			if (index % 2 == 0) {
+				tree.remove(nodes[index]);
+			}
+		}
+	};
+
+	auto reader = [&]() {
+		while (!writers_done.load()) {
+			for (size_t i = 0; i < CZIPTREE_TESTSIZE; i += 7) {
+				if (tree.find(static_cast<int>(2 * i + 1)) != &fixed_nodes[i]) {
+					reader_errors++;
+				}
+				if (tree.find(static_cast<int>(2 * i + 2)) != nullptr) {
+					reader_errors++;
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> writers;
+	std::vector<std::thread> readers;
+	for (size_t t = 0; t < CZIPTREE_THREADS; ++t) {
+		writers.emplace_back(writer, t);
+		readers.emplace_back(reader);
+	}
+	for (auto & t : writers) {
+		t.join();
+	}
+	writers_done.store(true);
+	for (auto & t : readers) {
+		t.join();
+	}
+
+	ASSERT_EQ(reader_errors.load(), size_t{0});
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), CZIPTREE_TESTSIZE + nodes.size() / 2);
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (i % 2 == 0) {
+			ASSERT_EQ(tree.find(nodes[i].data), nullptr);
+		} else {
+			ASSERT_EQ(tree.find(nodes[i].data), &nodes[i]);
+		}
+	}
+	for (size_t i = 0; i < CZIPTREE_TESTSIZE; ++i) {
+		ASSERT_EQ(tree.find(fixed_nodes[i].data), &fixed_nodes[i]);
+	}
+}
+
+} // namespace concurrent_ziptree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_CONCURRENT_ZIPTREE_HPP
@@ -0,0 +1,262 @@
+#ifndef TEST_CRITBIT_TREE_HPP
+#define TEST_CRITBIT_TREE_HPP
+
+#include "../src/critbit_tree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace critbit_tree {
+
+using namespace ygg;
+
+constexpr size_t CRITBIT_TESTSIZE = 3000;
+constexpr size_t CRITBIT_CHECK_INTERVAL = 100;
+constexpr size_t CRITBIT_SEED = 4;
+
+template <class Key, class Opts>
+class Node : public CritBitNodeBase<Node<Key, Opts>, Opts> {
+public:
+	Key key;
+
+	Node() : key(){};
+	explicit Node(Key key_in) : key(key_in){};
+};
+
+template <class Key, class Opts>
+class KeyGetter {
+public:
+	static Key
+	get_key(const Node<Key, Opts> & n)
+	{
+		return n.key;
+	}
+};
+
+template <class Key, class Opts>
+using Tree = CritBitTree<Node<Key, Opts>, KeyGetter<Key, Opts>, Opts>;
+
+using Options = TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE>;
+using SetOptions =
+    TreeOptions<TreeFlags::CONSTANT_TIME_SIZE, TreeFlags::MICRO_PREFETCH>;
+
+using ByteKey = std::array<unsigned char, 5>;
+
+/*
+ * Inserts and removes nodes with the given (sorted, unique) keys in random
+ * order, checking the tree in between.
+ */
+template <class Key, class Opts>
+void
+run_random_test(const std::vector<Key> & keys)
+{
+	using N = Node<Key, Opts>;
+	Tree<Key, Opts> tree;
+
+	std::vector<N> nodes(keys.size());
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(keys[i]);
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(CRITBIT_SEED));
+
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.insert(nodes[indices[i]]);
+		if (i % CRITBIT_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), keys.size());
+
+	size_t i = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i++;
+	}
+	ASSERT_EQ(i, keys.size());
+	for (auto it = tree.rbegin(); it != tree.rend(); ++it) {
+		i--;
+		ASSERT_EQ(&*it, &nodes[i]);
+	}
+
+	for (i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*tree.find(keys[i]), &nodes[i]);
+		ASSERT_EQ(&*tree.lower_bound(keys[i]), &nodes[i]);
+		if (i + 1 < nodes.size()) {
+			ASSERT_EQ(&*tree.upper_bound(keys[i]), &nodes[i + 1]);
+		} else {
+			ASSERT_EQ(tree.upper_bound(keys[i]), tree.end());
+		}
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(CRITBIT_SEED + 1));
+	for (i = 0; i < indices.size(); ++i) {
+		tree.remove(nodes[indices[i]]);
+		ASSERT_EQ(tree.find(keys[indices[i]]), tree.end());
+		if (i % CRITBIT_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+			ASSERT_EQ(tree.size(), keys.size() - i - 1);
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(CritBitTreeTest, SignedKeysTest)
+{
+	std::vector<int64_t> keys;
+	for (size_t i = 0; i < CRITBIT_TESTSIZE; ++i) {
+		keys.push_back(static_cast<int64_t>(i) * 7919 - 10000000);
+	}
+	keys.push_back(std::numeric_limits<int64_t>::max());
+	keys.insert(keys.begin(), std::numeric_limits<int64_t>::min());
+
+	run_random_test<int64_t, Options>(keys);
+	run_random_test<int64_t, SetOptions>(keys);
+}
+
+TEST(CritBitTreeTest, UnsignedKeysTest)
+{
+	std::vector<uint32_t> keys;
+	for (size_t i = 0; i < CRITBIT_TESTSIZE; ++i) {
+		keys.push_back(static_cast<uint32_t>(i * 1431655u));
+	}
+	run_random_test<uint32_t, Options>(keys);
+	run_random_test<uint32_t, SetOptions>(keys);
+}
+
+TEST(CritBitTreeTest, ByteKeysTest)
+{
+	std::vector<ByteKey> keys;
+	for (size_t i = 0; i < CRITBIT_TESTSIZE; ++i) {
+		ByteKey key = {static_cast<unsigned char>(i % 7),
+		               static_cast<unsigned char>(i * 13),
+		               static_cast<unsigned char>(i / 256), 0,
+		               static_cast<unsigned char>(i)};
+		keys.push_back(key);
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	run_random_test<ByteKey, Options>(keys);
+	run_random_test<ByteKey, SetOptions>(keys);
+}
+
+TEST(CritBitTreeTest, BoundsTest)
+{
+	using N = Node<int, SetOptions>;
+	Tree<int, SetOptions> tree;
+
+	std::vector<N> nodes(CRITBIT_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i) * 10);
+		tree.insert(nodes[i]);
+	}
+
+	for (int query = -5; query < static_cast<int>(CRITBIT_TESTSIZE) * 10 + 5;
+	     ++query) {
+		size_t expected_lower = static_cast<size_t>(std::max(0, (query + 9) / 10));
+		size_t expected_upper = static_cast<size_t>(std::max(0, query / 10 + 1));
+		if (query < 0) {
+			expected_upper = 0;
+		}
+
+		auto lower = tree.lower_bound(query);
+		auto upper = tree.upper_bound(query);
+		if (expected_lower < nodes.size()) {
+			ASSERT_EQ(&*lower, &nodes[expected_lower]);
+		} else {
+			ASSERT_EQ(lower, tree.end());
+		}
+		if (expected_upper < nodes.size()) {
+			ASSERT_EQ(&*upper, &nodes[expected_upper]);
+		} else {
+			ASSERT_EQ(upper, tree.end());
+		}
+		ASSERT_EQ(tree.find(query) != tree.end(), query >= 0 && query % 10 == 0 &&
+		                                              expected_lower < nodes.size());
+	}
+}
+
+TEST(CritBitTreeTest, DuplicatesTest)
+{
+	using N = Node<int, Options>;
+	Tree<int, Options> tree;
+
+	std::vector<N> nodes(CRITBIT_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+		if (i % CRITBIT_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	size_t count = 0;
+	for (auto it = tree.lower_bound(3); it != tree.upper_bound(3); ++it) {
+		ASSERT_EQ(it->key, 3);
+		count++;
+	}
+	ASSERT_EQ(count, CRITBIT_TESTSIZE / 10);
+	ASSERT_EQ(&*tree.find(3), &*tree.lower_bound(3));
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (nodes[i].key == 3) {
+			tree.remove(nodes[i]);
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.find(3), tree.end());
+	ASSERT_EQ(tree.lower_bound(3)->key, 4);
+	ASSERT_EQ(tree.size(), CRITBIT_TESTSIZE - CRITBIT_TESTSIZE / 10);
+}
+
+TEST(CritBitTreeTest, SetTest)
+{
+	using N = Node<int, SetOptions>;
+	Tree<int, SetOptions> tree;
+
+	std::vector<N> nodes(CRITBIT_TESTSIZE);
+	std::vector<N> duplicates(CRITBIT_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		duplicates[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		tree.insert(duplicates[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+	ASSERT_EQ(&*tree.find(7), &nodes[7]);
+
+	// The rejected duplicates can be inserted after removing the originals
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		tree.remove(nodes[i]);
+		tree.insert(duplicates[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+	ASSERT_EQ(&*tree.find(8), &duplicates[8]);
+	ASSERT_EQ(&*tree.find(9), &nodes[9]);
+
+	tree.clear();
+	ASSERT_TRUE(tree.empty());
+	ASSERT_EQ(tree.begin(), tree.end());
+}
+
+} // namespace critbit_tree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_CRITBIT_TREE_HPP
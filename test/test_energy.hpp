@@ -2,6 +2,7 @@
 #define TEST_ENERGY_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <random>
 #include <vector>
@@ -323,6 +324,380 @@ TEST(EnergyTreeTest, ComprehensiveTest)
 	}
 }
 
+TEST(EnergyTreeTest, RebalanceSubtreeTest)
+{
+	auto tree = EnergyTree<Node>();
+
+	std::vector<Node> nodes(ETREE_TESTSIZE);
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = Node(static_cast<int>(i));
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(4));
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+
+	tree.rebalance_subtree(*tree.get_root());
+	ASSERT_TRUE(tree.verify_integrity());
+
+	size_t height = 0;
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+		ASSERT_EQ(n._et_energy, 0);
+		height = std::max(height, n.get_depth() + 1);
+	}
+	ASSERT_EQ(height, static_cast<size_t>(std::ceil(
+	                      std::log2(static_cast<double>(nodes.size() + 1)))));
+
+	// Operations continue to work on the rebuilt tree
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		tree.remove(nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.find(3)->data, 3);
+	ASSERT_EQ(tree.find(4), tree.end());
+}
+
+using IncrementalOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                TreeFlags::ETREE_INCREMENTAL_REBUILD<4>>;
+
+class IncrementalNode
+    : public EnergyTreeNodeBase<IncrementalNode, IncrementalOptions> {
+public:
+	int data;
+
+	IncrementalNode() : data(0){};
+	explicit IncrementalNode(int data_in) : data(data_in){};
+
+	bool
+	operator<(const IncrementalNode & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+using IncrementalTree = EnergyTree<IncrementalNode, IncrementalOptions>;
+
+size_t
+get_height(const IncrementalTree & tree)
+{
+	size_t height = 0;
+	for (const auto & n : tree) {
+		height = std::max(height, n.get_depth() + 1);
+	}
+	return height;
+}
+
+void
+check_order(const IncrementalTree & tree)
+{
+	int last = std::numeric_limits<int>::min();
+	for (const auto & n : tree) {
+		ASSERT_LE(last, n.data);
+		last = n.data;
+	}
+}
+
+TEST(EnergyTreeTest, IncrementalRebuildLinearTest)
+{
+	IncrementalTree tree;
+	std::vector<IncrementalNode> nodes(ETREE_TESTSIZE);
+
+	bool saw_pending = false;
+	for (unsigned int i = 0; i < ETREE_TESTSIZE; ++i) {
+		nodes[i] = IncrementalNode(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		saw_pending |= tree.rebuild_pending();
+
+		ASSERT_TRUE(tree.verify_integrity());
+	}
+	ASSERT_TRUE(saw_pending);
+	check_order(tree);
+
+	tree.finish_rebuild();
+	ASSERT_FALSE(tree.rebuild_pending());
+	ASSERT_TRUE(tree.verify_integrity());
+	check_order(tree);
+	ASSERT_EQ(tree.size(), ETREE_TESTSIZE);
+
+	// Sorted insertion must not have degenerated the tree
+	ASSERT_LE(get_height(tree),
+	          3 * static_cast<size_t>(std::log2(ETREE_TESTSIZE) + 1));
+
+	for (unsigned int i = 0; i < ETREE_TESTSIZE; ++i) {
+		tree.remove(nodes[i]);
+		ASSERT_TRUE(tree.verify_integrity());
+	}
+	ASSERT_TRUE(tree.empty());
+	ASSERT_FALSE(tree.rebuild_pending());
+}
+
+// Counts the nodes whose parent changed since the last call. Every rotation
+// changes the parents of at most three nodes.
+size_t
+count_changed_parents(const std::vector<IncrementalNode> & nodes,
+                      std::vector<const IncrementalNode *> & parents,
+                      const std::vector<bool> & in_tree)
+{
+	size_t changed = 0;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const IncrementalNode * parent =
+		    in_tree[i] ? nodes[i].get_parent() : nullptr;
+		if (parent != parents[i]) {
+			changed++;
+			parents[i] = parent;
+		}
+	}
+	return changed;
+}
+
+TEST(EnergyTreeTest, IncrementalRebuildPendingBoundsTest)
+{
+	IncrementalTree tree;
+	std::vector<IncrementalNode> nodes(ETREE_TESTSIZE);
+	std::vector<const IncrementalNode *> parents(ETREE_TESTSIZE, nullptr);
+	std::vector<bool> in_tree(ETREE_TESTSIZE, false);
+
+	// Never calls finish_rebuild(). Every operation does O(log n) rebuild steps
+	// of O(log n) rotations each. Without incremental rebuilding, a single
+	// operation may rebuild the whole tree, i.e., change ETREE_TESTSIZE parents.
+	const size_t log_n = static_cast<size_t>(std::log2(ETREE_TESTSIZE));
+	const size_t max_changed = 2 * log_n * log_n;
+
+	auto check_bounds = [&](size_t i, size_t changed) {
+		ASSERT_LE(changed, max_changed);
+		if (i % 16 == 0) {
+			const size_t log_size =
+			    static_cast<size_t>(std::log2(tree.size() + 1)) + 1;
+			ASSERT_LE(get_height(tree), 2 * log_size);
+		}
+		if (i % 100 == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	};
+
+	bool saw_pending = false;
+	for (unsigned int i = 0; i < ETREE_TESTSIZE; ++i) {
+		nodes[i] = IncrementalNode(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		in_tree[i] = true;
+		saw_pending |= tree.rebuild_pending();
+
+		check_bounds(i, count_changed_parents(nodes, parents, in_tree));
+	}
+	ASSERT_TRUE(saw_pending);
+	ASSERT_TRUE(tree.verify_integrity());
+
+	// Removing in order is just as adversarial
+	for (unsigned int i = 0; i + 1 < ETREE_TESTSIZE; ++i) {
+		tree.remove(nodes[i]);
+		in_tree[i] = false;
+
+		check_bounds(i, count_changed_parents(nodes, parents, in_tree));
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), 1);
+}
+
+TEST(EnergyTreeTest, IncrementalRebuildRandomTest)
+{
+	IncrementalTree tree;
+	std::vector<IncrementalNode> nodes(ETREE_TESTSIZE);
+	std::vector<bool> in_tree(ETREE_TESTSIZE, false);
+	std::mt19937 rng(4); // chosen by fair xkcd
+	std::uniform_int_distribution<size_t> pick(0, ETREE_TESTSIZE - 1);
+
+	for (unsigned int i = 0; i < ETREE_TESTSIZE; ++i) {
+		nodes[i] = IncrementalNode(static_cast<int>(i % 100));
+	}
+
+	size_t count = 0;
+	for (unsigned int round = 0; round < 4 * ETREE_TESTSIZE; ++round) {
+		size_t index = pick(rng);
+		if (in_tree[index]) {
+			tree.remove(nodes[index]);
+			count--;
+		} else {
+			tree.insert(nodes[index]);
+			count++;
+		}
+		in_tree[index] = !in_tree[index];
+
+		if (round % 100 == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+			check_order(tree);
+		}
+	}
+
+	ASSERT_EQ(tree.size(), count);
+	tree.finish_rebuild();
+	ASSERT_TRUE(tree.verify_integrity());
+	check_order(tree);
+
+	for (unsigned int i = 0; i < ETREE_TESTSIZE; ++i) {
+		if (in_tree[i]) {
+			ASSERT_NE(tree.find(nodes[i]), tree.end());
+		}
+	}
+}
+
+template <class Opts>
+class OptionsNode : public EnergyTreeNodeBase<OptionsNode<Opts>, Opts> {
+public:
+	int data;
+
+	OptionsNode() : data(0){};
+	explicit OptionsNode(int data_in) : data(data_in){};
+
+	bool
+	operator<(const OptionsNode & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+template <class Opts>
+bool
+operator<(const OptionsNode<Opts> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+template <class Opts>
+bool
+operator<(const int lhs, const OptionsNode<Opts> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+TEST(EnergyTreeTest, HintedInsertionTest)
+{
+	auto tree = EnergyTree<Node>();
+	std::vector<Node> nodes(ETREE_TESTSIZE);
+
+	// Insert the even values, then every odd value right in front of its
+	// successor, and finally a few values at the end.
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		nodes[i] = Node(static_cast<int>(i));
+		tree.insert(nodes[i]);
+	}
+	for (size_t i = 1; i + 1 < nodes.size(); i += 2) {
+		nodes[i] = Node(static_cast<int>(i));
+		tree.insert(nodes[i], nodes[i + 1]);
+		if (i % 101 == 1) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	}
+	nodes.back() = Node(static_cast<int>(nodes.size() - 1));
+	tree.insert(nodes.back(), tree.end());
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+	}
+}
+
+TEST(EnergyTreeTest, STLEraseMultipleTest)
+{
+	using Opts = TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+	                         TreeFlags::STL_ERASE>;
+	using ENode = OptionsNode<Opts>;
+	EnergyTree<ENode, Opts> tree;
+
+	std::vector<ENode> nodes(ETREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = ENode(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+
+	ASSERT_EQ(tree.erase(3), ETREE_TESTSIZE / 10);
+	ASSERT_EQ(tree.erase(3), 0);
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), ETREE_TESTSIZE - ETREE_TESTSIZE / 10);
+	ASSERT_EQ(tree.find(3), tree.end());
+
+	// Erasing by iterator returns the successor
+	auto it = tree.find(4);
+	auto next = tree.erase(it);
+	ASSERT_EQ(next->data, 4);
+	ASSERT_TRUE(tree.verify_integrity());
+
+	tree.clear();
+	ASSERT_TRUE(tree.empty());
+	ASSERT_TRUE(tree.verify_integrity());
+}
+
+TEST(EnergyTreeTest, NonMultipleTest)
+{
+	using Opts = TreeOptions<TreeFlags::CONSTANT_TIME_SIZE>;
+	using ENode = OptionsNode<Opts>;
+	EnergyTree<ENode, Opts> tree;
+
+	std::vector<ENode> nodes(ETREE_TESTSIZE);
+	std::vector<ENode> duplicates(ETREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = ENode(static_cast<int>(i));
+		duplicates[i] = ENode(static_cast<int>(i));
+		tree.insert(nodes[i]);
+	}
+	for (size_t i = 0; i < duplicates.size(); ++i) {
+		tree.insert(duplicates[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*tree.find(static_cast<int>(i)), &nodes[i]);
+	}
+
+	// Without STL_ERASE, erase returns the removed node
+	ASSERT_EQ(tree.erase(7), &nodes[7]);
+	ASSERT_EQ(tree.erase(7), nullptr);
+	ASSERT_TRUE(tree.verify_integrity());
+}
+
+TEST(EnergyTreeTest, EnergyThresholdTest)
+{
+	// Rebuild as soon as the energy exceeds a quarter of the subtree size, and
+	// search without branches
+	using Opts = TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+	                         TreeFlags::ETREE_ENERGY_NUMERATOR<1>,
+	                         TreeFlags::ETREE_ENERGY_DENOMINATOR<4>,
+	                         TreeFlags::MICRO_AVOID_CONDITIONALS,
+	                         TreeFlags::MICRO_PREFETCH>;
+	using ENode = OptionsNode<Opts>;
+	EnergyTree<ENode, Opts> tree;
+
+	std::vector<ENode> nodes(ETREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = ENode(static_cast<int>(i));
+		tree.insert(nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+
+	for (const auto & n : tree) {
+		ASSERT_LE(4 * n._et_energy, n._et_size);
+	}
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*tree.find(static_cast<int>(i)), &nodes[i]);
+	}
+
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		tree.remove(nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size() / 2);
+}
+
 } // namespace energy
 } // namespace testing
 } // namespace ygg
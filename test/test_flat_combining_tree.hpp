@@ -0,0 +1,148 @@
+#ifndef TEST_FLAT_COMBINING_TREE_HPP
+#define TEST_FLAT_COMBINING_TREE_HPP
+
+#include "../src/flat_combining_tree.hpp"
+#include "../src/rbtree.hpp"
+#include "../src/wbtree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace flat_combining_tree {
+
+using namespace ygg;
+
+constexpr size_t FCTREE_TESTSIZE = 3000;
+constexpr size_t FCTREE_THREADS = 8;
+constexpr size_t FCTREE_SEED = 4;
+
+using Options = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE>;
+
+template <template <class, class, class> class NodeBase>
+class Node : public NodeBase<Node<NodeBase>, Options, int> {
+public:
+	int data;
+
+	Node() : data(0){};
+	Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const Node<NodeBase> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const int lhs, const Node<NodeBase> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using RBNode = Node<RBTreeNodeBase>;
+using WBNode = Node<WBTreeNodeBase>;
+
+using RBCombiningTree =
+    FlatCombiningTree<RBTree<RBNode, RBDefaultNodeTraits, Options>>;
+using WBCombiningTree =
+    FlatCombiningTree<WBTree<WBNode, WBDefaultNodeTraits, Options>>;
+
+template <class FCTree>
+void
+run_concurrent_test()
+{
+	using N = typename FCTree::Node;
+	FCTree tree;
+
+	// Every thread inserts keys i with i % FCTREE_THREADS == thread_id, so that
+	// concurrently combined batches contain runs of consecutive keys.
+	std::vector<N> nodes(FCTREE_TESTSIZE * FCTREE_THREADS);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+	}
+
+	auto writer = [&](size_t thread_id) {
+		for (size_t i = thread_id; i < nodes.size(); i += FCTREE_THREADS) {
+			tree.insert(nodes[i]);
+		}
+		// Remove every second one again
+		for (size_t i = thread_id; i < nodes.size(); i += FCTREE_THREADS) {
+			if (i % 2 == 0) {
+				tree.remove(nodes[i]);
+			}
+		}
+	};
+
+	std::vector<std::thread> writers;
+	for (size_t t = 0; t < FCTREE_THREADS; ++t) {
+		writers.emplace_back(writer, t);
+	}
+	for (auto & t : writers) {
+		t.join();
+	}
+
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size() / 2);
+	ASSERT_GT(tree.dbg_get_combined_batches(), size_t{0});
+
+	size_t i = 1;
+	for (const auto & n : tree.get_tree()) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i += 2;
+	}
+	for (i = 0; i < nodes.size(); ++i) {
+		if (i % 2 == 0) {
+			ASSERT_EQ(tree.find(static_cast<int>(i)), nullptr);
+		} else {
+			ASSERT_EQ(tree.find(static_cast<int>(i)), &nodes[i]);
+		}
+	}
+}
+
+TEST(FlatCombiningTreeTest, TrivialInsertionTest)
+{
+	RBCombiningTree tree;
+
+	RBNode n(0);
+	tree.insert(n);
+
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), size_t{1});
+	ASSERT_EQ(tree.find(0), &n);
+	ASSERT_EQ(tree.find(1), nullptr);
+
+	tree.remove(n);
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(FlatCombiningTreeTest, RBTreeConcurrentTest)
+{
+	run_concurrent_test<RBCombiningTree>();
+}
+
+TEST(FlatCombiningTreeTest, WBTreeConcurrentTest)
+{
+	run_concurrent_test<WBCombiningTree>();
+}
+
+} // namespace flat_combining_tree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_FLAT_COMBINING_TREE_HPP
@@ -0,0 +1,52 @@
+#ifndef TEST_HASH_ACCELERATED_HPP
+#define TEST_HASH_ACCELERATED_HPP
+
+#include "../src/hash_accelerated.hpp"
+#include "common_wrapper_tests.hpp"
+
+#include <gtest/gtest.h>
+
+namespace ygg {
+namespace testing {
+namespace hash_accelerated {
+
+using namespace ygg;
+using namespace ygg::testing::keyed_wrapper;
+
+template <class Options>
+using RBHashTree = RBWrapped<HashAccelerated, Options>;
+template <class Options>
+using ZHashTree = ZWrapped<HashAccelerated, Options>;
+
+TEST(HashAcceleratedTest, RandomInsertionDeletionTest)
+{
+	run_random_test<RBHashTree<MultiOptions>>();
+	run_random_test<RBHashTree<SetOptions>>();
+	run_random_test<ZHashTree<MultiOptions>>();
+}
+
+TEST(HashAcceleratedTest, DuplicatesTest)
+{
+	run_remove_duplicates_test<RBHashTree<MultiOptions>>();
+}
+
+TEST(HashAcceleratedTest, EraseTest)
+{
+	run_erase_duplicates_test<RBHashTree<MultiOptions>>();
+}
+
+TEST(HashAcceleratedTest, STLEraseTest)
+{
+	run_stl_erase_test<RBHashTree<STLMultiOptions>>();
+}
+
+TEST(HashAcceleratedTest, SetTest)
+{
+	run_set_test<RBHashTree<SetOptions>>();
+}
+
+} // namespace hash_accelerated
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_HASH_ACCELERATED_HPP
@@ -0,0 +1,296 @@
+#ifndef TEST_MULTI_INDEX_HPP
+#define TEST_MULTI_INDEX_HPP
+
+#include "../src/intervaltree.hpp"
+#include "../src/multi_index.hpp"
+#include "../src/rbtree.hpp"
+#include "../src/ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace multi_index {
+
+using namespace ygg;
+
+constexpr size_t MI_TESTSIZE = 2000;
+constexpr size_t MI_SEED = 4;
+
+using MIOptions =
+    ygg::TreeOptions<TreeFlags::MULTIPLE, TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+class IdTag {};
+class TimeTag {};
+class RangeTag {};
+
+class Node;
+
+class RangeTraits : public ITreeNodeTraits<Node> {
+public:
+	using key_type = int;
+
+	static int get_lower(const Node & n);
+	static int get_upper(const Node & n);
+
+	static int
+	get_lower(const std::pair<int, int> & i)
+	{
+		return i.first;
+	}
+
+	static int
+	get_upper(const std::pair<int, int> & i)
+	{
+		return i.second;
+	}
+};
+
+class Node : public RBTreeNodeBase<Node, MIOptions, IdTag>,
+             public ZTreeNodeBase<Node, MIOptions, TimeTag>,
+             public ITreeNodeBase<Node, RangeTraits, MIOptions, RangeTag> {
+public:
+	int id;
+	int timestamp;
+	int lower;
+	int upper;
+
+	Node() : id(0), timestamp(0), lower(0), upper(0){};
+	Node(int id_in, int timestamp_in, int lower_in, int upper_in)
+	    : id(id_in), timestamp(timestamp_in), lower(lower_in), upper(upper_in){};
+};
+
+inline int
+RangeTraits::get_lower(const Node & n)
+{
+	return n.lower;
+}
+
+inline int
+RangeTraits::get_upper(const Node & n)
+{
+	return n.upper;
+}
+
+class IdCompare {
+public:
+	bool
+	operator()(const Node & lhs, const Node & rhs) const noexcept
+	{
+		return lhs.id < rhs.id;
+	}
+	bool
+	operator()(int lhs, const Node & rhs) const noexcept
+	{
+		return lhs < rhs.id;
+	}
+	bool
+	operator()(const Node & lhs, int rhs) const noexcept
+	{
+		return lhs.id < rhs;
+	}
+};
+
+class TimeCompare {
+public:
+	bool
+	operator()(const Node & lhs, const Node & rhs) const noexcept
+	{
+		return lhs.timestamp < rhs.timestamp;
+	}
+	bool
+	operator()(int lhs, const Node & rhs) const noexcept
+	{
+		return lhs < rhs.timestamp;
+	}
+	bool
+	operator()(const Node & lhs, int rhs) const noexcept
+	{
+		return lhs.timestamp < rhs;
+	}
+};
+
+using IdTree = RBTree<Node, RBDefaultNodeTraits, MIOptions, IdTag, IdCompare>;
+using TimeTree = ZTree<Node, ZTreeDefaultNodeTraits<Node>, MIOptions, TimeTag,
+                       TimeCompare>;
+using RangeTree = IntervalTree<Node, RangeTraits, MIOptions, RangeTag>;
+
+using FullIndex = MultiIndex<Node, IdTree, TimeTree, RangeTree>;
+using SmallIndex = MultiIndex<Node, IdTree, TimeTree>;
+
+inline std::vector<Node>
+make_nodes()
+{
+	std::vector<Node> nodes(MI_TESTSIZE);
+	std::vector<int> timestamps(MI_TESTSIZE);
+	for (size_t i = 0; i < MI_TESTSIZE; ++i) {
+		timestamps[i] = static_cast<int>(i);
+	}
+	std::shuffle(timestamps.begin(), timestamps.end(),
+	             ygg::testing::utilities::Randomizer(MI_SEED));
+
+	for (size_t i = 0; i < MI_TESTSIZE; ++i) {
+		const int id = static_cast<int>(i);
+		nodes[i] = Node(id, timestamps[i], 10 * id, 10 * id + 5);
+	}
+	return nodes;
+}
+
+template <class MI>
+void
+verify_orders(const MI & mi, size_t expected_size)
+{
+	size_t count = 0;
+	const Node * last = nullptr;
+	for (const auto & n : mi.template get<0>()) {
+		if (last != nullptr) {
+			ASSERT_LE(last->id, n.id);
+		}
+		last = &n;
+		count++;
+	}
+	ASSERT_EQ(count, expected_size);
+
+	count = 0;
+	last = nullptr;
+	for (const auto & n : mi.template get<1>()) {
+		if (last != nullptr) {
+			ASSERT_LE(last->timestamp, n.timestamp);
+		}
+		last = &n;
+		count++;
+	}
+	ASSERT_EQ(count, expected_size);
+	ASSERT_EQ(mi.size(), expected_size);
+}
+
+TEST(MultiIndexTest, InsertRemoveTest)
+{
+	std::vector<Node> nodes = make_nodes();
+	FullIndex mi;
+	ASSERT_TRUE(mi.empty());
+
+	for (auto & n : nodes) {
+		mi.insert(n);
+	}
+	mi.get<0>().dbg_verify();
+	mi.get<1>().dbg_verify();
+	ASSERT_TRUE(mi.get<2>().verify_integrity());
+	verify_orders(mi, nodes.size());
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(&*mi.get<0>().find(nodes[i].id), &nodes[i]);
+		ASSERT_EQ(&*mi.get<1>().find(nodes[i].timestamp), &nodes[i]);
+	}
+
+	// Every range overlaps exactly itself
+	for (size_t i = 0; i < nodes.size(); i += 97) {
+		auto result = mi.get<2>().query(
+		    std::make_pair(nodes[i].lower + 1, nodes[i].lower + 2));
+		auto it = result.begin();
+		ASSERT_NE(it, result.end());
+		ASSERT_EQ(&*it, &nodes[i]);
+		++it;
+		ASSERT_EQ(it, result.end());
+	}
+
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		mi.remove(nodes[i]);
+	}
+	mi.get<0>().dbg_verify();
+	mi.get<1>().dbg_verify();
+	ASSERT_TRUE(mi.get<2>().verify_integrity());
+	verify_orders(mi, nodes.size() / 2);
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (i % 2 == 0) {
+			ASSERT_EQ(mi.get<0>().find(nodes[i].id), mi.get<0>().end());
+			ASSERT_EQ(mi.get<1>().find(nodes[i].timestamp), mi.get<1>().end());
+		} else {
+			ASSERT_EQ(&*mi.get<0>().find(nodes[i].id), &nodes[i]);
+		}
+	}
+}
+
+TEST(MultiIndexTest, ModifyKeyTest)
+{
+	std::vector<Node> nodes = make_nodes();
+	FullIndex mi;
+	for (auto & n : nodes) {
+		mi.insert(n);
+	}
+
+	// Move every node far ahead in time. Only the TimeTree is ordered by
+	// timestamps.
+	for (size_t i = 0; i < nodes.size(); i += 3) {
+		mi.modify_key<1>(nodes[i],
+		                 [](Node & n) { n.timestamp += 2 * MI_TESTSIZE; });
+	}
+	mi.get<1>().dbg_verify();
+	verify_orders(mi, nodes.size());
+	ASSERT_EQ(&*mi.get<1>().find(nodes[0].timestamp), &nodes[0]);
+	ASSERT_GE(mi.get<1>().find(nodes[0].timestamp)->timestamp,
+	          static_cast<int>(2 * MI_TESTSIZE));
+
+	// Change the ID and the range at the same time
+	mi.modify_key<0, 2>(nodes[5], [](Node & n) {
+		n.id = -1;
+		n.lower = -100;
+		n.upper = -50;
+	});
+	mi.get<0>().dbg_verify();
+	ASSERT_TRUE(mi.get<2>().verify_integrity());
+	ASSERT_EQ(&*mi.get<0>().begin(), &nodes[5]);
+	ASSERT_EQ(mi.get<0>().find(5), mi.get<0>().end());
+
+	auto result = mi.get<2>().query(std::make_pair(-80, -70));
+	ASSERT_NE(result.begin(), result.end());
+	ASSERT_EQ(&*result.begin(), &nodes[5]);
+
+	// Changing nothing the indexes care about
+	mi.modify_key<>(nodes[6], [](Node &) {});
+	verify_orders(mi, nodes.size());
+}
+
+TEST(MultiIndexTest, BatchTest)
+{
+	std::vector<Node> nodes = make_nodes();
+	SmallIndex mi;
+
+	mi.insert_batch(nodes.begin(), nodes.end());
+	mi.dbg_verify();
+	verify_orders(mi, nodes.size());
+
+	// Reverse the order of the timestamps of the first half
+	const auto half = nodes.begin() + static_cast<ptrdiff_t>(nodes.size() / 2);
+	mi.modify_key_batch<1>(nodes.begin(), half, [](Node & n) {
+		n.timestamp = -n.timestamp - 1;
+	});
+	mi.dbg_verify();
+	verify_orders(mi, nodes.size());
+	for (auto it = nodes.begin(); it != half; ++it) {
+		ASSERT_LT(it->timestamp, 0);
+		ASSERT_EQ(&*mi.get<1>().find(it->timestamp), &*it);
+	}
+
+	mi.remove_batch(nodes.begin(), half);
+	mi.dbg_verify();
+	verify_orders(mi, nodes.size() - nodes.size() / 2);
+	ASSERT_GE(mi.get<1>().begin()->timestamp, 0);
+
+	mi.clear();
+	ASSERT_TRUE(mi.empty());
+	ASSERT_EQ(mi.get<0>().begin(), mi.get<0>().end());
+	ASSERT_EQ(mi.get<1>().begin(), mi.get<1>().end());
+}
+
+} // namespace multi_index
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_MULTI_INDEX_HPP
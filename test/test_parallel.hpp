@@ -0,0 +1,170 @@
+#ifndef TEST_PARALLEL_HPP
+#define TEST_PARALLEL_HPP
+
+#include "../src/energy.hpp"
+#include "../src/parallel.hpp"
+#include "../src/rbtree.hpp"
+#include "../src/wbtree.hpp"
+#include "../src/ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace parallel {
+
+using namespace ygg;
+
+// Large enough to actually use multiple threads
+constexpr size_t PARALLEL_TESTSIZE = 3 * parallel_internal::PARALLEL_CUTOFF + 17;
+constexpr size_t PARALLEL_THREADS = 4;
+constexpr size_t PARALLEL_SEED = 4;
+
+using Options = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE,
+                                 TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+template <template <class, class, class> class NodeBase>
+class Node : public NodeBase<Node<NodeBase>, Options, int> {
+public:
+	int data;
+	std::atomic<size_t> visits;
+
+	Node() : data(0), visits(0){};
+	Node(int data_in) : data(data_in), visits(0){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+using RBNode = Node<RBTreeNodeBase>;
+using WBNode = Node<WBTreeNodeBase>;
+using ZNode = Node<ZTreeNodeBase>;
+using EnergyNode = Node<EnergyTreeNodeBase>;
+
+using RBTreeT = RBTree<RBNode, RBDefaultNodeTraits, Options>;
+using WBTreeT = WBTree<WBNode, WBDefaultNodeTraits, Options>;
+using ZTreeT = ZTree<ZNode, ZTreeDefaultNodeTraits<ZNode>, Options>;
+using EnergyTreeT = EnergyTree<EnergyNode, Options>;
+
+/*
+ * The (sorted) range of keys that a part of the reduction has seen. Combining
+ * two ranges fails if they are not in order.
+ */
+struct KeyRange
+{
+	bool empty;
+	bool sorted;
+	int first;
+	int last;
+	size_t count;
+};
+
+KeyRange
+combine_ranges(KeyRange lhs, KeyRange rhs)
+{
+	if (lhs.empty) {
+		return rhs;
+	}
+	if (rhs.empty) {
+		return lhs;
+	}
+	return {false, lhs.sorted && rhs.sorted && (lhs.last < rhs.first), lhs.first,
+	        rhs.last, lhs.count + rhs.count};
+}
+
+template <class Tree, class N>
+void
+run_traversal_test(Tree & tree, std::vector<N> & nodes)
+{
+	parallel_for_each(tree, [](N & n) { n.visits++; }, PARALLEL_THREADS);
+	for (const auto & n : nodes) {
+		ASSERT_EQ(n.visits.load(), size_t{1});
+	}
+
+	KeyRange empty_range{true, true, 0, 0, 0};
+	KeyRange range = parallel_reduce(
+	    static_cast<const Tree &>(tree), empty_range,
+	    [](KeyRange acc, const N & n) {
+		    return combine_ranges(acc, KeyRange{false, true, n.data, n.data, 1});
+	    },
+	    combine_ranges, PARALLEL_THREADS);
+	ASSERT_FALSE(range.empty);
+	ASSERT_TRUE(range.sorted);
+	ASSERT_EQ(range.first, 0);
+	ASSERT_EQ(range.last, static_cast<int>(nodes.size()) - 1);
+	ASSERT_EQ(range.count, nodes.size());
+
+	size_t sum = parallel_reduce(
+	    tree, size_t{0},
+	    [](size_t acc, N & n) { return acc + static_cast<size_t>(n.data); },
+	    [](size_t lhs, size_t rhs) { return lhs + rhs; });
+	ASSERT_EQ(sum, nodes.size() * (nodes.size() - 1) / 2);
+}
+
+template <class Tree, class N>
+void
+run_insertion_test()
+{
+	Tree tree;
+	std::vector<N> nodes(PARALLEL_TESTSIZE);
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i].data = static_cast<int>(i);
+		indices.push_back(i);
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(PARALLEL_SEED));
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+
+	run_traversal_test(tree, nodes);
+}
+
+TEST(ParallelTest, EmptyTreeTest)
+{
+	RBTreeT tree;
+	size_t calls = 0;
+	parallel_for_each(tree, [&](RBNode &) { calls++; });
+	ASSERT_EQ(calls, size_t{0});
+	ASSERT_EQ(parallel_reduce(
+	              tree, 42, [](int acc, RBNode &) { return acc + 1; },
+	              [](int lhs, int rhs) { return lhs + rhs; }),
+	          42);
+}
+
+TEST(ParallelTest, SmallTreeTest)
+{
+	WBTreeT tree;
+	std::vector<WBNode> nodes(3);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i].data = static_cast<int>(i);
+		tree.insert(nodes[i]);
+	}
+
+	run_traversal_test(tree, nodes);
+}
+
+TEST(ParallelTest, RBTreeTest) { run_insertion_test<RBTreeT, RBNode>(); }
+
+TEST(ParallelTest, WBTreeTest) { run_insertion_test<WBTreeT, WBNode>(); }
+
+TEST(ParallelTest, ZTreeTest) { run_insertion_test<ZTreeT, ZNode>(); }
+
+TEST(ParallelTest, EnergyTreeTest)
+{
+	run_insertion_test<EnergyTreeT, EnergyNode>();
+}
+
+} // namespace parallel
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_PARALLEL_HPP
@@ -2,11 +2,13 @@
 #define YGG_TEST_RBT_H
 
 #include "../src/ygg.hpp"
+#include "common_tree_tests.hpp"
 #include "randomizer.hpp"
 
 #include <algorithm>
 #include <gtest/gtest.h>
 #include <random>
+#include <unordered_set>
 #include <vector>
 
 namespace ygg {
@@ -34,6 +36,15 @@ using AdvancedMultipleOptions =
                 TreeFlags::COMPRESS_COLOR, TreeFlags::MICRO_AVOID_CONDITIONALS,
                 AdditionalOption>;
 
+template <class AdditionalOption = NonOptionDummy>
+using SinglePassNonMultipleOptions =
+    TreeOptions<TreeFlags::CONSTANT_TIME_SIZE, TreeFlags::RB_SINGLE_PASS,
+                AdditionalOption>;
+template <class AdditionalOption = NonOptionDummy>
+using SinglePassMultipleOptions =
+    TreeOptions<TreeFlags::CONSTANT_TIME_SIZE, TreeFlags::MULTIPLE,
+                TreeFlags::RB_SINGLE_PASS, AdditionalOption>;
+
 #define __RBT_BASENAME(NAME) Basic_##NAME
 #define __RBT_NONMULTIPLE BasicNonMultipleOptions
 #define __RBT_MULTIPLE BasicMultipleOptions
@@ -57,6 +68,19 @@ namespace advanced {
 #include "test_rbtree_base.hpp"
 }
 
+#undef __RBT_BASENAME
+#undef __RBT_NONMULTIPLE
+#undef __RBT_MULTIPLE
+#undef RBTREE_SEED
+#define __RBT_BASENAME(NAME) SinglePass_##NAME
+#define __RBT_NONMULTIPLE SinglePassNonMultipleOptions
+#define __RBT_MULTIPLE SinglePassMultipleOptions
+#define RBTREE_SEED 6
+
+namespace singlepass {
+#include "test_rbtree_base.hpp"
+}
+
 } // namespace rbtree
 } // namespace testing
 } // namespace ygg
@@ -270,6 +270,169 @@ TEST(__RBT_BASENAME(RBTreeTest), LinearNextHintedInsertionTest)
 	}
 }
 
+TEST(__RBT_BASENAME(RBTreeTest), LinearIteratorHintedInsertionSizeTest)
+{
+	auto tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>();
+
+	Node nodes[RBTREE_TESTSIZE];
+
+	for (unsigned int i = 0; i < RBTREE_TESTSIZE; ++i) {
+		nodes[i] = Node(static_cast<int>(i));
+	}
+
+	tree.insert(nodes[RBTREE_TESTSIZE - 1], tree.end());
+
+	for (int i = RBTREE_TESTSIZE - 2; i >= 0; --i) {
+		tree.insert(nodes[i], tree.iterator_to(nodes[i + 1]));
+	}
+
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), static_cast<size_t>(RBTREE_TESTSIZE));
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), ParallelBuildTest)
+{
+	// Large enough to actually use multiple threads
+	constexpr size_t BUILD_SIZE = 3 * parallel_internal::PARALLEL_CUTOFF + 17;
+	using Tree = RBTree<Node, RBDefaultNodeTraits, __RBT_NONMULTIPLE<>>;
+
+	// Every value appears twice, only the first one must be inserted.
+	utilities::run_parallel_build_test<Tree, Node>(
+	    2 * BUILD_SIZE, RBTREE_SEED, 4, false,
+	    [](Node & n, size_t i) { n = Node(static_cast<int>(i / 2)); },
+	    [](const Node & lhs, const Node & rhs) { return lhs.data < rhs.data; });
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), ParallelBuildWithHooksTest)
+{
+	using Tree = RBTree<MultiNode, MultiNodeTraits, __RBT_MULTIPLE<>>;
+
+	// Equal nodes must keep their order in the range
+	utilities::run_parallel_build_test<Tree, MultiNode>(
+	    RBTREE_TESTSIZE, RBTREE_SEED, 0, true,
+	    [](MultiNode & n, size_t i) {
+		    n = MultiNode(static_cast<int>(i % 100), static_cast<int>(i));
+	    },
+	    [](const MultiNode & lhs, const MultiNode & rhs) {
+		    return lhs.data < rhs.data;
+	    });
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), BatchInsertionTest)
+{
+	auto tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>();
+
+	// The tree holds the multiples of 3, every batch holds a contiguous range of
+	// keys, some of which are already in the tree.
+	constexpr size_t BATCH_SIZE = 100;
+	std::vector<Node> tree_nodes(RBTREE_TESTSIZE);
+	std::vector<Node> batch_nodes(3 * RBTREE_TESTSIZE);
+	for (size_t i = 0; i < tree_nodes.size(); ++i) {
+		tree_nodes[i] = Node(static_cast<int>(3 * i));
+		tree.insert(tree_nodes[i]);
+	}
+	for (size_t i = 0; i < batch_nodes.size(); ++i) {
+		batch_nodes[i] = Node(static_cast<int>(i));
+	}
+
+	std::vector<size_t> batch_starts;
+	for (size_t start = 0; start < batch_nodes.size(); start += BATCH_SIZE) {
+		batch_starts.push_back(start);
+	}
+	std::shuffle(batch_starts.begin(), batch_starts.end(),
+	             ygg::testing::utilities::Randomizer(RBTREE_SEED));
+
+	for (auto start : batch_starts) {
+		auto begin = batch_nodes.begin() + static_cast<ptrdiff_t>(start);
+		tree.insert_batch(begin, begin + BATCH_SIZE);
+		tree.dbg_verify();
+	}
+
+	ASSERT_EQ(tree.size(), batch_nodes.size());
+	size_t i = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, static_cast<int>(i));
+		if (i % 3 == 0) {
+			ASSERT_EQ(&n, &tree_nodes[i / 3]);
+		} else {
+			ASSERT_EQ(&n, &batch_nodes[i]);
+		}
+		i++;
+	}
+
+	// Duplicates within a batch are skipped, too.
+	auto new_tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>();
+	Node duplicates[4] = {Node(1), Node(2), Node(2), Node(3)};
+	new_tree.insert_batch(std::begin(duplicates), std::end(duplicates));
+	new_tree.dbg_verify();
+	ASSERT_EQ(new_tree.size(), size_t{3});
+	ASSERT_EQ(&*new_tree.find(2), &duplicates[1]);
+
+	tree.remove_batch(tree_nodes.begin(), tree_nodes.end());
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), batch_nodes.size() - tree_nodes.size());
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), BatchInsertionMultipleTest)
+{
+	auto tree = RBTree<MultiNode, MultiNodeTraits, __RBT_MULTIPLE<>>();
+
+	std::vector<MultiNode> tree_nodes(RBTREE_TESTSIZE);
+	for (size_t i = 0; i < tree_nodes.size(); ++i) {
+		tree_nodes[i] = MultiNode(static_cast<int>(i / 4), 0);
+		tree.insert(tree_nodes[i]);
+	}
+
+	// Every batch node compares equally to some tree nodes
+	std::vector<MultiNode> batch_nodes(RBTREE_TESTSIZE);
+	for (size_t i = 0; i < batch_nodes.size(); ++i) {
+		batch_nodes[i] = MultiNode(static_cast<int>(i / 4), 1);
+	}
+	tree.insert_batch(batch_nodes.begin(), batch_nodes.end());
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), 2 * static_cast<size_t>(RBTREE_TESTSIZE));
+
+	// Batch nodes come first and keep their order
+	const MultiNode * prev = nullptr;
+	for (const auto & n : tree) {
+		if (prev != nullptr) {
+			ASSERT_LE(prev->data, n.data);
+			if (prev->data == n.data) {
+				ASSERT_GE(prev->sub_data, n.sub_data);
+				if ((prev->sub_data == 1) && (n.sub_data == 1)) {
+					ASSERT_LT(prev, &n);
+				}
+			}
+		}
+		prev = &n;
+	}
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), UpdateKeyTest)
+{
+	using Tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>;
+	utilities::run_update_key_test<Tree, Node>(RBTREE_TESTSIZE, RBTREE_SEED);
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), UpdateKeyMultipleTest)
+{
+	using Tree = RBTree<MultiNode, MultiNodeTraits, __RBT_MULTIPLE<>>;
+	utilities::run_update_key_multiple_test<Tree, MultiNode>(RBTREE_TESTSIZE,
+	                                                         RBTREE_SEED);
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), UpdateKeyCollisionTest)
+{
+	using Tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>;
+	utilities::run_update_key_collision_test<Tree, Node>(RBTREE_TESTSIZE);
+}
+
+TEST(__RBT_BASENAME(RBTreeTest), UpdateKeyInPlaceTest)
+{
+	using Tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>;
+	utilities::run_update_key_in_place_test<Tree, Node>(RBTREE_TESTSIZE);
+}
+
 TEST(__RBT_BASENAME(RBTreeTest), LowerBoundTest)
 {
 	auto tree = RBTree<Node, NodeTraits, __RBT_NONMULTIPLE<>>();
@@ -0,0 +1,252 @@
+#ifndef TEST_SHARDED_TREE_HPP
+#define TEST_SHARDED_TREE_HPP
+
+#include "../src/rbtree.hpp"
+#include "../src/sharded_tree.hpp"
+#include "../src/wbtree.hpp"
+#include "../src/ziptree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace sharded_tree {
+
+using namespace ygg;
+
+constexpr size_t SHTREE_TESTSIZE = 4000;
+constexpr size_t SHTREE_SHARDS = 4;
+constexpr size_t SHTREE_SEED = 4;
+
+using Options = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE,
+                                 TreeFlags::ZTREE_RANK_TYPE<uint8_t>>;
+
+template <template <class, class, class> class NodeBase>
+class Node : public NodeBase<Node<NodeBase>, Options, int> {
+public:
+	int data;
+
+	Node() : data(0){};
+	Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const Node<NodeBase> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <template <class, class, class> class NodeBase>
+bool
+operator<(const int lhs, const Node<NodeBase> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+class KeyGetter {
+public:
+	template <class N>
+	static int
+	get_key(const N & n)
+	{
+		return n.data;
+	}
+};
+
+using Splitter = RangeSplitter<int, KeyGetter>;
+
+using RBNode = Node<RBTreeNodeBase>;
+using WBNode = Node<WBTreeNodeBase>;
+using ZNode = Node<ZTreeNodeBase>;
+
+using RBShardedTree =
+    ShardedTree<RBTree<RBNode, RBDefaultNodeTraits, Options>, Splitter>;
+using WBShardedTree =
+    ShardedTree<WBTree<WBNode, WBDefaultNodeTraits, Options>, Splitter>;
+using ZShardedTree =
+    ShardedTree<ZTree<ZNode, ZTreeDefaultNodeTraits<ZNode>, Options>, Splitter>;
+
+template <class STree>
+void
+run_sequential_test()
+{
+	using N = typename STree::Node;
+	// Initially, all keys end up in the last shard
+	STree tree(SHTREE_SHARDS, Splitter({-3, -2, -1}));
+
+	std::vector<N> nodes(SHTREE_TESTSIZE);
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < SHTREE_TESTSIZE; ++i) {
+		nodes[i] = N(static_cast<int>(2 * i));
+		indices.push_back(i);
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(SHTREE_SEED));
+
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), SHTREE_TESTSIZE);
+	ASSERT_EQ(tree.get_shard_size(SHTREE_SHARDS - 1), SHTREE_TESTSIZE);
+
+	ASSERT_FALSE(tree.rebalance_if_skewed(SHTREE_SHARDS));
+	ASSERT_TRUE(tree.rebalance_if_skewed());
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), SHTREE_TESTSIZE);
+	for (size_t i = 0; i < SHTREE_SHARDS; ++i) {
+		ASSERT_EQ(tree.get_shard_size(i), SHTREE_TESTSIZE / SHTREE_SHARDS);
+	}
+
+	size_t i = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i++;
+	}
+	ASSERT_EQ(i, SHTREE_TESTSIZE);
+
+	for (i = 0; i < SHTREE_TESTSIZE; ++i) {
+		int key = static_cast<int>(2 * i);
+		ASSERT_EQ(tree.find(key), &nodes[i]);
+		ASSERT_EQ(tree.find(key + 1), nullptr);
+		ASSERT_EQ(tree.lower_bound(key), &nodes[i]);
+		if (i + 1 < SHTREE_TESTSIZE) {
+			ASSERT_EQ(tree.lower_bound(key + 1), &nodes[i + 1]);
+		} else {
+			ASSERT_EQ(tree.lower_bound(key + 1), nullptr);
+		}
+	}
+
+	// Empty the second shard completely. Lower bounds must skip it.
+	for (i = 0; i < SHTREE_TESTSIZE; ++i) {
+		if (i >= SHTREE_TESTSIZE / SHTREE_SHARDS &&
+		    i < 2 * SHTREE_TESTSIZE / SHTREE_SHARDS) {
+			tree.remove(nodes[i]);
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.get_shard_size(1), size_t{0});
+	size_t first_after_gap = 2 * SHTREE_TESTSIZE / SHTREE_SHARDS;
+	ASSERT_EQ(tree.lower_bound(static_cast<int>(2 * first_after_gap) - 5),
+	          &nodes[first_after_gap]);
+
+	for (auto & n : nodes) {
+		if (tree.find(n.data) != nullptr) {
+			tree.remove(n);
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_TRUE(tree.empty());
+	ASSERT_TRUE(tree.begin() == tree.end());
+}
+
+TEST(ShardedTreeTest, RBTreeSequentialTest)
+{
+	run_sequential_test<RBShardedTree>();
+}
+
+TEST(ShardedTreeTest, WBTreeSequentialTest)
+{
+	run_sequential_test<WBShardedTree>();
+}
+
+TEST(ShardedTreeTest, ZTreeSequentialTest)
+{
+	run_sequential_test<ZShardedTree>();
+}
+
+TEST(ShardedTreeTest, ConcurrentWritersTest)
+{
+	std::vector<int> boundaries;
+	for (size_t i = 1; i < SHTREE_SHARDS; ++i) {
+		boundaries.push_back(static_cast<int>(i * SHTREE_TESTSIZE));
+	}
+	RBShardedTree tree(SHTREE_SHARDS, Splitter(boundaries));
+
+	// Every writer works on its own key range. Additionally, one thread
+	// rebalances all the time, moving nodes between the shards.
+	std::vector<RBNode> nodes(SHTREE_SHARDS * SHTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = RBNode(static_cast<int>(i));
+	}
+
+	std::atomic<bool> writers_done(false);
+	std::atomic<size_t> errors(0);
+
+	auto writer = [&](size_t thread_id) {
+		std::vector<size_t> indices;
+		for (size_t i = 0; i < SHTREE_TESTSIZE; ++i) {
+			indices.push_back(thread_id * SHTREE_TESTSIZE + i);
+		}
+		std::shuffle(indices.begin(), indices.end(),
+		             ygg::testing::utilities::Randomizer(SHTREE_SEED + thread_id));
+
+		for (auto index : indices) {
+			tree.insert(nodes[index]);
+		}
+		for (auto index : indices) {
+			if (tree.find(static_cast<int>(index)) != &nodes[index]) {
+				errors++;
+			}
+		}
+		// Remove every second one again
+		for (auto index : indices) {
+			if (index % 2 == 0) {
+				tree.remove(nodes[index]);
+			}
+		}
+	};
+
+	auto rebalancer = [&]() {
+		while (!writers_done.load()) {
+			tree.rebalance();
+			std::this_thread::yield();
+		}
+	};
+
+	std::thread rebalance_thread(rebalancer);
+	std::vector<std::thread> writers;
+	for (size_t t = 0; t < SHTREE_SHARDS; ++t) {
+		writers.emplace_back(writer, t);
+	}
+	for (auto & t : writers) {
+		t.join();
+	}
+	writers_done.store(true);
+	rebalance_thread.join();
+
+	ASSERT_EQ(errors.load(), size_t{0});
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), nodes.size() / 2);
+
+	tree.rebalance();
+	tree.dbg_verify();
+	size_t i = 1;
+	for (const auto & n : tree) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i += 2;
+	}
+	for (i = 0; i < nodes.size(); ++i) {
+		ASSERT_EQ(tree.lower_bound(static_cast<int>(i)),
+		          &nodes[i % 2 == 0 ? i + 1 : i]);
+	}
+}
+
+} // namespace sharded_tree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_SHARDED_TREE_HPP
@@ -0,0 +1,379 @@
+#ifndef TEST_SKIPLIST_HPP
+#define TEST_SKIPLIST_HPP
+
+#include "../src/skiplist.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace skiplist {
+
+using namespace ygg;
+
+constexpr size_t SKIPLIST_TESTSIZE = 5000;
+constexpr size_t SKIPLIST_THREADS = 4;
+constexpr size_t SKIPLIST_SEED = 4;
+
+using SkipListOptions = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE>;
+using LowSkipListOptions = ygg::TreeOptions<TreeFlags::CONSTANT_TIME_SIZE,
+                                            TreeFlags::SKIPLIST_MAX_HEIGHT<3>>;
+
+template <class Options>
+class Node : public SkipListNodeBase<Node<Options>, Options> {
+public:
+	int data;
+
+	Node() : data(0){};
+	Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+// Make comparable to int
+template <class Options>
+bool
+operator<(const Node<Options> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+
+template <class Options>
+bool
+operator<(const int lhs, const Node<Options> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+template <class Options>
+using List = SkipList<Node<Options>, Options>;
+
+TEST(SkipListTest, TrivialInsertionTest)
+{
+	List<SkipListOptions> list;
+
+	Node<SkipListOptions> n(0);
+	ASSERT_TRUE(list.insert(n));
+
+	list.dbg_verify();
+	ASSERT_EQ(list.size(), size_t{1});
+	ASSERT_EQ(&*list.find(0), &n);
+	ASSERT_EQ(list.find(1), list.end());
+	ASSERT_EQ(&*list.begin(), &n);
+
+	ASSERT_TRUE(list.remove(n));
+	list.dbg_verify();
+	ASSERT_TRUE(list.empty());
+	ASSERT_EQ(list.find(0), list.end());
+	ASSERT_EQ(list.begin(), list.end());
+
+	ASSERT_FALSE(list.remove(n));
+	ASSERT_EQ(list.size(), size_t{0});
+}
+
+template <class Options>
+void
+run_sequential_test()
+{
+	List<Options> list;
+
+	std::vector<Node<Options>> nodes(SKIPLIST_TESTSIZE);
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < SKIPLIST_TESTSIZE; ++i) {
+		nodes[i] = Node<Options>(static_cast<int>(2 * i));
+		indices.push_back(i);
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(SKIPLIST_SEED));
+
+	for (auto index : indices) {
+		list.insert(nodes[index]);
+	}
+	list.dbg_verify();
+	ASSERT_EQ(list.size(), SKIPLIST_TESTSIZE);
+
+	// Duplicates are rejected
+	Node<Options> duplicate(4);
+	ASSERT_FALSE(list.insert(duplicate));
+	ASSERT_EQ(list.size(), SKIPLIST_TESTSIZE);
+	ASSERT_EQ(&*list.find(4), &nodes[2]);
+
+	// Removing the rejected node must not change the list
+	ASSERT_FALSE(list.remove(duplicate));
+	ASSERT_EQ(list.size(), SKIPLIST_TESTSIZE);
+	ASSERT_EQ(&*list.find(4), &nodes[2]);
+	list.dbg_verify();
+
+	size_t i = 0;
+	for (const auto & n : list) {
+		ASSERT_EQ(&n, &nodes[i]);
+		i++;
+	}
+	ASSERT_EQ(i, SKIPLIST_TESTSIZE);
+
+	for (i = 0; i < SKIPLIST_TESTSIZE; ++i) {
+		ASSERT_EQ(&*list.find(static_cast<int>(2 * i)), &nodes[i]);
+		ASSERT_EQ(list.find(static_cast<int>(2 * i + 1)), list.end());
+		ASSERT_EQ(&*list.lower_bound(static_cast<int>(2 * i)), &nodes[i]);
+		if (i + 1 < SKIPLIST_TESTSIZE) {
+			ASSERT_EQ(&*list.lower_bound(static_cast<int>(2 * i + 1)), &nodes[i + 1]);
+		} else {
+			ASSERT_EQ(list.lower_bound(static_cast<int>(2 * i + 1)), list.end());
+		}
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(SKIPLIST_SEED + 1));
+
+	size_t remaining = SKIPLIST_TESTSIZE;
+	for (auto index : indices) {
+		list.remove(nodes[index]);
+		remaining--;
+		ASSERT_EQ(list.find(static_cast<int>(2 * index)), list.end());
+		ASSERT_EQ(list.size(), remaining);
+		if (remaining % 500 == 0) {
+			list.dbg_verify();
+		}
+	}
+	list.dbg_verify();
+	ASSERT_TRUE(list.empty());
+}
+
+TEST(SkipListTest, SequentialInsertionAndDeletionTest)
+{
+	run_sequential_test<SkipListOptions>();
+	run_sequential_test<LowSkipListOptions>();
+}
+
+TEST(SkipListTest, HeightTest)
+{
+	List<SkipListOptions> list;
+
+	std::vector<Node<SkipListOptions>> nodes(SKIPLIST_TESTSIZE);
+	size_t above_first = 0;
+	for (size_t i = 0; i < SKIPLIST_TESTSIZE; ++i) {
+		nodes[i] = Node<SkipListOptions>(static_cast<int>(i));
+		list.insert(nodes[i]);
+		ASSERT_GE(nodes[i].dbg_get_height(), size_t{1});
+		ASSERT_LE(nodes[i].dbg_get_height(), SkipListOptions::skiplist_max_height);
+		if (nodes[i].dbg_get_height() > 1) {
+			above_first++;
+		}
+	}
+	list.dbg_verify();
+
+	// About a quarter of the nodes reach beyond the lowest level
+	ASSERT_GT(above_first, SKIPLIST_TESTSIZE / 8);
+	ASSERT_LT(above_first, SKIPLIST_TESTSIZE / 2);
+}
+
+TEST(SkipListTest, ConcurrentInsertionAndDeletionTest)
+{
+	using N = Node<SkipListOptions>;
+	List<SkipListOptions> list;
+
+	// Every writer thread works on its own set of nodes with negative keys. The
+	// nodes with positive odd keys stay in the list all the time, the readers
+	// must always find them.
+	std::vector<N> fixed_nodes(SKIPLIST_TESTSIZE);
+	std::vector<N> nodes(SKIPLIST_TESTSIZE * SKIPLIST_THREADS);
+	for (size_t i = 0; i < SKIPLIST_TESTSIZE; ++i) {
+		fixed_nodes[i] = N(static_cast<int>(2 * i + 1));
+		list.insert(fixed_nodes[i]);
+	}
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(-static_cast<int>(2 * i + 2));
+	}
+
+	std::atomic<bool> writers_done(false);
+	std::atomic<size_t> reader_errors(0);
+
+	auto writer = [&](size_t thread_id) {
+		std::vector<size_t> indices;
+		for (size_t i = 0; i < SKIPLIST_TESTSIZE; ++i) {
+			indices.push_back(thread_id * SKIPLIST_TESTSIZE + i);
+		}
+		std::shuffle(indices.begin(), indices.end(),
+		             ygg::testing::utilities::Randomizer(SKIPLIST_SEED + thread_id));
+
+		for (auto index : indices) {
+			list.insert(nodes[index]);
+		}
+		// Remove every second one again
+		for (auto index : indices) {
+			if (index % 2 == 0) {
+				list.remove(nodes[index]);
+			}
+		}
+	};
+
+	auto reader = [&]() {
+		while (!writers_done.load()) {
+			for (size_t i = 0; i < SKIPLIST_TESTSIZE; i += 7) {
+				if (&*list.find(static_cast<int>(2 * i + 1)) != &fixed_nodes[i]) {
+					reader_errors++;
+				}
+				if (list.find(static_cast<int>(2 * i + 2)) != list.end()) {
+					reader_errors++;
+				}
+			}
+
+			// Iteration must always see the fixed nodes, in order
+			size_t fixed_seen = 0;
+			const N * last = nullptr;
+			for (const auto & n : list) {
+				if ((last != nullptr) && !(*last < n)) {
+					reader_errors++;
+				}
+				if (n.data > 0) {
+					fixed_seen++;
+				}
+				last = &n;
+			}
+			if (fixed_seen != SKIPLIST_TESTSIZE) {
+				reader_errors++;
+			}
+		}
+	};
+
+	std::vector<std::thread> writers;
+	std::vector<std::thread> readers;
+	for (size_t t = 0; t < SKIPLIST_THREADS; ++t) {
+		writers.emplace_back(writer, t);
+		readers.emplace_back(reader);
+	}
+	for (auto & t : writers) {
+		t.join();
+	}
+	writers_done.store(true);
+	for (auto & t : readers) {
+		t.join();
+	}
+
+	ASSERT_EQ(reader_errors.load(), size_t{0});
+	list.dbg_verify();
+	ASSERT_EQ(list.size(), SKIPLIST_TESTSIZE + nodes.size() / 2);
+
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (i % 2 == 0) {
+			ASSERT_EQ(list.find(nodes[i].data), list.end());
+		} else {
+			ASSERT_EQ(&*list.find(nodes[i].data), &nodes[i]);
+		}
+	}
+	for (size_t i = 0; i < SKIPLIST_TESTSIZE; ++i) {
+		ASSERT_EQ(&*list.find(fixed_nodes[i].data), &fixed_nodes[i]);
+	}
+}
+
+TEST(SkipListTest, ConcurrentInterleavedKeysTest)
+{
+	using N = Node<SkipListOptions>;
+	List<SkipListOptions> list;
+
+	// All writers work on interleaved keys, such that they constantly modify
+	// the same links. Every thread removes every second of its nodes again,
+	// while the others are still inserting.
+	std::vector<N> nodes(SKIPLIST_TESTSIZE * SKIPLIST_THREADS);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+	}
+
+	auto writer = [&](size_t thread_id) {
+		for (size_t i = thread_id; i < nodes.size(); i += SKIPLIST_THREADS) {
+			list.insert(nodes[i]);
+			if ((i >= 2 * SKIPLIST_THREADS) &&
+			    (((i - 2 * SKIPLIST_THREADS) / SKIPLIST_THREADS) % 2 == 0)) {
+				list.remove(nodes[i - 2 * SKIPLIST_THREADS]);
+			}
+		}
+	};
+
+	std::vector<std::thread> writers;
+	for (size_t t = 0; t < SKIPLIST_THREADS; ++t) {
+		writers.emplace_back(writer, t);
+	}
+	for (auto & t : writers) {
+		t.join();
+	}
+
+	list.dbg_verify();
+	size_t expected = 0;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		const bool removed = (i + 2 * SKIPLIST_THREADS < nodes.size()) &&
+		                     ((i / SKIPLIST_THREADS) % 2 == 0);
+		if (removed) {
+			ASSERT_EQ(list.find(static_cast<int>(i)), list.end());
+		} else {
+			ASSERT_EQ(&*list.find(static_cast<int>(i)), &nodes[i]);
+			expected++;
+		}
+	}
+	ASSERT_EQ(list.size(), expected);
+	ASSERT_EQ(list.dbg_count(), expected);
+}
+
+TEST(SkipListTest, ConcurrentRemovalOfSameNodesTest)
+{
+	using N = Node<SkipListOptions>;
+	List<SkipListOptions> list;
+
+	std::vector<N> nodes(SKIPLIST_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		list.insert(nodes[i]);
+	}
+
+	// All threads try to remove all of the first half of the nodes. Every node
+	// must be removed (and counted) exactly once.
+	std::atomic<size_t> removals(0);
+	auto remover = [&](size_t thread_id) {
+		std::vector<size_t> indices;
+		for (size_t i = 0; i < nodes.size() / 2; ++i) {
+			indices.push_back(i);
+		}
+		std::shuffle(indices.begin(), indices.end(),
+		             ygg::testing::utilities::Randomizer(SKIPLIST_SEED + thread_id));
+
+		for (auto index : indices) {
+			if (list.remove(nodes[index])) {
+				removals++;
+			}
+		}
+	};
+
+	std::vector<std::thread> removers;
+	for (size_t t = 0; t < SKIPLIST_THREADS; ++t) {
+		removers.emplace_back(remover, t);
+	}
+	for (auto & t : removers) {
+		t.join();
+	}
+
+	list.dbg_verify();
+	ASSERT_EQ(removals.load(), nodes.size() / 2);
+	ASSERT_EQ(list.size(), nodes.size() - nodes.size() / 2);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (i < nodes.size() / 2) {
+			ASSERT_EQ(list.find(static_cast<int>(i)), list.end());
+		} else {
+			ASSERT_EQ(&*list.find(static_cast<int>(i)), &nodes[i]);
+		}
+	}
+}
+
+} // namespace skiplist
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_SKIPLIST_HPP
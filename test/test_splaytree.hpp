@@ -0,0 +1,246 @@
+#ifndef TEST_SPLAYTREE_HPP
+#define TEST_SPLAYTREE_HPP
+
+#include "../src/splaytree.hpp"
+#include "randomizer.hpp"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace ygg {
+namespace testing {
+namespace splaytree {
+
+using namespace ygg;
+
+constexpr size_t SPLAYTREE_TESTSIZE = 3000;
+constexpr size_t SPLAYTREE_CHECK_INTERVAL = 100;
+constexpr size_t SPLAYTREE_SEED = 4;
+
+template <class Opts>
+class Node : public SplayTreeNodeBase<Node<Opts>, Opts> {
+public:
+	int data;
+
+	Node() : data(0){};
+	explicit Node(int data_in) : data(data_in){};
+
+	bool
+	operator<(const Node & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+template <class Opts>
+bool
+operator<(const Node<Opts> & lhs, const int rhs)
+{
+	return lhs.data < rhs;
+}
+template <class Opts>
+bool
+operator<(const int lhs, const Node<Opts> & rhs)
+{
+	return lhs < rhs.data;
+}
+
+using Options = TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE>;
+using SemiOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                TreeFlags::SPLAY_SEMI, TreeFlags::MICRO_PREFETCH,
+                TreeFlags::MICRO_AVOID_CONDITIONALS>;
+using EveryOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                TreeFlags::SPLAY_EVERY<4>>;
+using EraseOptions =
+    TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                TreeFlags::STL_ERASE>;
+using SetOptions = TreeOptions<TreeFlags::CONSTANT_TIME_SIZE>;
+using SemiSetOptions =
+    TreeOptions<TreeFlags::CONSTANT_TIME_SIZE, TreeFlags::SPLAY_SEMI>;
+
+template <class Opts>
+void
+run_random_test()
+{
+	using N = Node<Opts>;
+	SplayTree<N, Opts> tree;
+
+	std::vector<N> nodes(SPLAYTREE_TESTSIZE);
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(SPLAYTREE_SEED));
+
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.insert(nodes[indices[i]]);
+		if (i % SPLAYTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), SPLAYTREE_TESTSIZE);
+
+	int expected = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(n.data, expected);
+		expected++;
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(SPLAYTREE_SEED + 1));
+	for (size_t i = 0; i < indices.size(); ++i) {
+		ASSERT_EQ(&*tree.find(static_cast<int>(indices[i])), &nodes[indices[i]]);
+		if (i % SPLAYTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+	}
+	ASSERT_EQ(tree.find(-1), tree.end());
+	ASSERT_EQ(tree.find(static_cast<int>(SPLAYTREE_TESTSIZE)), tree.end());
+	ASSERT_TRUE(tree.verify_integrity());
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(SPLAYTREE_SEED + 2));
+	for (size_t i = 0; i < indices.size(); ++i) {
+		tree.remove(nodes[indices[i]]);
+		if (i % SPLAYTREE_CHECK_INTERVAL == 0) {
+			ASSERT_TRUE(tree.verify_integrity());
+			ASSERT_EQ(tree.size(), SPLAYTREE_TESTSIZE - i - 1);
+		}
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(SplayTreeTest, RandomInsertionDeletionTest)
+{
+	run_random_test<Options>();
+}
+
+TEST(SplayTreeTest, SemiSplayTest) { run_random_test<SemiOptions>(); }
+
+TEST(SplayTreeTest, SplayEveryTest) { run_random_test<EveryOptions>(); }
+
+TEST(SplayTreeTest, FindSplaysToRootTest)
+{
+	using N = Node<Options>;
+	SplayTree<N, Options> tree;
+
+	std::vector<N> nodes(SPLAYTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		// Sorted insertion degenerates to a path, but every insertion is O(1)
+		ASSERT_EQ(tree.get_root(), &nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+
+	for (size_t i = 0; i < nodes.size(); i += 7) {
+		auto it = tree.find(static_cast<int>(i));
+		ASSERT_EQ(&*it, &nodes[i]);
+		ASSERT_EQ(tree.get_root(), &nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+
+	// An unsuccessful search splays the last node on the search path
+	tree.remove(nodes[10]);
+	ASSERT_EQ(tree.find(10), tree.end());
+	ASSERT_TRUE((tree.get_root() == &nodes[9]) ||
+	            (tree.get_root() == &nodes[11]));
+
+	// The const version does not modify the tree
+	const auto & const_tree = tree;
+	N * root = tree.get_root();
+	ASSERT_EQ(&*const_tree.find(42), &nodes[42]);
+	ASSERT_EQ(tree.get_root(), root);
+	ASSERT_TRUE(tree.verify_integrity());
+}
+
+TEST(SplayTreeTest, SplayEveryFindTest)
+{
+	using N = Node<EveryOptions>;
+	SplayTree<N, EveryOptions> tree;
+
+	std::vector<N> nodes(SPLAYTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+	}
+
+	// Only every fourth lookup splays
+	for (size_t i = 0; i < 40; ++i) {
+		N * root = tree.get_root();
+		auto it = tree.find(static_cast<int>(i * 13));
+		ASSERT_EQ(&*it, &nodes[i * 13]);
+		if (i % 4 == 3) {
+			ASSERT_EQ(tree.get_root(), &nodes[i * 13]);
+		} else {
+			ASSERT_EQ(tree.get_root(), root);
+		}
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+}
+
+TEST(SplayTreeTest, MultipleEraseTest)
+{
+	using N = Node<EraseOptions>;
+	SplayTree<N, EraseOptions> tree;
+
+	std::vector<N> nodes(SPLAYTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i % 10));
+		tree.insert(nodes[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+
+	ASSERT_EQ(tree.erase(3), SPLAYTREE_TESTSIZE / 10);
+	ASSERT_EQ(tree.erase(3), 0);
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), SPLAYTREE_TESTSIZE - SPLAYTREE_TESTSIZE / 10);
+
+	int last = 0;
+	for (const auto & n : tree) {
+		ASSERT_LE(last, n.data);
+		ASSERT_NE(n.data, 3);
+		last = n.data;
+	}
+}
+
+template <class Opts>
+void
+run_set_test()
+{
+	using N = Node<Opts>;
+	SplayTree<N, Opts> tree;
+
+	std::vector<N> nodes(SPLAYTREE_TESTSIZE);
+	std::vector<N> duplicates(SPLAYTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = N(static_cast<int>(i));
+		duplicates[i] = N(static_cast<int>(i));
+		tree.insert(nodes[i]);
+		tree.insert(duplicates[i]);
+	}
+	ASSERT_TRUE(tree.verify_integrity());
+	ASSERT_EQ(tree.size(), nodes.size());
+
+	ASSERT_EQ(tree.erase(7), &nodes[7]);
+	ASSERT_EQ(tree.erase(7), nullptr);
+	ASSERT_TRUE(tree.verify_integrity());
+}
+
+TEST(SplayTreeTest, SetTest)
+{
+	run_set_test<SetOptions>();
+	run_set_test<SemiSetOptions>();
+}
+
+} // namespace splaytree
+} // namespace testing
+} // namespace ygg
+
+#endif // TEST_SPLAYTREE_HPP
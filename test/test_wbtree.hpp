@@ -2,12 +2,15 @@
 #define YGG_TEST_WBTREE_HPP
 
 #include "../src/wbtree.hpp"
+#include "common_tree_tests.hpp"
 #include "randomizer.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <gtest/gtest.h>
 #include <random>
 #include <sstream>
+#include <unordered_set>
 #include <vector>
 
 namespace ygg {
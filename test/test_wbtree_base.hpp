@@ -443,6 +443,59 @@ i++;
 }
 }
 */
+TEST(__WBT_BASENAME(WBTreeTest), ParallelBuildTest)
+{
+	// Large enough to actually use multiple threads
+	constexpr size_t BUILD_SIZE = 3 * parallel_internal::PARALLEL_CUTOFF + 17;
+	using Tree = WBTree<Node, WBDefaultNodeTraits, DEFAULT_FLAGS<>>;
+
+	// Every value appears twice, only the first one must be inserted.
+	utilities::run_parallel_build_test<Tree, Node>(
+	    2 * BUILD_SIZE, WBTREE_SEED, 4, false,
+	    [](Node & n, size_t i) { n = Node(static_cast<int>(i / 2)); },
+	    [](const Node & lhs, const Node & rhs) { return lhs.data < rhs.data; });
+}
+
+TEST(__WBT_BASENAME(WBTreeTest), ParallelBuildWithHooksTest)
+{
+	using Tree = WBTree<MultiNode, MultiNodeTraits, MULTI_FLAGS<>>;
+
+	// Equal nodes must keep their order in the range
+	utilities::run_parallel_build_test<Tree, MultiNode>(
+	    WBTREE_TESTSIZE, WBTREE_SEED, 0, true,
+	    [](MultiNode & n, size_t i) {
+		    n = MultiNode(static_cast<int>(i % 100), static_cast<int>(i));
+	    },
+	    [](const MultiNode & lhs, const MultiNode & rhs) {
+		    return lhs.data < rhs.data;
+	    });
+}
+
+TEST(__WBT_BASENAME(WBTreeTest), UpdateKeyTest)
+{
+	using Tree = WBTree<Node, NodeTraits, DEFAULT_FLAGS<>>;
+	utilities::run_update_key_test<Tree, Node>(WBTREE_TESTSIZE, WBTREE_SEED);
+}
+
+TEST(__WBT_BASENAME(WBTreeTest), UpdateKeyMultipleTest)
+{
+	using Tree = WBTree<MultiNode, MultiNodeTraits, MULTI_FLAGS<>>;
+	utilities::run_update_key_multiple_test<Tree, MultiNode>(WBTREE_TESTSIZE,
+	                                                         WBTREE_SEED);
+}
+
+TEST(__WBT_BASENAME(WBTreeTest), UpdateKeyCollisionTest)
+{
+	using Tree = WBTree<Node, NodeTraits, DEFAULT_FLAGS<>>;
+	utilities::run_update_key_collision_test<Tree, Node>(WBTREE_TESTSIZE);
+}
+
+TEST(__WBT_BASENAME(WBTreeTest), UpdateKeyInPlaceTest)
+{
+	using Tree = WBTree<Node, NodeTraits, DEFAULT_FLAGS<>>;
+	utilities::run_update_key_in_place_test<Tree, Node>(WBTREE_TESTSIZE);
+}
+
 TEST(__WBT_BASENAME(WBTreeTest), LowerBoundTest)
 {
 	auto tree = WBTree<Node, NodeTraits, DEFAULT_FLAGS<>>();
@@ -889,6 +942,123 @@ TEST(__WBT_BASENAME(WBTreeTest), FindTest)
 	}
 }
 
+TEST(__WBT_BASENAME(WBTreeTest), OrderStatisticsTest)
+{
+	auto tree = WBTree<MultiNode, MultiNodeTraits, MULTI_FLAGS<>>();
+
+	ASSERT_EQ(tree.select(0), tree.end());
+	ASSERT_EQ(tree.quantile(0.5), tree.end());
+	ASSERT_EQ(tree.count_between(0, 100), 0);
+
+	// Every value appears twice
+	std::vector<MultiNode> nodes(WBTREE_TESTSIZE);
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = MultiNode(static_cast<int>(i / 2), static_cast<int>(i));
+	}
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(WBTREE_SEED));
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+
+	size_t k = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(&(*tree.select(k)), &n);
+		ASSERT_EQ(tree.rank(n), k);
+		k++;
+	}
+	ASSERT_EQ(tree.select(k), tree.end());
+
+	// Nearest-rank quantiles
+	ASSERT_EQ(tree.quantile(0.0)->data, 0);
+	ASSERT_EQ(tree.quantile(1.0)->data, WBTREE_TESTSIZE / 2 - 1);
+	ASSERT_EQ(tree.quantile(0.5), tree.select(WBTREE_TESTSIZE / 2 - 1));
+	ASSERT_EQ(tree.quantile(0.99),
+	          tree.select(static_cast<size_t>(
+	              std::ceil(0.99 * WBTREE_TESTSIZE) - 1)));
+
+	for (int lower = -3; lower < WBTREE_TESTSIZE / 2 + 3; lower += 7) {
+		for (int upper = lower - 5; upper < WBTREE_TESTSIZE / 2 + 3;
+		     upper += 97) {
+			int expected = std::max(std::min(upper, WBTREE_TESTSIZE / 2) -
+			                            std::max(lower, 0),
+			                        0);
+			ASSERT_EQ(tree.count_between(lower, upper),
+			          static_cast<size_t>(2 * expected));
+		}
+	}
+
+	// Remove half of the nodes, ranks must follow.
+	for (size_t i = 0; i < nodes.size(); i += 2) {
+		tree.remove(nodes[i]);
+	}
+	k = 0;
+	for (const auto & n : tree) {
+		ASSERT_EQ(tree.rank(n), k);
+		ASSERT_EQ(n.data, static_cast<int>(k));
+		k++;
+	}
+	ASSERT_EQ(tree.count_between(10, 20), 10);
+}
+
+TEST(__WBT_BASENAME(WBTreeTest), RebalanceSubtreeTest)
+{
+	auto tree = WBTree<MultiNode, MultiNodeTraits, MULTI_FLAGS<>>();
+
+	std::vector<MultiNode> nodes(WBTREE_TESTSIZE);
+	std::vector<size_t> indices(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		nodes[i] = MultiNode(static_cast<int>(i / 3), static_cast<int>(i));
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(WBTREE_SEED));
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+	}
+
+	auto check = [&]() {
+		if (MULTI_FLAGS<>::wbt_delta() >= 2) {
+			ASSERT_TRUE(tree.verify_integrity());
+		}
+		size_t k = 0;
+		int last = -1;
+		for (const auto & n : tree) {
+			ASSERT_LE(last, n.data);
+			last = n.data;
+			ASSERT_EQ(&(*tree.select(k)), &n);
+			k++;
+		}
+		ASSERT_EQ(k, nodes.size());
+	};
+
+	// Rebalance a subtree below the root
+	tree.rebalance_subtree(*tree.get_root()->get_left());
+	check();
+
+	// Rebalancing the whole tree yields minimal height
+	tree.rebalance_subtree(*tree.get_root());
+	check();
+	size_t height = 0;
+	for (const auto & n : tree) {
+		height = std::max(height, n.get_depth() + 1);
+	}
+	ASSERT_EQ(height, static_cast<size_t>(std::ceil(
+	                      std::log2(static_cast<double>(nodes.size() + 1)))));
+
+	// Rebalancing a single node does nothing
+	MultiNode * leaf = tree.get_root();
+	while (leaf->get_left() != nullptr) {
+		leaf = leaf->get_left();
+	}
+	tree.rebalance_subtree(*leaf);
+	check();
+}
+
 TEST(__WBT_BASENAME(WBTreeTest), ComprehensiveTest)
 {
 	auto tree = WBTree<Node, NodeTraits, DEFAULT_FLAGS<>>();
@@ -2,6 +2,7 @@
 #define TEST_ZIPTREE_HPP
 
 #include "../src/ziptree.hpp"
+#include "common_tree_tests.hpp"
 #include "randomizer.hpp"
 
 #include <algorithm>
@@ -376,6 +377,44 @@ TEST(ZipTreeTest, InsertionAndIterationTest)
 	}
 }
 
+TEST(ZipTreeTest, ParallelBuildTest)
+{
+	// Large enough to actually use multiple threads
+	constexpr size_t BUILD_SIZE = 3 * parallel_internal::PARALLEL_CUTOFF + 17;
+	// Uses the default traits, thus the parallel code path
+	using Tree = ZTree<Node, ZTreeDefaultNodeTraits<Node>, ExplicitRankOptions<>,
+	                   int, ygg::utilities::flexible_less, DataRankGetter>;
+
+	// Every value appears twice, with geometrically distributed ranks and thus
+	// many ties. Equal values are ordered by rank.
+	std::mt19937 rng(ZIPTREE_SEED);
+	std::geometric_distribution<int> rank_dist(0.5);
+	utilities::run_parallel_build_test<Tree, Node>(
+	    BUILD_SIZE, ZIPTREE_SEED, 4, true,
+	    [&](Node & n, size_t i) {
+		    n = Node(static_cast<int>(i / 2), rank_dist(rng));
+	    },
+	    [](const Node & lhs, const Node & rhs) {
+		    if (lhs.get_data() != rhs.get_data()) {
+			    return lhs.get_data() < rhs.get_data();
+		    }
+		    return lhs.get_rank() < rhs.get_rank();
+	    });
+}
+
+TEST(ZipTreeTest, ParallelBuildWithHooksTest)
+{
+	utilities::run_parallel_build_test<ImplicitRankTree, HashRankNode>(
+	    ZIPTREE_TESTSIZE, ZIPTREE_SEED, 0, true,
+	    [](HashRankNode & n, size_t i) {
+		    // Copying does not copy the rank
+		    n.set_from(HashRankNode(static_cast<int>(i)));
+	    },
+	    [](const HashRankNode & lhs, const HashRankNode & rhs) {
+		    return lhs.get_data() < rhs.get_data();
+	    });
+}
+
 TEST(ZipTreeTest, InsertionAndDeletionTest)
 {
 	ExplicitRankTree tree;
@@ -434,6 +473,61 @@ TEST(ZipTreeTest, InsertionAndDeletionTest)
 	ASSERT_TRUE(iit == itree.end());
 }
 
+template <class Tree, class N>
+void
+run_update_key_test(Tree & tree, N * nodes)
+{
+	std::mt19937 rng(ZIPTREE_SEED);
+	std::uniform_int_distribution<size_t> node_distr(0, ZIPTREE_TESTSIZE - 1);
+	std::uniform_int_distribution<int> nudge_distr(-2, 2);
+	std::uniform_int_distribution<int> jump_distr(
+	    0, static_cast<int>(ZIPTREE_TESTSIZE));
+
+	// Mostly small nudges that keep the order, some large jumps
+	for (size_t i = 0; i < 5 * ZIPTREE_TESTSIZE; ++i) {
+		N & n = nodes[node_distr(rng)];
+		const int new_key =
+		    (i % 5 == 0) ? jump_distr(rng) : n.data + nudge_distr(rng);
+		tree.update_key(n, [&](N & node) { node.data = new_key; });
+		if (i % 100 == 0) {
+			tree.dbg_verify();
+		}
+	}
+	tree.dbg_verify();
+	ASSERT_EQ(tree.size(), ZIPTREE_TESTSIZE);
+
+	for (size_t i = 0; i < ZIPTREE_TESTSIZE; ++i) {
+		tree.remove(nodes[i]);
+	}
+	ASSERT_TRUE(tree.empty());
+}
+
+TEST(ZipTreeTest, UpdateKeyTest)
+{
+	ExplicitRankTree tree;
+	ImplicitRankTree itree;
+
+	Node nodes[ZIPTREE_TESTSIZE];
+	HashRankNode inodes[ZIPTREE_TESTSIZE];
+
+	std::vector<size_t> indices(ZIPTREE_TESTSIZE);
+	for (size_t i = 0; i < ZIPTREE_TESTSIZE; ++i) {
+		indices[i] = i;
+	}
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(ZIPTREE_SEED));
+
+	for (size_t i = 0; i < ZIPTREE_TESTSIZE; ++i) {
+		nodes[i] = Node(static_cast<int>(i), static_cast<int>(indices[i]));
+		inodes[i].set_from(HashRankNode(static_cast<int>(i)));
+		tree.insert(nodes[i]);
+		itree.insert(inodes[i]);
+	}
+
+	run_update_key_test(tree, nodes);
+	run_update_key_test(itree, inodes);
+}
+
 TEST(ZipTreeTest, EraseIteratorTest)
 {
 	ExplicitRankTree tree;
@@ -587,6 +681,150 @@ TEST(ZipTreeTest, ComprehensiveTest)
 	}
 }
 
+using CompressedRankOptions =
+    ygg::TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                     TreeFlags::ZTREE_COMPRESS_RANK>;
+using CompressedHashRankOptions =
+    ygg::TreeOptions<TreeFlags::MULTIPLE, TreeFlags::CONSTANT_TIME_SIZE,
+                     TreeFlags::ZTREE_USE_HASH, TreeFlags::ZTREE_COMPRESS_RANK>;
+
+class CompressedRankNode
+    : public ZTreeNodeBase<CompressedRankNode, CompressedRankOptions> {
+public:
+	int data;
+
+	CompressedRankNode() : data(0){};
+	CompressedRankNode(int data_in) : data(data_in){};
+
+	bool
+	operator<(const CompressedRankNode & other) const
+	{
+		return this->data < other.data;
+	}
+};
+
+class CompressedHashRankNode
+    : public ZTreeNodeBase<CompressedHashRankNode, CompressedHashRankOptions> {
+public:
+	int data;
+
+	CompressedHashRankNode() : data(0){};
+
+	bool
+	operator<(const CompressedHashRankNode & other) const
+	{
+		return this->data < other.data;
+	}
+
+	void
+	set_data(int data_in)
+	{
+		this->data = data_in;
+		this->update_rank();
+	}
+};
+
+class CompressedHashRankHasher {
+public:
+	size_t
+	operator()(const CompressedHashRankNode & n) const noexcept
+	{
+		return std::hash<int>{}(n.data) * size_t{0x9E3779B97F4A7C15ull};
+	}
+};
+
+} // namespace ziptree
+} // namespace testing
+} // namespace ygg
+
+namespace std {
+template <>
+struct hash<ygg::testing::ziptree::CompressedHashRankNode>
+{
+	size_t
+	operator()(const ygg::testing::ziptree::CompressedHashRankNode & n) const
+	    noexcept
+	{
+		return ygg::testing::ziptree::CompressedHashRankHasher{}(n);
+	}
+};
+} // namespace std
+
+namespace ygg {
+namespace testing {
+namespace ziptree {
+
+TEST(ZipTreeTest, CompressedRankTest)
+{
+	using CompressedTree =
+	    ZTree<CompressedRankNode, ZTreeDefaultNodeTraits<CompressedRankNode>,
+	          CompressedRankOptions>;
+	using CompressedHashTree =
+	    ZTree<CompressedHashRankNode,
+	          ZTreeDefaultNodeTraits<CompressedHashRankNode>,
+	          CompressedHashRankOptions>;
+
+	// The rank must not take up any space in the node
+	ASSERT_EQ(sizeof(ZTreeNodeBase<CompressedRankNode, CompressedRankOptions>),
+	          3 * sizeof(void *));
+	ASSERT_EQ(sizeof(ZTreeNodeBase<CompressedHashRankNode,
+	                               CompressedHashRankOptions>),
+	          3 * sizeof(void *));
+
+	CompressedTree tree;
+	CompressedHashTree htree;
+
+	std::vector<CompressedRankNode> nodes(ZIPTREE_TESTSIZE);
+	std::vector<CompressedHashRankNode> hnodes(ZIPTREE_TESTSIZE);
+	std::vector<size_t> indices;
+	std::vector<size_t> ranks;
+
+	for (size_t i = 0; i < ZIPTREE_TESTSIZE; ++i) {
+		nodes[i] = CompressedRankNode(static_cast<int>(i));
+		hnodes[i].set_data(static_cast<int>(i));
+		ranks.push_back(hnodes[i].dbg_get_rank());
+		indices.push_back(i);
+	}
+
+	std::shuffle(indices.begin(), indices.end(),
+	             ygg::testing::utilities::Randomizer(ZIPTREE_SEED));
+
+	for (auto index : indices) {
+		tree.insert(nodes[index]);
+		htree.insert(hnodes[index]);
+	}
+
+	tree.dbg_verify();
+	htree.dbg_verify();
+
+	// Linking must not have changed the ranks
+	for (size_t i = 0; i < ZIPTREE_TESTSIZE; ++i) {
+		ASSERT_EQ(hnodes[i].dbg_get_rank(), ranks[i]);
+	}
+
+	int i = 0;
+	for (auto & node : tree) {
+		ASSERT_EQ(node.data, i);
+		i++;
+	}
+
+	for (auto index : indices) {
+		if (index % 2 == 0) {
+			tree.remove(nodes[index]);
+			htree.remove(hnodes[index]);
+		}
+	}
+	ASSERT_EQ(tree.size(), ZIPTREE_TESTSIZE / 2);
+	ASSERT_EQ(htree.size(), ZIPTREE_TESTSIZE / 2);
+
+	tree.dbg_verify();
+	htree.dbg_verify();
+
+	for (size_t j = 0; j < ZIPTREE_TESTSIZE; ++j) {
+		ASSERT_EQ(hnodes[j].dbg_get_rank(), ranks[j]);
+	}
+}
+
 /*****************************************
  * Test for individual bugs
  *****************************************/